@@ -5,11 +5,13 @@
 #include "application/input/InputActionMap.hpp"
 #include "application/input/InputManager.hpp"
 
+#include "base/memory/AllocatorRegistry.hpp"
 #include "base/memory/HeapAllocator.hpp"
 
 #include "ecs/core/EntityWorld.hpp"
 #include "ecs/systems/SystemBase.hpp"
 
+#include "engine/components/CoreComponents.hpp"
 #include "engine/components/RenderingComponents.hpp"
 #include <engine/rendering/IRenderDevice.hpp>
 
@@ -27,6 +29,7 @@
 #include "engine/systems/ModelLoadSystem.hpp"
 #include "engine/systems/RenderSystem.hpp"
 #include "engine/systems/TransformMatrixCalculateSystem.hpp"
+#include "engine/systems/TransformHierarchySystem.hpp"
 #include "engine/ui/ReflectedComponents.hpp"
 #include "engine/ui/TypeInspectorRegistry.hpp"
 #include "engine/ui/UIInspectorManager.hpp"
@@ -51,7 +54,7 @@ int main(int argc, char* argv[])
 		spite::EntityWorld world(spite::getGlobalAllocator());
 
 		world.getSystemManager().registerSystems<
-			ModelLoadSystem, CameraMatricesUpdateSystem, TransformMatrixCalculateSystem,
+			ModelLoadSystem, CameraMatricesUpdateSystem, TransformMatrixCalculateSystem, TransformHierarchySystem,
 			BeginFrameSystem,
 			DepthPassSystem, GeometryPassSystem, LightPassSystem, CompositePassSystem, RenderSystem,
 			EventCleanupSystem>();
@@ -78,17 +81,18 @@ int main(int argc, char* argv[])
 			RenderResourceManagerSingleton{
 				.resourceManager = &renderingManager.getApiManager().renderer()->getDevice().getResourceManager()
 			}));
+		world.getEntityManager().registerSingletonComponent(std::make_unique<CameraMatricesSingleton>());
 
 		world.initialize();
 
 		UIInspectorManager::init(*windowManager, *renderingManager.getApiManager().renderer(),
 		                         world.getEntityManager());
 
-		world.getEntityManager().getEventManager().fire<ModelLoadRequest>(ModelLoadRequest{
+		world.getEntityManager().getEventManager().send<ModelLoadRequest>(ModelLoadRequest{
 			.filePath = toHashedString("models/cube2.obj")
 		});
 
-		world.getEntityManager().getEventManager().fire<ModelLoadRequest>(ModelLoadRequest{
+		world.getEntityManager().getEventManager().send<ModelLoadRequest>(ModelLoadRequest{
 			.filePath = toHashedString("models/cube2.obj")
 		});
 
@@ -105,6 +109,7 @@ int main(int argc, char* argv[])
 			eventDispatcher.pollEvents();
 			world.update(0.1f);
 			FrameScratchAllocator::resetFrame();
+			AllocatorRegistry::instance().endFrame();
 			//SDEBUG_LOG("Frame %zu finish\n", update)
 			++update;
 		}
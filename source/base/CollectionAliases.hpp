@@ -31,6 +31,12 @@ namespace spite
 	template <typename T>
 	using heap_set = eastl::vector_set<T, eastl::less<T>, HeapAllocatorAdapter<T>>;
 
+	template <typename Key, typename Value, typename Hash = eastl::hash<Key>, typename Equal = eastl::equal_to<Key>>
+	using heap_flat_map = flat_hash_map<Key, Value, Hash, Equal, HeapAllocatorAdapter<eastl::pair<const Key, Value>>>;
+
+	template <typename Key, typename Hash = eastl::hash<Key>, typename Equal = eastl::equal_to<Key>>
+	using heap_flat_set = flat_hash_set<Key, Hash, Equal, HeapAllocatorAdapter<Key>>;
+
 	//Type aliases for global heap allocated collections
 	template <typename T>
 	using glheap_vector = eastl::vector<T, GlobalHeapAllocator<T>>;
@@ -48,6 +54,9 @@ namespace spite
 	                                                  GlobalHeapAllocator<eastl::pair<
 		                                                  const Key, Value>>>;
 
+	template <typename Key, typename Value, typename Hash = eastl::hash<Key>, typename Equal = eastl::equal_to<Key>>
+	using glheap_flat_map = flat_hash_map<Key, Value, Hash, Equal>;
+
 	template <typename T, sizet C>
 	using heap_sbo_vector = sbo_vector<T, C, HeapAllocatorAdapter<T>>;
 
@@ -70,6 +79,13 @@ namespace spite
 	                                                   Hash, eastl::equal_to<Key>,
 	                                                   ScratchAllocatorAdapter<eastl::pair<
 		                                                   const Key, Value>>>;
+
+	template <typename Key, typename Value, typename Hash = eastl::hash<Key>, typename Equal = eastl::equal_to<Key>>
+	using scratch_flat_map = flat_hash_map<Key, Value, Hash, Equal,
+	                                       ScratchAllocatorAdapter<eastl::pair<const Key, Value>>>;
+
+	template <typename Key, typename Hash = eastl::hash<Key>, typename Equal = eastl::equal_to<Key>>
+	using scratch_flat_set = flat_hash_set<Key, Hash, Equal, ScratchAllocatorAdapter<Key>>;
 }
 
 namespace eastl
@@ -15,6 +15,18 @@ namespace spite
 		return heap_unordered_map<Key, Value, Hash>(HeapAllocatorAdapter<eastl::pair<const Key, Value>>(allocator));
 	}
 
+	template <typename Key, typename Value, typename Hash = eastl::hash<Key>>
+	heap_flat_map<Key, Value, Hash> makeHeapFlatMap(const HeapAllocator& allocator)
+	{
+		return heap_flat_map<Key, Value, Hash>(HeapAllocatorAdapter<eastl::pair<const Key, Value>>(allocator));
+	}
+
+	template <typename Key, typename Hash = eastl::hash<Key>>
+	heap_flat_set<Key, Hash> makeHeapFlatSet(const HeapAllocator& allocator)
+	{
+		return heap_flat_set<Key, Hash>(HeapAllocatorAdapter<Key>(allocator));
+	}
+
 	template <typename T>
 	heap_set<T> makeHeapSet(const HeapAllocator& allocator)
 	{
@@ -40,6 +52,18 @@ namespace spite
 			ScratchAllocatorAdapter<eastl::pair<const Key, Value>>(allocator));
 	}
 
+	template <typename Key, typename Value, typename Hash = eastl::hash<Key>>
+	scratch_flat_map<Key, Value, Hash> makeScratchFlatMap(ScratchAllocator& allocator)
+	{
+		return scratch_flat_map<Key, Value, Hash>(ScratchAllocatorAdapter<eastl::pair<const Key, Value>>(allocator));
+	}
+
+	template <typename Key, typename Hash = eastl::hash<Key>>
+	scratch_flat_set<Key, Hash> makeScratchFlatSet(ScratchAllocator& allocator)
+	{
+		return scratch_flat_set<Key, Hash>(ScratchAllocatorAdapter<Key>(allocator));
+	}
+
 	template <typename T>
 	scratch_set<T> makeScratchSet(ScratchAllocator& allocator)
 	{
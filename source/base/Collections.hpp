@@ -1,10 +1,19 @@
 #pragma once
 #include <algorithm>
+#include <bit>
+#include <cstring>
 #include <initializer_list>
 #include <utility>
 
+#include <EASTL/functional.h>
+#include <EASTL/utility.h>
+
 #include "memory/HeapAllocator.hpp"
 
+#if defined(SPITE_SIMD_SSE)
+#include <emmintrin.h>
+#endif
+
 namespace spite
 {
 	template <typename T, sizet InlineCapacity = 8, typename Allocator = GlobalHeapAllocator<T>>
@@ -494,4 +503,702 @@ namespace spite
 
 		return begin() + first_index;
 	}
+
+	namespace detail
+	{
+		// Control byte per slot of a flat_hash_table, full slots hold the low 7 bits of their hash
+		constexpr i8 FLAT_SLOT_EMPTY = -128;
+		constexpr i8 FLAT_SLOT_DELETED = -2;
+		// Trails the control bytes so iterators stop without a bounds check
+		constexpr i8 FLAT_SLOT_SENTINEL = -1;
+		constexpr sizet FLAT_GROUP_SIZE = 16;
+
+		// Control bytes of tables that have not allocated yet
+		inline constexpr i8 FLAT_EMPTY_CTRL[1] = {FLAT_SLOT_SENTINEL};
+
+		// One bit per slot of a 16 slot group, matched with a single SSE2 compare where available
+		class FlatGroup
+		{
+		private:
+#if defined(SPITE_SIMD_SSE)
+			__m128i m_ctrl;
+#else
+			const i8* m_ctrl;
+#endif
+
+		public:
+			explicit FlatGroup(const i8* ctrl)
+#if defined(SPITE_SIMD_SSE)
+				: m_ctrl(_mm_load_si128(reinterpret_cast<const __m128i*>(ctrl)))
+#else
+				: m_ctrl(ctrl)
+#endif
+			{
+			}
+
+			u32 match(i8 h2) const
+			{
+#if defined(SPITE_SIMD_SSE)
+				return static_cast<u32>(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(h2), m_ctrl)));
+#else
+				u32 mask = 0;
+				for (sizet i = 0; i < FLAT_GROUP_SIZE; ++i)
+				{
+					mask |= static_cast<u32>(m_ctrl[i] == h2) << i;
+				}
+				return mask;
+#endif
+			}
+
+			u32 match_empty() const { return match(FLAT_SLOT_EMPTY); }
+
+			// Empty and deleted slots are the ones with the sign bit set
+			u32 match_free() const
+			{
+#if defined(SPITE_SIMD_SSE)
+				return static_cast<u32>(_mm_movemask_epi8(m_ctrl));
+#else
+				u32 mask = 0;
+				for (sizet i = 0; i < FLAT_GROUP_SIZE; ++i)
+				{
+					mask |= static_cast<u32>(m_ctrl[i] < 0) << i;
+				}
+				return mask;
+#endif
+			}
+		};
+
+		template <typename Key, typename Value>
+		struct FlatMapPolicy
+		{
+			using key_type = Key;
+			using slot_type = eastl::pair<const Key, Value>;
+
+			static const Key& key(const slot_type& slot) { return slot.first; }
+
+			// Keys are const only to users, moving one out of a slot that is destroyed right after is fine
+			static void transfer(slot_type* dst, slot_type* src)
+			{
+				new(dst) slot_type(std::move(const_cast<Key&>(src->first)), std::move(src->second));
+				src->~slot_type();
+			}
+		};
+
+		template <typename Key>
+		struct FlatSetPolicy
+		{
+			using key_type = Key;
+			using slot_type = Key;
+
+			static const Key& key(const slot_type& slot) { return slot; }
+
+			static void transfer(slot_type* dst, slot_type* src)
+			{
+				new(dst) slot_type(std::move(*src));
+				src->~slot_type();
+			}
+		};
+	}
+
+	// Open addressing hash table, elements live inline next to one control byte each and lookups
+	// compare 16 control bytes at a time. Use through flat_hash_map and flat_hash_set.
+	// Growing invalidates iterators and element pointers, erase does not
+	template <typename Policy, typename Hash, typename Equal, typename Allocator>
+	class flat_hash_table
+	{
+	public:
+		using key_type = typename Policy::key_type;
+		using value_type = typename Policy::slot_type;
+		using sizetype = sizet;
+		using hasher = Hash;
+		using key_equal = Equal;
+		using allocator_type = Allocator;
+
+		template <bool IsConst>
+		class iterator_base
+		{
+		private:
+			friend class flat_hash_table;
+			using slot_pointer = std::conditional_t<IsConst, const typename flat_hash_table::value_type*,
+			                                        typename flat_hash_table::value_type*>;
+
+			const i8* m_ctrl = nullptr;
+			slot_pointer m_slot = nullptr;
+
+			iterator_base(const i8* ctrl, slot_pointer slot) : m_ctrl(ctrl), m_slot(slot)
+			{
+				skip_free();
+			}
+
+			void skip_free()
+			{
+				while (*m_ctrl < detail::FLAT_SLOT_SENTINEL)
+				{
+					++m_ctrl;
+					++m_slot;
+				}
+			}
+
+		public:
+			using value_type = typename flat_hash_table::value_type;
+			using reference = std::conditional_t<IsConst, const value_type&, value_type&>;
+			using pointer = slot_pointer;
+			using difference_type = ptrdiff_t;
+			using iterator_category = std::forward_iterator_tag;
+
+			iterator_base() = default;
+
+			template <bool OtherConst, typename = std::enable_if_t<IsConst && !OtherConst>>
+			iterator_base(const iterator_base<OtherConst>& other) : m_ctrl(other.m_ctrl), m_slot(other.m_slot)
+			{
+			}
+
+			reference operator*() const { return *m_slot; }
+			pointer operator->() const { return m_slot; }
+
+			iterator_base& operator++()
+			{
+				++m_ctrl;
+				++m_slot;
+				skip_free();
+				return *this;
+			}
+
+			iterator_base operator++(int)
+			{
+				iterator_base copy = *this;
+				++*this;
+				return copy;
+			}
+
+			template <bool OtherConst>
+			bool operator==(const iterator_base<OtherConst>& other) const { return m_ctrl == other.m_ctrl; }
+
+			template <bool OtherConst>
+			bool operator!=(const iterator_base<OtherConst>& other) const { return m_ctrl != other.m_ctrl; }
+
+			template <bool>
+			friend class iterator_base;
+		};
+
+		using iterator = iterator_base<false>;
+		using const_iterator = iterator_base<true>;
+
+	private:
+		i8* m_ctrl = const_cast<i8*>(detail::FLAT_EMPTY_CTRL);
+		value_type* m_slots = nullptr;
+		sizet m_capacity = 0;
+		sizet m_size = 0;
+		// Empty slots that can still be filled before the load factor is exceeded
+		sizet m_growthLeft = 0;
+		[[no_unique_address]] Hash m_hash;
+		[[no_unique_address]] Equal m_equal;
+		[[no_unique_address]] Allocator m_allocator;
+
+		static constexpr sizet NPOS = static_cast<sizet>(-1);
+		static constexpr sizet MIN_CAPACITY = detail::FLAT_GROUP_SIZE;
+
+		// 7/8
+		static constexpr sizet max_load(sizet capacity) { return capacity - capacity / 8; }
+		static sizet slots_offset(sizet capacity);
+		static sizet allocation_size(sizet capacity);
+
+		sizet hash_of(const key_type& key) const;
+		sizet find_index(const key_type& key, sizet hash) const;
+		sizet find_free_slot(sizet hash) const;
+		void allocate_slots(sizet capacity);
+		void deallocate_slots();
+		void set_ctrl(sizet index, i8 value);
+		void rehash(sizet capacity);
+		void destroy_elements() noexcept;
+		void erase_at(sizet index);
+
+	protected:
+		// Slot index for key, second is true if the caller has to construct the element in it
+		eastl::pair<sizet, bool> find_or_prepare_insert(const key_type& key);
+
+		value_type* slot_at(sizet index) { return m_slots + index; }
+		iterator iterator_at(sizet index) { return iterator(m_ctrl + index, m_slots + index); }
+
+	public:
+		flat_hash_table() = default;
+		explicit flat_hash_table(const Allocator& alloc);
+		flat_hash_table(const Allocator& alloc, const Hash& hash, const Equal& equal = Equal());
+		~flat_hash_table();
+
+		flat_hash_table(const flat_hash_table& other);
+		flat_hash_table(flat_hash_table&& other) noexcept;
+		flat_hash_table& operator=(const flat_hash_table& other);
+		flat_hash_table& operator=(flat_hash_table&& other) noexcept;
+
+		iterator begin() noexcept { return iterator(m_ctrl, m_slots); }
+		const_iterator begin() const noexcept { return const_iterator(m_ctrl, m_slots); }
+		const_iterator cbegin() const noexcept { return begin(); }
+
+		iterator end() noexcept { return iterator(m_ctrl + m_capacity, m_slots + m_capacity); }
+		const_iterator end() const noexcept { return const_iterator(m_ctrl + m_capacity, m_slots + m_capacity); }
+		const_iterator cend() const noexcept { return end(); }
+
+		bool empty() const noexcept { return m_size == 0; }
+		sizet size() const noexcept { return m_size; }
+		sizet capacity() const noexcept { return m_capacity; }
+
+		iterator find(const key_type& key);
+		const_iterator find(const key_type& key) const;
+		bool contains(const key_type& key) const;
+		sizet count(const key_type& key) const;
+
+		// Returns the iterator past the erased element
+		iterator erase(const_iterator pos);
+		sizet erase(const key_type& key);
+
+		// Keeps the allocation
+		void clear() noexcept;
+		// Makes room for count elements without growing
+		void reserve(sizet count);
+
+		const Allocator& get_allocator() const noexcept { return m_allocator; }
+	};
+
+	template <typename Key, typename Value, typename Hash = eastl::hash<Key>, typename Equal = eastl::equal_to<Key>,
+	          typename Allocator = GlobalHeapAllocator<eastl::pair<const Key, Value>>>
+	class flat_hash_map : public flat_hash_table<detail::FlatMapPolicy<Key, Value>, Hash, Equal, Allocator>
+	{
+	private:
+		using base = flat_hash_table<detail::FlatMapPolicy<Key, Value>, Hash, Equal, Allocator>;
+
+	public:
+		using mapped_type = Value;
+		using typename base::value_type;
+		using typename base::iterator;
+		using typename base::const_iterator;
+
+		using base::base;
+
+		// Constructs the value only if key is not present
+		template <typename K, typename... Args>
+		eastl::pair<iterator, bool> try_emplace(K&& key, Args&&... args);
+
+		template <typename K, typename... Args>
+		eastl::pair<iterator, bool> emplace(K&& key, Args&&... args)
+		{
+			return try_emplace(std::forward<K>(key), std::forward<Args>(args)...);
+		}
+
+		eastl::pair<iterator, bool> insert(const value_type& value) { return try_emplace(value.first, value.second); }
+
+		Value& operator[](const Key& key) { return try_emplace(key).first->second; }
+		Value& operator[](Key&& key) { return try_emplace(std::move(key)).first->second; }
+
+		Value& at(const Key& key);
+		const Value& at(const Key& key) const;
+	};
+
+	template <typename Key, typename Hash = eastl::hash<Key>, typename Equal = eastl::equal_to<Key>,
+	          typename Allocator = GlobalHeapAllocator<Key>>
+	class flat_hash_set : public flat_hash_table<detail::FlatSetPolicy<Key>, Hash, Equal, Allocator>
+	{
+	private:
+		using base = flat_hash_table<detail::FlatSetPolicy<Key>, Hash, Equal, Allocator>;
+
+	public:
+		using typename base::iterator;
+
+		using base::base;
+
+		template <typename K>
+		eastl::pair<iterator, bool> insert(K&& key);
+
+		template <typename... Args>
+		eastl::pair<iterator, bool> emplace(Args&&... args) { return insert(Key(std::forward<Args>(args)...)); }
+	};
+
+	template <typename P, typename H, typename E, typename A>
+	flat_hash_table<P, H, E, A>::flat_hash_table(const A& alloc) : m_allocator(alloc)
+	{
+	}
+
+	template <typename P, typename H, typename E, typename A>
+	flat_hash_table<P, H, E, A>::flat_hash_table(const A& alloc, const H& hash, const E& equal) : m_hash(hash),
+		m_equal(equal), m_allocator(alloc)
+	{
+	}
+
+	template <typename P, typename H, typename E, typename A>
+	flat_hash_table<P, H, E, A>::~flat_hash_table()
+	{
+		destroy_elements();
+		deallocate_slots();
+	}
+
+	template <typename P, typename H, typename E, typename A>
+	flat_hash_table<P, H, E, A>::flat_hash_table(const flat_hash_table& other) : m_hash(other.m_hash),
+		m_equal(other.m_equal), m_allocator(other.m_allocator)
+	{
+		if (other.m_size == 0)
+		{
+			return;
+		}
+		// Same capacity keeps every element in its slot, no rehashing needed
+		allocate_slots(other.m_capacity);
+		memcpy(m_ctrl, other.m_ctrl, m_capacity + 1);
+		for (sizet i = 0; i < m_capacity; ++i)
+		{
+			if (m_ctrl[i] >= 0)
+			{
+				new(m_slots + i) value_type(other.m_slots[i]);
+			}
+		}
+		m_size = other.m_size;
+		m_growthLeft = other.m_growthLeft;
+	}
+
+	template <typename P, typename H, typename E, typename A>
+	flat_hash_table<P, H, E, A>::flat_hash_table(flat_hash_table&& other) noexcept : m_ctrl(other.m_ctrl),
+		m_slots(other.m_slots), m_capacity(other.m_capacity), m_size(other.m_size), m_growthLeft(other.m_growthLeft),
+		m_hash(std::move(other.m_hash)), m_equal(std::move(other.m_equal)), m_allocator(std::move(other.m_allocator))
+	{
+		other.m_ctrl = const_cast<i8*>(detail::FLAT_EMPTY_CTRL);
+		other.m_slots = nullptr;
+		other.m_capacity = 0;
+		other.m_size = 0;
+		other.m_growthLeft = 0;
+	}
+
+	template <typename P, typename H, typename E, typename A>
+	flat_hash_table<P, H, E, A>& flat_hash_table<P, H, E, A>::operator=(const flat_hash_table& other)
+	{
+		if (this == &other) return *this;
+		flat_hash_table copy(other);
+		*this = std::move(copy);
+		return *this;
+	}
+
+	template <typename P, typename H, typename E, typename A>
+	flat_hash_table<P, H, E, A>& flat_hash_table<P, H, E, A>::operator=(flat_hash_table&& other) noexcept
+	{
+		if (this == &other) return *this;
+		destroy_elements();
+		deallocate_slots();
+		m_ctrl = other.m_ctrl;
+		m_slots = other.m_slots;
+		m_capacity = other.m_capacity;
+		m_size = other.m_size;
+		m_growthLeft = other.m_growthLeft;
+		m_hash = std::move(other.m_hash);
+		m_equal = std::move(other.m_equal);
+		m_allocator = std::move(other.m_allocator);
+
+		other.m_ctrl = const_cast<i8*>(detail::FLAT_EMPTY_CTRL);
+		other.m_slots = nullptr;
+		other.m_capacity = 0;
+		other.m_size = 0;
+		other.m_growthLeft = 0;
+		return *this;
+	}
+
+	template <typename P, typename H, typename E, typename A>
+	sizet flat_hash_table<P, H, E, A>::slots_offset(sizet capacity)
+	{
+		// Control bytes plus the sentinel
+		return (capacity + 1 + alignof(value_type) - 1) & ~(alignof(value_type) - 1);
+	}
+
+	template <typename P, typename H, typename E, typename A>
+	sizet flat_hash_table<P, H, E, A>::allocation_size(sizet capacity)
+	{
+		return slots_offset(capacity) + capacity * sizeof(value_type);
+	}
+
+	template <typename P, typename H, typename E, typename A>
+	sizet flat_hash_table<P, H, E, A>::hash_of(const key_type& key) const
+	{
+		// Many hashers are the identity, mixing spreads them over both the group index and the control bits
+		const u64 hash = static_cast<u64>(m_hash(key)) * 0x9E3779B97F4A7C15ull;
+		return static_cast<sizet>(hash ^ (hash >> 32));
+	}
+
+	template <typename P, typename H, typename E, typename A>
+	sizet flat_hash_table<P, H, E, A>::find_index(const key_type& key, sizet hash) const
+	{
+		if (m_size == 0)
+		{
+			return NPOS;
+		}
+
+		const i8 h2 = static_cast<i8>(hash & 0x7F);
+		const sizet groupMask = m_capacity / detail::FLAT_GROUP_SIZE - 1;
+		sizet group = (hash >> 7) & groupMask;
+		// Triangular probing visits every group, the load factor guarantees an empty slot somewhere
+		for (sizet step = 1;; ++step)
+		{
+			const sizet first = group * detail::FLAT_GROUP_SIZE;
+			const detail::FlatGroup ctrl(m_ctrl + first);
+			for (u32 mask = ctrl.match(h2); mask; mask &= mask - 1)
+			{
+				const sizet index = first + std::countr_zero(mask);
+				if (m_equal(P::key(m_slots[index]), key))
+				{
+					return index;
+				}
+			}
+			if (ctrl.match_empty())
+			{
+				return NPOS;
+			}
+			group = (group + step) & groupMask;
+		}
+	}
+
+	template <typename P, typename H, typename E, typename A>
+	sizet flat_hash_table<P, H, E, A>::find_free_slot(sizet hash) const
+	{
+		const sizet groupMask = m_capacity / detail::FLAT_GROUP_SIZE - 1;
+		sizet group = (hash >> 7) & groupMask;
+		for (sizet step = 1;; ++step)
+		{
+			const sizet first = group * detail::FLAT_GROUP_SIZE;
+			if (const u32 mask = detail::FlatGroup(m_ctrl + first).match_free())
+			{
+				return first + std::countr_zero(mask);
+			}
+			group = (group + step) & groupMask;
+		}
+	}
+
+	template <typename P, typename H, typename E, typename A>
+	void flat_hash_table<P, H, E, A>::allocate_slots(sizet capacity)
+	{
+		SASSERTM(std::has_single_bit(capacity) && capacity >= MIN_CAPACITY, "Invalid flat hash table capacity\n")
+		constexpr sizet alignment = std::max(detail::FLAT_GROUP_SIZE, alignof(value_type));
+		auto* memory = static_cast<std::byte*>(static_cast<void*>(m_allocator.allocate(
+			allocation_size(capacity), alignment, 0)));
+		SASSERTM(memory, "Flat hash table allocation failed\n")
+
+		m_ctrl = reinterpret_cast<i8*>(memory);
+		m_slots = reinterpret_cast<value_type*>(memory + slots_offset(capacity));
+		m_capacity = capacity;
+		m_growthLeft = max_load(capacity) - m_size;
+		memset(m_ctrl, detail::FLAT_SLOT_EMPTY, capacity);
+		m_ctrl[capacity] = detail::FLAT_SLOT_SENTINEL;
+	}
+
+	template <typename P, typename H, typename E, typename A>
+	void flat_hash_table<P, H, E, A>::deallocate_slots()
+	{
+		if (m_capacity)
+		{
+			m_allocator.deallocate(static_cast<void*>(m_ctrl), allocation_size(m_capacity));
+		}
+		m_ctrl = const_cast<i8*>(detail::FLAT_EMPTY_CTRL);
+		m_slots = nullptr;
+		m_capacity = 0;
+		m_growthLeft = 0;
+	}
+
+	template <typename P, typename H, typename E, typename A>
+	void flat_hash_table<P, H, E, A>::set_ctrl(sizet index, i8 value)
+	{
+		m_ctrl[index] = value;
+	}
+
+	template <typename P, typename H, typename E, typename A>
+	void flat_hash_table<P, H, E, A>::rehash(sizet capacity)
+	{
+		i8* oldCtrl = m_ctrl;
+		value_type* oldSlots = m_slots;
+		const sizet oldCapacity = m_capacity;
+
+		allocate_slots(capacity);
+		for (sizet i = 0; i < oldCapacity; ++i)
+		{
+			if (oldCtrl[i] >= 0)
+			{
+				const sizet hash = hash_of(P::key(oldSlots[i]));
+				const sizet index = find_free_slot(hash);
+				set_ctrl(index, static_cast<i8>(hash & 0x7F));
+				P::transfer(m_slots + index, oldSlots + i);
+			}
+		}
+
+		if (oldCapacity)
+		{
+			m_allocator.deallocate(static_cast<void*>(oldCtrl), allocation_size(oldCapacity));
+		}
+	}
+
+	template <typename P, typename H, typename E, typename A>
+	void flat_hash_table<P, H, E, A>::destroy_elements() noexcept
+	{
+		if constexpr (!std::is_trivially_destructible_v<value_type>)
+		{
+			for (sizet i = 0; i < m_capacity && m_size; ++i)
+			{
+				if (m_ctrl[i] >= 0)
+				{
+					m_slots[i].~value_type();
+				}
+			}
+		}
+	}
+
+	template <typename P, typename H, typename E, typename A>
+	void flat_hash_table<P, H, E, A>::erase_at(sizet index)
+	{
+		m_slots[index].~value_type();
+		--m_size;
+		// A group that still has an empty slot never filled up, so no probe sequence continues past it
+		// and the slot can become empty again instead of a tombstone
+		const sizet first = index & ~(detail::FLAT_GROUP_SIZE - 1);
+		if (detail::FlatGroup(m_ctrl + first).match_empty())
+		{
+			set_ctrl(index, detail::FLAT_SLOT_EMPTY);
+			++m_growthLeft;
+		}
+		else
+		{
+			set_ctrl(index, detail::FLAT_SLOT_DELETED);
+		}
+	}
+
+	template <typename P, typename H, typename E, typename A>
+	eastl::pair<sizet, bool> flat_hash_table<P, H, E, A>::find_or_prepare_insert(const key_type& key)
+	{
+		const sizet hash = hash_of(key);
+		const sizet found = find_index(key, hash);
+		if (found != NPOS)
+		{
+			return {found, false};
+		}
+
+		if (m_growthLeft == 0)
+		{
+			// Mostly tombstones: rehash in place, otherwise double
+			const bool tombstones = m_capacity && m_size <= max_load(m_capacity) / 2;
+			rehash(m_capacity == 0 ? MIN_CAPACITY : tombstones ? m_capacity : m_capacity * 2);
+		}
+
+		const sizet index = find_free_slot(hash);
+		if (m_ctrl[index] == detail::FLAT_SLOT_EMPTY)
+		{
+			--m_growthLeft;
+		}
+		set_ctrl(index, static_cast<i8>(hash & 0x7F));
+		++m_size;
+		return {index, true};
+	}
+
+	template <typename P, typename H, typename E, typename A>
+	typename flat_hash_table<P, H, E, A>::iterator flat_hash_table<P, H, E, A>::find(const key_type& key)
+	{
+		const sizet index = find_index(key, hash_of(key));
+		return index == NPOS ? end() : iterator_at(index);
+	}
+
+	template <typename P, typename H, typename E, typename A>
+	typename flat_hash_table<P, H, E, A>::const_iterator flat_hash_table<P, H, E, A>::find(const key_type& key) const
+	{
+		const sizet index = find_index(key, hash_of(key));
+		return index == NPOS ? end() : const_iterator(m_ctrl + index, m_slots + index);
+	}
+
+	template <typename P, typename H, typename E, typename A>
+	bool flat_hash_table<P, H, E, A>::contains(const key_type& key) const
+	{
+		return find_index(key, hash_of(key)) != NPOS;
+	}
+
+	template <typename P, typename H, typename E, typename A>
+	sizet flat_hash_table<P, H, E, A>::count(const key_type& key) const
+	{
+		return contains(key) ? 1 : 0;
+	}
+
+	template <typename P, typename H, typename E, typename A>
+	typename flat_hash_table<P, H, E, A>::iterator flat_hash_table<P, H, E, A>::erase(const_iterator pos)
+	{
+		const sizet index = static_cast<sizet>(pos.m_ctrl - m_ctrl);
+		erase_at(index);
+		return iterator_at(index + 1);
+	}
+
+	template <typename P, typename H, typename E, typename A>
+	sizet flat_hash_table<P, H, E, A>::erase(const key_type& key)
+	{
+		const sizet index = find_index(key, hash_of(key));
+		if (index == NPOS)
+		{
+			return 0;
+		}
+		erase_at(index);
+		return 1;
+	}
+
+	template <typename P, typename H, typename E, typename A>
+	void flat_hash_table<P, H, E, A>::clear() noexcept
+	{
+		if (m_capacity == 0)
+		{
+			return;
+		}
+		destroy_elements();
+		memset(m_ctrl, detail::FLAT_SLOT_EMPTY, m_capacity);
+		m_size = 0;
+		m_growthLeft = max_load(m_capacity);
+	}
+
+	template <typename P, typename H, typename E, typename A>
+	void flat_hash_table<P, H, E, A>::reserve(sizet count)
+	{
+		sizet capacity = std::max(m_capacity, MIN_CAPACITY);
+		while (max_load(capacity) < count)
+		{
+			capacity *= 2;
+		}
+		if (capacity != m_capacity)
+		{
+			rehash(capacity);
+		}
+	}
+
+	template <typename K, typename V, typename H, typename E, typename A>
+	template <typename Key, typename... Args>
+	eastl::pair<typename flat_hash_map<K, V, H, E, A>::iterator, bool> flat_hash_map<K, V, H, E, A>::try_emplace(
+		Key&& key, Args&&... args)
+	{
+		const auto [index, inserted] = base::find_or_prepare_insert(key);
+		if (inserted)
+		{
+			new(base::slot_at(index)) value_type(std::forward<Key>(key), V(std::forward<Args>(args)...));
+		}
+		return {base::iterator_at(index), inserted};
+	}
+
+	template <typename K, typename V, typename H, typename E, typename A>
+	V& flat_hash_map<K, V, H, E, A>::at(const K& key)
+	{
+		auto it = base::find(key);
+		SASSERTM(it != base::end(), "Key is not in the flat hash map\n")
+		return it->second;
+	}
+
+	template <typename K, typename V, typename H, typename E, typename A>
+	const V& flat_hash_map<K, V, H, E, A>::at(const K& key) const
+	{
+		auto it = base::find(key);
+		SASSERTM(it != base::end(), "Key is not in the flat hash map\n")
+		return it->second;
+	}
+
+	template <typename K, typename H, typename E, typename A>
+	template <typename Key>
+	eastl::pair<typename flat_hash_set<K, H, E, A>::iterator, bool> flat_hash_set<K, H, E, A>::insert(Key&& key)
+	{
+		const auto [index, inserted] = base::find_or_prepare_insert(key);
+		if (inserted)
+		{
+			new(base::slot_at(index)) K(std::forward<Key>(key));
+		}
+		return {base::iterator_at(index), inserted};
+	}
 }
@@ -1,12 +1,156 @@
 #pragma once
+#include <bit>
 
 #include "base/CollectionAliases.hpp"
 #include "base/Platform.hpp"
 
 #include "CollectionUtilities.hpp"
 
+#if defined(SPITE_SIMD_AVX2) || defined(SPITE_SIMD_SSE)
+#include <immintrin.h>
+#endif
+
 namespace spite
 {
+	constexpr sizet BITSET_NPOS = static_cast<sizet>(-1);
+
+	// Block kernels shared by DynamicBitset and FixedBitset, 4 blocks per step with AVX2, 2 with SSE2
+	namespace detail
+	{
+		constexpr sizet BITS_PER_BLOCK = 64;
+
+		inline u64 blockOr(u64 a, u64 b) { return a | b; }
+		inline u64 blockAnd(u64 a, u64 b) { return a & b; }
+		inline u64 blockAndNot(u64 a, u64 b) { return a & ~b; }
+
+#if defined(SPITE_SIMD_AVX2)
+		using BlockVector = __m256i;
+		constexpr sizet VECTOR_BLOCKS = 4;
+
+		inline BlockVector loadBlocks(const u64* p) { return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)); }
+		inline void storeBlocks(u64* p, BlockVector v) { _mm256_storeu_si256(reinterpret_cast<__m256i*>(p), v); }
+		inline BlockVector blockOr(BlockVector a, BlockVector b) { return _mm256_or_si256(a, b); }
+		inline BlockVector blockAnd(BlockVector a, BlockVector b) { return _mm256_and_si256(a, b); }
+		inline BlockVector blockAndNot(BlockVector a, BlockVector b) { return _mm256_andnot_si256(b, a); }
+		inline bool isZero(BlockVector v) { return _mm256_testz_si256(v, v); }
+#elif defined(SPITE_SIMD_SSE)
+		using BlockVector = __m128i;
+		constexpr sizet VECTOR_BLOCKS = 2;
+
+		inline BlockVector loadBlocks(const u64* p) { return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p)); }
+		inline void storeBlocks(u64* p, BlockVector v) { _mm_storeu_si128(reinterpret_cast<__m128i*>(p), v); }
+		inline BlockVector blockOr(BlockVector a, BlockVector b) { return _mm_or_si128(a, b); }
+		inline BlockVector blockAnd(BlockVector a, BlockVector b) { return _mm_and_si128(a, b); }
+		inline BlockVector blockAndNot(BlockVector a, BlockVector b) { return _mm_andnot_si128(b, a); }
+		inline bool isZero(BlockVector v)
+		{
+			return _mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_setzero_si128())) == 0xFFFF;
+		}
+#else
+		constexpr sizet VECTOR_BLOCKS = 0;
+#endif
+
+		// dst may alias a or b, op is called with both vectors and single blocks
+		template <typename Op>
+		void combineBlocks(u64* dst, const u64* a, const u64* b, sizet count, Op op)
+		{
+			sizet i = 0;
+#if defined(SPITE_SIMD_AVX2) || defined(SPITE_SIMD_SSE)
+			for (; i + VECTOR_BLOCKS <= count; i += VECTOR_BLOCKS)
+			{
+				storeBlocks(dst + i, op(loadBlocks(a + i), loadBlocks(b + i)));
+			}
+#endif
+			for (; i < count; ++i)
+			{
+				dst[i] = op(a[i], b[i]);
+			}
+		}
+
+		inline void orBlocks(u64* dst, const u64* a, const u64* b, sizet count)
+		{
+			combineBlocks(dst, a, b, count, [](auto x, auto y) { return blockOr(x, y); });
+		}
+
+		inline void andBlocks(u64* dst, const u64* a, const u64* b, sizet count)
+		{
+			combineBlocks(dst, a, b, count, [](auto x, auto y) { return blockAnd(x, y); });
+		}
+
+		inline void andNotBlocks(u64* dst, const u64* a, const u64* b, sizet count)
+		{
+			combineBlocks(dst, a, b, count, [](auto x, auto y) { return blockAndNot(x, y); });
+		}
+
+		inline bool anyBlocks(const u64* a, sizet count)
+		{
+			sizet i = 0;
+#if defined(SPITE_SIMD_AVX2) || defined(SPITE_SIMD_SSE)
+			for (; i + VECTOR_BLOCKS <= count; i += VECTOR_BLOCKS)
+			{
+				if (!isZero(loadBlocks(a + i))) return true;
+			}
+#endif
+			for (; i < count; ++i)
+			{
+				if (a[i]) return true;
+			}
+			return false;
+		}
+
+		// (a & b).any() without materializing the intersection
+		inline bool intersectBlocks(const u64* a, const u64* b, sizet count)
+		{
+			sizet i = 0;
+#if defined(SPITE_SIMD_AVX2) || defined(SPITE_SIMD_SSE)
+			for (; i + VECTOR_BLOCKS <= count; i += VECTOR_BLOCKS)
+			{
+				if (!isZero(blockAnd(loadBlocks(a + i), loadBlocks(b + i)))) return true;
+			}
+#endif
+			for (; i < count; ++i)
+			{
+				if (a[i] & b[i]) return true;
+			}
+			return false;
+		}
+
+		// Compiles to popcnt where the target has it, vector popcount needs AVX-512
+		inline sizet popcountBlocks(const u64* a, sizet count)
+		{
+			sizet total = 0;
+			for (sizet i = 0; i < count; ++i)
+			{
+				total += static_cast<sizet>(std::popcount(a[i]));
+			}
+			return total;
+		}
+
+		// First set bit at or after pos, BITSET_NPOS if there is none
+		inline sizet findNextBit(const u64* a, sizet count, sizet pos)
+		{
+			sizet block = pos / BITS_PER_BLOCK;
+			if (block >= count) return BITSET_NPOS;
+
+			const u64 first = a[block] & (~0ULL << (pos % BITS_PER_BLOCK));
+			if (first) return block * BITS_PER_BLOCK + std::countr_zero(first);
+
+			++block;
+#if defined(SPITE_SIMD_AVX2) || defined(SPITE_SIMD_SSE)
+			// Skip empty runs a vector at a time
+			while (block + VECTOR_BLOCKS <= count && isZero(loadBlocks(a + block)))
+			{
+				block += VECTOR_BLOCKS;
+			}
+#endif
+			for (; block < count; ++block)
+			{
+				if (a[block]) return block * BITS_PER_BLOCK + std::countr_zero(a[block]);
+			}
+			return BITSET_NPOS;
+		}
+	}
+
 	// A bitset that can be resized at runtime.
 	class DynamicBitset
 	{
@@ -41,6 +185,11 @@ namespace spite
 			m_size = num_bits;
 			const sizet num_blocks = (num_bits + BITS_PER_BLOCK - 1) / BITS_PER_BLOCK;
 			m_blocks.resize(num_blocks, 0);
+			// Bits past the size stay clear, count and find_first read whole blocks
+			if (bit_index(num_bits))
+			{
+				m_blocks.back() &= (1ULL << bit_index(num_bits)) - 1;
+			}
 		}
 
 		DynamicBitset& set(sizet pos, bool value = true)
@@ -60,46 +209,79 @@ namespace spite
 			return *this;
 		}
 
+		DynamicBitset& reset(sizet pos)
+		{
+			if (pos < m_size)
+			{
+				m_blocks[block_index(pos)] &= ~(1ULL << bit_index(pos));
+			}
+			return *this;
+		}
+
+		// Clears every bit, the size is kept
+		DynamicBitset& reset()
+		{
+			std::fill(m_blocks.begin(), m_blocks.end(), 0);
+			return *this;
+		}
+
 		bool test(sizet pos) const
 		{
 			if (pos >= m_size) return false;
 			return (m_blocks[block_index(pos)] >> bit_index(pos)) & 1ULL;
 		}
 
-		bool any() const
+		bool any() const { return detail::anyBlocks(m_blocks.data(), m_blocks.size()); }
+		bool none() const { return !any(); }
+		sizet count() const { return detail::popcountBlocks(m_blocks.data(), m_blocks.size()); }
+
+		sizet find_first() const { return find_next(0); }
+
+		// First set bit at or after pos, BITSET_NPOS if there is none
+		sizet find_next(sizet pos) const { return detail::findNextBit(m_blocks.data(), m_blocks.size(), pos); }
+
+		// Same as (*this & other).any(), without allocating the intersection
+		bool intersects(const DynamicBitset& other) const
 		{
-			for (u64 block : m_blocks)
-			{
-				if (block != 0) return true;
-			}
-			return false;
+			return detail::intersectBlocks(m_blocks.data(), other.m_blocks.data(),
+			                               std::min(m_blocks.size(), other.m_blocks.size()));
 		}
 
 		sizet size() const { return m_size; }
 
-		DynamicBitset operator|(const DynamicBitset& other) const
+		DynamicBitset& operator|=(const DynamicBitset& other)
 		{
-			DynamicBitset result(std::max(m_size, other.m_size), m_blocks.get_allocator());
-			const sizet common_blocks = std::min(m_blocks.size(), other.m_blocks.size());
-			for (sizet i = 0; i < common_blocks; ++i)
-			{
-				result.m_blocks[i] = m_blocks[i] | other.m_blocks[i];
-			}
-			// Copy remaining blocks from the larger bitset
-			if (m_blocks.size() > other.m_blocks.size())
-			{
-				for (sizet i = common_blocks; i < m_blocks.size(); ++i)
-				{
-					result.m_blocks[i] = m_blocks[i];
-				}
-			}
-			else
+			if (other.m_size > m_size)
 			{
-				for (sizet i = common_blocks; i < other.m_blocks.size(); ++i)
-				{
-					result.m_blocks[i] = other.m_blocks[i];
-				}
+				resize(other.m_size);
 			}
+			detail::orBlocks(m_blocks.data(), m_blocks.data(), other.m_blocks.data(), other.m_blocks.size());
+			return *this;
+		}
+
+		DynamicBitset& operator&=(const DynamicBitset& other)
+		{
+			const sizet common_blocks = std::min(m_blocks.size(), other.m_blocks.size());
+			detail::andBlocks(m_blocks.data(), m_blocks.data(), other.m_blocks.data(), common_blocks);
+			std::fill(m_blocks.begin() + common_blocks, m_blocks.end(), 0);
+			return *this;
+		}
+
+		// Clears the bits set in other
+		DynamicBitset& and_not(const DynamicBitset& other)
+		{
+			detail::andNotBlocks(m_blocks.data(), m_blocks.data(), other.m_blocks.data(),
+			                     std::min(m_blocks.size(), other.m_blocks.size()));
+			return *this;
+		}
+
+		DynamicBitset operator|(const DynamicBitset& other) const
+		{
+			const DynamicBitset& larger = m_size >= other.m_size ? *this : other;
+			const DynamicBitset& smaller = m_size >= other.m_size ? other : *this;
+			DynamicBitset result(larger);
+			detail::orBlocks(result.m_blocks.data(), larger.m_blocks.data(), smaller.m_blocks.data(),
+			                 smaller.m_blocks.size());
 			return result;
 		}
 
@@ -107,11 +289,101 @@ namespace spite
 		{
 			DynamicBitset result(std::max(m_size, other.m_size), m_blocks.get_allocator());
 			const sizet num_blocks = std::min(m_blocks.size(), other.m_blocks.size());
-			for (sizet i = 0; i < num_blocks; ++i)
+			detail::andBlocks(result.m_blocks.data(), m_blocks.data(), other.m_blocks.data(), num_blocks);
+			return result;
+		}
+	};
+
+	// Inline storage for masks with a known bound, no allocation and trivially copyable
+	template <sizet Bits>
+	class FixedBitset
+	{
+	private:
+		static constexpr sizet BLOCK_COUNT = (Bits + detail::BITS_PER_BLOCK - 1) / detail::BITS_PER_BLOCK;
+
+		u64 m_blocks[BLOCK_COUNT] = {};
+
+		static sizet block_index(sizet pos) { return pos / detail::BITS_PER_BLOCK; }
+		static u64 bit_mask(sizet pos) { return 1ULL << (pos % detail::BITS_PER_BLOCK); }
+
+	public:
+		static_assert(Bits > 0, "FixedBitset needs at least one bit");
+
+		static constexpr sizet size() { return Bits; }
+
+		FixedBitset& set(sizet pos, bool value = true)
+		{
+			SASSERTM(pos < Bits, "FixedBitset position out of range\n")
+			if (value)
 			{
-				result.m_blocks[i] = m_blocks[i] & other.m_blocks[i];
+				m_blocks[block_index(pos)] |= bit_mask(pos);
 			}
-			return result;
+			else
+			{
+				m_blocks[block_index(pos)] &= ~bit_mask(pos);
+			}
+			return *this;
+		}
+
+		FixedBitset& reset(sizet pos) { return set(pos, false); }
+
+		FixedBitset& reset()
+		{
+			std::fill(std::begin(m_blocks), std::end(m_blocks), 0);
+			return *this;
+		}
+
+		bool test(sizet pos) const
+		{
+			if (pos >= Bits) return false;
+			return m_blocks[block_index(pos)] & bit_mask(pos);
+		}
+
+		bool any() const { return detail::anyBlocks(m_blocks, BLOCK_COUNT); }
+		bool none() const { return !any(); }
+		sizet count() const { return detail::popcountBlocks(m_blocks, BLOCK_COUNT); }
+
+		sizet find_first() const { return find_next(0); }
+		sizet find_next(sizet pos) const { return detail::findNextBit(m_blocks, BLOCK_COUNT, pos); }
+
+		bool intersects(const FixedBitset& other) const
+		{
+			return detail::intersectBlocks(m_blocks, other.m_blocks, BLOCK_COUNT);
+		}
+
+		FixedBitset& operator|=(const FixedBitset& other)
+		{
+			detail::orBlocks(m_blocks, m_blocks, other.m_blocks, BLOCK_COUNT);
+			return *this;
+		}
+
+		FixedBitset& operator&=(const FixedBitset& other)
+		{
+			detail::andBlocks(m_blocks, m_blocks, other.m_blocks, BLOCK_COUNT);
+			return *this;
+		}
+
+		FixedBitset& and_not(const FixedBitset& other)
+		{
+			detail::andNotBlocks(m_blocks, m_blocks, other.m_blocks, BLOCK_COUNT);
+			return *this;
+		}
+
+		FixedBitset operator|(const FixedBitset& other) const
+		{
+			FixedBitset result = *this;
+			return result |= other;
+		}
+
+		FixedBitset operator&(const FixedBitset& other) const
+		{
+			FixedBitset result = *this;
+			return result &= other;
+		}
+
+		bool operator==(const FixedBitset& other) const
+		{
+			return std::equal(std::begin(m_blocks), std::end(m_blocks), std::begin(other.m_blocks));
 		}
 	};
 }
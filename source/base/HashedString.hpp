@@ -6,35 +6,67 @@ namespace spite
 {
 	class StringInterner;
 
-	// A type-safe, lightweight handle for an interned string.
+	// 64-bit FNV-1a, shared by the _hs literal and the interner so both produce the same ids
+	constexpr u64 hashString(cstring str, sizet length)
+	{
+		constexpr u64 basis = 14695981039346656037ULL;
+		constexpr u64 prime = 1099511628211ULL;
+
+		u64 hash = basis;
+		for (sizet i = 0; i < length; ++i)
+		{
+			hash ^= static_cast<u64>(static_cast<unsigned char>(str[i]));
+			hash *= prime;
+		}
+		return hash;
+	}
+
+	struct HashedString;
+	consteval HashedString operator""_hs(cstring str, sizet length);
+
+	// A type-safe, lightweight handle for a string, the id is the FNV-1a hash of the string.
 	// It can be passed by value and used as a key in hash maps.
+	// Use "name"_hs for literals, it is computed at compile time and never touches the interner.
 	struct HashedString
 	{
 	private:
 		friend class StringInterner;
 		friend struct hash;
+		friend consteval HashedString operator""_hs(cstring str, sizet length);
 
 		u64 m_id = 0;
+#ifdef DEBUG
+		// Literals are not registered, keep the text around for c_str() in debug builds
+		cstring m_debugName = nullptr;
+#endif
 
-		explicit HashedString(u64 id) : m_id(id)
+		constexpr explicit HashedString(u64 id) : m_id(id)
+		{
+		}
+
+		constexpr HashedString(u64 id, [[maybe_unused]] cstring debugName) : m_id(id)
+#ifdef DEBUG
+			, m_debugName(debugName)
+#endif
 		{
 		}
 
 	public:
-		HashedString() = default;
+		constexpr HashedString() = default;
 
 		// Resolves the ID back to the original string for debugging or display.
 		// Note: This involves a lookup and should not be used in performance-critical code.
+		// Release builds resolve literals only if the same string was also interned at runtime.
 		[[nodiscard]] cstring c_str() const;
 
-		u64 id() const { return m_id; }
+		constexpr u64 id() const { return m_id; }
 
-		bool isValid() const { return m_id != 0; }
+		constexpr bool isValid() const { return m_id != 0; }
 
-		static HashedString undefined() { return HashedString(0); }
+		static constexpr HashedString undefined() { return HashedString(0); }
 
-		bool operator==(const HashedString& other) const = default;
-		bool operator!=(const HashedString& other) const = default;
+		constexpr bool operator==(const HashedString& other) const { return m_id == other.m_id; }
+		constexpr bool operator!=(const HashedString& other) const { return m_id != other.m_id; }
 
 		struct hash
 		{
@@ -44,6 +76,15 @@ namespace spite
 			}
 		};
 	};
+
+	consteval HashedString operator""_hs(cstring str, sizet length)
+	{
+		if (length == 0)
+		{
+			return HashedString::undefined();
+		}
+		return HashedString(hashString(str, length), str);
+	}
 }
 
 template <>
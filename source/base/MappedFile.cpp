@@ -0,0 +1,145 @@
+#include "MappedFile.hpp"
+
+#include <utility>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "base/Logging.hpp"
+
+namespace spite
+{
+	MappedFile::~MappedFile()
+	{
+		close();
+	}
+
+	MappedFile::MappedFile(MappedFile&& other) noexcept
+		: m_data(std::exchange(other.m_data, nullptr)),
+		  m_size(std::exchange(other.m_size, 0)),
+		  m_fileHandle(std::exchange(other.m_fileHandle, nullptr)),
+		  m_mappingHandle(std::exchange(other.m_mappingHandle, nullptr))
+	{
+	}
+
+	MappedFile& MappedFile::operator=(MappedFile&& other) noexcept
+	{
+		if (this != &other)
+		{
+			close();
+			m_data = std::exchange(other.m_data, nullptr);
+			m_size = std::exchange(other.m_size, 0);
+			m_fileHandle = std::exchange(other.m_fileHandle, nullptr);
+			m_mappingHandle = std::exchange(other.m_mappingHandle, nullptr);
+		}
+		return *this;
+	}
+
+#if defined(_WIN32)
+	bool MappedFile::open(cstring path)
+	{
+		close();
+
+		HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+		                          FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+		if (file == INVALID_HANDLE_VALUE)
+		{
+			SDEBUG_LOG("WARNING: file %s could not be opened for mapping\n", path)
+			return false;
+		}
+
+		LARGE_INTEGER fileSize;
+		if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0)
+		{
+			CloseHandle(file);
+			return false;
+		}
+
+		HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_WRITECOPY, 0, 0, nullptr);
+		if (!mapping)
+		{
+			SDEBUG_LOG("WARNING: file %s could not be mapped\n", path)
+			CloseHandle(file);
+			return false;
+		}
+
+		void* view = MapViewOfFile(mapping, FILE_MAP_COPY, 0, 0, 0);
+		if (!view)
+		{
+			SDEBUG_LOG("WARNING: view of file %s could not be mapped\n", path)
+			CloseHandle(mapping);
+			CloseHandle(file);
+			return false;
+		}
+
+		m_data = static_cast<std::byte*>(view);
+		m_size = static_cast<sizet>(fileSize.QuadPart);
+		m_fileHandle = file;
+		m_mappingHandle = mapping;
+		return true;
+	}
+
+	void MappedFile::close()
+	{
+		if (m_data)
+		{
+			UnmapViewOfFile(m_data);
+			CloseHandle(m_mappingHandle);
+			CloseHandle(m_fileHandle);
+		}
+		m_data = nullptr;
+		m_size = 0;
+		m_fileHandle = nullptr;
+		m_mappingHandle = nullptr;
+	}
+#else
+	bool MappedFile::open(cstring path)
+	{
+		close();
+
+		const int file = ::open(path, O_RDONLY);
+		if (file < 0)
+		{
+			SDEBUG_LOG("WARNING: file %s could not be opened for mapping\n", path)
+			return false;
+		}
+
+		struct stat fileStat{};
+		if (fstat(file, &fileStat) != 0 || fileStat.st_size == 0)
+		{
+			::close(file);
+			return false;
+		}
+
+		// The mapping keeps its own reference to the file
+		void* view = mmap(nullptr, static_cast<sizet>(fileStat.st_size), PROT_READ | PROT_WRITE, MAP_PRIVATE, file, 0);
+		::close(file);
+		if (view == MAP_FAILED)
+		{
+			SDEBUG_LOG("WARNING: file %s could not be mapped\n", path)
+			return false;
+		}
+
+		m_data = static_cast<std::byte*>(view);
+		m_size = static_cast<sizet>(fileStat.st_size);
+		return true;
+	}
+
+	void MappedFile::close()
+	{
+		if (m_data)
+		{
+			munmap(m_data, m_size);
+		}
+		m_data = nullptr;
+		m_size = 0;
+	}
+#endif
+}
@@ -0,0 +1,39 @@
+#pragma once
+#include <cstddef>
+
+#include "base/Platform.hpp"
+
+namespace spite
+{
+	// Read-only file mapped copy-on-write: pages can be patched in place,
+	// changes stay private to the process and are never written back
+	class MappedFile
+	{
+	private:
+		std::byte* m_data = nullptr;
+		sizet m_size = 0;
+		void* m_fileHandle = nullptr;
+		void* m_mappingHandle = nullptr;
+
+		void close();
+
+	public:
+		MappedFile() = default;
+		~MappedFile();
+
+		MappedFile(const MappedFile&) = delete;
+		MappedFile& operator=(const MappedFile&) = delete;
+
+		MappedFile(MappedFile&& other) noexcept;
+		MappedFile& operator=(MappedFile&& other) noexcept;
+
+		// (returns false if the file does not exist, is empty or could not be mapped)
+		bool open(cstring path);
+
+		[[nodiscard]] bool isOpen() const { return m_data != nullptr; }
+
+		// Page aligned
+		[[nodiscard]] std::byte* data() const { return m_data; }
+		[[nodiscard]] sizet size() const { return m_size; }
+	};
+}
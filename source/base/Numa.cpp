@@ -0,0 +1,109 @@
+#include "Numa.hpp"
+
+#include <cstdlib>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#include <Windows.h>
+#elif defined(SPITE_USE_LIBNUMA)
+#include <numa.h>
+#include <sched.h>
+#endif
+
+#include "base/Logging.hpp"
+
+namespace spite
+{
+	namespace
+	{
+		u32 queryNumaNodeCount()
+		{
+#if defined(_WIN32)
+			ULONG highestNode = 0;
+			if (!GetNumaHighestNodeNumber(&highestNode))
+			{
+				return 1;
+			}
+			return static_cast<u32>(highestNode) + 1;
+#elif defined(SPITE_USE_LIBNUMA)
+			if (numa_available() < 0)
+			{
+				return 1;
+			}
+			return static_cast<u32>(numa_max_node()) + 1;
+#else
+			return 1;
+#endif
+		}
+	}
+
+	u32 getNumaNodeCount()
+	{
+		static const u32 nodeCount = []
+		{
+			const u32 count = queryNumaNodeCount();
+			if (count > MAX_NUMA_NODES)
+			{
+				SDEBUG_LOG("WARNING: %u NUMA nodes reported, only %u are used\n", count, MAX_NUMA_NODES)
+				return MAX_NUMA_NODES;
+			}
+			return count;
+		}();
+		return nodeCount;
+	}
+
+	u32 getCurrentNumaNode()
+	{
+		if (getNumaNodeCount() == 1)
+		{
+			return 0;
+		}
+
+#if defined(_WIN32)
+		PROCESSOR_NUMBER processor;
+		GetCurrentProcessorNumberEx(&processor);
+		USHORT node = 0;
+		GetNumaProcessorNodeEx(&processor, &node);
+		return static_cast<u32>(node) % MAX_NUMA_NODES;
+#elif defined(SPITE_USE_LIBNUMA)
+		const int node = numa_node_of_cpu(sched_getcpu());
+		return node < 0 ? 0 : static_cast<u32>(node) % MAX_NUMA_NODES;
+#else
+		return 0;
+#endif
+	}
+
+	void* allocateNumaMemory(sizet size, u32 node)
+	{
+		if (getNumaNodeCount() == 1)
+		{
+			return malloc(size);
+		}
+
+#if defined(_WIN32)
+		return VirtualAllocExNuma(GetCurrentProcess(), nullptr, size, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE,
+		                          node);
+#elif defined(SPITE_USE_LIBNUMA)
+		return numa_alloc_onnode(size, static_cast<int>(node));
+#else
+		return malloc(size);
+#endif
+	}
+
+	void freeNumaMemory(void* memory, sizet size)
+	{
+		if (getNumaNodeCount() == 1)
+		{
+			free(memory);
+			return;
+		}
+
+#if defined(_WIN32)
+		VirtualFree(memory, 0, MEM_RELEASE);
+#elif defined(SPITE_USE_LIBNUMA)
+		numa_free(memory, size);
+#else
+		free(memory);
+#endif
+	}
+}
@@ -0,0 +1,20 @@
+#pragma once
+#include "base/Platform.hpp"
+
+namespace spite
+{
+	constexpr u32 MAX_NUMA_NODES = 16;
+	// Memory not bound to any node
+	constexpr u32 ANY_NUMA_NODE = ~0u;
+
+	// Nodes past MAX_NUMA_NODES are folded onto the first ones.
+	// 1 when the system has a single node or NUMA is unavailable (Linux builds need SPITE_USE_LIBNUMA and libnuma)
+	u32 getNumaNodeCount();
+
+	// Node of the processor the calling thread is running on, 0 on single node systems
+	u32 getCurrentNumaNode();
+
+	// Memory backed by the physical pages of node, plain heap memory on single node systems
+	void* allocateNumaMemory(sizet size, u32 node);
+	void freeNumaMemory(void* memory, sizet size);
+}
@@ -33,6 +33,20 @@
 #define SPITE_FUNCTION_INFO                        SPITE_FUNCTION "() "
 #define SPITE_FILELINE_FUNC(MESSAGE)               __FILE__ "(" SPITE_LINE_STRING ") " SPITE_FUNCTION "() : " MESSAGE
 
+//simd instruction sets available for the target
+#if defined(__AVX__)
+#define SPITE_SIMD_AVX 1
+#endif
+#if defined(__AVX2__)
+#define SPITE_SIMD_AVX2 1
+#endif
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define SPITE_SIMD_SSE 1
+#endif
+#if defined(__ARM_NEON) || defined(_M_ARM64)
+#define SPITE_SIMD_NEON 1
+#endif
+
 //native types
 typedef uint8_t u8;
 typedef uint16_t u16;
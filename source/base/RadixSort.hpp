@@ -0,0 +1,83 @@
+#pragma once
+#include <utility>
+
+#include <EASTL/span.h>
+
+#include "base/Assert.hpp"
+#include "base/Platform.hpp"
+
+namespace spite
+{
+	// Stable LSD radix sort on a 64-bit key, one byte per pass.
+	// Passes where every key has the same byte are skipped, so small key ranges cost only a few passes.
+	// scratch must be at least as large as items, the sorted result always ends up in items
+	template <typename T, typename KeyFn>
+	void radixSort(eastl::span<T> items, eastl::span<T> scratch, KeyFn keyFn)
+	{
+		SASSERT(scratch.size() >= items.size())
+
+		const sizet count = items.size();
+		if (count < 2)
+		{
+			return;
+		}
+
+		constexpr sizet DIGIT_BITS = 8;
+		constexpr sizet DIGIT_COUNT = 1 << DIGIT_BITS;
+		constexpr sizet PASS_COUNT = sizeof(u64) * 8 / DIGIT_BITS;
+
+		// All histograms are built in a single read of the keys
+		u32 histograms[PASS_COUNT][DIGIT_COUNT] = {};
+		for (sizet i = 0; i < count; ++i)
+		{
+			const u64 key = keyFn(items[i]);
+			for (sizet pass = 0; pass < PASS_COUNT; ++pass)
+			{
+				++histograms[pass][(key >> (pass * DIGIT_BITS)) & (DIGIT_COUNT - 1)];
+			}
+		}
+
+		T* src = items.data();
+		T* dst = scratch.data();
+		for (sizet pass = 0; pass < PASS_COUNT; ++pass)
+		{
+			u32* histogram = histograms[pass];
+			const u64 firstDigit = (keyFn(src[0]) >> (pass * DIGIT_BITS)) & (DIGIT_COUNT - 1);
+			if (histogram[firstDigit] == count)
+			{
+				continue;
+			}
+
+			u32 offset = 0;
+			for (sizet digit = 0; digit < DIGIT_COUNT; ++digit)
+			{
+				const u32 digitCount = histogram[digit];
+				histogram[digit] = offset;
+				offset += digitCount;
+			}
+
+			for (sizet i = 0; i < count; ++i)
+			{
+				const u64 digit = (keyFn(src[i]) >> (pass * DIGIT_BITS)) & (DIGIT_COUNT - 1);
+				dst[histogram[digit]++] = std::move(src[i]);
+			}
+
+			T* tmp = src;
+			src = dst;
+			dst = tmp;
+		}
+
+		if (src != items.data())
+		{
+			for (sizet i = 0; i < count; ++i)
+			{
+				items[i] = std::move(src[i]);
+			}
+		}
+	}
+
+	inline void radixSort(eastl::span<u64> keys, eastl::span<u64> scratch)
+	{
+		radixSort(keys, scratch, [](u64 key) { return key; });
+	}
+}
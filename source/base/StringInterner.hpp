@@ -7,47 +7,22 @@
 
 namespace spite
 {
-	// A thread-safe singleton registry for interning strings.
-	// It maps strings to unique HashedString IDs to save memory and improve lookup performance.
+	// A thread-safe singleton registry of runtime strings.
+	// Ids are the FNV-1a hash of the string, so interned strings compare equal to "name"_hs literals.
+	// The interner only keeps the reverse table for c_str() and detects hash collisions on registration.
 	class StringInterner
 	{
 	private:
-		// Transparent hasher for heterogeneous lookups (char* vs heap_string)
-		struct StringHasher
-		{
-			using is_transparent = void;
-
-			// Hasher for the lookup type (const char*)
-			// Implements the FNV-1a hash algorithm
-			sizet operator()(cstring str) const;
-
-			// Hasher for the actual key type (eastl::string)
-			sizet operator()(const heap_string& txt) const;
-		};
-
-		// Transparent equality for heterogeneous lookups
-		struct StringEqual
-		{
-			using is_transparent = void;
-
-			// Explicitly use strcmp for all comparisons to guarantee content-based checking.
-			bool operator()(const heap_string& a, const heap_string& b) const;
-
-			bool operator()(const heap_string& a, const char* b) const;
-			bool operator()(const char* a, const heap_string& b) const;
-		};
-
 		static StringInterner* m_instance;
 		HeapAllocator m_allocator;
 
-		// Owns the actual string data
-		heap_vector<heap_string> m_idToStrings;
-		// Maps a string to its unique ID for fast lookups
-		heap_unordered_map<heap_string, u64, StringHasher, StringEqual> m_stringToId;
+		// Owns the actual string data, nodes keep c_str() pointers stable
+		heap_unordered_map<u64, heap_string> m_idToString;
 
-		u64 m_nextId = 1; // Start from 1, 0 is reserved for undefined/empty
 		mutable std::mutex m_mutex;
 
+		HashedString registerString(u64 id, cstring str);
+
 	public:
 		StringInterner(const StringInterner&) = delete;
 		StringInterner& operator=(const StringInterner&) = delete;
@@ -58,7 +33,7 @@ namespace spite
 		static StringInterner* get();
 
 		// Gets the HashedString for a given C-style string.
-		// This version avoids intermediate heap_string allocation for lookups.
+		// Prefer "name"_hs when the string is known at compile time.
 		HashedString getOrCreate(cstring str);
 
 		// Gets the HashedString for a given eastl::string.
@@ -66,7 +41,7 @@ namespace spite
 		HashedString getOrCreate(const heap_string& str);
 
 		// Resolves a HashedString back to its original C-style string.
-		// Returns nullptr if the ID is invalid.
+		// Returns nullptr if the string was never interned.
 		cstring resolve(HashedString id) const;
 	};
 
@@ -0,0 +1,54 @@
+#include "ThreadIndex.hpp"
+
+#include <mutex>
+
+#include "base/Assert.hpp"
+
+namespace spite
+{
+	namespace
+	{
+		std::mutex g_indexMutex;
+		u32 g_freeIndices[MAX_THREAD_INDICES];
+		u32 g_freeCount = 0;
+		u32 g_nextIndex = 0;
+
+		u32 acquireIndex()
+		{
+			std::lock_guard<std::mutex> lock(g_indexMutex);
+			if (g_freeCount > 0)
+			{
+				return g_freeIndices[--g_freeCount];
+			}
+			SASSERTM(g_nextIndex < MAX_THREAD_INDICES, "More than %u threads requested a thread index\n",
+			         MAX_THREAD_INDICES)
+			return g_nextIndex++;
+		}
+
+		void releaseIndex(u32 index)
+		{
+			std::lock_guard<std::mutex> lock(g_indexMutex);
+			g_freeIndices[g_freeCount++] = index;
+		}
+
+		struct ThreadIndexHolder
+		{
+			u32 index;
+
+			ThreadIndexHolder() : index(acquireIndex())
+			{
+			}
+
+			~ThreadIndexHolder()
+			{
+				releaseIndex(index);
+			}
+		};
+	}
+
+	u32 getThreadIndex()
+	{
+		thread_local ThreadIndexHolder holder;
+		return holder.index;
+	}
+}
@@ -0,0 +1,13 @@
+#pragma once
+#include "base/Platform.hpp"
+
+namespace spite
+{
+	// Upper bound on threads that may hold an index at the same time
+	constexpr u32 MAX_THREAD_INDICES = 64;
+
+	// Small dense index of the calling thread in [0, MAX_THREAD_INDICES)
+	// Assigned on first call and returned to the pool when the thread exits,
+	// so it can be used to address per-thread slots in fixed arrays
+	u32 getThreadIndex();
+}
@@ -1,4 +1,10 @@
 #include "AllocatorRegistry.hpp"
+
+#include <algorithm>
+#include <cstdio>
+
+#include <external/tracy/tracy/Tracy.hpp>
+
 #include "base/Logging.hpp"
 
 namespace spite
@@ -11,11 +17,12 @@ namespace spite
 
 	void AllocatorRegistry::createSubsystemAllocators()
 	{
-		createAllocator("MainAllocator",32*MB);
-		createAllocator("GpuAllocator", 128 * MB);
+		createAllocator("MainAllocator", 16 * MB, ANY_NUMA_NODE, 1024 * MB);
+		createAllocator("GpuAllocator", 32 * MB, ANY_NUMA_NODE, 1024 * MB);
 	}
 
-	HeapAllocator& AllocatorRegistry::createAllocator(cstring name, sizet size)
+	HeapAllocator& AllocatorRegistry::createAllocator(cstring name, sizet size, u32 numaNode, sizet maxSize,
+	                                                  bool hugePages)
 	{
 		auto it = m_allocators.find(name);
 		if (it != m_allocators.end()) {
@@ -23,15 +30,43 @@ namespace spite
 			return *it->second;
 		}
         
-		auto allocator = std::make_unique<HeapAllocator>(name, size);
+		auto allocator = std::make_unique<HeapAllocator>(name, size, std::max(size, maxSize), numaNode, hugePages);
 		HeapAllocator& ref = *allocator;
-		m_allocators[name] = std::move(allocator);
+		auto inserted = m_allocators.emplace(name, std::move(allocator)).first;
+		// The key outlives the allocator, name may be a temporary
+		ref.set_name(inserted->first.c_str());
         
-		SDEBUG_LOG("AllocatorRegistry: Created allocator '%s' with %zu MB\n", 
-		           name, size / (MB))
+		SDEBUG_LOG("AllocatorRegistry: Created allocator '%s' with %zu MB, up to %zu MB\n",
+		           name, size / (MB), ref.get_max_size() / (MB))
 		return ref;
 	}
 
+	void AllocatorRegistry::createNumaArenas(sizet sizePerNode, bool hugePages)
+	{
+		const u32 nodeCount = getNumaNodeCount();
+		for (u32 node = 0; node < nodeCount; ++node)
+		{
+			char name[32];
+			snprintf(name, sizeof(name), "NumaArena%u", node);
+			m_numaArenas[node] = &createAllocator(name, sizePerNode, nodeCount > 1 ? node : ANY_NUMA_NODE, 0, hugePages);
+		}
+		m_numaArenaCount = nodeCount;
+	}
+
+	HeapAllocator& AllocatorRegistry::getNumaArena(u32 node)
+	{
+		if (m_numaArenaCount == 0)
+		{
+			return getGlobalAllocator();
+		}
+		return *m_numaArenas[node % m_numaArenaCount];
+	}
+
+	u32 AllocatorRegistry::getNumaArenaCount() const
+	{
+		return m_numaArenaCount;
+	}
+
 	HeapAllocator& AllocatorRegistry::getAllocator(cstring name)
 	{
 		auto it = m_allocators.find(name);
@@ -48,6 +83,78 @@ namespace spite
 		return m_allocators.find(name) != m_allocators.end();
 	}
 
+	void AllocatorRegistry::endFrame(bool walkPools)
+	{
+		for (auto& [name, allocator] : m_allocators)
+		{
+			allocator->end_frame();
+			plotStats(name.c_str(), allocator->get_stats(walkPools), walkPools);
+		}
+		HeapAllocator& global = getGlobalAllocator();
+		global.end_frame();
+		plotStats(getGlobalAllocatorName(), global.get_stats(walkPools), walkPools);
+	}
+
+	glheap_vector<AllocatorRegistry::AllocatorReport> AllocatorRegistry::collectStats(bool walkPools) const
+	{
+		glheap_vector<AllocatorReport> reports;
+		reports.reserve(m_allocators.size() + 1);
+		for (const auto& [name, allocator] : m_allocators)
+		{
+			reports.push_back({name.c_str(), allocator->get_stats(walkPools)});
+		}
+		reports.push_back({getGlobalAllocatorName(), getGlobalAllocator().get_stats(walkPools)});
+		return reports;
+	}
+
+	void AllocatorRegistry::printStats(bool walkPools) const
+	{
+		for (const AllocatorReport& report : collectStats(walkPools))
+		{
+			const HeapAllocatorStats& stats = report.stats;
+			SDEBUG_LOG("%s: live %zu KB, peak %zu KB, reserved %zu KB, last frame %llu allocs %llu frees\n", report.name,
+			           stats.liveBytes / KB, stats.peakBytes / KB, stats.reservedBytes / KB, stats.frameAllocations,
+			           stats.frameFrees)
+			if (walkPools)
+			{
+				SDEBUG_LOG("%s: free %zu KB, largest free block %zu KB, fragmentation %.2f\n", report.name,
+				           stats.freeBytes / KB, stats.largestFreeBlock / KB, stats.fragmentation)
+			}
+		}
+	}
+
+	const AllocatorRegistry::PlotNames& AllocatorRegistry::getPlotNames(cstring name)
+	{
+		auto it = m_plotNames.find(name);
+		if (it != m_plotNames.end())
+		{
+			return it->second;
+		}
+
+		const eastl::string prefix(name);
+		PlotNames names{
+			prefix + " live", prefix + " peak", prefix + " allocations", prefix + " frees", prefix + " fragmentation"
+		};
+		const PlotNames& inserted = m_plotNames.emplace(name, std::move(names)).first->second;
+		TracyPlotConfig(inserted.liveBytes.c_str(), tracy::PlotFormatType::Memory, true, true, 0);
+		TracyPlotConfig(inserted.peakBytes.c_str(), tracy::PlotFormatType::Memory, true, false, 0);
+		TracyPlotConfig(inserted.fragmentation.c_str(), tracy::PlotFormatType::Percentage, true, false, 0);
+		return inserted;
+	}
+
+	void AllocatorRegistry::plotStats(cstring name, const HeapAllocatorStats& stats, bool walkPools)
+	{
+		const PlotNames& names = getPlotNames(name);
+		TracyPlot(names.liveBytes.c_str(), static_cast<int64_t>(stats.liveBytes));
+		TracyPlot(names.peakBytes.c_str(), static_cast<int64_t>(stats.peakBytes));
+		TracyPlot(names.allocations.c_str(), static_cast<int64_t>(stats.frameAllocations));
+		TracyPlot(names.frees.c_str(), static_cast<int64_t>(stats.frameFrees));
+		if (walkPools)
+		{
+			TracyPlot(names.fragmentation.c_str(), stats.fragmentation * 100.f);
+		}
+	}
+
 	void AllocatorRegistry::shutdownAll()
 	{
 		SDEBUG_LOG("AllocatorRegistry: Shutting down %zu subsystem allocators\n", m_allocators.size())
@@ -58,5 +165,6 @@ namespace spite
 			allocator->shutdown(false);
 		}
 		m_allocators.clear(true);
+		m_numaArenaCount = 0;
 	}
 }
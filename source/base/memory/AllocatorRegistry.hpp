@@ -6,8 +6,29 @@ namespace spite
 {
 	class AllocatorRegistry
 	{
+	public:
+		struct AllocatorReport
+		{
+			cstring name;
+			HeapAllocatorStats stats;
+		};
+
 	private:
+		// Tracy keys plots by name pointer, the strings live as long as the registry
+		struct PlotNames
+		{
+			eastl::string liveBytes;
+			eastl::string peakBytes;
+			eastl::string allocations;
+			eastl::string frees;
+			eastl::string fragmentation;
+		};
+
 		glheap_unordered_map<eastl::string, std::unique_ptr<HeapAllocator>> m_allocators;
+		glheap_unordered_map<eastl::string, PlotNames> m_plotNames;
+		// Indexed by node, owned by m_allocators
+		HeapAllocator* m_numaArenas[MAX_NUMA_NODES] = {};
+		u32 m_numaArenaCount = 0;
 	public:
 		static AllocatorRegistry& instance();
 
@@ -15,13 +36,39 @@ namespace spite
 		void createSubsystemAllocators();
 
 		// Create a new allocator or return existing one
-		HeapAllocator& createAllocator(cstring name, sizet size);
+		// maxSize above size lets the allocator grow on demand, 0 keeps it fixed at size.
+		// hugePages backs it with 2 MiB pages, check get_huge_page_mode for what was obtained
+		HeapAllocator& createAllocator(cstring name, sizet size, u32 numaNode = ANY_NUMA_NODE, sizet maxSize = 0,
+		                               bool hugePages = false);
+
+		// Creates "NumaArena<node>" with memory local to every NUMA node, a single arena on single node systems.
+		// Chunk storage is scanned linearly, huge pages cut its TLB misses
+		void createNumaArenas(sizet sizePerNode, bool hugePages = false);
+
+		// Falls back to the global allocator if arenas were not created
+		HeapAllocator& getNumaArena(u32 node);
+
+		// 0 until createNumaArenas is called
+		u32 getNumaArenaCount() const;
 
 		HeapAllocator& getAllocator(cstring name);
 
 		// Check if an allocator exists
 		bool hasAllocator(cstring name) const;
 
+		// Closes the frame counters of the registered allocators and the global one and plots them to Tracy.
+		// walkPools adds the fragmentation plot, see HeapAllocator::get_stats for its cost
+		void endFrame(bool walkPools = false);
+
+		// The registered allocators followed by the global one
+		glheap_vector<AllocatorReport> collectStats(bool walkPools = true) const;
+
+		void printStats(bool walkPools = true) const;
+
 		void shutdownAll();
+
+	private:
+		const PlotNames& getPlotNames(cstring name);
+		void plotStats(cstring name, const HeapAllocatorStats& stats, bool walkPools);
 	};
 }
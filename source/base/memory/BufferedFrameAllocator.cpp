@@ -0,0 +1,124 @@
+#include "BufferedFrameAllocator.hpp"
+
+#include <algorithm>
+
+namespace spite
+{
+	BufferedFrameAllocator::BufferedFrameAllocator(u32 frameCount, sizet regionSize, cstring name,
+	                                               bool hugePages): m_current(frameCount - 1), m_name(name)
+	{
+		SASSERTM(frameCount > 0, "BufferedFrameAllocator %s needs at least one frame\n", name)
+		m_regions.reserve(frameCount);
+		for (u32 i = 0; i < frameCount; ++i)
+		{
+			m_regions.push_back(FrameRegion{ScratchAllocator(regionSize, name, hugePages)});
+		}
+	}
+
+	u64 BufferedFrameAllocator::beginFrame()
+	{
+		const u32 next = (m_current + 1) % frame_count();
+		FrameRegion& region = m_regions[next];
+		SASSERTM(region.retired, "BufferedFrameAllocator %s: frame %llu is still in flight\n", m_name, region.frame)
+
+		region.scratch.reset();
+		region.frame = m_nextFrame++;
+		region.retired = false;
+		m_current = next;
+		return region.frame;
+	}
+
+	void BufferedFrameAllocator::retireFrame(u64 frame)
+	{
+		FrameRegion& region = m_regions[frame % frame_count()];
+		if (region.frame == frame)
+		{
+			region.retired = true;
+		}
+	}
+
+	bool BufferedFrameAllocator::isRetired(u64 frame) const
+	{
+		const FrameRegion& region = m_regions[frame % frame_count()];
+		// A recycled region was retired before
+		return region.frame != frame || region.retired;
+	}
+
+	u64 BufferedFrameAllocator::current_frame() const noexcept
+	{
+		return m_regions[m_current].frame;
+	}
+
+	ScratchAllocator& BufferedFrameAllocator::current()
+	{
+		SASSERTM(m_nextFrame > 0, "BufferedFrameAllocator %s: beginFrame was not called\n", m_name)
+		return m_regions[m_current].scratch;
+	}
+
+	void* BufferedFrameAllocator::allocate(sizet size, int flags)
+	{
+		return current().allocate(size, flags);
+	}
+
+	void* BufferedFrameAllocator::allocate(sizet size, sizet alignment, sizet offset, int flags)
+	{
+		return current().allocate(size, alignment, offset, flags);
+	}
+
+	void BufferedFrameAllocator::deallocate(void*, size_t) noexcept
+	{
+	}
+
+	ScratchAllocator::ScopedMarker BufferedFrameAllocator::get_scoped_marker()
+	{
+		return current().get_scoped_marker();
+	}
+
+	sizet BufferedFrameAllocator::bytes_used() const noexcept
+	{
+		return m_regions[m_current].scratch.bytes_used();
+	}
+
+	sizet BufferedFrameAllocator::bytes_remaining() const noexcept
+	{
+		return m_regions[m_current].scratch.bytes_remaining();
+	}
+
+	sizet BufferedFrameAllocator::total_size() const noexcept
+	{
+		sizet size = 0;
+		for (const FrameRegion& region : m_regions)
+		{
+			size += region.scratch.total_size();
+		}
+		return size;
+	}
+
+	sizet BufferedFrameAllocator::high_water_mark() const noexcept
+	{
+		sizet mark = 0;
+		for (const FrameRegion& region : m_regions)
+		{
+			mark = std::max(mark, region.scratch.high_water_mark());
+		}
+		return mark;
+	}
+
+	u32 BufferedFrameAllocator::frame_count() const noexcept
+	{
+		return static_cast<u32>(m_regions.size());
+	}
+
+	const char* BufferedFrameAllocator::get_name() const noexcept
+	{
+		return m_name;
+	}
+
+	bool BufferedFrameAllocator::owns(const void* ptr) const noexcept
+	{
+		return std::any_of(m_regions.begin(), m_regions.end(), [ptr](const FrameRegion& region)
+		{
+			return region.scratch.owns(ptr);
+		});
+	}
+}
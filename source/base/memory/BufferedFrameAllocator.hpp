@@ -0,0 +1,99 @@
+#pragma once
+#include "base/CollectionAliases.hpp"
+#include "base/memory/ScratchAllocator.hpp"
+
+namespace spite
+{
+	// Ring of scratch regions for data that has to live while its frame is in flight:
+	// upload staging, draw lists, render extraction.
+	// beginFrame moves to the next region, which is recycled only after retireFrame was called for the frame
+	// that last filled it (its fence has signalled). Mirrors ScratchAllocator and, like it, is not thread safe.
+	// Containers can use ScratchAllocatorAdapter over current()
+	class BufferedFrameAllocator
+	{
+	public:
+		static constexpr u64 NO_FRAME = ~0ull;
+
+	private:
+		struct FrameRegion
+		{
+			ScratchAllocator scratch;
+			// Frame that last filled the region
+			u64 frame = NO_FRAME;
+			bool retired = true;
+		};
+
+		glheap_vector<FrameRegion> m_regions;
+		u32 m_current;
+		u64 m_nextFrame = 0;
+		cstring m_name;
+
+	public:
+		// frameCount regions of regionSize bytes each, usually one per frame in flight
+		BufferedFrameAllocator(u32 frameCount, sizet regionSize, cstring name = "BufferedFrameAllocator",
+		                       bool hugePages = false);
+
+		BufferedFrameAllocator(const BufferedFrameAllocator&) = delete;
+		BufferedFrameAllocator& operator=(const BufferedFrameAllocator&) = delete;
+
+		// Recycles the next region and returns the frame it now belongs to.
+		// Asserts if the frame that used the region before has not been retired
+		u64 beginFrame();
+
+		// The frame's data is no longer in use, its region may be recycled
+		void retireFrame(u64 frame);
+
+		bool isRetired(u64 frame) const;
+
+		// NO_FRAME before the first beginFrame
+		u64 current_frame() const noexcept;
+
+		// Region of the current frame
+		ScratchAllocator& current();
+
+		//alignment is 16 by default
+		void* allocate(sizet size, int flags = 0);
+		void* allocate(sizet size, sizet alignment, sizet offset = 0, int flags = 0);
+
+		template <typename T, typename... Args>
+		T* new_object(Args&&... args);
+
+		template <typename T>
+		void delete_object(T* obj);
+
+		// No-op, memory goes back when the frame is recycled
+		void deallocate(void* /*ptr*/, size_t /*size*/) noexcept;
+
+		// Rewinds within the current frame
+		ScratchAllocator::ScopedMarker get_scoped_marker();
+
+		// Of the current frame
+		sizet bytes_used() const noexcept;
+		sizet bytes_remaining() const noexcept;
+
+		// Sum over all regions
+		sizet total_size() const noexcept;
+
+		// Highest among the regions
+		sizet high_water_mark() const noexcept;
+
+		u32 frame_count() const noexcept;
+
+		const char* get_name() const noexcept;
+
+		// Check if pointer was allocated from any of the regions
+		bool owns(const void* ptr) const noexcept;
+	};
+
+	template <typename T, typename ... Args>
+	T* BufferedFrameAllocator::new_object(Args&&... args)
+	{
+		return current().new_object<T>(std::forward<Args>(args)...);
+	}
+
+	template <typename T>
+	void BufferedFrameAllocator::delete_object(T* obj)
+	{
+		current().delete_object(obj);
+	}
+}
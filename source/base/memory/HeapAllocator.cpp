@@ -1,6 +1,10 @@
 #include "HeapAllocator.hpp"
 
+#include <algorithm>
+#include <atomic>
 #include <cstdlib>
+#include <cstring>
+#include <mutex>
 #include <thread>
 
 #include <external/tracy/client/TracyCallstack.hpp>
@@ -8,12 +12,15 @@
 #include "Base/Assert.hpp"
 #include "Base/Logging.hpp"
 #include "base/CallstackDebug.hpp"
+#include "base/ThreadIndex.hpp"
+#include "base/memory/VirtualMemory.hpp"
 
 #include "External/tlsf.h"
 
 namespace spite
 {
-	constexpr sizet GLOBAL_ALLOCATOR_SIZE = 1024 * MB;
+	constexpr sizet GLOBAL_ALLOCATOR_SIZE = 256 * MB;
+	constexpr sizet GLOBAL_ALLOCATOR_MAX_SIZE = 4096 * MB;
 
 	namespace
 	{
@@ -23,7 +30,8 @@ namespace spite
 	void initGlobalAllocator()
 	{
 		SASSERTM(!s_globalAllocator, "Trying to initialize the global allocator more than once\n")
-		s_globalAllocator = new HeapAllocator("Global Allocator", GLOBAL_ALLOCATOR_SIZE);
+		s_globalAllocator = new HeapAllocator("Global Allocator", GLOBAL_ALLOCATOR_SIZE, GLOBAL_ALLOCATOR_MAX_SIZE,
+		                                      ANY_NUMA_NODE);
 	}
 
 	HeapAllocator& getGlobalAllocator()
@@ -79,6 +87,628 @@ namespace spite
 		}
 	}
 
+	namespace
+	{
+		// Small blocks are carved from spans, each span holds one size class and belongs to one thread
+		constexpr sizet SPAN_SIZE = 16 * KB;
+		constexpr sizet SPAN_SHIFT = 14;
+		constexpr sizet SMALL_BLOCK_ALIGNMENT = 16;
+		constexpr sizet SMALL_SIZE_CLASSES[] = {16, 32, 48, 64, 96, 128, 192, 256, 384, 512};
+		constexpr u32 SIZE_CLASS_COUNT = sizeof(SMALL_SIZE_CLASSES) / sizeof(SMALL_SIZE_CLASSES[0]);
+		constexpr sizet MAX_SMALL_SIZE = SMALL_SIZE_CLASSES[SIZE_CLASS_COUNT - 1];
+
+		static_assert(sizet(1) << SPAN_SHIFT == SPAN_SIZE);
+
+		struct FreeBlock
+		{
+			FreeBlock* next;
+		};
+
+		// Only touched by the owning thread
+		struct SpanHeader
+		{
+			// Partial list of the owning cache
+			SpanHeader* prev;
+			SpanHeader* next;
+			FreeBlock* freeList;
+			u32 owner;
+			u32 sizeClass;
+			u32 liveCount;
+			u32 carvedCount;
+			u32 capacity;
+			bool isPartial;
+		};
+
+		constexpr sizet SPAN_DATA_OFFSET = (sizeof(SpanHeader) + SMALL_BLOCK_ALIGNMENT - 1) & ~(
+			SMALL_BLOCK_ALIGNMENT - 1);
+
+		struct alignas(64) ThreadCache
+		{
+			// Span blocks are allocated from, kept even when it runs empty
+			SpanHeader* active[SIZE_CLASS_COUNT];
+			// Spans with free blocks other than the active one
+			SpanHeader* partial[SIZE_CLASS_COUNT];
+			// Blocks freed by other threads, drained by the owner when its spans run out
+			std::atomic<FreeBlock*> remoteFrees;
+			// Telemetry of calls made on this thread, written by it only and summed by get_stats
+			std::atomic<u64> allocations;
+			std::atomic<u64> frees;
+			std::atomic<u64> allocatedBytes;
+			std::atomic<u64> freedBytes;
+		};
+
+		u32 sizeClassOf(sizet size)
+		{
+			u32 sizeClass = 0;
+			while (SMALL_SIZE_CLASSES[sizeClass] < size)
+			{
+				++sizeClass;
+			}
+			return sizeClass;
+		}
+
+		bool isSmallRequest(sizet size, sizet alignment)
+		{
+			return size != 0 && size <= MAX_SMALL_SIZE && alignment <= SMALL_BLOCK_ALIGNMENT;
+		}
+	}
+
+	namespace
+	{
+		constexpr u32 MAX_HEAP_REGIONS = 64;
+		// Grown regions are rounded up to this
+		constexpr sizet REGION_GRANULARITY = 64 * KB;
+
+		// Memory added to the tlsf pool. The address range of a published region never changes,
+		// lock-free lookups may read it while other threads grow or shrink the pool
+		struct HeapRegion
+		{
+			std::byte* memory;
+			sizet size;
+			pool_t pool;
+			// memory rounded down to SPAN_SIZE, spanMap[i] is the span starting at spanBase + i * SPAN_SIZE
+			uintptr_t spanBase;
+			std::atomic<SpanHeader*>* spanMap;
+			// Bytes of live tlsf blocks
+			sizet usedBytes;
+			// Released regions are kept until shutdown since a lookup may still be scanning them
+			HeapRegion* nextRetired;
+
+			bool contains(uintptr_t address) const
+			{
+				const uintptr_t begin = reinterpret_cast<uintptr_t>(memory);
+				return address >= begin && address - begin < size;
+			}
+		};
+	}
+
+	struct HeapAllocatorState
+	{
+		void* tlsfHandle;
+		// Guards the tlsf pool, regions, usedBytes and spanMap writes
+		std::mutex mutex;
+		u32 numaNode;
+		bool hugePages;
+		std::atomic<HugePageMode> hugePageMode;
+		// Minimum size of a grown region
+		sizet regionSize;
+		sizet maxSize;
+		std::atomic<sizet> reservedBytes;
+		// regions[0] holds the tlsf control structure and is never released
+		std::atomic<HeapRegion*> regions[MAX_HEAP_REGIONS];
+		// Slots ever used, released slots are null until a new region takes them
+		std::atomic<u32> regionCount;
+		HeapRegion* retiredRegions;
+		ThreadCache caches[MAX_THREAD_INDICES];
+		// Highest live byte count sampled by end_frame and get_stats
+		std::atomic<sizet> peakBytes;
+		// Counter totals at the last end_frame and the counts of the frame it closed, guarded by mutex
+		u64 frameStartAllocations;
+		u64 frameStartFrees;
+		u64 frameAllocations;
+		u64 frameFrees;
+	};
+
+	namespace
+	{
+		sizet regionGranularity(const HeapAllocatorState& state)
+		{
+			return state.hugePages ? HUGE_PAGE_SIZE : REGION_GRANULARITY;
+		}
+
+		void* mapRegionMemory(HeapAllocatorState& state, sizet size, bool firstRegion)
+		{
+			void* memory;
+			HugePageMode mode = HugePageMode::eNone;
+			if (state.numaNode != ANY_NUMA_NODE)
+			{
+				memory = allocateNumaMemory(size, state.numaNode);
+				if (memory && state.hugePages)
+				{
+					mode = adviseHugePages(memory, size);
+				}
+			}
+			else if (state.hugePages)
+			{
+				memory = reserveHugePageMemory(size, mode);
+			}
+			else
+			{
+				memory = reserveVirtualMemory(size);
+			}
+
+			if (memory && (firstRegion || mode < state.hugePageMode.load(std::memory_order_relaxed)))
+			{
+				state.hugePageMode.store(mode, std::memory_order_relaxed);
+			}
+			return memory;
+		}
+
+		void unmapRegionMemory(void* memory, sizet size, u32 numaNode)
+		{
+			if (numaNode == ANY_NUMA_NODE)
+			{
+				releaseVirtualMemory(memory, size);
+			}
+			else
+			{
+				freeNumaMemory(memory, size);
+			}
+		}
+
+		HeapRegion* createRegion(void* memory, sizet size, pool_t pool)
+		{
+			auto* region = static_cast<HeapRegion*>(malloc(sizeof(HeapRegion)));
+			region->memory = static_cast<std::byte*>(memory);
+			region->size = size;
+			region->pool = pool;
+			region->spanBase = reinterpret_cast<uintptr_t>(memory) & ~(SPAN_SIZE - 1);
+			const sizet spanMapSize = ((reinterpret_cast<uintptr_t>(memory) + size - region->spanBase) >> SPAN_SHIFT) +
+				1;
+			region->spanMap = static_cast<std::atomic<SpanHeader*>*>(
+				calloc(spanMapSize, sizeof(std::atomic<SpanHeader*>)));
+			region->usedBytes = 0;
+			region->nextRetired = nullptr;
+			return region;
+		}
+
+		void destroyRegion(HeapRegion* region)
+		{
+			free(region->spanMap);
+			free(region);
+		}
+
+		void publishRegion(HeapAllocatorState& state, u32 slot, HeapRegion* region)
+		{
+			state.regions[slot].store(region, std::memory_order_release);
+			if (slot == state.regionCount.load(std::memory_order_relaxed))
+			{
+				state.regionCount.store(slot + 1, std::memory_order_release);
+			}
+			state.reservedBytes.fetch_add(region->size, std::memory_order_relaxed);
+		}
+
+		HeapRegion* findRegion(const HeapAllocatorState& state, uintptr_t address)
+		{
+			const u32 count = state.regionCount.load(std::memory_order_acquire);
+			for (u32 slot = 0; slot < count; ++slot)
+			{
+				HeapRegion* region = state.regions[slot].load(std::memory_order_acquire);
+				if (region && region->contains(address))
+				{
+					return region;
+				}
+			}
+			return nullptr;
+		}
+
+		SpanHeader* findSpan(const HeapAllocatorState& state, const void* p)
+		{
+			const uintptr_t address = reinterpret_cast<uintptr_t>(p);
+			const HeapRegion* region = findRegion(state, address);
+			return region
+				       ? region->spanMap[(address - region->spanBase) >> SPAN_SHIFT].load(std::memory_order_acquire)
+				       : nullptr;
+		}
+
+		// Everything below expects the state mutex to be held
+
+		// Adds a region large enough for the request, false if the ceiling or the OS does not allow it
+		bool growPool(HeapAllocatorState& state, sizet size, sizet alignment)
+		{
+			const sizet granularity = regionGranularity(state);
+			const sizet needed = (size + alignment + tlsf_pool_overhead() + tlsf_alloc_overhead() + granularity - 1) &
+				~(granularity - 1);
+			const sizet available = state.maxSize - state.reservedBytes.load(std::memory_order_relaxed);
+			const sizet regionSize = std::min({std::max(state.regionSize, needed), available, tlsf_block_size_max()}) &
+				~(granularity - 1);
+			if (regionSize < needed)
+			{
+				return false;
+			}
+
+			u32 slot = 0;
+			const u32 count = state.regionCount.load(std::memory_order_relaxed);
+			while (slot < count && state.regions[slot].load(std::memory_order_relaxed))
+			{
+				++slot;
+			}
+			if (slot == MAX_HEAP_REGIONS)
+			{
+				SDEBUG_LOG("WARNING: HeapAllocator ran out of region slots\n")
+				return false;
+			}
+
+			void* memory = mapRegionMemory(state, regionSize, false);
+			if (!memory)
+			{
+				return false;
+			}
+			pool_t pool = tlsf_add_pool(state.tlsfHandle, memory, regionSize);
+			if (!pool)
+			{
+				unmapRegionMemory(memory, regionSize, state.numaNode);
+				return false;
+			}
+
+			publishRegion(state, slot, createRegion(memory, regionSize, pool));
+			SDEBUG_LOG("HeapAllocator region of %llu bytes added, %llu bytes reserved\n", regionSize,
+			           state.reservedBytes.load(std::memory_order_relaxed))
+			return true;
+		}
+
+		void releaseRegionIfEmpty(HeapAllocatorState& state, HeapRegion* region)
+		{
+			if (region->usedBytes != 0 || region == state.regions[0].load(std::memory_order_relaxed))
+			{
+				return;
+			}
+
+			const u32 count = state.regionCount.load(std::memory_order_relaxed);
+			for (u32 slot = 1; slot < count; ++slot)
+			{
+				if (state.regions[slot].load(std::memory_order_relaxed) == region)
+				{
+					state.regions[slot].store(nullptr, std::memory_order_release);
+					break;
+				}
+			}
+			tlsf_remove_pool(state.tlsfHandle, region->pool);
+			unmapRegionMemory(region->memory, region->size, state.numaNode);
+			state.reservedBytes.fetch_sub(region->size, std::memory_order_relaxed);
+
+			region->nextRetired = state.retiredRegions;
+			state.retiredRegions = region;
+			SDEBUG_LOG("HeapAllocator region of %llu bytes released, %llu bytes reserved\n", region->size,
+			           state.reservedBytes.load(std::memory_order_relaxed))
+		}
+
+		void bumpCounter(std::atomic<u64>& counter, u64 value)
+		{
+			counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+		}
+
+		// Small blocks count their size class, pool blocks their tlsf block size
+		void recordAllocation(HeapAllocatorState& state, sizet bytes)
+		{
+			ThreadCache& cache = state.caches[getThreadIndex()];
+			bumpCounter(cache.allocations, 1);
+			bumpCounter(cache.allocatedBytes, bytes);
+		}
+
+		void recordFree(HeapAllocatorState& state, sizet bytes)
+		{
+			ThreadCache& cache = state.caches[getThreadIndex()];
+			bumpCounter(cache.frees, 1);
+			bumpCounter(cache.freedBytes, bytes);
+		}
+
+		struct CounterTotals
+		{
+			u64 allocations = 0;
+			u64 frees = 0;
+			sizet liveBytes = 0;
+		};
+
+		CounterTotals sumCounters(const HeapAllocatorState& state)
+		{
+			CounterTotals totals;
+			u64 allocatedBytes = 0;
+			u64 freedBytes = 0;
+			for (const ThreadCache& cache : state.caches)
+			{
+				totals.allocations += cache.allocations.load(std::memory_order_relaxed);
+				totals.frees += cache.frees.load(std::memory_order_relaxed);
+				allocatedBytes += cache.allocatedBytes.load(std::memory_order_relaxed);
+				freedBytes += cache.freedBytes.load(std::memory_order_relaxed);
+			}
+			// Counters of other threads are read while they move
+			totals.liveBytes = allocatedBytes > freedBytes ? allocatedBytes - freedBytes : 0;
+			return totals;
+		}
+
+		sizet samplePeak(HeapAllocatorState& state, sizet liveBytes)
+		{
+			sizet peak = state.peakBytes.load(std::memory_order_relaxed);
+			while (liveBytes > peak && !state.peakBytes.compare_exchange_weak(peak, liveBytes, std::memory_order_relaxed))
+			{
+			}
+			return std::max(peak, liveBytes);
+		}
+
+		void freeSpaceWalker(void* ptr, sizet size, int used, void* user)
+		{
+			auto* stats = static_cast<HeapAllocatorStats*>(user);
+			if (!used)
+			{
+				stats->freeBytes += size;
+				stats->largestFreeBlock = std::max(stats->largestFreeBlock, size);
+			}
+		}
+
+		void trackBlock(HeapAllocatorState& state, void* p)
+		{
+			if (p)
+			{
+				findRegion(state, reinterpret_cast<uintptr_t>(p))->usedBytes += tlsf_block_size(p);
+			}
+		}
+
+		// alignment 0 takes the plain tlsf_malloc path
+		void* poolAllocate(HeapAllocatorState& state, sizet size, sizet alignment)
+		{
+			auto allocate = [&]
+			{
+				return alignment ? tlsf_memalign(state.tlsfHandle, alignment, size) : tlsf_malloc(state.tlsfHandle, size);
+			};
+
+			void* mem = allocate();
+			if (!mem && size && growPool(state, size, alignment))
+			{
+				mem = allocate();
+			}
+			trackBlock(state, mem);
+			return mem;
+		}
+
+		void poolFree(HeapAllocatorState& state, void* p)
+		{
+			HeapRegion* region = findRegion(state, reinterpret_cast<uintptr_t>(p));
+			SASSERTM(region, "Freed pointer does not belong to the allocator\n")
+			region->usedBytes -= tlsf_block_size(p);
+			tlsf_free(state.tlsfHandle, p);
+			releaseRegionIfEmpty(state, region);
+		}
+
+		void* poolReallocate(HeapAllocatorState& state, void* original, sizet size)
+		{
+			if (!original)
+			{
+				void* mem = poolAllocate(state, size, 0);
+				if (mem)
+				{
+					recordAllocation(state, tlsf_block_size(mem));
+				}
+				return mem;
+			}
+			if (size == 0)
+			{
+				recordFree(state, tlsf_block_size(original));
+				poolFree(state, original);
+				return nullptr;
+			}
+
+			HeapRegion* region = findRegion(state, reinterpret_cast<uintptr_t>(original));
+			SASSERTM(region, "Reallocated pointer does not belong to the allocator\n")
+			const sizet originalSize = tlsf_block_size(original);
+			void* mem = tlsf_realloc(state.tlsfHandle, original, size);
+			if (!mem && growPool(state, size, 0))
+			{
+				mem = tlsf_realloc(state.tlsfHandle, original, size);
+			}
+			if (!mem)
+			{
+				return nullptr;
+			}
+
+			region->usedBytes -= originalSize;
+			trackBlock(state, mem);
+			releaseRegionIfEmpty(state, region);
+			recordFree(state, originalSize);
+			recordAllocation(state, tlsf_block_size(mem));
+			return mem;
+		}
+
+		SpanHeader* createSpan(HeapAllocatorState& state, u32 owner, u32 sizeClass)
+		{
+			std::lock_guard<std::mutex> lock(state.mutex);
+			void* memory = poolAllocate(state, SPAN_SIZE, SPAN_SIZE);
+			if (!memory)
+			{
+				return nullptr;
+			}
+
+			auto* span = static_cast<SpanHeader*>(memory);
+			*span = {};
+			span->owner = owner;
+			span->sizeClass = sizeClass;
+			span->capacity = static_cast<u32>((SPAN_SIZE - SPAN_DATA_OFFSET) / SMALL_SIZE_CLASSES[sizeClass]);
+			const uintptr_t address = reinterpret_cast<uintptr_t>(span);
+			const HeapRegion* region = findRegion(state, address);
+			region->spanMap[(address - region->spanBase) >> SPAN_SHIFT].store(span, std::memory_order_release);
+			return span;
+		}
+
+		void releaseSpan(HeapAllocatorState& state, SpanHeader* span)
+		{
+			std::lock_guard<std::mutex> lock(state.mutex);
+			const uintptr_t address = reinterpret_cast<uintptr_t>(span);
+			const HeapRegion* region = findRegion(state, address);
+			region->spanMap[(address - region->spanBase) >> SPAN_SHIFT].store(nullptr, std::memory_order_relaxed);
+			poolFree(state, span);
+		}
+
+		void linkPartial(ThreadCache& cache, SpanHeader* span)
+		{
+			SpanHeader*& head = cache.partial[span->sizeClass];
+			span->prev = nullptr;
+			span->next = head;
+			if (head)
+			{
+				head->prev = span;
+			}
+			head = span;
+			span->isPartial = true;
+		}
+
+		void unlinkPartial(ThreadCache& cache, SpanHeader* span)
+		{
+			if (span->prev)
+			{
+				span->prev->next = span->next;
+			}
+			else
+			{
+				cache.partial[span->sizeClass] = span->next;
+			}
+			if (span->next)
+			{
+				span->next->prev = span->prev;
+			}
+			span->prev = span->next = nullptr;
+			span->isPartial = false;
+		}
+
+		bool hasFreeBlock(const SpanHeader* span)
+		{
+			return span->freeList || span->carvedCount < span->capacity;
+		}
+
+		void* popBlock(SpanHeader* span)
+		{
+			++span->liveCount;
+			if (FreeBlock* block = span->freeList)
+			{
+				span->freeList = block->next;
+				return block;
+			}
+			return reinterpret_cast<std::byte*>(span) + SPAN_DATA_OFFSET + span->carvedCount++ * SMALL_SIZE_CLASSES[span
+				->sizeClass];
+		}
+
+		// Empty spans go back to the pool unless they are the active span of their class
+		void freeLocal(HeapAllocatorState& state, ThreadCache& cache, SpanHeader* span, void* p)
+		{
+			auto* block = static_cast<FreeBlock*>(p);
+			block->next = span->freeList;
+			span->freeList = block;
+			--span->liveCount;
+
+			if (span == cache.active[span->sizeClass])
+			{
+				return;
+			}
+			if (span->liveCount == 0)
+			{
+				if (span->isPartial)
+				{
+					unlinkPartial(cache, span);
+				}
+				releaseSpan(state, span);
+			}
+			else if (!span->isPartial)
+			{
+				linkPartial(cache, span);
+			}
+		}
+
+		void freeRemote(ThreadCache& ownerCache, void* p)
+		{
+			auto* block = static_cast<FreeBlock*>(p);
+			FreeBlock* head = ownerCache.remoteFrees.load(std::memory_order_relaxed);
+			do
+			{
+				block->next = head;
+			}
+			while (!ownerCache.remoteFrees.compare_exchange_weak(head, block, std::memory_order_release,
+			                                                     std::memory_order_relaxed));
+		}
+
+		void drainRemoteFrees(HeapAllocatorState& state, ThreadCache& cache)
+		{
+			FreeBlock* block = cache.remoteFrees.exchange(nullptr, std::memory_order_acquire);
+			while (block)
+			{
+				FreeBlock* next = block->next;
+				freeLocal(state, cache, findSpan(state, block), block);
+				block = next;
+			}
+		}
+
+		void* allocateSmall(HeapAllocatorState& state, sizet size)
+		{
+			const u32 sizeClass = sizeClassOf(size);
+			const u32 owner = getThreadIndex();
+			ThreadCache& cache = state.caches[owner];
+
+			SpanHeader* span = cache.active[sizeClass];
+			if (!span || !hasFreeBlock(span))
+			{
+				drainRemoteFrees(state, cache);
+			}
+			if (!span || !hasFreeBlock(span))
+			{
+				// A full active span is left untracked until one of its blocks is freed
+				span = cache.partial[sizeClass];
+				if (span)
+				{
+					unlinkPartial(cache, span);
+				}
+				else
+				{
+					span = createSpan(state, owner, sizeClass);
+					if (!span)
+					{
+						return nullptr;
+					}
+				}
+				cache.active[sizeClass] = span;
+			}
+			recordAllocation(state, SMALL_SIZE_CLASSES[sizeClass]);
+			return popBlock(span);
+		}
+
+		void deallocateSmall(HeapAllocatorState& state, SpanHeader* span, void* p)
+		{
+			recordFree(state, SMALL_SIZE_CLASSES[span->sizeClass]);
+			if (span->owner == getThreadIndex())
+			{
+				freeLocal(state, state.caches[span->owner], span, p);
+			}
+			else
+			{
+				freeRemote(state.caches[span->owner], p);
+			}
+		}
+
+		// Returns cached empty spans to the pool, the allocator must not be used concurrently
+		void releaseCachedSpans(HeapAllocatorState& state)
+		{
+			for (ThreadCache& cache : state.caches)
+			{
+				drainRemoteFrees(state, cache);
+				for (SpanHeader*& span : cache.active)
+				{
+					if (span && span->liveCount == 0)
+					{
+						releaseSpan(state, span);
+					}
+					span = nullptr;
+				}
+			}
+		}
+	}
+
 	HeapAllocator& HeapAllocator::operator=(const HeapAllocator& x)
 	{
 		return *this;
@@ -86,27 +716,53 @@ namespace spite
 
 	HeapAllocator::HeapAllocator(cstring name, sizet size) : m_name(name), m_maxSize(size)
 	{
-		init(size);
+		init(size, size, false);
+	}
+
+	HeapAllocator::HeapAllocator(cstring name, sizet size, u32 numaNode) : m_name(name), m_maxSize(size),
+	                                                                      m_numaNode(numaNode)
+	{
+		init(size, size, false);
+	}
+
+	HeapAllocator::HeapAllocator(cstring name, sizet size, sizet maxSize, u32 numaNode, bool hugePages) :
+		m_name(name), m_maxSize(std::max(size, maxSize)), m_numaNode(numaNode)
+	{
+		init(size, m_maxSize, hugePages);
 	}
 
 	HeapAllocator::HeapAllocator(const HeapAllocator& x) : m_name(x.m_name),
 	                                                       m_tlsfHandle(x.m_tlsfHandle),
 	                                                       m_memory(x.m_memory),
-	                                                       m_maxSize(x.m_maxSize)
+	                                                       m_state(x.m_state),
+	                                                       m_maxSize(x.m_maxSize),
+	                                                       m_numaNode(x.m_numaNode)
 	{
 	}
 
 	HeapAllocator::HeapAllocator(const HeapAllocator& x, const char* pName) : m_name(pName),
 	                                                                          m_tlsfHandle(x.m_tlsfHandle),
 	                                                                          m_memory(x.m_memory),
-	                                                                          m_maxSize(x.m_maxSize)
+	                                                                          m_state(x.m_state),
+	                                                                          m_maxSize(x.m_maxSize),
+	                                                                          m_numaNode(x.m_numaNode)
 
 	{
 	}
 
 	void* HeapAllocator::allocate(sizet size, int flags) const
 	{
-		void* mem = tlsf_malloc(m_tlsfHandle, size);
+		if (isSmallRequest(size, SMALL_BLOCK_ALIGNMENT))
+		{
+			return allocateSmall(*m_state, size);
+		}
+
+		std::lock_guard<std::mutex> lock(m_state->mutex);
+		void* mem = poolAllocate(*m_state, size, 0);
+		if (mem)
+		{
+			recordAllocation(*m_state, tlsf_block_size(mem));
+		}
 		//SDEBUG_LOG("HeapAllocator %s memory allocation: %p size %llu \n", m_name, mem, size)
 		//logCallstack(15, "HeapAlloc stack\n");
 		return mem;
@@ -114,7 +770,17 @@ namespace spite
 
 	void* HeapAllocator::allocate(sizet size, sizet alignment, sizet offset, int flags) const
 	{
-		void* mem = tlsf_memalign(m_tlsfHandle, alignment, size);
+		if (isSmallRequest(size, alignment))
+		{
+			return allocateSmall(*m_state, size);
+		}
+
+		std::lock_guard<std::mutex> lock(m_state->mutex);
+		void* mem = poolAllocate(*m_state, size, alignment);
+		if (mem)
+		{
+			recordAllocation(*m_state, tlsf_block_size(mem));
+		}
 		//SDEBUG_LOG("HeapAllocator %s memory allocation: %p size %llu \n", m_name, mem, size)
 		//logCallstack(15, "HeapAlloc stack\n");
 		return mem;
@@ -122,12 +788,43 @@ namespace spite
 
 	void* HeapAllocator::reallocate(void* original, sizet size) const
 	{
-		return tlsf_realloc(m_tlsfHandle, original, size);
+		// allocate(0) fails, small blocks would never be freed on the span path
+		if (size == 0)
+		{
+			deallocate(original);
+			return nullptr;
+		}
+
+		if (SpanHeader* span = findSpan(*m_state, original))
+		{
+			void* mem = allocate(size);
+			if (mem)
+			{
+				memcpy(mem, original, std::min(size, SMALL_SIZE_CLASSES[span->sizeClass]));
+				deallocateSmall(*m_state, span, original);
+			}
+			return mem;
+		}
+
+		std::lock_guard<std::mutex> lock(m_state->mutex);
+		return poolReallocate(*m_state, original, size);
 	}
 
 	void HeapAllocator::deallocate(void* p, sizet n) const
 	{
-		tlsf_free(m_tlsfHandle, p);
+		if (!p)
+		{
+			return;
+		}
+		if (SpanHeader* span = findSpan(*m_state, p))
+		{
+			deallocateSmall(*m_state, span, p);
+			return;
+		}
+
+		std::lock_guard<std::mutex> lock(m_state->mutex);
+		recordFree(*m_state, tlsf_block_size(p));
+		poolFree(*m_state, p);
 	}
 
 	const char* HeapAllocator::get_name() const
@@ -140,12 +837,123 @@ namespace spite
 		m_name = name;
 	}
 
-	void HeapAllocator::init(sizet size)
+	u32 HeapAllocator::get_numa_node() const
 	{
-		m_memory = malloc(size);
+		return m_numaNode;
+	}
+
+	sizet HeapAllocator::get_reserved_size() const
+	{
+		return m_state->reservedBytes.load(std::memory_order_relaxed);
+	}
+
+	sizet HeapAllocator::get_max_size() const
+	{
+		return m_maxSize;
+	}
+
+	HugePageMode HeapAllocator::get_huge_page_mode() const
+	{
+		return m_state->hugePageMode.load(std::memory_order_relaxed);
+	}
+
+	HeapAllocatorStats HeapAllocator::get_stats(bool walkPools) const
+	{
+		const CounterTotals totals = sumCounters(*m_state);
+		HeapAllocatorStats stats{};
+		stats.liveBytes = totals.liveBytes;
+		stats.peakBytes = samplePeak(*m_state, totals.liveBytes);
+		stats.totalAllocations = totals.allocations;
+		stats.totalFrees = totals.frees;
+		stats.reservedBytes = get_reserved_size();
+
+		std::lock_guard<std::mutex> lock(m_state->mutex);
+		stats.frameAllocations = m_state->frameAllocations;
+		stats.frameFrees = m_state->frameFrees;
+		if (walkPools)
+		{
+			const u32 regionCount = m_state->regionCount.load(std::memory_order_relaxed);
+			for (u32 slot = 0; slot < regionCount; ++slot)
+			{
+				if (const HeapRegion* region = m_state->regions[slot].load(std::memory_order_relaxed))
+				{
+					tlsf_walk_pool(region->pool, freeSpaceWalker, &stats);
+				}
+			}
+			if (stats.freeBytes)
+			{
+				stats.fragmentation = 1.f - static_cast<float>(stats.largestFreeBlock) / static_cast<float>(stats.
+					freeBytes);
+			}
+		}
+		return stats;
+	}
+
+	void HeapAllocator::end_frame() const
+	{
+		const CounterTotals totals = sumCounters(*m_state);
+		samplePeak(*m_state, totals.liveBytes);
+
+		std::lock_guard<std::mutex> lock(m_state->mutex);
+		m_state->frameAllocations = totals.allocations - m_state->frameStartAllocations;
+		m_state->frameFrees = totals.frees - m_state->frameStartFrees;
+		m_state->frameStartAllocations = totals.allocations;
+		m_state->frameStartFrees = totals.frees;
+	}
+
+	void HeapAllocator::init(sizet size, sizet maxSize, bool hugePages)
+	{
+		if (hugePages)
+		{
+			size = alignToHugePage(size);
+			m_maxSize = std::max(m_maxSize, size);
+			maxSize = m_maxSize;
+		}
+
+		m_state = new(malloc(sizeof(HeapAllocatorState))) HeapAllocatorState();
+		m_state->numaNode = m_numaNode;
+		m_state->hugePages = hugePages;
+		m_state->regionSize = size;
+		m_state->maxSize = maxSize;
+
+		m_memory = mapRegionMemory(*m_state, size, true);
 		m_tlsfHandle = tlsf_create_with_pool(m_memory, size);
+		m_state->tlsfHandle = m_tlsfHandle;
+		publishRegion(*m_state, 0, createRegion(m_memory, size, tlsf_get_pool(m_tlsfHandle)));
 
-		SDEBUG_LOG("HeapAllocator %s of size %llu created\n", m_name, size)
+		if (maxSize > size)
+		{
+			SDEBUG_LOG("HeapAllocator %s of size %llu created, grows up to %llu\n", m_name, size, maxSize)
+		}
+		else
+		{
+			SDEBUG_LOG("HeapAllocator %s of size %llu created\n", m_name, size)
+		}
+		if (hugePages)
+		{
+			SDEBUG_LOG("HeapAllocator %s huge pages: %s\n", m_name, hugePageModeName(get_huge_page_mode()))
+		}
+	}
+
+	void HeapAllocator::releaseMemory() const
+	{
+		const u32 count = m_state->regionCount.load(std::memory_order_relaxed);
+		for (u32 slot = 0; slot < count; ++slot)
+		{
+			if (HeapRegion* region = m_state->regions[slot].load(std::memory_order_relaxed))
+			{
+				unmapRegionMemory(region->memory, region->size, m_numaNode);
+				destroyRegion(region);
+			}
+		}
+		while (HeapRegion* region = m_state->retiredRegions)
+		{
+			m_state->retiredRegions = region->nextRetired;
+			destroyRegion(region);
+		}
+
+		m_state->~HeapAllocatorState();
+		free(m_state);
 	}
 
 	void HeapAllocator::shutdown(bool forceDealloc) const
@@ -153,13 +961,21 @@ namespace spite
 		if (forceDealloc)
 		{
 			tlsf_destroy(m_tlsfHandle);
-			free(m_memory);
+			releaseMemory();
 			return;
 		}
 
-		MemoryStatistics stats{.allocatedBytes = 0, .totalBytes = m_maxSize, .allocationCount = 0};
-		pool_t pool = tlsf_get_pool(m_tlsfHandle);
-		tlsf_walk_pool(pool, exitWalker, &stats);
+		releaseCachedSpans(*m_state);
+
+		MemoryStatistics stats{.allocatedBytes = 0, .totalBytes = get_reserved_size(), .allocationCount = 0};
+		const u32 regionCount = m_state->regionCount.load(std::memory_order_relaxed);
+		for (u32 slot = 0; slot < regionCount; ++slot)
+		{
+			if (const HeapRegion* region = m_state->regions[slot].load(std::memory_order_relaxed))
+			{
+				tlsf_walk_pool(region->pool, exitWalker, &stats);
+			}
+		}
 
 		if (stats.allocatedBytes > 0)
 		{
@@ -181,7 +997,7 @@ namespace spite
 		SASSERTM(stats.allocatedBytes == 0, "Allocations still present\n")
 
 		tlsf_destroy(m_tlsfHandle);
-		free(m_memory);
+		releaseMemory();
 	}
 
 	bool HeapAllocator::operator==(const HeapAllocator& b) const
@@ -5,12 +5,38 @@
 
 #include "Base/Assert.hpp"
 #include "Base/Platform.hpp"
+#include "base/Numa.hpp"
 #include "base/memory/Memory.hpp"
+#include "base/memory/VirtualMemory.hpp"
 
 namespace spite
 {
+	// Shared by an allocator and its copies, defined in HeapAllocator.cpp
+	struct HeapAllocatorState;
+
+	struct HeapAllocatorStats
+	{
+		// Allocated and not yet freed, small blocks count their whole size class
+		sizet liveBytes;
+		// Highest liveBytes seen by end_frame and get_stats
+		sizet peakBytes;
+		u64 totalAllocations;
+		u64 totalFrees;
+		// Counts of the last frame closed by end_frame
+		u64 frameAllocations;
+		u64 frameFrees;
+		sizet reservedBytes;
+		// Free space of the tlsf pools, only filled when they were walked
+		sizet freeBytes;
+		sizet largestFreeBlock;
+		// 1 - largestFreeBlock / freeBytes, 0 when all free space is one block
+		float fragmentation;
+	};
+
 	//tlsf based heap allocator
 	//call shutdown to dispose!
+	//thread safe: small blocks come from per-thread caches, everything else locks the tlsf pool
+	//growable allocators add regions when the pool runs out and release them once they are empty again
 	class HeapAllocator
 	{
 	public:
@@ -20,7 +46,14 @@ namespace spite
 
 		~HeapAllocator() = default;
 
+		// Fixed pool of size bytes
 		HeapAllocator(cstring name = "HeapAllocator", sizet size = 32 * MB);
+		// Pool memory is placed on numaNode, ANY_NUMA_NODE behaves like the constructor above
+		HeapAllocator(cstring name, sizet size, u32 numaNode);
+		// Starts with a region of size bytes and grows by regions of at least size bytes
+		// until maxSize bytes are reserved. hugePages backs the regions with 2 MiB pages and
+		// rounds their sizes up to HUGE_PAGE_SIZE
+		HeapAllocator(cstring name, sizet size, sizet maxSize, u32 numaNode, bool hugePages = false);
 
 		//copied allocator manages the same memory pool
 		//create new allocator if otherwise desired
@@ -43,6 +76,23 @@ namespace spite
 		const char* get_name() const;
 		void set_name(cstring name);
 
+		// ANY_NUMA_NODE if the pool is not bound to a node
+		u32 get_numa_node() const;
+
+		// Bytes of all regions currently reserved from the OS
+		sizet get_reserved_size() const;
+		// Ceiling of get_reserved_size
+		sizet get_max_size() const;
+
+		// Weakest huge page backing among the regions added so far, eNone unless requested
+		HugePageMode get_huge_page_mode() const;
+
+		// Counters are cheap to read, walkPools also fills the free space figures by visiting
+		// every block under the pool lock, keep it out of per-frame paths
+		HeapAllocatorStats get_stats(bool walkPools = false) const;
+		// Closes the per-frame allocation counters and samples the peak, call once per frame
+		void end_frame() const;
+
 		/**
 		 * \brief disposes of allocations
 		 * \param forceDealloc if true, does not check if any allocations remain and silently deallocates anything 
@@ -53,12 +103,15 @@ namespace spite
 		bool operator!=(const HeapAllocator& b) const;
 
 	private:
-		void init(sizet size);
+		void init(sizet size, sizet maxSize, bool hugePages);
+		void releaseMemory() const;
 		cstring m_name;
 
 		void* m_tlsfHandle{};
 		void* m_memory{};
+		HeapAllocatorState* m_state{};
 		sizet m_maxSize;
+		u32 m_numaNode = ANY_NUMA_NODE;
 	};
 
 	void initGlobalAllocator();
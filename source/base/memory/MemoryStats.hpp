@@ -11,6 +11,7 @@ namespace spite
             sizet bytesUsed;
             sizet bytesTotal;
             sizet highWaterMark;
+            u32 overflowCount;
             float usagePercentage;
         };
         
@@ -21,6 +22,7 @@ namespace spite
             stats.bytesUsed = scratch.bytes_used();
             stats.bytesTotal = scratch.total_size();
             stats.highWaterMark = scratch.high_water_mark();
+            stats.overflowCount = scratch.overflow_count();
             stats.usagePercentage = static_cast<float>(stats.bytesUsed) / stats.bytesTotal * 100.0f;
             return stats;
         }
@@ -28,8 +30,9 @@ namespace spite
         static void printFrameScratchStats()
         {
             auto stats = getFrameScratchStats();
-            SDEBUG_LOG("Frame Scratch: %zu/%zu bytes (%.1f%%), HWM: %zu bytes\n",
-                   stats.bytesUsed, stats.bytesTotal, stats.usagePercentage, stats.highWaterMark);
+            SDEBUG_LOG("Frame Scratch: %zu/%zu bytes (%.1f%%), HWM: %zu bytes, overflows: %u\n",
+                   stats.bytesUsed, stats.bytesTotal, stats.usagePercentage, stats.highWaterMark,
+                   stats.overflowCount);
         }
     };
     
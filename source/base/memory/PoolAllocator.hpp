@@ -1,116 +1,312 @@
 #pragma once
-#include <bitset>
+#include <algorithm>
+#include <bit>
+#include <mutex>
+
+#include <EASTL/span.h>
 
 #include "HeapAllocator.hpp"
+#include "base/ThreadIndex.hpp"
 
 namespace spite
 {
+    enum class PoolConcurrency : u8
+    {
+        // No synchronization, the pool is used by one thread at a time
+        eSingleThread,
+        // Per-thread magazines in front of the shared free list, which is guarded by a mutex
+        eThreadMagazines
+    };
+
     // Pool-based allocator for same-sized objects
+    // Free slots form an intrusive list, so allocate and deallocate are O(1).
+    // Blocks are aligned to their size, the block of a slot is found by masking its address
+    // A block is the largest power of two that fits the header and at most BlockSize slots
     template<typename T, size_t BlockSize = 1024>
     class PoolAllocator
     {
     private:
-        struct Block
+        struct FreeSlot
+        {
+            FreeSlot* next;
+        };
+
+        struct BlockHeader
+        {
+            PoolAllocator* owner;
+            BlockHeader* next;
+        };
+
+        static constexpr size_t SLOT_ALIGNMENT = alignof(T) > alignof(FreeSlot) ? alignof(T) : alignof(FreeSlot);
+        static constexpr size_t SLOT_SIZE = ((sizeof(T) > sizeof(FreeSlot) ? sizeof(T) : sizeof(FreeSlot)) +
+            SLOT_ALIGNMENT - 1) & ~(SLOT_ALIGNMENT - 1);
+        static constexpr size_t HEADER_SIZE = (sizeof(BlockHeader) + SLOT_ALIGNMENT - 1) & ~(SLOT_ALIGNMENT - 1);
+        // Rounding down keeps the whole block in use, at least one slot always fits
+        static constexpr size_t BLOCK_BYTES = std::max(std::bit_floor(HEADER_SIZE + SLOT_SIZE * BlockSize),
+                                                       std::bit_ceil(HEADER_SIZE + SLOT_SIZE));
+        static constexpr size_t SLOTS_PER_BLOCK = (BLOCK_BYTES - HEADER_SIZE) / SLOT_SIZE;
+
+        // Refills take and flushes leave half of a magazine
+        static constexpr u32 MAGAZINE_CAPACITY = 64;
+
+        struct alignas(64) Magazine
         {
-            alignas(T) char data[sizeof(T) * BlockSize];
-            std::bitset<BlockSize> used;
-            Block* next = nullptr;
+            FreeSlot* slots[MAGAZINE_CAPACITY];
+            u32 count = 0;
         };
 
-        Block* m_currentBlock = nullptr;
-        static inline PoolAllocator* m_instance = nullptr;
+        HeapAllocator m_allocator;
+        BlockHeader* m_blocks = nullptr;
+        FreeSlot* m_freeList = nullptr;
+        // Slots of the newest block that were never handed out
+        std::byte* m_carveCursor = nullptr;
+        std::byte* m_carveEnd = nullptr;
+
+        // One per thread index, nullptr for PoolConcurrency::eSingleThread
+        Magazine* m_magazines = nullptr;
+        std::mutex m_mutex;
+
+        void allocate_new_block();
 
-        PoolAllocator();
+        FreeSlot* pop_slot();
+        void push_slot(void* ptr);
 
-        Block* allocate_new_block();
+        static BlockHeader* block_of(const void* ptr);
 
     public:
+        explicit PoolAllocator(const HeapAllocator& allocator = getGlobalAllocator(),
+                               PoolConcurrency concurrency = PoolConcurrency::eSingleThread);
+
+        PoolAllocator(const PoolAllocator&) = delete;
+        PoolAllocator& operator=(const PoolAllocator&) = delete;
+
+        // Single threaded pool backed by the global allocator
         static PoolAllocator& instance();
 
+        // Uninitialized storage for one T
         T* allocate();
+        // Fills out with uninitialized slots, takes the lock once for the whole batch
+        void allocate(eastl::span<T*> out);
 
         void deallocate(T* ptr);
+        void deallocate(eastl::span<T* const> ptrs);
+
+        bool owns(const T* ptr) const;
 
+        static constexpr size_t slots_per_block() { return SLOTS_PER_BLOCK; }
+        static constexpr size_t block_bytes() { return BLOCK_BYTES; }
+
+        // Releases every block, all slots must have been deallocated and no thread may use the pool meanwhile
         void cleanup();
 
         ~PoolAllocator();
     };
 
     template <typename T, size_t BlockSize>
-    PoolAllocator<T, BlockSize>::PoolAllocator() = default;
+    PoolAllocator<T, BlockSize>::PoolAllocator(const HeapAllocator& allocator, PoolConcurrency concurrency)
+        : m_allocator(allocator)
+    {
+        if (concurrency == PoolConcurrency::eThreadMagazines)
+        {
+            m_magazines = static_cast<Magazine*>(m_allocator.allocate(sizeof(Magazine) * MAX_THREAD_INDICES,
+                                                                      alignof(Magazine)));
+            for (u32 i = 0; i < MAX_THREAD_INDICES; ++i)
+            {
+                new (m_magazines + i) Magazine();
+            }
+        }
+    }
+
+    template <typename T, size_t BlockSize>
+    void PoolAllocator<T, BlockSize>::allocate_new_block()
+    {
+        auto* block = static_cast<BlockHeader*>(m_allocator.allocate(BLOCK_BYTES, BLOCK_BYTES));
+        SASSERTM(block, "PoolAllocator block allocation of %llu bytes failed\n", BLOCK_BYTES)
+        block->owner = this;
+        block->next = m_blocks;
+        m_blocks = block;
+
+        m_carveCursor = reinterpret_cast<std::byte*>(block) + HEADER_SIZE;
+        m_carveEnd = m_carveCursor + SLOT_SIZE * SLOTS_PER_BLOCK;
+    }
+
+    template <typename T, size_t BlockSize>
+    typename PoolAllocator<T, BlockSize>::FreeSlot* PoolAllocator<T, BlockSize>::pop_slot()
+    {
+        if (FreeSlot* slot = m_freeList)
+        {
+            m_freeList = slot->next;
+            return slot;
+        }
+
+        if (m_carveCursor == m_carveEnd)
+        {
+            allocate_new_block();
+        }
+        auto* slot = reinterpret_cast<FreeSlot*>(m_carveCursor);
+        m_carveCursor += SLOT_SIZE;
+        return slot;
+    }
+
+    template <typename T, size_t BlockSize>
+    void PoolAllocator<T, BlockSize>::push_slot(void* ptr)
+    {
+        auto* slot = static_cast<FreeSlot*>(ptr);
+        slot->next = m_freeList;
+        m_freeList = slot;
+    }
 
     template <typename T, size_t BlockSize>
-    typename PoolAllocator<T, BlockSize>::Block* PoolAllocator<T, BlockSize>::allocate_new_block()
+    typename PoolAllocator<T, BlockSize>::BlockHeader* PoolAllocator<T, BlockSize>::block_of(const void* ptr)
     {
-        Block* new_block = static_cast<Block*>(getGlobalAllocator().allocate(sizeof(Block), alignof(Block)));
-        new (new_block) Block();
-        new_block->next = m_currentBlock;
-        m_currentBlock = new_block;
-        return new_block;
+        return reinterpret_cast<BlockHeader*>(reinterpret_cast<uintptr_t>(ptr) & ~(BLOCK_BYTES - 1));
     }
 
     template <typename T, size_t BlockSize>
     PoolAllocator<T, BlockSize>& PoolAllocator<T, BlockSize>::instance()
     {
-        if (!m_instance) {
-            m_instance = static_cast<PoolAllocator*>(getGlobalAllocator().allocate(sizeof(PoolAllocator), alignof(PoolAllocator)));
-            new (m_instance) PoolAllocator();
-        }
-        return *m_instance;
+        // Blocks must be released with cleanup before the global allocator shuts down
+        static PoolAllocator instance;
+        return instance;
     }
 
     template <typename T, size_t BlockSize>
     T* PoolAllocator<T, BlockSize>::allocate()
     {
-        Block* block = m_currentBlock;
-        while (block) {
-            for (size_t i = 0; i < BlockSize; ++i) {
-                if (!block->used[i]) {
-                    block->used[i] = true;
-                    return reinterpret_cast<T*>(block->data + i * sizeof(T));
-                }
+        if (!m_magazines)
+        {
+            return reinterpret_cast<T*>(pop_slot());
+        }
+
+        Magazine& magazine = m_magazines[getThreadIndex()];
+        if (magazine.count == 0)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            while (magazine.count < MAGAZINE_CAPACITY / 2)
+            {
+                magazine.slots[magazine.count++] = pop_slot();
+            }
+        }
+        return reinterpret_cast<T*>(magazine.slots[--magazine.count]);
+    }
+
+    template <typename T, size_t BlockSize>
+    void PoolAllocator<T, BlockSize>::allocate(eastl::span<T*> out)
+    {
+        size_t filled = 0;
+        if (m_magazines)
+        {
+            Magazine& magazine = m_magazines[getThreadIndex()];
+            while (filled < out.size() && magazine.count > 0)
+            {
+                out[filled++] = reinterpret_cast<T*>(magazine.slots[--magazine.count]);
+            }
+            if (filled == out.size())
+            {
+                return;
             }
-            block = block->next;
         }
 
-        // No free slot found, allocate new block
-        block = allocate_new_block();
-        block->used[0] = true;
-        return reinterpret_cast<T*>(block->data);
+        std::unique_lock<std::mutex> lock(m_mutex, std::defer_lock);
+        if (m_magazines)
+        {
+            lock.lock();
+        }
+        for (; filled < out.size(); ++filled)
+        {
+            out[filled] = reinterpret_cast<T*>(pop_slot());
+        }
     }
 
     template <typename T, size_t BlockSize>
     void PoolAllocator<T, BlockSize>::deallocate(T* ptr)
     {
-        Block* block = m_currentBlock;
-        while (block) {
-            char* block_start = block->data;
-            char* block_end = block->data + sizeof(T) * BlockSize;
-            char* ptr_char = reinterpret_cast<char*>(ptr);
-
-            if (ptr_char >= block_start && ptr_char < block_end) {
-                size_t index = (ptr_char - block_start) / sizeof(T);
-                block->used[index] = false;
+        if (!ptr)
+        {
+            return;
+        }
+        SASSERTM(owns(ptr), "Pointer %p was not allocated from this PoolAllocator\n", ptr)
+
+        if (!m_magazines)
+        {
+            push_slot(ptr);
+            return;
+        }
+
+        Magazine& magazine = m_magazines[getThreadIndex()];
+        if (magazine.count == MAGAZINE_CAPACITY)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            while (magazine.count > MAGAZINE_CAPACITY / 2)
+            {
+                push_slot(magazine.slots[--magazine.count]);
+            }
+        }
+        magazine.slots[magazine.count++] = reinterpret_cast<FreeSlot*>(ptr);
+    }
+
+    template <typename T, size_t BlockSize>
+    void PoolAllocator<T, BlockSize>::deallocate(eastl::span<T* const> ptrs)
+    {
+        size_t released = 0;
+        if (m_magazines)
+        {
+            Magazine& magazine = m_magazines[getThreadIndex()];
+            while (released < ptrs.size() && magazine.count < MAGAZINE_CAPACITY)
+            {
+                SASSERTM(owns(ptrs[released]), "Pointer %p was not allocated from this PoolAllocator\n",
+                         ptrs[released])
+                magazine.slots[magazine.count++] = reinterpret_cast<FreeSlot*>(ptrs[released++]);
+            }
+            if (released == ptrs.size())
+            {
                 return;
             }
-            block = block->next;
         }
+
+        std::unique_lock<std::mutex> lock(m_mutex, std::defer_lock);
+        if (m_magazines)
+        {
+            lock.lock();
+        }
+        for (; released < ptrs.size(); ++released)
+        {
+            SASSERTM(owns(ptrs[released]), "Pointer %p was not allocated from this PoolAllocator\n", ptrs[released])
+            push_slot(ptrs[released]);
+        }
+    }
+
+    template <typename T, size_t BlockSize>
+    bool PoolAllocator<T, BlockSize>::owns(const T* ptr) const
+    {
+        // Only valid for pointers into blocks of some PoolAllocator of the same type
+        return block_of(ptr)->owner == this;
     }
 
     template <typename T, size_t BlockSize>
     void PoolAllocator<T, BlockSize>::cleanup()
     {
-        while (m_currentBlock) {
-            Block* next = m_currentBlock->next;
-            m_currentBlock->~Block();
-            getGlobalAllocator().deallocate(m_currentBlock);
-            m_currentBlock = next;
+        if (m_magazines)
+        {
+            for (u32 i = 0; i < MAX_THREAD_INDICES; ++i)
+            {
+                m_magazines[i].count = 0;
+            }
+        }
+
+        while (m_blocks) {
+            BlockHeader* next = m_blocks->next;
+            m_allocator.deallocate(m_blocks);
+            m_blocks = next;
         }
+        m_freeList = nullptr;
+        m_carveCursor = m_carveEnd = nullptr;
     }
 
     template <typename T, size_t BlockSize>
     PoolAllocator<T, BlockSize>::~PoolAllocator()
     {
         cleanup();
+        m_allocator.deallocate(m_magazines);
     }
 }
@@ -9,51 +9,115 @@
 
 namespace spite
 {
-	ScratchAllocator::ScratchAllocator(sizet bufferSize, const char* name): m_size(bufferSize),
-	                                                                        m_name(name)
+	namespace
 	{
-		m_buffer = static_cast<char*>(getGlobalAllocator().allocate(bufferSize));
+		// Share of the recent peak dropped on every reset, a spike decays below half in ~22 resets
+		constexpr sizet PEAK_DECAY_SHIFT = 5;
+		constexpr sizet BUFFER_GRANULARITY = 64 * KB;
+	}
 
+	ScratchAllocator::ScratchAllocator(sizet bufferSize, const char* name): ScratchAllocator(bufferSize, name, false)
+	{
+	}
+
+	ScratchAllocator::ScratchAllocator(sizet bufferSize, const char* name, bool hugePages): m_size(bufferSize),
+		m_name(name), m_ownsPages(hugePages), m_initialSize(bufferSize)
+	{
+		if (hugePages)
+		{
+			m_size = m_initialSize = alignToHugePage(bufferSize);
+		}
+		m_buffer = allocate_buffer(m_size);
+		if (hugePages)
+		{
+			SDEBUG_LOG("ScratchAllocator %s huge pages: %s\n", name, hugePageModeName(m_hugePageMode))
+		}
 
 		m_current = m_buffer;
-		m_end = m_buffer + bufferSize;
+		m_end = m_buffer + m_size;
 	}
 
 	ScratchAllocator::~ScratchAllocator()
 	{
-		if (m_buffer)
+		release_overflow_blocks(m_overflowBlocks);
+		release_buffer();
+	}
+
+	char* ScratchAllocator::allocate_buffer(sizet size)
+	{
+		if (m_ownsPages)
+		{
+			return static_cast<char*>(reserveHugePageMemory(size, m_hugePageMode));
+		}
+		return static_cast<char*>(getGlobalAllocator().allocate(size));
+	}
+
+	void ScratchAllocator::release_buffer() noexcept
+	{
+		if (!m_buffer)
+		{
+			return;
+		}
+		if (m_ownsPages)
+		{
+			releaseVirtualMemory(m_buffer, m_size);
+		}
+		else
 		{
 			getGlobalAllocator().deallocate(m_buffer, m_size);
 		}
 	}
 
+	void ScratchAllocator::release_overflow_blocks(OverflowBlock* block) noexcept
+	{
+		while (block)
+		{
+			OverflowBlock* next = block->next;
+			getGlobalAllocator().deallocate(block, sizeof(OverflowBlock) + block->size);
+			block = next;
+		}
+	}
+
 	ScratchAllocator::ScratchAllocator(ScratchAllocator&& other) noexcept:
 		m_buffer(other.m_buffer), m_current(other.m_current), m_end(other.m_end),
-		m_size(other.m_size), m_name(other.m_name), m_highWaterMark(other.m_highWaterMark)
+		m_size(other.m_size), m_name(other.m_name), m_ownsPages(other.m_ownsPages),
+		m_hugePageMode(other.m_hugePageMode), m_block(other.m_block), m_overflowBlocks(other.m_overflowBlocks),
+		m_initialSize(other.m_initialSize), m_framePeak(other.m_framePeak), m_recentPeak(other.m_recentPeak),
+		m_overflowCount(other.m_overflowCount), m_highWaterMark(other.m_highWaterMark)
 	{
 		other.m_buffer = nullptr;
 		other.m_current = nullptr;
 		other.m_end = nullptr;
+		other.m_block = nullptr;
+		other.m_overflowBlocks = nullptr;
 	}
 
 	ScratchAllocator& ScratchAllocator::operator=(ScratchAllocator&& other) noexcept
 	{
 		if (this != &other)
 		{
-			if (m_buffer)
-			{
-				getGlobalAllocator().deallocate(m_buffer, m_size);
-			}
+			release_overflow_blocks(m_overflowBlocks);
+			release_buffer();
 			m_buffer = other.m_buffer;
 			m_current = other.m_current;
 			m_end = other.m_end;
 			m_size = other.m_size;
 			m_name = other.m_name;
+			m_ownsPages = other.m_ownsPages;
+			m_hugePageMode = other.m_hugePageMode;
+			m_block = other.m_block;
+			m_overflowBlocks = other.m_overflowBlocks;
+			m_initialSize = other.m_initialSize;
+			m_framePeak = other.m_framePeak;
+			m_recentPeak = other.m_recentPeak;
+			m_overflowCount = other.m_overflowCount;
 			m_highWaterMark = other.m_highWaterMark;
 
 			other.m_buffer = nullptr;
 			other.m_current = nullptr;
 			other.m_end = nullptr;
+			other.m_block = nullptr;
+			other.m_overflowBlocks = nullptr;
 		}
 		return *this;
 	}
@@ -68,19 +132,52 @@ namespace spite
 		void* ptr = m_current;
 		size_t space = m_end - m_current;
 
-		if (std::align(alignment, size, ptr, space))
+		if (!std::align(alignment, size, ptr, space))
 		{
-			m_current = static_cast<char*>(ptr) + size;
+			ptr = allocate_overflow(size, alignment);
+		}
+		m_current = static_cast<char*>(ptr) + size;
 
-			// Update high water mark
-			size_t used = m_current - m_buffer;
-			m_highWaterMark = std::max(used, m_highWaterMark);
+		// Update high water mark
+		const sizet used = bytes_used();
+		m_framePeak = std::max(used, m_framePeak);
+		m_highWaterMark = std::max(used, m_highWaterMark);
 
-			return ptr;
+		return ptr;
+	}
+
+	void* ScratchAllocator::allocate_overflow(sizet size, sizet alignment)
+	{
+		const sizet needed = size + alignment;
+		OverflowBlock*& link = m_block ? m_block->next : m_overflowBlocks;
+		// Blocks left behind by a marker rewind are reused if they are large enough
+		if (link && link->size < needed)
+		{
+			release_overflow_blocks(link);
+			link = nullptr;
+		}
+		if (!link)
+		{
+			const sizet blockSize = std::max(needed, m_size);
+			link = static_cast<OverflowBlock*>(getGlobalAllocator().allocate(
+				sizeof(OverflowBlock) + blockSize, alignof(OverflowBlock)));
+			SASSERTM(link, "Scratch alloc %s out of memory\n", get_name())
+			link->next = nullptr;
+			link->size = blockSize;
+			++m_overflowCount;
+			SDEBUG_LOG("ScratchAllocator %s overflowed at %llu bytes, chained a block of %llu bytes\n", get_name(),
+			           bytes_used(), blockSize)
 		}
 
-		SASSERTM(false, "Scratch alloc %s out of memory\n", get_name())
-		return nullptr;
+		OverflowBlock* block = link;
+		block->startOffset = bytes_used();
+		m_block = block;
+		m_current = block->data();
+		m_end = m_current + block->size;
+
+		void* ptr = m_current;
+		size_t space = block->size;
+		return std::align(alignment, size, ptr, space);
 	}
 
 	void ScratchAllocator::deallocate(void*, size_t) noexcept
@@ -90,19 +187,51 @@ namespace spite
 
 	void ScratchAllocator::reset() noexcept
 	{
+		const sizet decayed = m_recentPeak - (m_recentPeak >> PEAK_DECAY_SHIFT);
+		m_recentPeak = std::max(m_framePeak, decayed);
+		m_framePeak = 0;
+
+		// Grow to hold a whole frame after an overflow, shrink once the spike has decayed
+		sizet newSize = m_size;
+		if (m_overflowBlocks)
+		{
+			newSize = std::max(m_size, m_recentPeak);
+			release_overflow_blocks(m_overflowBlocks);
+			m_overflowBlocks = nullptr;
+		}
+		else if (m_size > m_initialSize && m_recentPeak < m_size / 2)
+		{
+			newSize = std::max(m_initialSize, m_recentPeak);
+		}
+
+		if (newSize != m_size)
+		{
+			newSize = m_ownsPages
+				          ? alignToHugePage(newSize)
+				          : (newSize + BUFFER_GRANULARITY - 1) & ~(BUFFER_GRANULARITY - 1);
+			if (char* buffer = allocate_buffer(newSize))
+			{
+				release_buffer();
+				m_buffer = buffer;
+				m_size = newSize;
+			}
+		}
+
+		m_block = nullptr;
 		m_current = m_buffer;
+		m_end = m_buffer + m_size;
 	}
 
 	ScratchAllocator::ScopedMarker::~ScopedMarker()
 	{
 		if (m_allocator)
 		{
-			m_allocator->reset_to(m_position);
+			m_allocator->reset_to(m_block, m_position);
 		}
 	}
 
 	ScratchAllocator::ScopedMarker::ScopedMarker(ScopedMarker&& other) noexcept: m_allocator(other.m_allocator),
-		m_position(other.m_position)
+		m_block(other.m_block), m_position(other.m_position)
 	{
 		other.m_allocator = nullptr; // Prevent double-reset
 	}
@@ -114,34 +243,44 @@ namespace spite
 		{
 			if (m_allocator)
 			{
-				m_allocator->reset_to(m_position);
+				m_allocator->reset_to(m_block, m_position);
 			}
 			m_allocator = other.m_allocator;
+			m_block = other.m_block;
 			m_position = other.m_position;
 			other.m_allocator = nullptr;
 		}
 		return *this;
 	}
 
-	ScratchAllocator::ScopedMarker::ScopedMarker(ScratchAllocator* allocator, char* position): m_allocator(allocator),
-		m_position(position)
+	ScratchAllocator::ScopedMarker::ScopedMarker(ScratchAllocator* allocator, OverflowBlock* block, char* position):
+		m_allocator(allocator), m_block(block), m_position(position)
 	{
 	}
 
 	ScratchAllocator::ScopedMarker ScratchAllocator::get_scoped_marker()
 	{
-		return ScopedMarker(this, m_current);
+		return ScopedMarker(this, m_block, m_current);
 	}
 
-	void ScratchAllocator::reset_to(char* position)
+	void ScratchAllocator::reset_to(OverflowBlock* block, char* position)
 	{
-		SASSERTM(position >= m_buffer && position < m_end,
+		// Blocks past the marker stay chained for reuse
+		char* begin = block ? block->data() : m_buffer;
+		char* end = block ? begin + block->size : m_buffer + m_size;
+		SASSERTM(position >= begin && position <= end,
 		         "Position is out of bounds of scratch allocator")
+		m_block = block;
 		m_current = position;
+		m_end = end;
 	}
 
 	sizet ScratchAllocator::bytes_used() const noexcept
 	{
+		if (m_block)
+		{
+			return m_block->startOffset + (m_current - m_block->data());
+		}
 		return m_current - m_buffer;
 	}
 
@@ -152,7 +291,12 @@ namespace spite
 
 	sizet ScratchAllocator::total_size() const noexcept
 	{
-		return m_size;
+		sizet size = m_size;
+		for (const OverflowBlock* block = m_overflowBlocks; block; block = block->next)
+		{
+			size += block->size;
+		}
+		return size;
 	}
 
 	sizet ScratchAllocator::high_water_mark() const noexcept
@@ -160,6 +304,16 @@ namespace spite
 		return m_highWaterMark;
 	}
 
+	u32 ScratchAllocator::overflow_count() const noexcept
+	{
+		return m_overflowCount;
+	}
+
+	HugePageMode ScratchAllocator::huge_page_mode() const noexcept
+	{
+		return m_hugePageMode;
+	}
+
 	void ScratchAllocator::print_stats() const noexcept
 	{
 		SDEBUG_LOG("Stats for ScratchAllocator %s\n", get_name())
@@ -167,6 +321,7 @@ namespace spite
 		SDEBUG_LOG("MB remaining %llu \n", bytes_remaining() / MB)
 		SDEBUG_LOG("Total size %llu \n", total_size() / MB)
 		SDEBUG_LOG("High water mark %llu\n", high_water_mark() / MB)
+		SDEBUG_LOG("Overflows %u\n", overflow_count())
 	}
 
 	const char* ScratchAllocator::get_name() const noexcept
@@ -176,16 +331,30 @@ namespace spite
 
 	bool ScratchAllocator::owns(const void* ptr) const noexcept
 	{
-		return ptr >= m_buffer && ptr < m_end;
+		if (ptr >= m_buffer && ptr < m_buffer + m_size)
+		{
+			return true;
+		}
+		for (OverflowBlock* block = m_overflowBlocks; block; block = block->next)
+		{
+			if (ptr >= block->data() && ptr < block->data() + block->size)
+			{
+				return true;
+			}
+		}
+		return false;
 	}
 
 	thread_local ScratchAllocator* FrameScratchAllocator::m_frameAllocator = nullptr;
+	thread_local ScratchAllocator* FrameScratchAllocator::m_threadOverride = nullptr;
+	bool FrameScratchAllocator::m_hugePages = false;
 	void* FrameScratchAllocator::m_allAllocators = nullptr;
 	std::mutex FrameScratchAllocator::m_registryMutex;
 
-	void FrameScratchAllocator::init()
+	void FrameScratchAllocator::init(bool hugePages)
 	{
 		SASSERTM(!m_allAllocators, "FrameScratchAllocators were already initialized\n")
+		m_hugePages = hugePages;
 		m_allAllocators = getGlobalAllocator().new_object<heap_vector<ScratchAllocator*>>(
 			makeHeapVector<ScratchAllocator*>(getGlobalAllocator()));
 	}
@@ -209,10 +378,14 @@ namespace spite
 
 	ScratchAllocator& FrameScratchAllocator::get()
 	{
+		if (m_threadOverride)
+		{
+			return *m_threadOverride;
+		}
 		if (!m_frameAllocator)
 		{
 			m_frameAllocator = getGlobalAllocator().new_object<ScratchAllocator>(
-				ScratchAllocator(DEFAULT_FRAME_SIZE, "FrameScratchThreadAllocator"));
+				ScratchAllocator(DEFAULT_FRAME_SIZE, "FrameScratchThreadAllocator", m_hugePages));
 
 			// Register the new allocator in the central list for later cleanup
 			std::lock_guard<std::mutex> lock(m_registryMutex);
@@ -231,4 +404,14 @@ namespace spite
 			allocator->reset();
 		}
 	}
+
+	FrameScratchAllocator::ScopedOverride::ScopedOverride(ScratchAllocator& allocator) : m_previous(m_threadOverride)
+	{
+		m_threadOverride = &allocator;
+	}
+
+	FrameScratchAllocator::ScopedOverride::~ScopedOverride()
+	{
+		m_threadOverride = m_previous;
+	}
 }
@@ -7,6 +7,7 @@
 #include "Base/Assert.hpp"
 #include "base/memory/HeapAllocator.hpp"
 #include "base/memory/Memory.hpp"
+#include "base/memory/VirtualMemory.hpp"
 
 namespace spite
 {
@@ -14,20 +15,48 @@ namespace spite
 	// Perfect for frame-based allocations, string building, temporary containers
 	// Very fast allocation (just pointer bump), bulk deallocation (reset)
 	// Has a backing allocator type : Global or Frame (used for allocating internal buffer)
+	// Running past the buffer chains overflow blocks from the global allocator. On reset the buffer is resized to
+	// the recent peak: it grows after an overflow and shrinks back towards the initial size once spikes decay
 	class ScratchAllocator
 	{
 	private:
+		// Chained behind the buffer in allocation order, kept for reuse until the next reset
+		struct alignas(16) OverflowBlock
+		{
+			OverflowBlock* next;
+			sizet size;
+			// Logical offset of the block's first byte, bytes_used of the buffer and earlier blocks
+			sizet startOffset;
+
+			char* data() { return reinterpret_cast<char*>(this + 1); }
+		};
+
+		// Primary buffer
 		char* m_buffer;
 		char* m_current;
 		char* m_end;
 		sizet m_size;
 		cstring m_name;
+		// Buffer was reserved from the OS instead of the global allocator
+		bool m_ownsPages = false;
+		HugePageMode m_hugePageMode = HugePageMode::eNone;
+
+		// Block m_current points into, nullptr while in the primary buffer
+		OverflowBlock* m_block = nullptr;
+		OverflowBlock* m_overflowBlocks = nullptr;
+		sizet m_initialSize;
+		// Peak usage since the last reset and a decaying peak over recent resets
+		sizet m_framePeak = 0;
+		sizet m_recentPeak = 0;
+		u32 m_overflowCount = 0;
 
 		// Track high water mark for debugging
 		mutable sizet m_highWaterMark = 0;
 
 	public:
 		explicit ScratchAllocator(sizet bufferSize, const char* name = "ScratchAllocator");
+		// Buffer is backed by 2 MiB pages, bufferSize is rounded up to HUGE_PAGE_SIZE
+		ScratchAllocator(sizet bufferSize, const char* name, bool hugePages);
 
 		~ScratchAllocator();
 
@@ -54,7 +83,8 @@ namespace spite
 		// Individual deallocation is a no-op (linear allocator characteristic)
 		void deallocate(void* /*ptr*/, size_t /*size*/) noexcept;
 
-		// Reset to beginning - very fast bulk deallocation
+		// Reset to beginning - very fast bulk deallocation.
+		// Frees overflow blocks and resizes the buffer if the recent peak calls for it
 		void reset() noexcept;
 
 		// RAII helper for managing temporary allocations.
@@ -64,6 +94,7 @@ namespace spite
 		{
 		private:
 			ScratchAllocator* m_allocator;
+			OverflowBlock* m_block;
 			char* m_position;
 
 		public:
@@ -79,7 +110,7 @@ namespace spite
 		private:
 			friend class ScratchAllocator;
 
-			ScopedMarker(ScratchAllocator* allocator, char* position);
+			ScopedMarker(ScratchAllocator* allocator, OverflowBlock* block, char* position);
 		};
 
 		// Returns a ScopedMarker that will reset the allocator to the current
@@ -91,14 +122,23 @@ namespace spite
 		// } // Allocator is automatically reset to the marker's position here.
 		ScopedMarker get_scoped_marker();
 
+		// Includes the overflow blocks
 		sizet bytes_used() const noexcept;
 
+		// Left in the current block before the next overflow
 		sizet bytes_remaining() const noexcept;
 
+		// Buffer and overflow blocks
 		sizet total_size() const noexcept;
 
 		sizet high_water_mark() const noexcept;
 
+		// Times an overflow block had to be chained
+		u32 overflow_count() const noexcept;
+
+		// eNone unless huge pages were requested and obtained
+		HugePageMode huge_page_mode() const noexcept;
+
 		void print_stats() const noexcept;
 
 		const char* get_name() const noexcept;
@@ -107,7 +147,11 @@ namespace spite
 		bool owns(const void* ptr) const noexcept;
 
 	private:
-		void reset_to(char* position) ;
+		void reset_to(OverflowBlock* block, char* position);
+		void* allocate_overflow(sizet size, sizet alignment);
+		char* allocate_buffer(sizet size);
+		void release_buffer() noexcept;
+		void release_overflow_blocks(OverflowBlock* block) noexcept;
 	};
 
 	// EASTL-compatible wrapper for ScratchAllocator
@@ -166,20 +210,44 @@ namespace spite
 	class FrameScratchAllocator
 	{
 	private:
-		static constexpr sizet DEFAULT_FRAME_SIZE = 32 * MB; // 32MB per frame
+		// Grows on demand, see ScratchAllocator::reset
+		static constexpr sizet DEFAULT_FRAME_SIZE = 8 * MB;
 		static thread_local ScratchAllocator* m_frameAllocator;
+		// Set by ScopedOverride, takes precedence over m_frameAllocator
+		static thread_local ScratchAllocator* m_threadOverride;
+		static bool m_hugePages;
 
 		// Central registry for all created thread-local allocators
 		static void* m_allAllocators;
 		static std::mutex m_registryMutex;
 
 	public:
-		static void init();
+		// hugePages backs every thread's frame buffer with 2 MiB pages
+		static void init(bool hugePages = false);
 		static void shutdown();
 
 		static ScratchAllocator& get();
 
+		// Resets the frame allocators of all threads, overrides are left alone
 		static void resetFrame();
+
+		// Routes get() on the calling thread to allocator while alive. Threads whose work spans frames
+		// (loaders) use one, so resetFrame on the main thread cannot reset scratch they still use
+		class ScopedOverride
+		{
+		private:
+			ScratchAllocator* m_previous;
+
+		public:
+			explicit ScopedOverride(ScratchAllocator& allocator);
+			~ScopedOverride();
+
+			ScopedOverride(const ScopedOverride&) = delete;
+			ScopedOverride& operator=(const ScopedOverride&) = delete;
+
+			// Override restored on destruction, nullptr for the thread's frame allocator
+			ScratchAllocator* previous() const { return m_previous; }
+		};
 	};
 
 	template <typename T, typename ... Args>
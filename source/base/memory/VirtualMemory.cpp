@@ -0,0 +1,119 @@
+#include "VirtualMemory.hpp"
+
+#include <cstddef>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#include <Windows.h>
+#else
+#include <sys/mman.h>
+#endif
+
+#include "Base/Assert.hpp"
+#include "base/Logging.hpp"
+
+namespace spite
+{
+	cstring hugePageModeName(HugePageMode mode)
+	{
+		switch (mode)
+		{
+		case HugePageMode::eTransparent:
+			return "transparent";
+		case HugePageMode::eExplicit:
+			return "explicit";
+		default:
+			return "none";
+		}
+	}
+
+	void* reserveVirtualMemory(sizet size)
+	{
+#if defined(_WIN32)
+		void* memory = VirtualAlloc(nullptr, size, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+#else
+		void* memory = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+		if (memory == MAP_FAILED)
+		{
+			memory = nullptr;
+		}
+#endif
+		if (!memory)
+		{
+			SDEBUG_LOG("WARNING: failed to reserve %llu bytes of virtual memory\n", size)
+		}
+		return memory;
+	}
+
+	void* reserveHugePageMemory(sizet size, HugePageMode& mode)
+	{
+		SASSERTM(size % HUGE_PAGE_SIZE == 0, "Huge page regions must be a multiple of HUGE_PAGE_SIZE\n")
+#if defined(_WIN32)
+		// Needs the "Lock pages in memory" privilege, commits the whole region up front
+		const sizet largePage = GetLargePageMinimum();
+		if (largePage != 0 && size % largePage == 0)
+		{
+			if (void* memory = VirtualAlloc(nullptr, size, MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES,
+			                                PAGE_READWRITE))
+			{
+				mode = HugePageMode::eExplicit;
+				return memory;
+			}
+		}
+		mode = HugePageMode::eNone;
+		return reserveVirtualMemory(size);
+#else
+#if defined(MAP_HUGETLB)
+		void* memory = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+		if (memory != MAP_FAILED)
+		{
+			mode = HugePageMode::eExplicit;
+			return memory;
+		}
+#endif
+		// No reserved huge pages, over-map and trim to get an aligned range the kernel can promote
+		auto* mapping = static_cast<std::byte*>(reserveVirtualMemory(size + HUGE_PAGE_SIZE));
+		if (!mapping)
+		{
+			mode = HugePageMode::eNone;
+			return nullptr;
+		}
+		const sizet head = (HUGE_PAGE_SIZE - reinterpret_cast<uintptr_t>(mapping) % HUGE_PAGE_SIZE) % HUGE_PAGE_SIZE;
+		if (head)
+		{
+			munmap(mapping, head);
+		}
+		munmap(mapping + head + size, HUGE_PAGE_SIZE - head);
+
+		std::byte* aligned = mapping + head;
+		mode = adviseHugePages(aligned, size);
+		return aligned;
+#endif
+	}
+
+	HugePageMode adviseHugePages(void* memory, sizet size)
+	{
+#if defined(MADV_HUGEPAGE)
+		const uintptr_t begin = (reinterpret_cast<uintptr_t>(memory) + HUGE_PAGE_SIZE - 1) & ~(HUGE_PAGE_SIZE - 1);
+		const uintptr_t end = (reinterpret_cast<uintptr_t>(memory) + size) & ~(HUGE_PAGE_SIZE - 1);
+		if (begin < end && madvise(reinterpret_cast<void*>(begin), end - begin, MADV_HUGEPAGE) == 0)
+		{
+			return HugePageMode::eTransparent;
+		}
+#endif
+		return HugePageMode::eNone;
+	}
+
+	void releaseVirtualMemory(void* memory, sizet size)
+	{
+		if (!memory)
+		{
+			return;
+		}
+#if defined(_WIN32)
+		VirtualFree(memory, 0, MEM_RELEASE);
+#else
+		munmap(memory, size);
+#endif
+	}
+}
@@ -0,0 +1,39 @@
+#pragma once
+#include "base/memory/Memory.hpp"
+
+namespace spite
+{
+	constexpr sizet HUGE_PAGE_SIZE = 2 * MB;
+
+	// What backs a huge page request
+	enum class HugePageMode : u8
+	{
+		// Regular pages
+		eNone,
+		// Transparent huge pages were requested, the kernel promotes 2 MiB ranges when it can
+		eTransparent,
+		// Explicitly mapped huge pages (MAP_HUGETLB, MEM_LARGE_PAGES)
+		eExplicit
+	};
+
+	cstring hugePageModeName(HugePageMode mode);
+
+	constexpr sizet alignToHugePage(sizet size)
+	{
+		return (size + HUGE_PAGE_SIZE - 1) & ~(HUGE_PAGE_SIZE - 1);
+	}
+
+	// Page aligned region straight from the OS, pages are committed on first touch.
+	// nullptr if the address space could not be reserved
+	void* reserveVirtualMemory(sizet size);
+
+	// Tries explicit huge pages first, then a HUGE_PAGE_SIZE aligned region advised for transparent huge pages.
+	// size must be a multiple of HUGE_PAGE_SIZE, mode reports what was obtained
+	void* reserveHugePageMemory(sizet size, HugePageMode& mode);
+
+	// Requests transparent huge pages for the HUGE_PAGE_SIZE aligned part of memory mapped elsewhere
+	HugePageMode adviseHugePages(void* memory, sizet size);
+
+	// size must match the reserved size
+	void releaseVirtualMemory(void* memory, sizet size);
+}
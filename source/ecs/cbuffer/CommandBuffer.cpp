@@ -1,50 +1,240 @@
 #include "CommandBuffer.hpp"
 #include "ecs/core/EntityManager.hpp"
 #include "base/Collections.hpp"
+#include "base/RadixSort.hpp"
 #include <algorithm>
 
 namespace spite
 {
+	namespace
+	{
+		thread_local u32 g_recordingOrder = 0;
+	}
+
+	CommandBuffer::RecordingOrderScope::RecordingOrderScope(u32 order) : m_previous(g_recordingOrder)
+	{
+		g_recordingOrder = order;
+	}
+
+	CommandBuffer::RecordingOrderScope::~RecordingOrderScope()
+	{
+		g_recordingOrder = m_previous;
+	}
+
+	u32 CommandBuffer::getRecordingOrder()
+	{
+		return g_recordingOrder;
+	}
+
 	CommandBuffer::CommandBuffer(ArchetypeManager* archetypeManager, const HeapAllocator& allocator)
 		: m_archetypeManager(archetypeManager),
-		  m_commandBuffer(makeHeapVector<std::byte>(allocator)), m_nextProxyId(0)
+		  m_allocator(allocator),
+		  m_state(m_allocator.new_object<RecordingState>())
+	{
+	}
+
+	CommandBuffer::~CommandBuffer()
 	{
+		destroyState();
 	}
 
 	CommandBuffer::CommandBuffer(CommandBuffer&& other) noexcept
 		: m_archetypeManager(other.m_archetypeManager),
-		  m_commandBuffer(std::move(other.m_commandBuffer)),
-		  m_nextProxyId(other.m_nextProxyId)
+		  m_allocator(other.m_allocator),
+		  m_state(other.m_state)
 	{
-		other.m_nextProxyId = 0;
+		other.m_state = nullptr;
 	}
 
 	CommandBuffer& CommandBuffer::operator=(CommandBuffer&& other) noexcept
 	{
 		if (this != &other)
 		{
+			destroyState();
 			m_archetypeManager = other.m_archetypeManager;
-			m_commandBuffer = std::move(other.m_commandBuffer);
-			m_nextProxyId = other.m_nextProxyId;
-			other.m_nextProxyId = 0;
+			m_allocator = other.m_allocator;
+			m_state = other.m_state;
+			other.m_state = nullptr;
 		}
 		return *this;
 	}
 
-	void* CommandBuffer::writeCommand(CommandType type, u16 size)
+	void CommandBuffer::destroyState()
 	{
-		std::lock_guard<std::mutex> lock(m_bufferMutex);
-		const auto offset = m_commandBuffer.size();
-		m_commandBuffer.resize(offset + size);
-		auto header = reinterpret_cast<CommandHeader*>(m_commandBuffer.data() + offset);
+		if (!m_state)
+		{
+			return;
+		}
+
+		releasePages();
+
+		CommandPage* page = m_state->freePages;
+		while (page)
+		{
+			CommandPage* next = page->next;
+			m_allocator.deallocate(page, sizeof(CommandPage) + page->capacity);
+			page = next;
+		}
+
+		m_allocator.delete_object(m_state);
+		m_state = nullptr;
+	}
+
+	CommandBuffer::CommandPage* CommandBuffer::acquirePage(sizet minCapacity)
+	{
+		constexpr sizet defaultCapacity = PAGE_SIZE - sizeof(CommandPage);
+
+		CommandPage* page = nullptr;
+		if (minCapacity <= defaultCapacity)
+		{
+			{
+				std::lock_guard<std::mutex> lock(m_state->pagePoolMutex);
+				page = m_state->freePages;
+				if (page)
+				{
+					m_state->freePages = page->next;
+				}
+			}
+
+			if (!page)
+			{
+				page = static_cast<CommandPage*>(m_allocator.allocate(PAGE_SIZE, alignof(CommandPage)));
+				page->capacity = static_cast<u32>(defaultCapacity);
+			}
+		}
+		else
+		{
+			// Oversized pages hold a single command and are not pooled
+			page = static_cast<CommandPage*>(m_allocator.allocate(sizeof(CommandPage) + minCapacity,
+			                                                      alignof(CommandPage)));
+			page->capacity = static_cast<u32>(minCapacity);
+		}
+
+		page->next = nullptr;
+		page->used = 0;
+		return page;
+	}
+
+	void CommandBuffer::releaseChain(CommandPage* page)
+	{
+		constexpr sizet defaultCapacity = PAGE_SIZE - sizeof(CommandPage);
+
+		while (page)
+		{
+			CommandPage* next = page->next;
+			if (page->capacity == defaultCapacity)
+			{
+				page->next = m_state->freePages;
+				m_state->freePages = page;
+			}
+			else
+			{
+				m_allocator.deallocate(page, sizeof(CommandPage) + page->capacity);
+			}
+			page = next;
+		}
+	}
+
+	void CommandBuffer::releasePages()
+	{
+		for (auto& recorder : m_state->recorders)
+		{
+			releaseChain(recorder.head);
+			releaseChain(recorder.payloadHead);
+			recorder = ThreadRecorder{};
+		}
+		m_state->proxyIdsReserved.store(0, std::memory_order_relaxed);
+	}
+
+	void* CommandBuffer::writeCommand(CommandType type, sizet size)
+	{
+		ThreadRecorder& recorder = m_state->recorders[getThreadIndex()];
+		if (recorder.chainOrder != g_recordingOrder)
+		{
+			auto marker = static_cast<RecordingOrderCmd*>(appendCommand(recorder, CommandType::eRecordingOrder,
+			                                                            sizeof(RecordingOrderCmd)));
+			marker->order = g_recordingOrder;
+			recorder.chainOrder = g_recordingOrder;
+		}
+		return appendCommand(recorder, type, size);
+	}
+
+	void* CommandBuffer::appendCommand(ThreadRecorder& recorder, CommandType type, sizet size)
+	{
+		const sizet alignedSize = (size + COMMAND_ALIGNMENT - 1) & ~(COMMAND_ALIGNMENT - 1);
+		SASSERTM(alignedSize <= U16_MAX, "Command of %llu bytes exceeds the command size limit", alignedSize)
+
+		CommandPage* page = recorder.tail;
+		if (!page || page->capacity - page->used < alignedSize)
+		{
+			CommandPage* newPage = acquirePage(alignedSize);
+			if (page)
+			{
+				page->next = newPage;
+			}
+			else
+			{
+				recorder.head = newPage;
+			}
+			recorder.tail = newPage;
+			page = newPage;
+		}
+
+		auto header = reinterpret_cast<CommandHeader*>(page->data() + page->used);
+		page->used += static_cast<u32>(alignedSize);
 		header->type = type;
-		header->size = size;
+		header->flags = 0;
+		header->size = static_cast<u16>(alignedSize);
 		return header;
 	}
 
+	void* CommandBuffer::allocatePayload(sizet size, sizet alignment, PayloadRef& outRef)
+	{
+		ThreadRecorder& recorder = m_state->recorders[getThreadIndex()];
+
+		// Offset inside the page data, aligned by address so any alignment works with any page
+		auto alignedOffset = [alignment](const CommandPage* page)
+		{
+			const uintptr_t start = reinterpret_cast<uintptr_t>(page->data());
+			const uintptr_t aligned = (start + page->used + alignment - 1) & ~(static_cast<uintptr_t>(alignment) - 1);
+			return static_cast<sizet>(aligned - start);
+		};
+
+		CommandPage* page = recorder.payloadTail;
+		if (!page || alignedOffset(page) + size > page->capacity)
+		{
+			CommandPage* newPage = acquirePage(size + alignment - 1);
+			if (page)
+			{
+				page->next = newPage;
+			}
+			else
+			{
+				recorder.payloadHead = newPage;
+			}
+			recorder.payloadTail = newPage;
+			++recorder.payloadPageCount;
+			page = newPage;
+		}
+
+		const sizet offset = alignedOffset(page);
+		page->used = static_cast<u32>(offset + size);
+
+		outRef.pageIndex = recorder.payloadPageCount - 1;
+		outRef.offset = static_cast<u32>(offset);
+		return page->data() + offset;
+	}
+
 	Entity CommandBuffer::createEntity()
 	{
-		const u32 proxyId = m_nextProxyId++;
+		ThreadRecorder& recorder = m_state->recorders[getThreadIndex()];
+		if (recorder.nextProxyId == recorder.proxyBlockEnd)
+		{
+			recorder.nextProxyId = m_state->proxyIdsReserved.fetch_add(PROXY_BLOCK_SIZE, std::memory_order_relaxed);
+			recorder.proxyBlockEnd = recorder.nextProxyId + PROXY_BLOCK_SIZE;
+		}
+
+		const u32 proxyId = recorder.nextProxyId++;
 		auto cmd = static_cast<CreateEntityCmd*>(writeCommand(CommandType::eCreateEntity, sizeof(CreateEntityCmd)));
 		cmd->proxyId = proxyId;
 		return Entity{proxyId, Entity::PROXY_GENERATION};
@@ -56,14 +246,34 @@ namespace spite
 		cmd->entity = entity;
 	}
 
+	void CommandBuffer::recordToggle(CommandType type, Entity entity, ComponentID componentId)
+	{
+		auto cmd = static_cast<ToggleComponentCmd*>(writeCommand(type, sizeof(ToggleComponentCmd)));
+		cmd->entity = entity;
+		cmd->componentId = componentId;
+	}
+
+	bool CommandBuffer::isEmpty() const
+	{
+		for (const auto& recorder : m_state->recorders)
+		{
+			if (recorder.head && recorder.head->used > 0)
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
 	void CommandBuffer::commit(EntityManager& entityManager)
 	{
-		if (m_commandBuffer.empty())
+		if (isEmpty())
 		{
 			return;
 		}
 
-		auto marker = FrameScratchAllocator::get().get_scoped_marker();
+		ScratchAllocator& scratch = FrameScratchAllocator::get();
+		auto marker = scratch.get_scoped_marker();
 
 		// --- Pass 1: Decode and Sort ---
 		struct DecodedCommand
@@ -72,17 +282,34 @@ namespace spite
 			CommandType type;
 			ComponentID componentId; // Only for Add/Remove
 			void* componentData; // Only for Add
+			u32 order;
+			u32 recorder;
 		};
 
-		auto decodedCmds = makeScratchVector<DecodedCommand>(FrameScratchAllocator::get());
-		decodedCmds.reserve(m_commandBuffer.size() / sizeof(CommandHeader)); // Approximate reservation
+		auto decodedCmds = makeScratchVector<DecodedCommand>(scratch);
+		// In-place commands skip the sort and the archetype resolution entirely
+		auto inPlaceCmds = makeScratchVector<DecodedCommand>(scratch);
+
+		// Payload pages of the recorder being decoded, indexed by PayloadRef::pageIndex
+		auto payloadPages = makeScratchVector<CommandPage*>(scratch);
+
+		auto payloadData = [&payloadPages](const CommandHeader* header, const void* payloadField) -> void*
+		{
+			if (header->flags & PAYLOAD_OUT_OF_LINE)
+			{
+				const auto* ref = static_cast<const PayloadRef*>(payloadField);
+				return payloadPages[ref->pageIndex]->data() + ref->offset;
+			}
+			return const_cast<void*>(payloadField);
+		};
 
-		const std::byte* cursor = m_commandBuffer.data();
-		const std::byte* end = cursor + m_commandBuffer.size();
+		// Recording order and thread slot of the chain being decoded
+		u32 order = 0;
+		u32 recorderIndex = 0;
+		bool hasRecordingOrders = false;
 
-		while (cursor < end)
+		auto decodeCommand = [&](const CommandHeader* header)
 		{
-			const auto* header = reinterpret_cast<const CommandHeader*>(cursor);
 			switch (header->type)
 			{
 			case CommandType::eCreateEntity:
@@ -90,80 +317,243 @@ namespace spite
 					const auto* cmd = reinterpret_cast<const CreateEntityCmd*>(header);
 					decodedCmds.push_back({
 						Entity{cmd->proxyId, Entity::PROXY_GENERATION}, CommandType::eCreateEntity,
-						INVALID_COMPONENT_ID, nullptr
+						INVALID_COMPONENT_ID, nullptr, order, recorderIndex
 					});
 					break;
 				}
 			case CommandType::eDestroyEntity:
 				{
 					const auto* cmd = reinterpret_cast<const DestroyEntityCmd*>(header);
-					decodedCmds.push_back({cmd->entity, CommandType::eDestroyEntity, INVALID_COMPONENT_ID, nullptr});
+					decodedCmds.push_back({
+						cmd->entity, CommandType::eDestroyEntity, INVALID_COMPONENT_ID, nullptr, order, recorderIndex
+					});
 					break;
 				}
 			case CommandType::eAddComponent:
 				{
 					const auto* cmd = reinterpret_cast<const AddComponentCmd*>(header);
-					void* data = const_cast<void*>(reinterpret_cast<const void*>(cmd + 1));
-					decodedCmds.push_back({cmd->entity, CommandType::eAddComponent, cmd->componentId, data});
+					void* data = payloadData(header, cmd + 1);
+					decodedCmds.push_back({
+						cmd->entity, CommandType::eAddComponent, cmd->componentId, data, order, recorderIndex
+					});
 					break;
 				}
 			case CommandType::eRemoveComponent:
 				{
 					const auto* cmd = reinterpret_cast<const RemoveComponentCmd*>(header);
-					decodedCmds.push_back({cmd->entity, CommandType::eRemoveComponent, cmd->componentId, nullptr});
+					decodedCmds.push_back({
+						cmd->entity, CommandType::eRemoveComponent, cmd->componentId, nullptr, order, recorderIndex
+					});
+					break;
+				}
+			case CommandType::eSetComponent:
+				{
+					const auto* cmd = reinterpret_cast<const SetComponentCmd*>(header);
+					void* data = payloadData(header, cmd + 1);
+					inPlaceCmds.push_back({
+						cmd->entity, CommandType::eSetComponent, cmd->componentId, data, order, recorderIndex
+					});
+					break;
+				}
+			case CommandType::eEnableComponent:
+			case CommandType::eDisableComponent:
+				{
+					const auto* cmd = reinterpret_cast<const ToggleComponentCmd*>(header);
+					inPlaceCmds.push_back({cmd->entity, header->type, cmd->componentId, nullptr, order, recorderIndex});
 					break;
 				}
+			case CommandType::eRecordingOrder:
+				order = reinterpret_cast<const RecordingOrderCmd*>(header)->order;
+				hasRecordingOrders = true;
+				break;
+			}
+		};
+
+		for (const auto& recorder : m_state->recorders)
+		{
+			if (!recorder.head)
+			{
+				++recorderIndex;
+				continue;
+			}
+
+			order = 0;
+			payloadPages.clear();
+			for (CommandPage* page = recorder.payloadHead; page; page = page->next)
+			{
+				payloadPages.push_back(page);
+			}
+
+			for (const CommandPage* page = recorder.head; page; page = page->next)
+			{
+				const std::byte* cursor = page->data();
+				const std::byte* end = cursor + page->used;
+				while (cursor < end)
+				{
+					const auto* header = reinterpret_cast<const CommandHeader*>(cursor);
+					decodeCommand(header);
+					cursor += header->size;
+				}
 			}
-			cursor += header->size;
+			++recorderIndex;
 		}
 
-		// Sort by entity to process all commands for an entity at once.
-		std::ranges::sort(decodedCmds, [](const auto& a, const auto& b)
+		// Thread slots depend on scheduling, the recording order does not.
+		// The sort is stable, so commands of one thread keep their sequence within an order
+		if (hasRecordingOrders)
 		{
-			return a.entity.id() < b.entity.id();
-		});
+			auto sortByOrder = [&scratch](scratch_vector<DecodedCommand>& commands)
+			{
+				auto orderScratch = makeScratchVector<DecodedCommand>(scratch);
+				orderScratch.resize(commands.size());
+				radixSort(eastl::span<DecodedCommand>(commands.data(), commands.size()),
+				          eastl::span<DecodedCommand>(orderScratch.data(), orderScratch.size()),
+				          [](const DecodedCommand& command) { return static_cast<u64>(command.order); });
+			};
+			sortByOrder(decodedCmds);
+			sortByOrder(inPlaceCmds);
+		}
 
-		// --- Pass 2: Process Sorted Commands ---
+#ifdef DEBUG
+		// Commands of one entity recorded on different threads with the same order have no reproducible winner
+		auto checkOrderConflicts = [&scratch](const scratch_vector<DecodedCommand>& commands)
+		{
+			auto sorted = makeScratchVector<const DecodedCommand*>(scratch);
+			sorted.reserve(commands.size());
+			for (const DecodedCommand& command : commands)
+			{
+				sorted.push_back(&command);
+			}
+			std::sort(sorted.begin(), sorted.end(), [](const DecodedCommand* a, const DecodedCommand* b)
+			{
+				return a->entity.id() != b->entity.id() ? a->entity.id() < b->entity.id() : a->order < b->order;
+			});
 
-		scratch_vector<Entity> proxyToRealEntity = makeScratchVector<Entity>(FrameScratchAllocator::get());
-		proxyToRealEntity.resize(m_nextProxyId, Entity::undefined());
+			for (sizet i = 0; i < sorted.size();)
+			{
+				sizet j = i + 1;
+				while (j < sorted.size() && sorted[j]->entity == sorted[i]->entity && sorted[j]->order == sorted[i]->order)
+				{
+					++j;
+				}
+				for (sizet a = i; a < j; ++a)
+				{
+					for (sizet b = a + 1; b < j; ++b)
+					{
+						const DecodedCommand& first = *sorted[a];
+						const DecodedCommand& second = *sorted[b];
+						const bool conflicts = first.type == CommandType::eDestroyEntity ||
+							second.type == CommandType::eDestroyEntity ||
+							(first.componentId == second.componentId && first.componentId != INVALID_COMPONENT_ID);
+						SASSERTM(first.recorder == second.recorder || !conflicts,
+						         "Conflicting commands for entity %llu were recorded on different threads with order %u, "
+						         "use CommandBuffer::RecordingOrderScope\n", first.entity.id(), first.order)
+					}
+				}
+				i = j;
+			}
+		};
+		checkOrderConflicts(decodedCmds);
+		checkOrderConflicts(inPlaceCmds);
+#endif
+
+		// Sort key: entity index | proxy bit | recording sequence.
+		// Equal high bits group the commands of one entity, the sequence keeps them in recording order
+		constexpr u64 PROXY_KEY_BIT = 1ull << 31;
+		constexpr u64 SEQUENCE_MASK = PROXY_KEY_BIT - 1;
+		SASSERTM(decodedCmds.size() <= SEQUENCE_MASK, "Too many commands in a single commit: %llu",
+		         static_cast<u64>(decodedCmds.size()))
+
+		auto sortKeys = makeScratchVector<u64>(scratch);
+		sortKeys.resize(decodedCmds.size());
+		for (sizet i = 0; i < decodedCmds.size(); ++i)
+		{
+			const Entity entity = decodedCmds[i].entity;
+			sortKeys[i] = static_cast<u64>(entity.index()) << 32 | (isProxy(entity) ? PROXY_KEY_BIT : 0) | i;
+		}
+
+		{
+			auto keyScratch = makeScratchVector<u64>(scratch);
+			keyScratch.resize(sortKeys.size());
+			radixSort(eastl::span<u64>(sortKeys.data(), sortKeys.size()),
+			          eastl::span<u64>(keyScratch.data(), keyScratch.size()));
+		}
 
-		auto creations = makeScratchMap<Aspect, scratch_vector<Entity>, Aspect::hash>(FrameScratchAllocator::get());
-		auto moves = makeScratchMap<Aspect, scratch_vector<Entity>, Aspect::hash>(FrameScratchAllocator::get());
-		scratch_vector<Entity> deletions = makeScratchVector<Entity>(FrameScratchAllocator::get());
+		// --- Pass 2: Resolve every entity to its final archetype ---
 
-		//for convenient entities->components bulk sort
-		auto componentsToAdd = makeScratchMap<Entity, eastl::pair<scratch_vector<ComponentID>, scratch_vector<void*>>,
-		                                      Entity::hash>(
-			FrameScratchAllocator::get());
+		// Structural change of one entity, archetypes are referenced by id so ops can be bucketed with a sort
+		struct EntityOp
+		{
+			Entity entity;
+			u32 fromArchetypeId; // NEW_ENTITY for entities created in this buffer
+			u32 toArchetypeId;
+			u32 firstPayload;
+			u32 payloadCount;
+		};
+		constexpr u32 NEW_ENTITY = U32_MAX;
+
+		struct PendingPayload
+		{
+			ComponentID componentId;
+			void* data;
+		};
 
-		auto componentsToRemove = makeScratchVector<ComponentID>(FrameScratchAllocator::get());
+		auto ops = makeScratchVector<EntityOp>(scratch);
+		auto payloads = makeScratchVector<PendingPayload>(scratch);
+		auto deletions = makeScratchVector<Entity>(scratch);
 
-		for (sizet i = 0; i < decodedCmds.size();)
+		// Payloads hold live components, the ones that never reach a chunk are destroyed in the arena
+		const DestructionContext destructionContext(entityManager.getSharedComponentManager());
+		auto destroyPayload = [&destructionContext](ComponentID componentId, void* data)
 		{
-			Entity currentEntity = decodedCmds[i].entity;
+			ComponentMetadataRegistry::getMetadata(componentId).destructionPolicy(data, destructionContext);
+		};
+
+		// Drops a payload recorded earlier for the same entity, a later add or remove supersedes it
+		auto dropPendingPayload = [&payloads, &destroyPayload](sizet firstPayload, ComponentID componentId)
+		{
+			for (sizet p = firstPayload; p < payloads.size(); ++p)
+			{
+				if (payloads[p].componentId == componentId)
+				{
+					destroyPayload(componentId, payloads[p].data);
+					payloads.erase(payloads.begin() + p);
+					return;
+				}
+			}
+		};
+
+		Archetype* rootArchetype = m_archetypeManager->getRootArchetype();
+
+		for (sizet i = 0; i < sortKeys.size();)
+		{
+			const Entity currentEntity = decodedCmds[sortKeys[i] & SEQUENCE_MASK].entity;
+			const u64 entityKey = sortKeys[i] >> 31;
 
-			// Find the range of commands for the current entity
 			sizet j = i;
-			while (j < decodedCmds.size() && decodedCmds[j].entity == currentEntity)
+			while (j < sortKeys.size() && sortKeys[j] >> 31 == entityKey)
 			{
-				j++;
+				++j;
 			}
 
-			// Process this entity's commands
 			bool isCreatedInThisBuffer = false;
 			bool isDestroyedInThisBuffer = false;
 
-			auto finalAspectIds = makeScratchVector<ComponentID>(FrameScratchAllocator::get());
-			Aspect finalAspect = isProxy(currentEntity) ? Aspect{} : m_archetypeManager->getEntityAspect(currentEntity);
-
-			finalAspectIds.assign(finalAspect.getComponentIds().begin(), finalAspect.getComponentIds().end());
+			Archetype* fromArchetype = rootArchetype;
+			if (!isProxy(currentEntity))
+			{
+				SASSERT(entityManager.isEntityValid(currentEntity))
+				fromArchetype = m_archetypeManager->findEntityArchetype(currentEntity);
+			}
+			Archetype* toArchetype = fromArchetype;
 
-			componentsToRemove.clear();
+			const sizet firstPayload = payloads.size();
 
 			for (sizet k = i; k < j; ++k)
 			{
-				const auto& cmd = decodedCmds[k];
+				const auto& cmd = decodedCmds[sortKeys[k] & SEQUENCE_MASK];
+				SASSERTM(cmd.entity == currentEntity, "Commands recorded for stale entity %llu\n", cmd.entity.id())
+
 				switch (cmd.type)
 				{
 				case CommandType::eCreateEntity:
@@ -173,142 +563,267 @@ namespace spite
 					isDestroyedInThisBuffer = true;
 					break;
 				case CommandType::eAddComponent:
-					{
-						//if components was recorded for removal
-						if (std::ranges::find(componentsToRemove, cmd.componentId) != componentsToRemove.end())
-						{
-							break;
-						}
-
-						finalAspectIds.push_back(cmd.componentId);
-						auto it = componentsToAdd.find(currentEntity);
-						if (it == componentsToAdd.end())
-						{
-							it = componentsToAdd.emplace(currentEntity,
-							                             eastl::make_pair(
-								                             makeScratchVector<ComponentID>(
-									                             FrameScratchAllocator::get()),
-								                             makeScratchVector<void*>(FrameScratchAllocator::get()))).
-							                     first;
-						}
-						it->second.first.push_back(cmd.componentId);
-						it->second.second.push_back(cmd.componentData);
-						break;
-					}
+					toArchetype = m_archetypeManager->getArchetypeWith(toArchetype, cmd.componentId);
+					dropPendingPayload(firstPayload, cmd.componentId);
+					payloads.push_back({cmd.componentId, cmd.componentData});
+					break;
 				case CommandType::eRemoveComponent:
-					{
-						finalAspectIds.erase(std::ranges::remove(finalAspectIds,
-						                                         cmd.componentId).begin(),
-						                     finalAspectIds.end());
-						//if component is added+removed -> do nothing
-						auto it = componentsToAdd.find(currentEntity);
-						if (it != componentsToAdd.end())
-						{
-							auto& components = componentsToAdd.at(currentEntity).first;
-							//clean addition command for this component
-							if (components.erase_first(cmd.componentId) != components.end())
-							{
-								break;
-							}
-						}
-
-						componentsToRemove.push_back(cmd.componentId);
-
-						break;
-					}
+					toArchetype = m_archetypeManager->getArchetypeWithout(toArchetype, cmd.componentId);
+					dropPendingPayload(firstPayload, cmd.componentId);
+					break;
+				default:
+					break;
 				}
 			}
 
-			finalAspect = Aspect(finalAspectIds);
+			i = j;
+
 			if (isDestroyedInThisBuffer)
 			{
+				// Entities created and destroyed in the same buffer never reach the world
 				if (!isCreatedInThisBuffer)
 				{
-					auto it = componentsToAdd.find(currentEntity);
-					if (it != componentsToAdd.end())
-					{
-						componentsToAdd.erase(it);
-					}
-					// Don't delete entities created and destroyed in the same buffer
 					deletions.push_back(currentEntity);
 				}
+				for (sizet p = firstPayload; p < payloads.size(); ++p)
+				{
+					destroyPayload(payloads[p].componentId, payloads[p].data);
+				}
+				payloads.resize(firstPayload);
+				continue;
 			}
-			else
+
+			SASSERTM(!isProxy(currentEntity) || isCreatedInThisBuffer,
+			         "Proxy entity %llu was not created by this command buffer\n", currentEntity.id())
+
+			const u32 payloadCount = static_cast<u32>(payloads.size() - firstPayload);
+			if (!isCreatedInThisBuffer && toArchetype == fromArchetype && payloadCount == 0)
 			{
-				if (isCreatedInThisBuffer)
+				continue;
+			}
+
+			ops.push_back({
+				currentEntity, isCreatedInThisBuffer ? NEW_ENTITY : fromArchetype->id(), toArchetype->id(),
+				static_cast<u32>(firstPayload), payloadCount
+			});
+		}
+
+		// --- Pass 3: Execute Batched Structural Changes & Set Data ---
+
+		// Bucket by (target, source) archetype pair, so each bucket is a single bulk create or move
+		{
+			auto opScratch = makeScratchVector<EntityOp>(scratch);
+			opScratch.resize(ops.size());
+			radixSort(eastl::span<EntityOp>(ops.data(), ops.size()),
+			          eastl::span<EntityOp>(opScratch.data(), opScratch.size()),
+			          [](const EntityOp& op)
+			          {
+				          return static_cast<u64>(op.toArchetypeId) << 32 | op.fromArchetypeId;
+			          });
+		}
+
+		auto bucketEntities = makeScratchVector<Entity>(scratch);
+		auto realEntities = makeScratchVector<Entity>(scratch);
+
+		// Only in-place commands can still reference proxies once creations are done
+		auto proxyToRealEntity = makeScratchVector<Entity>(scratch);
+		if (!inPlaceCmds.empty())
+		{
+			proxyToRealEntity.resize(m_state->proxyIdsReserved.load(std::memory_order_relaxed), Entity::undefined());
+		}
+
+		for (sizet i = 0; i < ops.size();)
+		{
+			const u32 toId = ops[i].toArchetypeId;
+			const u32 fromId = ops[i].fromArchetypeId;
+
+			sizet j = i;
+			bucketEntities.clear();
+			while (j < ops.size() && ops[j].toArchetypeId == toId && ops[j].fromArchetypeId == fromId)
+			{
+				bucketEntities.push_back(ops[j].entity);
+				++j;
+			}
+
+			Archetype* toArchetype = m_archetypeManager->getArchetypeById(toId);
+			if (fromId == NEW_ENTITY)
+			{
+				entityManager.createEntities(bucketEntities.size(), realEntities, toArchetype->aspect());
+				for (sizet k = i; k < j; ++k)
 				{
-					auto it = creations.find(finalAspect);
-					if (it == creations.end())
+					if (!proxyToRealEntity.empty())
 					{
-						it = creations.emplace(finalAspect,
-						                       makeScratchVector<Entity>(FrameScratchAllocator::get())).first;
+						proxyToRealEntity[getProxyId(ops[k].entity)] = realEntities[k - i];
 					}
-					it->second.push_back(currentEntity);
+					ops[k].entity = realEntities[k - i];
 				}
-				else
+			}
+			else if (fromId != toId)
+			{
+				m_archetypeManager->moveEntities(m_archetypeManager->getArchetypeById(fromId), toArchetype,
+				                                 bucketEntities);
+			}
+
+			i = j;
+		}
+
+		// Ops sharing a target archetype are contiguous, so column lookups are resolved once per target
+		struct ColumnCacheEntry
+		{
+			ComponentID componentId;
+			int componentIndex;
+			const ComponentMetadata* metadata;
+		};
+		auto columnCache = makeScratchVector<ColumnCacheEntry>(scratch);
+
+		for (sizet i = 0; i < ops.size();)
+		{
+			const u32 toId = ops[i].toArchetypeId;
+			const Archetype* toArchetype = m_archetypeManager->getArchetypeById(toId);
+			columnCache.clear();
+
+			for (; i < ops.size() && ops[i].toArchetypeId == toId; ++i)
+			{
+				const EntityOp& op = ops[i];
+				if (op.payloadCount == 0)
 				{
-					if (m_archetypeManager->getEntityAspect(currentEntity) != finalAspect)
+					continue;
+				}
+
+				auto [chunk, indexInChunk] = toArchetype->getEntityLocation(op.entity);
+				for (u32 p = op.firstPayload; p < op.firstPayload + op.payloadCount; ++p)
+				{
+					const PendingPayload& payload = payloads[p];
+
+					auto columnIt = std::ranges::find_if(columnCache, [&payload](const ColumnCacheEntry& entry)
 					{
-						auto it = moves.find(finalAspect);
-						if (it == moves.end())
-						{
-							it = moves.emplace(finalAspect,
-							                   makeScratchVector<Entity>(FrameScratchAllocator::get())).first;
-						}
-						it->second.push_back(currentEntity);
+						return entry.componentId == payload.componentId;
+					});
+					if (columnIt == columnCache.end())
+					{
+						columnCache.push_back({
+							payload.componentId, toArchetype->getComponentIndex(payload.componentId),
+							&ComponentMetadataRegistry::getMetadata(payload.componentId)
+						});
+						columnIt = columnCache.end() - 1;
 					}
+
+					void* dest = chunk->getComponentDataPtrByIndex(columnIt->componentIndex, indexInChunk);
+					columnIt->metadata->moveAndDestroy(dest, payload.data);
 				}
 			}
-			i = j; // Move to the next entity
 		}
 
-		// --- Pass 3: Execute Batched Structural Changes & Set Data ---
+		entityManager.destroyEntities(deletions);
+
+		// --- Pass 4: In-place writes, grouped by chunk ---
+
+		struct InPlaceWrite
+		{
+			Entity entity;
+			Chunk* chunk;
+			const Archetype* archetype;
+			u32 indexInChunk;
+			u32 commandIndex;
+		};
 
-		// Execute creations
-		for (auto const& [aspect, proxyEntities] : creations)
+		auto inPlaceWrites = makeScratchVector<InPlaceWrite>(scratch);
+		inPlaceWrites.reserve(inPlaceCmds.size());
+		for (sizet i = 0; i < inPlaceCmds.size(); ++i)
 		{
-			//SDEBUG_LOG("CommandBuffer: Creating %zu entities with aspect size %zu\n", proxyEntities.size(), aspect.size());
-			scratch_vector<Entity> realEntities = makeScratchVector<Entity>(FrameScratchAllocator::get());
-			entityManager.createEntities(proxyEntities.size(), realEntities, aspect);
-			for (sizet i = 0; i < proxyEntities.size(); ++i)
+			Entity entity = inPlaceCmds[i].entity;
+			if (isProxy(entity))
+			{
+				entity = proxyToRealEntity[getProxyId(entity)];
+			}
+
+			// Entities destroyed by this commit (or proxies that were never created) are skipped
+			const Archetype* archetype = entity == Entity::undefined()
+				                             ? nullptr
+				                             : m_archetypeManager->findEntityArchetype(entity);
+			if (!archetype)
 			{
-				proxyToRealEntity[getProxyId(proxyEntities[i])] = realEntities[i];
+				if (inPlaceCmds[i].componentData)
+				{
+					destroyPayload(inPlaceCmds[i].componentId, inPlaceCmds[i].componentData);
+				}
+				continue;
 			}
+
+			auto [chunk, indexInChunk] = archetype->getEntityLocation(entity);
+			inPlaceWrites.push_back({entity, chunk, archetype, static_cast<u32>(indexInChunk), static_cast<u32>(i)});
 		}
 
-		// Execute moves
-		for (auto const& [aspect, entities] : moves)
+		// Stable, so commands that hit the same chunk keep their recording order
 		{
-			//SDEBUG_LOG("CommandBuffer: Moving %zu entities to aspect size %zu\n", entities.size(), aspect.size());
-			entityManager.moveEntities(aspect, entities);
+			auto writeScratch = makeScratchVector<InPlaceWrite>(scratch);
+			writeScratch.resize(inPlaceWrites.size());
+			radixSort(eastl::span<InPlaceWrite>(inPlaceWrites.data(), inPlaceWrites.size()),
+			          eastl::span<InPlaceWrite>(writeScratch.data(), writeScratch.size()),
+			          [](const InPlaceWrite& write)
+			          {
+				          return static_cast<u64>(reinterpret_cast<uintptr_t>(write.chunk));
+			          });
 		}
 
-		// Set component data for all entities that had components added
-		for (auto const& [proxyOrRealEntity, components] : componentsToAdd)
+		ComponentObserverRegistry& observerRegistry = m_archetypeManager->getObserverRegistry();
+		const Archetype* cachedArchetype = nullptr;
+		for (const InPlaceWrite& write : inPlaceWrites)
 		{
-			Entity realEntity = isProxy(proxyOrRealEntity)
-				                    ? proxyToRealEntity[getProxyId(proxyOrRealEntity)]
-				                    : proxyOrRealEntity;
-			if (realEntity == Entity::undefined()) continue;
+			if (write.archetype != cachedArchetype)
+			{
+				cachedArchetype = write.archetype;
+				columnCache.clear();
+			}
 
-			auto& componentIds = components.first;
-			auto& componentDatas = components.second;
-			for (sizet i = 0; i < componentIds.size(); ++i)
+			const DecodedCommand& cmd = inPlaceCmds[write.commandIndex];
+			auto columnIt = std::ranges::find_if(columnCache, [&cmd](const ColumnCacheEntry& entry)
 			{
-				entityManager.setComponentData(realEntity, componentIds[i], componentDatas[i]);
+				return entry.componentId == cmd.componentId;
+			});
+			if (columnIt == columnCache.end())
+			{
+				columnCache.push_back({
+					cmd.componentId, write.archetype->getComponentIndex(cmd.componentId),
+					&ComponentMetadataRegistry::getMetadata(cmd.componentId)
+				});
+				columnIt = columnCache.end() - 1;
 			}
-		}
 
-		// Execute deletions
-		//if (!deletions.empty())
-		//{
-		//	SDEBUG_LOG("CommandBuffer: Deleting %zu entities\n", deletions.size());
-		//}
-		entityManager.destroyEntities(deletions);
+			const int componentIndex = columnIt->componentIndex;
+			if (componentIndex == -1)
+			{
+				// The entity lost the component, a set payload is dropped
+				if (cmd.componentData)
+				{
+					destroyPayload(cmd.componentId, cmd.componentData);
+				}
+				continue;
+			}
+
+			switch (cmd.type)
+			{
+			case CommandType::eSetComponent:
+				{
+					void* dest = write.chunk->getComponentDataPtrByIndex(componentIndex, write.indexInChunk);
+					columnIt->metadata->moveAssignAndDestroy(dest, cmd.componentData);
+					write.chunk->markModifiedByIndex(componentIndex, write.indexInChunk);
+					observerRegistry.record(cmd.componentId, ObserverEvent::eChange, {&write.entity, 1});
+					break;
+				}
+			case CommandType::eEnableComponent:
+				write.chunk->enableComponentByIndex(componentIndex, write.indexInChunk);
+				break;
+			case CommandType::eDisableComponent:
+				write.chunk->disableComponentByIndex(componentIndex, write.indexInChunk);
+				break;
+			default:
+				break;
+			}
+		}
 
 		// --- Cleanup ---
-		m_commandBuffer.clear();
-		m_nextProxyId = 0;
+		releasePages();
 	}
 
 	bool CommandBuffer::isProxy(Entity entity)
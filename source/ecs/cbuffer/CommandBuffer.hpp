@@ -1,4 +1,5 @@
 #pragma once
+#include <atomic>
 #include <mutex>
 
 #include "ecs/storage/Archetype.hpp"
@@ -6,6 +7,7 @@
 #include "ecs/core/ComponentMetadataRegistry.hpp"
 #include "base/memory/ScratchAllocator.hpp"
 #include "base/CollectionAliases.hpp"
+#include "base/ThreadIndex.hpp"
 
 namespace spite
 {
@@ -13,7 +15,11 @@ namespace spite
 	class EntityManager;
 
 	// A command buffer for recording entity and component operations to be executed later.
-	// Uses a scratch allocator for fast, temporary allocations.
+	// Recording is lock-free: every thread appends to its own chain of command pages
+	// and takes proxy ids from its own block. commit() must not run concurrently with recording.
+	// Which thread slot a worker gets changes between runs, so commands are merged by their recording order
+	// (see RecordingOrderScope). Conflicting commands for one entity recorded with the same order
+	// on different threads have no reproducible winner and are rejected in debug builds
 	class CommandBuffer
 	{
 	private:
@@ -24,15 +30,32 @@ namespace spite
 			eCreateEntity,
 			eDestroyEntity,
 			eAddComponent,
-			eRemoveComponent
+			eRemoveComponent,
+			// In-place commands, applied without any structural processing
+			eSetComponent,
+			eEnableComponent,
+			eDisableComponent,
+			// Marker, the recording order of the following commands of the thread
+			eRecordingOrder
 		};
 
 		struct CommandHeader
 		{
 			CommandType type;
+			u8 flags;
 			u16 size; // Size of the entire command packet (header + data)
 		};
 
+		// Set in CommandHeader::flags when the component data is a PayloadRef into the payload arena
+		static constexpr u8 PAYLOAD_OUT_OF_LINE = 1;
+
+		// Location of an out-of-line payload in the payload pages of the recording thread
+		struct PayloadRef
+		{
+			u32 pageIndex;
+			u32 offset;
+		};
+
 		struct CreateEntityCmd
 		{
 			CommandHeader header;
@@ -50,7 +73,7 @@ namespace spite
 			CommandHeader header;
 			Entity entity;
 			ComponentID componentId;
-			// Component data follows immediately in the buffer
+			// Component data or a PayloadRef follows immediately in the buffer
 		};
 
 		struct RemoveComponentCmd
@@ -60,14 +83,117 @@ namespace spite
 			ComponentID componentId;
 		};
 
-		std::mutex m_bufferMutex;
-		heap_vector<std::byte> m_commandBuffer;
-		u32 m_nextProxyId;
+		struct SetComponentCmd
+		{
+			CommandHeader header;
+			Entity entity;
+			ComponentID componentId;
+			// Component data or a PayloadRef follows immediately in the buffer
+		};
+
+		// Shared by eEnableComponent and eDisableComponent
+		struct ToggleComponentCmd
+		{
+			CommandHeader header;
+			Entity entity;
+			ComponentID componentId;
+		};
+
+		struct RecordingOrderCmd
+		{
+			CommandHeader header;
+			u32 order;
+		};
+
+		// Every command starts at this alignment, so payloads of up to 8-byte aligned types are placed correctly
+		static constexpr sizet COMMAND_ALIGNMENT = 8;
+		static constexpr sizet PAGE_SIZE = 16 * KB;
+		static constexpr u32 PROXY_BLOCK_SIZE = 256;
+		// Bigger or over-aligned payloads go to the payload arena to keep the command stream compact
+		static constexpr sizet INLINE_PAYLOAD_LIMIT = 128;
+
+		template <typename T>
+		static constexpr bool IS_INLINE_PAYLOAD = sizeof(T) <= INLINE_PAYLOAD_LIMIT && alignof(T) <= COMMAND_ALIGNMENT;
+
+		template <typename T>
+		static constexpr sizet PAYLOAD_FIELD_SIZE = IS_INLINE_PAYLOAD<T> ? sizeof(T) : sizeof(PayloadRef);
+
+		// Append-only block of commands or payloads, data follows the header
+		struct CommandPage
+		{
+			CommandPage* next;
+			u32 used;
+			u32 capacity;
+
+			std::byte* data() { return reinterpret_cast<std::byte*>(this + 1); }
+			const std::byte* data() const { return reinterpret_cast<const std::byte*>(this + 1); }
+		};
+
+		// Written only by the thread owning the slot, padded to avoid false sharing
+		struct alignas(64) ThreadRecorder
+		{
+			CommandPage* head = nullptr;
+			CommandPage* tail = nullptr;
+			u32 nextProxyId = 0;
+			u32 proxyBlockEnd = 0;
+			// Order of the last command in the chain, a marker is written when the thread's order changes
+			u32 chainOrder = 0;
+
+			// Out-of-line payloads, referenced from commands by page index and offset
+			CommandPage* payloadHead = nullptr;
+			CommandPage* payloadTail = nullptr;
+			u32 payloadPageCount = 0;
+		};
+
+		struct RecordingState
+		{
+			ThreadRecorder recorders[MAX_THREAD_INDICES];
+			std::atomic<u32> proxyIdsReserved{0};
+
+			// Recycled default-sized pages, only touched when a thread runs out of page space
+			std::mutex pagePoolMutex;
+			CommandPage* freePages = nullptr;
+		};
+
+		HeapAllocator m_allocator;
+		RecordingState* m_state;
+
+		void* writeCommand(CommandType type, sizet size);
+		void* appendCommand(ThreadRecorder& recorder, CommandType type, sizet size);
+		void* allocatePayload(sizet size, sizet alignment, PayloadRef& outRef);
+		CommandPage* acquirePage(sizet minCapacity);
+		void releaseChain(CommandPage* page);
+		void releasePages();
+
+		// Returns where the component of a command with inline payload field at payloadField should be constructed
+		template <typename T>
+		void* placePayload(CommandHeader& header, void* payloadField);
+		void destroyState();
 
-		void* writeCommand(CommandType type, u16 size);
+		void recordToggle(CommandType type, Entity entity, ComponentID componentId);
 
 		public:
+		// Sets the recording order of the calling thread for every command buffer until the scope ends.
+		// Use a sequence that does not depend on scheduling, such as the system or job index.
+		// Commands are merged by order first and keep the recording sequence of their thread within one order
+		class RecordingOrderScope
+		{
+		private:
+			u32 m_previous;
+
+		public:
+			explicit RecordingOrderScope(u32 order);
+			~RecordingOrderScope();
+
+			RecordingOrderScope(const RecordingOrderScope&) = delete;
+			RecordingOrderScope& operator=(const RecordingOrderScope&) = delete;
+		};
+
+		// Order set by the innermost RecordingOrderScope of the calling thread, 0 outside of any
+		static u32 getRecordingOrder();
+
 		CommandBuffer(ArchetypeManager* archetypeManager, const HeapAllocator& allocator);
+		~CommandBuffer();
 
 		CommandBuffer(const CommandBuffer&) = delete;
 		CommandBuffer& operator=(const CommandBuffer&) = delete;
@@ -89,9 +215,25 @@ namespace spite
 		template <t_component T>
 		void removeComponent(Entity entity);
 
+		// Records an overwrite of a component the entity already has.
+		// Applied in place after structural changes of the same commit, dropped if the entity lost the component
+		template <t_component T>
+		void setComponent(Entity entity, T&& component);
+
+		// Records enabling of a component the entity already has, applied in place like setComponent
+		template <t_component T>
+		void enableComponent(Entity entity);
+
+		// Records disabling of a component the entity already has, applied in place like setComponent
+		template <t_component T>
+		void disableComponent(Entity entity);
+
 		// Executes all recorded commands on the EntityManager.
+		// Commands are merged by recording order, commands of one thread keep their recording sequence
 		void commit(EntityManager& entityManager);
 
+		bool isEmpty() const;
+
 		static bool isProxy(Entity entity);
 		static u32 getProxyId(Entity entity);
 	};
@@ -100,24 +242,64 @@ namespace spite
 	void CommandBuffer::addComponent(Entity entity, T&& component)
 	{
 		const ComponentID componentId = ComponentMetadataRegistry::getComponentId<T>();
-		constexpr u16 commandSize = sizeof(AddComponentCmd) + sizeof(T);
+		constexpr sizet commandSize = sizeof(AddComponentCmd) + PAYLOAD_FIELD_SIZE<T>;
 
 		auto cmd = static_cast<AddComponentCmd*>(writeCommand(CommandType::eAddComponent, commandSize));
 		cmd->entity = entity;
 		cmd->componentId = componentId;
 
-		// Write component data directly after the command struct
-		new(cmd + 1) T(std::forward<T>(component));
+		new(placePayload<T>(cmd->header, cmd + 1)) T(std::forward<T>(component));
+	}
+
+	template <typename T>
+	void* CommandBuffer::placePayload(CommandHeader& header, void* payloadField)
+	{
+		if constexpr (IS_INLINE_PAYLOAD<T>)
+		{
+			return payloadField;
+		}
+		else
+		{
+			header.flags |= PAYLOAD_OUT_OF_LINE;
+			return allocatePayload(sizeof(T), alignof(T), *static_cast<PayloadRef*>(payloadField));
+		}
 	}
 
 	template <t_component T>
 	void CommandBuffer::removeComponent(Entity entity)
 	{
 		const ComponentID componentId = ComponentMetadataRegistry::getComponentId<T>();
-		constexpr u16 commandSize = sizeof(RemoveComponentCmd);
+		constexpr sizet commandSize = sizeof(RemoveComponentCmd);
 
 		auto cmd = static_cast<RemoveComponentCmd*>(writeCommand(CommandType::eRemoveComponent, commandSize));
 		cmd->entity = entity;
 		cmd->componentId = componentId;
 	}
+
+	template <t_component T>
+	void CommandBuffer::setComponent(Entity entity, T&& component)
+	{
+		static_assert(!t_shared_handle<std::decay_t<T>>, "Shared components are reassigned through SharedComponentManager");
+
+		const ComponentID componentId = ComponentMetadataRegistry::getComponentId<T>();
+		constexpr sizet commandSize = sizeof(SetComponentCmd) + PAYLOAD_FIELD_SIZE<T>;
+
+		auto cmd = static_cast<SetComponentCmd*>(writeCommand(CommandType::eSetComponent, commandSize));
+		cmd->entity = entity;
+		cmd->componentId = componentId;
+
+		new(placePayload<T>(cmd->header, cmd + 1)) T(std::forward<T>(component));
+	}
+
+	template <t_component T>
+	void CommandBuffer::enableComponent(Entity entity)
+	{
+		recordToggle(CommandType::eEnableComponent, entity, ComponentMetadataRegistry::getComponentId<T>());
+	}
+
+	template <t_component T>
+	void CommandBuffer::disableComponent(Entity entity)
+	{
+		recordToggle(CommandType::eDisableComponent, entity, ComponentMetadataRegistry::getComponentId<T>());
+	}
 }
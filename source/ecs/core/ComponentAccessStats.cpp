@@ -0,0 +1,113 @@
+#include "ComponentAccessStats.hpp"
+
+#include <algorithm>
+#include <fstream>
+
+#include "ecs/core/ComponentMetadataRegistry.hpp"
+
+namespace spite
+{
+	std::atomic<bool> ComponentAccessStats::m_enabled = false;
+	ComponentAccessStats::Slot ComponentAccessStats::m_slots[MAX_TRACKED_COMPONENTS] = {};
+
+	namespace
+	{
+		cstring placementName(ComponentPlacement placement)
+		{
+			switch (placement)
+			{
+			case ComponentPlacement::eHot:
+				return "hot";
+			case ComponentPlacement::eCold:
+				return "cold";
+			default:
+				return "auto";
+			}
+		}
+
+		u64 totalChunks(const ComponentAccessStats::Counters& counters)
+		{
+			return counters.readChunks + counters.writeChunks;
+		}
+	}
+
+	void ComponentAccessStats::setEnabled(bool enabled)
+	{
+		m_enabled.store(enabled, std::memory_order_relaxed);
+	}
+
+	void ComponentAccessStats::recordChunk(ComponentID id, bool write, sizet elements)
+	{
+		if (id >= MAX_TRACKED_COMPONENTS)
+		{
+			return;
+		}
+
+		Slot& slot = m_slots[id];
+		(write ? slot.writeChunks : slot.readChunks).fetch_add(1, std::memory_order_relaxed);
+		slot.elements.fetch_add(elements, std::memory_order_relaxed);
+	}
+
+	ComponentAccessStats::Counters ComponentAccessStats::get(ComponentID id)
+	{
+		if (id >= MAX_TRACKED_COMPONENTS)
+		{
+			return {};
+		}
+
+		const Slot& slot = m_slots[id];
+		return {
+			slot.readChunks.load(std::memory_order_relaxed),
+			slot.writeChunks.load(std::memory_order_relaxed),
+			slot.elements.load(std::memory_order_relaxed)
+		};
+	}
+
+	void ComponentAccessStats::reset()
+	{
+		for (Slot& slot : m_slots)
+		{
+			slot.readChunks.store(0, std::memory_order_relaxed);
+			slot.writeChunks.store(0, std::memory_order_relaxed);
+			slot.elements.store(0, std::memory_order_relaxed);
+		}
+	}
+
+	bool ComponentAccessStats::suggestsCold(ComponentID id, float coldFraction)
+	{
+		const sizet count = std::min(ComponentMetadataRegistry::getRegisteredComponentCount(), MAX_TRACKED_COMPONENTS);
+		u64 busiest = 0;
+		for (ComponentID i = 1; i < count; ++i)
+		{
+			busiest = std::max(busiest, totalChunks(get(i)));
+		}
+
+		if (busiest == 0)
+		{
+			return false;
+		}
+		return static_cast<float>(totalChunks(get(id))) < coldFraction * static_cast<float>(busiest);
+	}
+
+	bool ComponentAccessStats::exportCsv(cstring path, float coldFraction)
+	{
+		std::ofstream file(path, std::ios::trunc);
+		if (!file)
+		{
+			return false;
+		}
+
+		file << "id,type,size,pinned,read_chunks,write_chunks,elements,suggested\n";
+		for (ComponentID id = 1, count = static_cast<ComponentID>(ComponentMetadataRegistry::getRegisteredComponentCount());
+		     id < count; ++id)
+		{
+			const auto& metadata = ComponentMetadataRegistry::getMetadata(id);
+			const Counters counters = get(id);
+			// Type names of templates contain commas
+			file << id << ",\"" << (metadata.typeName ? metadata.typeName : "") << "\"," << metadata.size << ','
+				<< placementName(metadata.placement) << ',' << counters.readChunks << ',' << counters.writeChunks << ','
+				<< counters.elements << ',' << (suggestsCold(id, coldFraction) ? "cold" : "hot") << '\n';
+		}
+		return static_cast<bool>(file);
+	}
+}
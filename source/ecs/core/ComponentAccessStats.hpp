@@ -0,0 +1,56 @@
+#pragma once
+#include <atomic>
+
+#include "ecs/core/ComponentMetadata.hpp"
+
+namespace spite
+{
+	// Per-component access counters fed by query views and Chunk::getComponents, disabled by default.
+	// Accesses are counted once per chunk visit, elements adds up the entities of the visited chunks.
+	// Results drive ChunkLayoutMode::eAccessStats and can be exported for offline placement decisions
+	class ComponentAccessStats
+	{
+	public:
+		static constexpr sizet MAX_TRACKED_COMPONENTS = 1024;
+		// Share of the busiest component's chunk visits below which a component is considered cold
+		static constexpr float DEFAULT_COLD_FRACTION = 0.05f;
+
+		struct Counters
+		{
+			u64 readChunks = 0;
+			u64 writeChunks = 0;
+			u64 elements = 0;
+		};
+
+	private:
+		struct Slot
+		{
+			std::atomic<u64> readChunks;
+			std::atomic<u64> writeChunks;
+			std::atomic<u64> elements;
+		};
+
+		static std::atomic<bool> m_enabled;
+		static Slot m_slots[MAX_TRACKED_COMPONENTS];
+
+	public:
+		static void setEnabled(bool enabled);
+
+		static bool isEnabled() { return m_enabled.load(std::memory_order_relaxed); }
+
+		// Components past MAX_TRACKED_COMPONENTS are not counted
+		static void recordChunk(ComponentID id, bool write, sizet elements);
+
+		static Counters get(ComponentID id);
+
+		static void reset();
+
+		// false if nothing was recorded for the component or it is visited at least coldFraction as often
+		// as the busiest component
+		static bool suggestsCold(ComponentID id, float coldFraction = DEFAULT_COLD_FRACTION);
+
+		// One CSV row per registered component: id, type, size, pinned placement, counters and suggested placement
+		// (returns false if the file could not be written)
+		static bool exportCsv(cstring path, float coldFraction = DEFAULT_COLD_FRACTION);
+	};
+}
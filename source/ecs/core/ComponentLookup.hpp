@@ -0,0 +1,107 @@
+#pragma once
+#include <type_traits>
+#include <typeinfo>
+
+#include "ecs/core/ComponentMetadataRegistry.hpp"
+#include "ecs/storage/ArchetypeManager.hpp"
+
+namespace spite
+{
+	// Random access to a single component type by Entity.
+	// Column indices of every archetype are resolved when the lookup is built,
+	// so each access is one record table read and a pointer offset.
+	// Meant to be obtained once per update, the lookup does not follow structural changes made after that.
+	// A lookup over const T is read-only and does not mark components as modified
+	template <typename T>
+		requires t_component<std::remove_const_t<T>>
+	class ComponentLookup
+	{
+	private:
+		static constexpr sizet INLINE_ARCHETYPE_CAPACITY = 64;
+
+		const EntityRecordTable* m_records;
+		// Indexed by Archetype::id(), -1 if the archetype has no T
+		sbo_vector<int, INLINE_ARCHETYPE_CAPACITY> m_columns;
+
+		// (returns -1 if entity is not alive or has no T)
+		int findColumn(const EntityRecord* record) const
+		{
+			if (!record)
+			{
+				return -1;
+			}
+
+			const u32 archetypeId = record->archetype->id();
+			SASSERTM(archetypeId < m_columns.size(), "ComponentLookup<%s> was used after a structural change\n",
+			         typeid(T).name())
+			return m_columns[archetypeId];
+		}
+
+	public:
+		explicit ComponentLookup(const ArchetypeManager& archetypeManager)
+			: m_records(&archetypeManager.getEntityRecords()),
+			  m_columns(archetypeManager.archetypeCount(), -1)
+		{
+			const ComponentID componentId = ComponentMetadataRegistry::getComponentId<std::remove_const_t<T>>();
+			for (sizet i = 0, size = m_columns.size(); i < size; ++i)
+			{
+				m_columns[i] = archetypeManager.getArchetypeById(static_cast<u32>(i))->getComponentIndex(componentId);
+			}
+		}
+
+		// (returns nullptr if entity is not alive or has no T)
+		T* tryGet(Entity entity) const
+		{
+			const EntityRecord* record = m_records->find(entity);
+			const int column = findColumn(record);
+			if (column < 0)
+			{
+				return nullptr;
+			}
+
+			Chunk* chunk = record->archetype->getChunks()[record->chunkIndex];
+			if constexpr (!std::is_const_v<T>)
+			{
+				chunk->markModifiedByIndex(column, record->indexInChunk);
+			}
+			return reinterpret_cast<T*>(chunk->getComponentArrayByIndex(column)) + record->indexInChunk;
+		}
+
+		T& get(Entity entity) const
+		{
+			T* component = tryGet(entity);
+			SASSERTM(component, "Entity %llu has no component %s\n", entity.id(), typeid(T).name())
+			return *component;
+		}
+
+		bool has(Entity entity) const
+		{
+			return findColumn(m_records->find(entity)) >= 0;
+		}
+
+		// Change tracking of the entity's T, reset together with the chunk modification bits
+		bool wasModified(Entity entity) const
+		{
+			const EntityRecord* record = m_records->find(entity);
+			const int column = findColumn(record);
+			if (column < 0)
+			{
+				return false;
+			}
+			const Chunk* chunk = record->archetype->getChunks()[record->chunkIndex];
+			return chunk->wasModifiedLastFrameByIndex(column, record->indexInChunk);
+		}
+
+		// Modification bits are per chunk, threads writing through the same lookup should be partitioned by it
+		// (returns nullptr if entity is not alive or has no T)
+		const Chunk* findChunk(Entity entity) const
+		{
+			const EntityRecord* record = m_records->find(entity);
+			if (findColumn(record) < 0)
+			{
+				return nullptr;
+			}
+			return record->archetype->getChunks()[record->chunkIndex];
+		}
+	};
+}
@@ -1,19 +1,43 @@
 #pragma once
 #include "Base/Platform.hpp"
+#include "ecs/core/IComponent.hpp"
 
 namespace spite
 {
 	// Forward-declare for the function pointer signature
 	class DestructionContext; 
+	class SnapshotWriter;
+	class SnapshotReader;
+	class HeapAllocator;
+	struct ISharedComponentPool;
 
 	using ComponentID = u32;
 	constexpr ComponentID INVALID_COMPONENT_ID = 0;
 
+	// How a component column is stored in a world snapshot
+	enum class SerializationMode : u8
+	{
+		// Not written, the component is dropped from saved entities
+		eNone,
+		// Trivially copyable, chunk memory is written and adopted as is
+		eRaw,
+		// Written and read element by element through the component's serialize/deserialize
+		eCustom,
+		// SharedComponent<T> handle, raw bytes with the component id remapped on load
+		eSharedHandle
+	};
+
 	struct ComponentMetadata
 	{
 		// A single function pointer to handle all destruction side-effects.
 		using DestructionPolicyFn = void (*)(void* componentPtr, const DestructionContext& context);
 		using MoveAndDestroyFn = void (*)(void* destPtr, void* srcPtr);
+		// Like MoveAndDestroyFn, but destPtr already holds a live component
+		using MoveAssignAndDestroyFn = void (*)(void* destPtr, void* srcPtr);
+		using SerializeFn = void (*)(const void* componentPtr, SnapshotWriter& writer);
+		// Constructs the component into uninitialized destPtr
+		using DeserializeFn = void (*)(void* destPtr, SnapshotReader& reader);
+		using CreateSharedPoolFn = ISharedComponentPool* (*)(HeapAllocator& allocator);
 
 		ComponentID id = INVALID_COMPONENT_ID;
 		sizet size = 0;
@@ -21,6 +45,17 @@ namespace spite
 		
 		DestructionPolicyFn destructionPolicy = nullptr;
 		MoveAndDestroyFn moveAndDestroy = nullptr;
+		MoveAssignAndDestroyFn moveAssignAndDestroy = nullptr;
+
+		// Hash of the type name, identifies the component across runs where ids may differ
+		u64 typeHash = 0;
+		cstring typeName = nullptr;
+		ComponentPlacement placement = ComponentPlacement::eAuto;
+		SerializationMode serializationMode = SerializationMode::eNone;
+		SerializeFn serialize = nullptr;
+		DeserializeFn deserialize = nullptr;
+		// Only for SharedComponent<T> handles, creates an empty pool of the shared data type
+		CreateSharedPoolFn createSharedPool = nullptr;
 
 		constexpr ComponentMetadata() = default;
 
@@ -28,10 +63,12 @@ namespace spite
 		                  sizet size,
 		                  sizet alignment,
 		                  DestructionPolicyFn policyFn,
-		                  MoveAndDestroyFn moveAndDestroyFn)
+		                  MoveAndDestroyFn moveAndDestroyFn,
+		                  MoveAssignAndDestroyFn moveAssignAndDestroyFn)
 			: id(id), size(size), alignment(alignment),
 			  destructionPolicy(policyFn),
-			  moveAndDestroy(moveAndDestroyFn)
+			  moveAndDestroy(moveAndDestroyFn),
+			  moveAssignAndDestroy(moveAssignAndDestroyFn)
 		{}
 	};
 }
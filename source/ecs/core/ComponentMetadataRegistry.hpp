@@ -15,6 +15,9 @@ namespace spite
 {
 	class SharedComponentManager;
 
+	template <t_shared_component T>
+	class TypedSharedComponentPool;
+
 	// This context is passed to the policy function at runtime.
 	class DestructionContext
 	{
@@ -36,6 +39,18 @@ namespace spite
 		{
 		}
 
+		// 64-bit FNV-1a, used for type names which are stable between runs of the same build
+		constexpr u64 hashTypeName(cstring name)
+		{
+			u64 hash = 14695981039346656037ull;
+			for (; *name; ++name)
+			{
+				hash ^= static_cast<u8>(*name);
+				hash *= 1099511628211ull;
+			}
+			return hash;
+		}
+
 		// Creates a single ComponentMetadata entry for a given component type.
 		template <t_component T>
 		ComponentMetadata create_metadata_for(ComponentID id)
@@ -43,6 +58,7 @@ namespace spite
 			// Start with the default no-op policy.
 			ComponentMetadata::DestructionPolicyFn policyFn = &empty_destruction_policy;
 			ComponentMetadata::MoveAndDestroyFn moveAndDestroyFn;
+			ComponentMetadata::MoveAssignAndDestroyFn moveAssignAndDestroyFn;
 
 			// --- Overwrite Destruction Policy for Special Cases ---
 			if constexpr (t_shared_handle<T>)
@@ -65,6 +81,7 @@ namespace spite
 				{
 					memcpy(dest, src, sizeof(T));
 				};
+				moveAssignAndDestroyFn = moveAndDestroyFn;
 			}
 			else
 			{
@@ -74,15 +91,69 @@ namespace spite
 					new(dest) T(std::move(*static_cast<T*>(src)));
 					static_cast<T*>(src)->~T();
 				};
+				moveAssignAndDestroyFn = [](void* dest, void* src)
+				{
+					if constexpr (std::is_move_assignable_v<T>)
+					{
+						*static_cast<T*>(dest) = std::move(*static_cast<T*>(src));
+					}
+					else
+					{
+						static_cast<T*>(dest)->~T();
+						new(dest) T(std::move(*static_cast<T*>(src)));
+					}
+					static_cast<T*>(src)->~T();
+				};
 			}
 
-			return ComponentMetadata(
+			ComponentMetadata metadata(
 				id,
 				sizeof(T),
 				alignof(T),
 				policyFn,
-				moveAndDestroyFn
+				moveAndDestroyFn,
+				moveAssignAndDestroyFn
 			);
+
+			metadata.typeName = typeid(T).name();
+			if constexpr (t_placement_hinted<T>)
+			{
+				metadata.placement = T::placement;
+			}
+
+			// --- Select Snapshot Serialization ---
+			metadata.typeHash = hashTypeName(typeid(T).name());
+			if constexpr (t_shared_handle<T>)
+			{
+				using Data = typename T::DataType;
+				metadata.createSharedPool = [](HeapAllocator& allocator) -> ISharedComponentPool*
+				{
+					return allocator.new_object<TypedSharedComponentPool<Data>>(allocator);
+				};
+				// Pools are written as raw slots, so only trivially copyable shared data is supported
+				if constexpr (std::is_trivially_copyable_v<Data>)
+				{
+					metadata.serializationMode = SerializationMode::eSharedHandle;
+				}
+			}
+			else if constexpr (t_custom_serializable<T>)
+			{
+				metadata.serializationMode = SerializationMode::eCustom;
+				metadata.serialize = [](const void* c, SnapshotWriter& writer)
+				{
+					T::serialize(*static_cast<const T*>(c), writer);
+				};
+				metadata.deserialize = [](void* dest, SnapshotReader& reader)
+				{
+					new(dest) T(T::deserialize(reader));
+				};
+			}
+			else if constexpr (std::is_trivially_copyable_v<T>)
+			{
+				metadata.serializationMode = SerializationMode::eRaw;
+			}
+
+			return metadata;
 		}
 	}
 
@@ -147,6 +218,22 @@ namespace spite
 			return metadata;
 		}
 
+		// Component types are registered lazily, a type that was not used yet in this run is not found
+		// (returns INVALID_COMPONENT_ID if no registered component has this type hash)
+		static ComponentID findComponentIdByTypeHash(u64 typeHash)
+		{
+			SASSERTM(ComponentMetadataRegistry::m_instance, "ComponentMetadataRegistry is not initialized\n")
+			const auto& idToMetadata = ComponentMetadataRegistry::m_instance->m_idToMetadata;
+			for (sizet i = 1, size = idToMetadata.size(); i < size; ++i)
+			{
+				if (idToMetadata[i].typeHash == typeHash)
+				{
+					return static_cast<ComponentID>(i);
+				}
+			}
+			return INVALID_COMPONENT_ID;
+		}
+
 		static sizet getRegisteredComponentCount()
 		{
 			SASSERTM(ComponentMetadataRegistry::m_instance, "ComponentMetadataRegistry is not initialized\n")
@@ -14,9 +14,9 @@ namespace spite
 		  m_singletonComponentRegistry(
 			  singletonComponentRegistry),
 		  m_queryRegistry(queryRegistry),
-		  m_eventManager(this),
-		  m_generations(makeHeapVector<u32>(allocator)), m_freeIndices(makeHeapVector<u32>(allocator)),
-		  m_allocator(allocator)
+		  m_allocator(allocator),
+		  m_eventManager(this, m_allocator),
+		  m_generations(makeHeapVector<u32>(allocator)), m_freeIndices(makeHeapVector<u32>(allocator))
 	{
 		m_generations.push_back(0);
 	}
@@ -31,7 +31,7 @@ namespace spite
 		return CommandBuffer(m_archetypeManager, m_allocator);
 	}
 
-	Entity EntityManager::createEntity(const Aspect& aspect)
+	Entity EntityManager::allocateEntity()
 	{
 		u32 index;
 		if (!m_freeIndices.empty())
@@ -44,7 +44,12 @@ namespace spite
 			index = static_cast<u32>(m_generations.size());
 			m_generations.push_back(0);
 		}
-		Entity entity(index, m_generations[index]);
+		return Entity(index, m_generations[index]);
+	}
+
+	Entity EntityManager::createEntity(const Aspect& aspect)
+	{
+		Entity entity = allocateEntity();
 		m_archetypeManager->addEntity(aspect, entity);
 		return entity;
 	}
@@ -80,6 +85,62 @@ namespace spite
 			generation());
 	}
 
+	eastl::span<const u32> EntityManager::getGenerations() const
+	{
+		return {m_generations.data(), m_generations.size()};
+	}
+
+	eastl::span<const u32> EntityManager::getFreeIndices() const
+	{
+		return {m_freeIndices.data(), m_freeIndices.size()};
+	}
+
+	bool EntityManager::isPristine() const
+	{
+		// Index 0 is reserved for Entity::undefined
+		return m_generations.size() == 1 && m_freeIndices.empty();
+	}
+
+	void EntityManager::restoreEntityIndices(eastl::span<const u32> generations, eastl::span<const u32> freeIndices)
+	{
+		SASSERT(!generations.empty())
+		m_generations.assign(generations.begin(), generations.end());
+		m_freeIndices.assign(freeIndices.begin(), freeIndices.end());
+	}
+
+	scratch_vector<Entity> EntityManager::mergeFrom(EntityManager& source)
+	{
+		SASSERT(&source != this)
+
+		auto remap = makeScratchVector<Entity>(FrameScratchAllocator::get());
+		remap.resize(source.m_generations.size(), Entity::undefined());
+
+		const ArchetypeManager& sourceArchetypes = *source.m_archetypeManager;
+		for (u32 archetypeId = 0, size = static_cast<u32>(sourceArchetypes.archetypeCount()); archetypeId < size; ++
+		     archetypeId)
+		{
+			for (const Chunk* chunk : sourceArchetypes.getArchetypeById(archetypeId)->getChunks())
+			{
+				for (const Entity entity : chunk->entities())
+				{
+					remap[entity.index()] = allocateEntity();
+				}
+			}
+		}
+
+		m_archetypeManager->mergeFrom(*source.m_archetypeManager, {remap.data(), remap.size()});
+
+		for (u32 index = 0; index < remap.size(); ++index)
+		{
+			if (remap[index] != Entity::undefined())
+			{
+				++source.m_generations[index];
+				source.m_freeIndices.push_back(index);
+			}
+		}
+		return remap;
+	}
+
 	void EntityManager::addComponents(eastl::span<const Entity> entities,
 	                                  eastl::span<const ComponentID> componentIds) const
 	{
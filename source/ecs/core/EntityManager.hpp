@@ -6,6 +6,7 @@
 #include "SingletonComponentRegistry.hpp"
 
 #include "ecs/storage/ArchetypeManager.hpp"
+#include "ComponentLookup.hpp"
 #include "ecs/storage/SharedComponentManager.hpp"
 #include "base/CollectionAliases.hpp"
 
@@ -26,13 +27,18 @@ namespace spite
 		AspectRegistry* m_aspectRegistry;
 		SingletonComponentRegistry* m_singletonComponentRegistry;
 		QueryRegistry* m_queryRegistry;
-		EntityEventManager m_eventManager;
 
+		// Declared before m_eventManager, its command buffer allocates from it on construction
 		HeapAllocator m_allocator;
 
+		EntityEventManager m_eventManager;
+
 		heap_vector<u32> m_generations;
 		heap_vector<u32> m_freeIndices;
 
+		// Takes a free index or appends a new one, the entity is not placed into any archetype
+		Entity allocateEntity();
+
 	public:
 		EntityManager(ArchetypeManager* archetypeManager, SharedComponentManager* sharedComponentManager,
 		              SingletonComponentRegistry* singletonComponentRegistry, AspectRegistry* aspectRegistry,
@@ -44,6 +50,8 @@ namespace spite
 
 		[[nodiscard]] ArchetypeManager* getArchetypeManager() const { return m_archetypeManager; }
 
+		[[nodiscard]] SharedComponentManager* getSharedComponentManager() const { return m_sharedComponentManager; }
+
 		[[nodiscard]] EntityEventManager& getEventManager();
 
 		//creates Entity with aspect which it will belong to
@@ -69,6 +77,21 @@ namespace spite
 
 		bool isEntityValid(Entity entity) const;
 
+		// Entity index allocation state, written into world snapshots
+		[[nodiscard]] eastl::span<const u32> getGenerations() const;
+		[[nodiscard]] eastl::span<const u32> getFreeIndices() const;
+
+		// true if no entity was created yet
+		[[nodiscard]] bool isPristine() const;
+
+		// Replaces the index allocation state, entity storage has to be restored to match
+		void restoreEntityIndices(eastl::span<const u32> generations, eastl::span<const u32> freeIndices);
+
+		// Moves every entity of source (a staging world) into this manager in one step, see ArchetypeManager::mergeFrom.
+		// Source entities are destroyed there, components holding Entity values must be remapped by the caller
+		// (returns the new entity for every source entity index, caller owns the scratch marker)
+		scratch_vector<Entity> mergeFrom(EntityManager& source);
+
 		template <t_component T, typename... Args>
 		void addComponent(Entity entity, Args&&... args);
 
@@ -98,6 +121,9 @@ namespace spite
 		template <t_component T>
 		void disableComponent(Entity entity) const;
 
+		template <t_component T>
+		bool isComponentEnabled(Entity entity) const;
+
 		template <t_component T>
 		T& getComponent(Entity entity);
 
@@ -110,6 +136,13 @@ namespace spite
 		template <t_component T>
 		bool hasComponent(Entity entity) const;
 
+		// Cached random access for systems that follow entity references, valid until the next structural change
+		template <t_component T>
+		ComponentLookup<T> getComponentLookup() const;
+
+		template <t_component T>
+		ComponentLookup<const T> getReadOnlyComponentLookup() const;
+
 		bool hasComponent(Entity entity, ComponentID id) const;
 
 		void setComponentData(Entity entity, ComponentID componentId, void* componentData) const;
@@ -132,6 +165,10 @@ namespace spite
 		template <t_singleton_component T>
 		const T& getSingletonComponent() const;
 
+		// Lock-free, returns nullptr if T was never registered
+		template <t_singleton_component T>
+		T* tryGetSingletonComponent() const;
+
 		template <t_singleton_component T>
 		void accesSingleton(std::function<void(T&)> accessor);
 
@@ -152,18 +189,7 @@ namespace spite
 
 		for (sizet i = 0; i < count; ++i)
 		{
-			u32 index;
-			if (!m_freeIndices.empty())
-			{
-				index = m_freeIndices.back();
-				m_freeIndices.pop_back();
-			}
-			else
-			{
-				index = static_cast<u32>(m_generations.size());
-				m_generations.push_back(0);
-			}
-			outputEntities.emplace_back(Entity(index, m_generations[index]));
+			outputEntities.emplace_back(allocateEntity());
 		}
 
 		m_archetypeManager->addEntities(aspect, outputEntities);
@@ -287,6 +313,16 @@ namespace spite
 		                               index);
 	}
 
+	template <t_component T>
+	bool EntityManager::isComponentEnabled(Entity entity) const
+	{
+		SASSERT(isEntityValid(entity))
+		auto& archetype = m_archetypeManager->getEntityArchetype(entity);
+		auto [chunk, index] = archetype.getEntityLocation(entity);
+		return chunk->isComponentEnabledByIndex(
+			archetype.getComponentIndex(ComponentMetadataRegistry::getComponentId<T>()), index);
+	}
+
 	template <t_component T>
 	T& EntityManager::getComponent(Entity entity)
 	{
@@ -333,6 +369,18 @@ namespace spite
 		return archetype.aspect().contains(componentId);
 	}
 
+	template <t_component T>
+	ComponentLookup<T> EntityManager::getComponentLookup() const
+	{
+		return ComponentLookup<T>(*m_archetypeManager);
+	}
+
+	template <t_component T>
+	ComponentLookup<const T> EntityManager::getReadOnlyComponentLookup() const
+	{
+		return ComponentLookup<const T>(*m_archetypeManager);
+	}
+
 	template <t_shared_component T>
 	void EntityManager::setShared(Entity entity, const T& data)
 	{
@@ -414,6 +462,12 @@ namespace spite
 		return m_singletonComponentRegistry->get<T>();
 	}
 
+	template <t_singleton_component T>
+	T* EntityManager::tryGetSingletonComponent() const
+	{
+		return m_singletonComponentRegistry->tryGet<T>();
+	}
+
 	template <t_singleton_component T>
 	void EntityManager::accesSingleton(std::function<void(T&)> accessor)
 	{
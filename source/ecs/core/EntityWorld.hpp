@@ -1,9 +1,11 @@
 #pragma once
 #include "EntityManager.hpp"
+#include "StagingWorld.hpp"
 #include "ecs/systems/SystemManager.hpp"
 #include "ecs/query/QueryRegistry.hpp"
 #include "ecs/storage/AspectRegistry.hpp"
 #include "ecs/core/ComponentMetadataRegistry.hpp"
+#include "ecs/serialization/WorldSnapshot.hpp"
 
 namespace spite
 {
@@ -52,5 +54,23 @@ namespace spite
 		{
 			m_systemManager.update(deltaTime);
 		}
+
+		bool saveSnapshot(cstring path) const
+		{
+			return WorldSnapshot::save(m_entityManager, path, m_allocator);
+		}
+
+		// Only valid before any entity is created, see WorldSnapshot::load
+		bool loadSnapshot(cstring path)
+		{
+			return WorldSnapshot::load(m_entityManager, path);
+		}
+
+		// Moves all entities of a finished staging world into this world, on the thread that updates it.
+		// (returns the new entity for every staging entity index, caller owns the scratch marker)
+		scratch_vector<Entity> merge(StagingWorld& staging)
+		{
+			return m_entityManager.mergeFrom(staging.getEntityManager());
+		}
 	};
 }
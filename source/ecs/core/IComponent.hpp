@@ -1,4 +1,5 @@
 #pragma once
+#include <concepts>
 #include <type_traits>
 #include <utility>
 
@@ -6,6 +7,9 @@
 
 namespace spite
 {
+	class SnapshotWriter;
+	class SnapshotReader;
+
 	// --- Base Component Interfaces ---
 
 	struct IComponent
@@ -50,6 +54,8 @@ namespace spite
 	template <t_shared_component T>
 	struct SharedComponent : IComponent
 	{
+		using DataType = T;
+
 		SharedComponentHandle handle;
 	};
 
@@ -68,17 +74,50 @@ namespace spite
 	template <typename T>
 	concept t_shared_handle = is_shared_handle<T>::value;
 
+	// Opt-in world snapshot support for components that are not trivially copyable.
+	// Trivially copyable components are written as raw bytes without it
+	template <typename T>
+	concept t_custom_serializable = requires(const T& component, SnapshotWriter& writer, SnapshotReader& reader)
+	{
+		T::serialize(component, writer);
+		{ T::deserialize(reader) } -> std::same_as<T>;
+	};
+
+	// Where a component column is stored inside a chunk
+	enum class ComponentPlacement : u8
+	{
+		// Decided by the archetype manager's ChunkLayoutMode
+		eAuto,
+		// Main storage block, iterated by most systems
+		eHot,
+		// Separate side allocation, for large rarely touched data
+		eCold
+	};
+
+	// Components pin their placement with a static member:
+	// static constexpr ComponentPlacement placement = ComponentPlacement::eCold;
+	template <typename T>
+	concept t_placement_hinted = requires
+	{
+		{ T::placement } -> std::convertible_to<ComponentPlacement>;
+	};
+
 	// --- Access Wrappers ---
 
+	// Any type that can be named in Read<T>/Write<T>: chunk components in queries,
+	// singletons in SystemBase::declareAccess
+	template <typename T>
+	concept t_accessible = t_component<T> || t_singleton_component<T>;
+
 	// Wrapper to request read-only access to a component in a query.
-	template <t_component T>
+	template <t_accessible T>
 	struct Read
 	{
 		using type = T;
 	};
 
 	// Wrapper to request read-write access to a component in a query.
-	template <t_component T>
+	template <t_accessible T>
 	struct Write
 	{
 		using type = T;
@@ -5,9 +5,24 @@
 namespace spite
 {
 	SingletonComponentRegistry::SingletonComponentRegistry(const HeapAllocator& allocator)
-		: m_instances(
-			  makeHeapMap<std::type_index, std::unique_ptr<ISingletonWrapper>, std::hash<std::type_index>>(allocator)),
-		  m_mutexes(makeHeapMap<std::type_index, std::unique_ptr<std::mutex>, std::hash<std::type_index>>(allocator))
+		: m_instances(makeHeapVector<std::unique_ptr<ISingletonWrapper>>(allocator)),
+		  m_mutexes(makeHeapVector<std::unique_ptr<std::mutex>>(allocator))
 	{
 	}
+
+	void SingletonComponentRegistry::ensureSlot(SingletonID id)
+	{
+		if (id < m_instances.size())
+		{
+			return;
+		}
+
+		m_instances.resize(id + 1);
+		const sizet oldMutexCount = m_mutexes.size();
+		m_mutexes.resize(id + 1);
+		for (sizet i = oldMutexCount; i < m_mutexes.size(); ++i)
+		{
+			m_mutexes[i] = std::make_unique<std::mutex>();
+		}
+	}
 }
@@ -1,8 +1,9 @@
 #pragma once
 
+#include <atomic>
 #include <memory>
 #include <utility>
-#include <typeindex>
+#include <typeinfo>
 #include <mutex>
 #include <functional>
 
@@ -12,6 +13,8 @@
 
 namespace spite
 {
+	using SingletonID = u32;
+
 	class SingletonComponentRegistry
 	{
 	private:
@@ -30,10 +33,15 @@ namespace spite
 			}
 		};
 
-		heap_unordered_map<std::type_index, std::unique_ptr<ISingletonWrapper>, std::hash<std::type_index>> m_instances;
-		heap_unordered_map<std::type_index, std::unique_ptr<std::mutex>, std::hash<std::type_index>> m_mutexes;
+		inline static std::atomic<SingletonID> s_nextSingletonId{0};
+
+		// Indexed by SingletonID, so lookups are a plain array access
+		heap_vector<std::unique_ptr<ISingletonWrapper>> m_instances;
+		heap_vector<std::unique_ptr<std::mutex>> m_mutexes;
 		mutable std::mutex m_registryMutex;
 
+		void ensureSlot(SingletonID id);
+
 	public:
 		SingletonComponentRegistry(const HeapAllocator& allocator);
 
@@ -44,70 +52,89 @@ namespace spite
 
 		~SingletonComponentRegistry() = default;
 
+		// Process-wide slot id of the singleton type, assigned on first use and stable afterwards
+		template <t_singleton_component T>
+		static SingletonID getSingletonId()
+		{
+			static const SingletonID id = s_nextSingletonId.fetch_add(1, std::memory_order_relaxed);
+			return id;
+		}
+
 		template <t_singleton_component T>
 		void registerSingleton(std::unique_ptr<T> instance = nullptr)
 		{
-			const auto typeIndex = std::type_index(typeid(T));
+			const SingletonID id = getSingletonId<T>();
 			std::lock_guard<std::mutex> lock(m_registryMutex);
 
+			ensureSlot(id);
+
 			auto wrapper = std::make_unique<SingletonWrapper<T>>();
 			if (instance)
 			{
 				wrapper->instance = std::move(instance);
 			}
-			m_instances[typeIndex] = std::move(wrapper);
+			m_instances[id] = std::move(wrapper);
+		}
 
-			if (m_mutexes.find(typeIndex) == m_mutexes.end())
+		template <t_singleton_component T>
+		bool isRegistered() const
+		{
+			const SingletonID id = getSingletonId<T>();
+			return id < m_instances.size() && m_instances[id] != nullptr;
+		}
+
+		// Lock-free lookup, returns nullptr if the singleton was not registered
+		// Safe to call concurrently as long as no registration happens at the same time
+		template <t_singleton_component T>
+		T* tryGet() const
+		{
+			const SingletonID id = getSingletonId<T>();
+			if (id >= m_instances.size() || !m_instances[id])
 			{
-				m_mutexes.emplace(typeIndex, std::make_unique<std::mutex>());
+				return nullptr;
 			}
+			return static_cast<SingletonWrapper<T>*>(m_instances[id].get())->instance.get();
 		}
 
 		//not thread-safe
 		template <t_singleton_component T>
 		T& get()
 		{
-			const auto typeIndex = std::type_index(typeid(T));
-			auto it = m_instances.find(typeIndex);
-			if (it == m_instances.end())
+			T* instance = tryGet<T>();
+			if (!instance)
 			{
 				registerSingleton<T>();
-				it = m_instances.find(typeIndex);
+				instance = tryGet<T>();
 			}
-			auto* wrapper = static_cast<SingletonWrapper<T>*>(it->second.get());
-			return *wrapper->instance;
+			return *instance;
 		}
 
 		//not thread-safe
 		template <t_singleton_component T>
 		const T& get() const
 		{
-			const auto typeIndex = std::type_index(typeid(T));
-			auto it = m_instances.find(typeIndex);
-			SASSERTM(it != m_instances.end(), "Singleton of type %s was accessed before it was created\n",
+			const T* instance = tryGet<T>();
+			SASSERTM(instance, "Singleton of type %s was accessed before it was created\n",
 			         typeid(T).name())
-			const auto* wrapper = static_cast<const SingletonWrapper<T>*>(it->second.get());
-			return *wrapper->instance;
+			return *instance;
 		}
 
 		//thread-safe
 		template <t_singleton_component T>
 		void access(std::function<void(T&)> accessor)
 		{
-			const auto typeIndex = std::type_index(typeid(T));
+			const SingletonID id = getSingletonId<T>();
 
 			std::unique_lock<std::mutex> registryLock(m_registryMutex);
 
-			auto it = m_instances.find(typeIndex);
-			if (it == m_instances.end())
+			ensureSlot(id);
+			if (!m_instances[id])
 			{
-				auto wrapper = std::make_unique<SingletonWrapper<T>>();
-				it = m_instances.emplace(typeIndex, std::move(wrapper)).first;
-				m_mutexes.emplace(typeIndex, std::make_unique<std::mutex>());
+				m_instances[id] = std::make_unique<SingletonWrapper<T>>();
 			}
 
-			auto& instanceMutex = *m_mutexes.at(typeIndex);
-			auto* wrapperPtr = static_cast<SingletonWrapper<T>*>(it->second.get());
+			auto& instanceMutex = *m_mutexes[id];
+			auto* wrapperPtr = static_cast<SingletonWrapper<T>*>(m_instances[id].get());
 
 			registryLock.unlock();
 
@@ -119,16 +146,15 @@ namespace spite
 		template <t_singleton_component T>
 		void access(std::function<void(const T&)> accessor) const
 		{
-			const auto typeIndex = std::type_index(typeid(T));
+			const SingletonID id = getSingletonId<T>();
 
 			std::unique_lock<std::mutex> registryLock(m_registryMutex);
 
-			auto it = m_instances.find(typeIndex);
-			SASSERTM(it != m_instances.end(), "Singleton of type %s was accessed before it was created.",
-			         typeid(T).name());
+			SASSERTM(id < m_instances.size() && m_instances[id],
+			         "Singleton of type %s was accessed before it was created.", typeid(T).name())
 
-			auto& instanceMutex = *m_mutexes.at(typeIndex);
-			const auto* wrapper = static_cast<const SingletonWrapper<T>*>(it->second.get());
+			auto& instanceMutex = *m_mutexes[id];
+			const auto* wrapper = static_cast<const SingletonWrapper<T>*>(m_instances[id].get());
 
 			registryLock.unlock();
 
@@ -0,0 +1,88 @@
+#pragma once
+#include "EntityManager.hpp"
+#include "base/memory/ScratchAllocator.hpp"
+#include "ecs/query/QueryRegistry.hpp"
+#include "ecs/serialization/WorldSnapshot.hpp"
+#include "ecs/storage/AspectRegistry.hpp"
+#include "ecs/storage/VersionManager.hpp"
+
+namespace spite
+{
+	// Entity storage without systems for streaming content in: filled on a loader thread from a snapshot,
+	// procedural generation or command buffers, then merged into an EntityWorld in one step.
+	// Give it a heap of its own when it is built off the main thread, merged chunks are copied into the world's heap
+	// so the staging heap can be reused afterwards. A staging world is used by one thread at a time,
+	// a loader thread builds it inside a BuildScope
+	class StagingWorld
+	{
+	private:
+		static constexpr sizet SCRATCH_SIZE = 1 * MB;
+
+		HeapAllocator m_allocator;
+		// Frame scratch of the building thread, FrameScratchAllocator::resetFrame does not reach it
+		ScratchAllocator m_scratchAllocator;
+
+		AspectRegistry m_aspectRegistry;
+		VersionManager m_versionManager;
+
+		SharedComponentManager m_sharedComponentManager;
+
+		ArchetypeManager m_archetypeManager;
+		QueryRegistry m_queryRegistry;
+
+		SingletonComponentRegistry m_singletonComponentRegistry;
+
+		EntityManager m_entityManager;
+
+	public:
+		StagingWorld(const HeapAllocator& stagingAllocator) :
+			m_allocator(stagingAllocator),
+			m_scratchAllocator(SCRATCH_SIZE, "StagingWorldScratchAllocator"),
+			m_aspectRegistry(m_allocator),
+			m_versionManager(m_allocator, &m_aspectRegistry),
+			m_sharedComponentManager(m_allocator),
+			m_archetypeManager(m_allocator, &m_aspectRegistry, &m_versionManager, &m_sharedComponentManager),
+			m_queryRegistry(m_allocator, &m_archetypeManager, &m_versionManager),
+			m_singletonComponentRegistry(m_allocator),
+			m_entityManager(&m_archetypeManager, &m_sharedComponentManager, &m_singletonComponentRegistry,
+			                &m_aspectRegistry, &m_queryRegistry, m_allocator)
+		{
+		}
+
+		// Redirects frame scratch of the calling thread to the staging world while it builds,
+		// the main thread keeps resetting its frames meanwhile
+		class BuildScope
+		{
+		private:
+			ScratchAllocator& m_scratchAllocator;
+			FrameScratchAllocator::ScopedOverride m_override;
+
+		public:
+			explicit BuildScope(StagingWorld& world) : m_scratchAllocator(world.m_scratchAllocator),
+			                                           m_override(m_scratchAllocator)
+			{
+			}
+
+			~BuildScope()
+			{
+				// Nested scopes leave the reset to the outermost one
+				if (m_override.previous() != &m_scratchAllocator)
+				{
+					m_scratchAllocator.reset();
+				}
+			}
+
+			BuildScope(const BuildScope&) = delete;
+			BuildScope& operator=(const BuildScope&) = delete;
+		};
+
+		EntityManager& getEntityManager() { return m_entityManager; }
+
+		// Only valid before any entity is created, see WorldSnapshot::load
+		bool loadSnapshot(cstring path)
+		{
+			BuildScope scope(*this);
+			return WorldSnapshot::load(m_entityManager, path);
+		}
+	};
+}
@@ -0,0 +1,97 @@
+#include "ComponentObserverRegistry.hpp"
+
+#include "base/Assert.hpp"
+
+#include "ecs/storage/Aspect.hpp"
+
+namespace spite
+{
+	ComponentObserverRegistry::ComponentObserverRegistry(const HeapAllocator& allocator)
+		: m_allocator(allocator),
+		  m_subscriptions(makeHeapVector<std::unique_ptr<Subscription>>(allocator)),
+		  m_subscribersByKey(makeHeapVector<heap_vector<ObserverID>>(allocator))
+	{
+	}
+
+	sizet ComponentObserverRegistry::getKey(ComponentID componentId, ObserverEvent event)
+	{
+		return static_cast<sizet>(componentId) * static_cast<sizet>(ObserverEvent::eCount) + static_cast<sizet>(
+			event);
+	}
+
+	ObserverID ComponentObserverRegistry::subscribe(ComponentID componentId, ObserverEvent event)
+	{
+		SASSERT(event != ObserverEvent::eCount)
+
+		const auto id = static_cast<ObserverID>(m_subscriptions.size());
+		m_subscriptions.push_back(std::make_unique<Subscription>(componentId, event, m_allocator));
+
+		const sizet key = getKey(componentId, event);
+		while (m_subscribersByKey.size() <= key)
+		{
+			m_subscribersByKey.push_back(makeHeapVector<ObserverID>(m_allocator));
+		}
+		m_subscribersByKey[key].push_back(id);
+		return id;
+	}
+
+	bool ComponentObserverRegistry::hasSubscriptions() const
+	{
+		return !m_subscriptions.empty();
+	}
+
+	bool ComponentObserverRegistry::isObserved(ComponentID componentId, ObserverEvent event) const
+	{
+		const sizet key = getKey(componentId, event);
+		return key < m_subscribersByKey.size() && !m_subscribersByKey[key].empty();
+	}
+
+	void ComponentObserverRegistry::record(ComponentID componentId, ObserverEvent event,
+	                                       eastl::span<const Entity> entities)
+	{
+		const sizet key = getKey(componentId, event);
+		if (key >= m_subscribersByKey.size() || entities.empty())
+		{
+			return;
+		}
+
+		for (ObserverID observer : m_subscribersByKey[key])
+		{
+			auto& pending = m_subscriptions[observer]->pending;
+			pending.insert(pending.end(), entities.begin(), entities.end());
+		}
+	}
+
+	void ComponentObserverRegistry::recordAspect(const Aspect& aspect, const Aspect* exclude, ObserverEvent event,
+	                                             eastl::span<const Entity> entities)
+	{
+		if (!hasSubscriptions())
+		{
+			return;
+		}
+
+		for (const ComponentID componentId : aspect.getComponentIds())
+		{
+			if (exclude && exclude->contains(componentId))
+			{
+				continue;
+			}
+			record(componentId, event, entities);
+		}
+	}
+
+	void ComponentObserverRegistry::deliver(ObserverID observer)
+	{
+		SASSERT(observer < m_subscriptions.size())
+		Subscription& subscription = *m_subscriptions[observer];
+		subscription.delivered.clear();
+		subscription.delivered.swap(subscription.pending);
+	}
+
+	eastl::span<const Entity> ComponentObserverRegistry::getDelivered(ObserverID observer) const
+	{
+		SASSERT(observer < m_subscriptions.size())
+		const auto& delivered = m_subscriptions[observer]->delivered;
+		return {delivered.data(), delivered.size()};
+	}
+}
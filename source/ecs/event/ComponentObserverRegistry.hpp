@@ -0,0 +1,75 @@
+#pragma once
+#include <memory>
+
+#include <EASTL/span.h>
+
+#include "base/CollectionUtilities.hpp"
+#include "ecs/core/ComponentMetadata.hpp"
+#include "ecs/core/Entity.hpp"
+
+namespace spite
+{
+	class Aspect;
+
+	enum class ObserverEvent : u8
+	{
+		eAdd,
+		eRemove,
+		eChange,
+		eCount
+	};
+
+	using ObserverID = u32;
+
+	// Collects entity batches per (component, event) during structural changes and in-place writes.
+	// Every subscription has its own pending batch, deliver() makes it readable as a span.
+	// Components nobody subscribed to cost a single array lookup per batch
+	class ComponentObserverRegistry
+	{
+	private:
+		struct Subscription
+		{
+			ComponentID componentId;
+			ObserverEvent event;
+			heap_vector<Entity> pending;
+			heap_vector<Entity> delivered;
+
+			Subscription(ComponentID componentId, ObserverEvent event, const HeapAllocator& allocator)
+				: componentId(componentId), event(event), pending(makeHeapVector<Entity>(allocator)),
+				  delivered(makeHeapVector<Entity>(allocator))
+			{
+			}
+		};
+
+		HeapAllocator m_allocator;
+		heap_vector<std::unique_ptr<Subscription>> m_subscriptions;
+		// Indexed by componentId * eCount + event
+		heap_vector<heap_vector<ObserverID>> m_subscribersByKey;
+
+		static sizet getKey(ComponentID componentId, ObserverEvent event);
+
+	public:
+		ComponentObserverRegistry(const HeapAllocator& allocator);
+
+		ComponentObserverRegistry(const ComponentObserverRegistry&) = delete;
+		ComponentObserverRegistry& operator=(const ComponentObserverRegistry&) = delete;
+
+		ObserverID subscribe(ComponentID componentId, ObserverEvent event);
+
+		bool hasSubscriptions() const;
+
+		bool isObserved(ComponentID componentId, ObserverEvent event) const;
+
+		void record(ComponentID componentId, ObserverEvent event, eastl::span<const Entity> entities);
+
+		// Records event for every component of aspect that is missing from exclude
+		void recordAspect(const Aspect& aspect, const Aspect* exclude, ObserverEvent event,
+		                  eastl::span<const Entity> entities);
+
+		// Drops the previously delivered batch and makes everything recorded since readable
+		void deliver(ObserverID observer);
+
+		// Entities may have been destroyed or changed again after the batch was recorded
+		eastl::span<const Entity> getDelivered(ObserverID observer) const;
+	};
+}
@@ -4,13 +4,22 @@
 
 namespace spite
 {
-	EntityEventManager::EntityEventManager(EntityManager* entityManager)
-		: m_entityManager(entityManager), m_commandBuffer(m_entityManager->createCommandBuffer())
+	EntityEventManager::EntityEventManager(EntityManager* entityManager, const HeapAllocator& allocator)
+		: m_entityManager(entityManager), m_commandBuffer(m_entityManager->createCommandBuffer()),
+		  m_allocator(allocator),
+		  m_channels(makeHeapVector<std::unique_ptr<IEventChannel>>(allocator))
 	{
 	}
 
 	void EntityEventManager::commit()
 	{
+		for (auto& channel : m_channels)
+		{
+			if (channel)
+			{
+				channel->swap();
+			}
+		}
 		m_commandBuffer.commit(*m_entityManager);
 	}
 }
@@ -1,4 +1,8 @@
 #pragma once
+#include <memory>
+#include <typeinfo>
+
+#include "EventChannel.hpp"
 #include "IEventComponent.hpp"
 #include "ecs/cbuffer/CommandBuffer.hpp"
 
@@ -9,10 +13,40 @@ namespace spite
 	private:
 		EntityManager* m_entityManager;
 		CommandBuffer m_commandBuffer;
+		HeapAllocator m_allocator;
+
+		inline static std::atomic<EventChannelID> s_nextChannelId{0};
+
+		// Indexed by EventChannelID, empty slots belong to channels registered in other managers
+		heap_vector<std::unique_ptr<IEventChannel>> m_channels;
+
+		template <t_event T>
+		EventChannel<T>& getChannel() const;
 
 	public:
-		EntityEventManager(EntityManager* entityManager);
+		EntityEventManager(EntityManager* entityManager, const HeapAllocator& allocator);
+
+		// Process-wide channel id of the event type, assigned on first use and stable afterwards
+		template <t_event T>
+		static EventChannelID getChannelId();
+
+		// Channels are created up front, send and read never allocate a channel
+		template <t_event T>
+		void registerChannel();
+
+		template <t_event T>
+		bool isChannelRegistered() const;
+
+		// Thread-safe, the event becomes readable after the next commit
+		template <t_event T>
+		void send(T&& event = T{});
+
+		// Events sent before the last commit
+		template <t_event T>
+		eastl::span<const T> read() const;
 
+		// Creates an entity with EventTag and the event component.
+		// Only for events that have to be queried like components, use send otherwise
 		template <t_event T>
 		void fire(T&& event = T{});
 
@@ -21,9 +55,53 @@ namespace spite
 	};
 
 	template <t_event T>
-	void EntityEventManager::fire(T&& event)
+	EventChannelID EntityEventManager::getChannelId()
+	{
+		static const EventChannelID id = s_nextChannelId.fetch_add(1, std::memory_order_relaxed);
+		return id;
+	}
+
+	template <t_event T>
+	EventChannel<T>& EntityEventManager::getChannel() const
 	{
+		SASSERTM(isChannelRegistered<T>(), "Event channel %s is not registered\n", typeid(T).name())
+		return static_cast<EventChannel<T>&>(*m_channels[getChannelId<T>()]);
+	}
+
+	template <t_event T>
+	void EntityEventManager::registerChannel()
+	{
+		const EventChannelID id = getChannelId<T>();
+		if (id >= m_channels.size())
+		{
+			m_channels.resize(id + 1);
+		}
+		SASSERTM(!m_channels[id], "Event channel %s is already registered\n", typeid(T).name())
+		m_channels[id] = std::make_unique<EventChannel<T>>(m_allocator);
+	}
+
+	template <t_event T>
+	bool EntityEventManager::isChannelRegistered() const
+	{
+		const EventChannelID id = getChannelId<T>();
+		return id < m_channels.size() && m_channels[id];
+	}
+
+	template <t_event T>
+	void EntityEventManager::send(T&& event)
+	{
+		getChannel<T>().send(std::forward<T>(event));
+	}
+
+	template <t_event T>
+	eastl::span<const T> EntityEventManager::read() const
+	{
+		return getChannel<T>().read();
+	}
 
+	template <t_event T>
+	void EntityEventManager::fire(T&& event)
+	{
 		Entity e = m_commandBuffer.createEntity();
 		m_commandBuffer.addComponent(e, EventTag{});
 		m_commandBuffer.addComponent<T>(e, std::forward<T>(event));
@@ -0,0 +1,98 @@
+#pragma once
+#include <atomic>
+
+#include <EASTL/span.h>
+
+#include "IEventComponent.hpp"
+#include "base/CollectionUtilities.hpp"
+#include "base/ThreadIndex.hpp"
+
+namespace spite
+{
+	using EventChannelID = u32;
+
+	class IEventChannel
+	{
+	public:
+		virtual ~IEventChannel() = default;
+
+		// Publishes events sent since the previous swap and drops the ones published before
+		virtual void swap() = 0;
+	};
+
+	// Double-buffered, per-type event storage.
+	// Every thread appends to its own buffer, so sending is lock-free.
+	// Readers see the events sent during the previous frame as one contiguous span.
+	template <t_event T>
+	class EventChannel : public IEventChannel
+	{
+	private:
+		// Written only by the thread owning the slot, padded to avoid false sharing
+		struct alignas(64) ThreadBuffer
+		{
+			heap_vector<T> events;
+
+			ThreadBuffer(const HeapAllocator& allocator) : events(makeHeapVector<T>(allocator))
+			{
+			}
+		};
+
+		heap_vector<ThreadBuffer> m_threadBuffers;
+		heap_vector<T> m_published;
+
+	public:
+		EventChannel(const HeapAllocator& allocator)
+			: m_threadBuffers(makeHeapVector<ThreadBuffer>(allocator)),
+			  m_published(makeHeapVector<T>(allocator))
+		{
+			m_threadBuffers.reserve(MAX_THREAD_INDICES);
+			for (sizet i = 0; i < MAX_THREAD_INDICES; ++i)
+			{
+				m_threadBuffers.emplace_back(allocator);
+			}
+		}
+
+		void send(T&& event)
+		{
+			m_threadBuffers[getThreadIndex()].events.push_back(std::move(event));
+		}
+
+		eastl::span<const T> read() const
+		{
+			return {m_published.data(), m_published.size()};
+		}
+
+		void swap() override
+		{
+			m_published.clear();
+
+			sizet writerCount = 0;
+			ThreadBuffer* lastWriter = nullptr;
+			for (auto& buffer : m_threadBuffers)
+			{
+				if (!buffer.events.empty())
+				{
+					++writerCount;
+					lastWriter = &buffer;
+				}
+			}
+
+			// Common case of a single sending thread, buffers are exchanged without copying
+			if (writerCount == 1)
+			{
+				m_published.swap(lastWriter->events);
+				return;
+			}
+
+			// Merged in thread index order
+			for (auto& buffer : m_threadBuffers)
+			{
+				for (auto& event : buffer.events)
+				{
+					m_published.push_back(std::move(event));
+				}
+				buffer.events.clear();
+			}
+		}
+	};
+}
@@ -177,6 +177,10 @@ namespace spite
 						{
 							m_currentChunk = *m_chunkIt;
 							m_entityIndexInChunk = 0;
+							if (ComponentAccessStats::isEnabled())
+							{
+								recordChunkAccess();
+							}
 							return;
 						}
 						++m_chunkIt;
@@ -186,6 +190,20 @@ namespace spite
 				m_currentChunk = nullptr; // End of iteration
 			}
 
+			void recordChunkAccess() const
+			{
+				auto record = [&]<typename T0>(std::type_identity<T0>)
+				{
+					if constexpr (is_read_wrapper_v<T0> || is_write_wrapper_v<T0>)
+					{
+						ComponentAccessStats::recordChunk(
+							ComponentMetadataRegistry::getComponentId<get_component_type<T0>>(),
+							is_write_wrapper_v<T0>, m_currentChunk->size());
+					}
+				};
+				(record(std::type_identity<TArgs>{}), ...);
+			}
+
 			void updateChunkCache()
 			{
 				if constexpr (component_count > 0)
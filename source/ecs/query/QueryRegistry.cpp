@@ -7,24 +7,36 @@ namespace spite
 	                             VersionManager* versionManager)
 		: m_archetypeManager(archetypeManager),
 		  m_versionManager(versionManager),
-		  m_queries(makeHeapMap<QueryDescriptor, Query, QueryDescriptor::hash>(allocator))
+		  m_allocator(allocator),
+		  m_queries(makeHeapFlatMap<QueryDescriptor, Query*, QueryDescriptor::hash>(allocator))
 	{
 	}
 
+	QueryRegistry::~QueryRegistry()
+	{
+		for (auto& [descriptor, query] : m_queries)
+		{
+			m_allocator.delete_object(query);
+		}
+	}
+
 	Query* QueryRegistry::findOrCreateQuery(const QueryDescriptor& descriptor)
 	{
 		auto it = m_queries.find(descriptor);
 		if (it == m_queries.end())
 		{
-			it = m_queries.emplace(descriptor, Query(m_archetypeManager, descriptor.includeAspect,
-			                                         descriptor.readAspect, descriptor.writeAspect,
-			                                         descriptor.excludeAspect, descriptor.enabledAspect,
-			                                         descriptor.modifiedAspect)).first;
+			it = m_queries.emplace(descriptor, m_allocator.new_object<Query>(m_archetypeManager,
+			                                                                 descriptor.includeAspect,
+			                                                                 descriptor.readAspect,
+			                                                                 descriptor.writeAspect,
+			                                                                 descriptor.excludeAspect,
+			                                                                 descriptor.enabledAspect,
+			                                                                 descriptor.modifiedAspect)).first;
 			//SDEBUG_LOG("Creating new query (include aspect: %p).\n",
 			//(void*)descriptor.includeAspect)
 		}
 
-		Query& query = it->second;
+		Query& query = *it->second;
 		const u64 currentVersion = m_versionManager->getVersion(*descriptor.includeAspect);
 
 		if (query.m_includeVersion != currentVersion)
@@ -52,8 +64,8 @@ namespace spite
 
 			Aspect includeAspect(allIds.begin(), allIds.end());
 
-			query.rebuild(*m_archetypeManager);
-			query.m_includeVersion = m_versionManager->getVersion(includeAspect);
+			query->rebuild(*m_archetypeManager);
+			query->m_includeVersion = m_versionManager->getVersion(includeAspect);
 		}
 	}
 
@@ -31,9 +31,15 @@ namespace spite
     {
         ArchetypeManager* m_archetypeManager;
 		VersionManager* m_versionManager;
-        heap_unordered_map<QueryDescriptor, Query, QueryDescriptor::hash> m_queries;
+        HeapAllocator m_allocator;
+        // Queries are allocated separately, handles keep pointers to them while the table grows
+        heap_flat_map<QueryDescriptor, Query*, QueryDescriptor::hash> m_queries;
     public:
         QueryRegistry(const HeapAllocator& allocator, ArchetypeManager* archetypeManager, VersionManager* versionManager);
+        ~QueryRegistry();
+
+        QueryRegistry(const QueryRegistry&) = delete;
+        QueryRegistry& operator=(const QueryRegistry&) = delete;
 
         Query* findOrCreateQuery(const QueryDescriptor& descriptor);
 
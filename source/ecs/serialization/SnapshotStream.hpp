@@ -0,0 +1,133 @@
+#pragma once
+#include <cstring>
+#include <type_traits>
+
+#include "base/CollectionUtilities.hpp"
+
+namespace spite
+{
+	// Growable byte buffer the snapshot and custom component hooks are written into.
+	// Everything is addressed by offsets, the buffer may reallocate while it grows
+	class SnapshotWriter
+	{
+	private:
+		heap_vector<std::byte> m_buffer;
+
+	public:
+		SnapshotWriter(const HeapAllocator& allocator) : m_buffer(makeHeapVector<std::byte>(allocator))
+		{
+		}
+
+		// (returns offset of the written bytes)
+		sizet write(const void* data, sizet size)
+		{
+			const sizet offset = m_buffer.size();
+			m_buffer.resize(offset + size);
+			if (size != 0)
+			{
+				memcpy(m_buffer.data() + offset, data, size);
+			}
+			return offset;
+		}
+
+		template <typename T>
+			requires std::is_trivially_copyable_v<T>
+		sizet writeValue(const T& value)
+		{
+			return write(&value, sizeof(T));
+		}
+
+		// Zero filled space to be patched through at()
+		sizet reserve(sizet size)
+		{
+			const sizet offset = m_buffer.size();
+			m_buffer.resize(offset + size, std::byte{0});
+			return offset;
+		}
+
+		// Pads with zeros up to the alignment, relative to the start of the buffer
+		sizet align(sizet alignment)
+		{
+			const sizet misalignment = m_buffer.size() % alignment;
+			if (misalignment != 0)
+			{
+				reserve(alignment - misalignment);
+			}
+			return m_buffer.size();
+		}
+
+		template <typename T>
+			requires std::is_trivially_copyable_v<T>
+		T& at(sizet offset)
+		{
+			SASSERT(offset + sizeof(T) <= m_buffer.size())
+			return *reinterpret_cast<T*>(m_buffer.data() + offset);
+		}
+
+		// Drops everything written after size, the capacity is kept for reuse
+		void truncate(sizet size)
+		{
+			SASSERT(size <= m_buffer.size())
+			m_buffer.resize(size);
+		}
+
+		std::byte* data() { return m_buffer.data(); }
+		const std::byte* data() const { return m_buffer.data(); }
+		sizet size() const { return m_buffer.size(); }
+	};
+
+	// Bounds-checked cursor over snapshot bytes.
+	// Reading past the end fails the reader and yields zeros instead of asserting, snapshots come from disk
+	class SnapshotReader
+	{
+	private:
+		const std::byte* m_data;
+		sizet m_size;
+		sizet m_position = 0;
+		bool m_failed = false;
+
+	public:
+		SnapshotReader(const std::byte* data, sizet size) : m_data(data), m_size(size)
+		{
+		}
+
+		bool read(void* destination, sizet size)
+		{
+			if (m_failed || size > m_size - m_position)
+			{
+				m_failed = true;
+				memset(destination, 0, size);
+				return false;
+			}
+			memcpy(destination, m_data + m_position, size);
+			m_position += size;
+			return true;
+		}
+
+		template <typename T>
+			requires std::is_trivially_copyable_v<T>
+		T readValue()
+		{
+			T value;
+			read(&value, sizeof(T));
+			return value;
+		}
+
+		// (returns nullptr and fails the reader if fewer than size bytes are left)
+		const std::byte* skip(sizet size)
+		{
+			if (m_failed || size > m_size - m_position)
+			{
+				m_failed = true;
+				return nullptr;
+			}
+			const std::byte* current = m_data + m_position;
+			m_position += size;
+			return current;
+		}
+
+		sizet position() const { return m_position; }
+		sizet remaining() const { return m_failed ? 0 : m_size - m_position; }
+		bool failed() const { return m_failed; }
+	};
+}
@@ -0,0 +1,374 @@
+#include "WorldHistory.hpp"
+
+#include "ecs/core/EntityManager.hpp"
+
+namespace spite
+{
+	namespace
+	{
+		// Delta layout: u32 archetype count | archetypes | u8 has indices [| u32 count | generations | u32 count | free indices].
+		// Every archetype is followed by its changed chunks, every chunk by its entities and enabled masks
+		// if its structure changed, then by the changed columns
+		struct DeltaArchetype
+		{
+			u32 archetypeId;
+			u32 columnCount;
+			u32 chunkCount;
+			u32 changedChunkCount;
+		};
+
+		struct DeltaChunk
+		{
+			u32 chunkIndex;
+			u32 entityCount;
+			u32 changedColumnCount;
+			u32 structural;
+		};
+
+		struct DeltaColumn
+		{
+			u32 column;
+			u32 padding;
+			u64 size;
+		};
+
+		void writeColumn(const Chunk& chunk, sizet column, SnapshotWriter& writer)
+		{
+			const auto& metadata = ComponentMetadataRegistry::getMetadata(chunk.aspect().getComponentIds()[column]);
+			const std::byte* array = chunk.getComponentArrayByIndex(column);
+			const sizet headerOffset = writer.writeValue(DeltaColumn{static_cast<u32>(column), 0, 0});
+			const sizet dataOffset = writer.size();
+
+			switch (metadata.serializationMode)
+			{
+			case SerializationMode::eRaw:
+				writer.write(array, chunk.size() * metadata.size);
+				break;
+			case SerializationMode::eCustom:
+				for (sizet i = 0; i < chunk.size(); ++i)
+				{
+					metadata.serialize(array + i * metadata.size, writer);
+				}
+				break;
+			default:
+				SASSERTM(false, "WorldHistory cannot record component %u, it needs serialize/deserialize hooks\n",
+				         metadata.id)
+			}
+			writer.at<DeltaColumn>(headerOffset).size = writer.size() - dataOffset;
+		}
+
+		template <typename T>
+		void readArray(SnapshotReader& reader, heap_vector<T>& values)
+		{
+			values.resize(reader.readValue<u32>());
+			reader.read(values.data(), values.size() * sizeof(T));
+		}
+
+		template <typename T>
+		void writeArray(SnapshotWriter& writer, eastl::span<const T> values)
+		{
+			writer.writeValue(static_cast<u32>(values.size()));
+			writer.write(values.data(), values.size() * sizeof(T));
+		}
+	}
+
+	WorldHistory::ChunkImage::ChunkImage(const HeapAllocator& allocator, sizet columnCount)
+		: enabledMasks(makeHeapVector<u64>(allocator)),
+		  columns(makeHeapVector<heap_vector<std::byte>>(allocator))
+	{
+		enabledMasks.resize(columnCount, 0);
+		columns.reserve(columnCount);
+		for (sizet i = 0; i < columnCount; ++i)
+		{
+			columns.push_back(makeHeapVector<std::byte>(allocator));
+		}
+	}
+
+	WorldHistory::ArchetypeImage::ArchetypeImage(const HeapAllocator& allocator)
+		: chunks(makeHeapVector<ChunkImage>(allocator))
+	{
+	}
+
+	WorldHistory::WorldImage::WorldImage(const HeapAllocator& allocator)
+		: archetypes(makeHeapVector<ArchetypeImage>(allocator)),
+		  generations(makeHeapVector<u32>(allocator)),
+		  freeIndices(makeHeapVector<u32>(allocator))
+	{
+	}
+
+	WorldHistory::ArchetypeTrack::ArchetypeTrack(const HeapAllocator& allocator)
+		: chunks(makeHeapVector<const Chunk*>(allocator)),
+		  versions(makeHeapVector<u32>(allocator))
+	{
+	}
+
+	WorldHistory::WorldHistory(EntityManager& entityManager, sizet capacity, const HeapAllocator& allocator)
+		: m_entityManager(&entityManager),
+		  m_allocator(allocator),
+		  m_base(allocator),
+		  m_tracks(makeHeapVector<ArchetypeTrack>(allocator)),
+		  m_frames(makeHeapVector<SnapshotWriter>(allocator))
+	{
+		SASSERT(capacity > 0)
+		m_frames.reserve(capacity);
+		for (sizet i = 0; i < capacity; ++i)
+		{
+			m_frames.emplace_back(allocator);
+		}
+	}
+
+	u64 WorldHistory::capture()
+	{
+		if (m_nextFrame - m_oldestFrame == m_frames.size())
+		{
+			applyDelta(m_base, m_oldestFrame);
+			++m_oldestFrame;
+		}
+
+		const ArchetypeManager& archetypeManager = *m_entityManager->getArchetypeManager();
+		SnapshotWriter& writer = m_frames[m_nextFrame % m_frames.size()];
+		writer.truncate(0);
+
+		const sizet archetypeCountOffset = writer.reserve(sizeof(u32));
+		u32 archetypeCount = 0;
+		// The base image always starts with the entity indices
+		bool hasStructuralChanges = m_nextFrame == 0;
+
+		for (u32 archetypeId = 0, size = static_cast<u32>(archetypeManager.archetypeCount()); archetypeId < size; ++
+		     archetypeId)
+		{
+			if (archetypeId == m_tracks.size())
+			{
+				m_tracks.emplace_back(m_allocator);
+			}
+
+			const Archetype* archetype = archetypeManager.getArchetypeById(archetypeId);
+			const auto& chunks = archetype->getChunks();
+			const ArchetypeTrack& track = m_tracks[archetypeId];
+			const u32 columnCount = static_cast<u32>(archetype->aspect().size());
+			const sizet stride = columnCount + 1;
+
+			const sizet archetypeOffset = writer.writeValue(DeltaArchetype{
+				archetypeId, columnCount, static_cast<u32>(chunks.size()), 0
+			});
+			u32 changedChunkCount = 0;
+
+			for (sizet chunkIndex = 0; chunkIndex < chunks.size(); ++chunkIndex)
+			{
+				const Chunk& chunk = *chunks[chunkIndex];
+				const u32* versions = chunkIndex < track.chunks.size() ? &track.versions[chunkIndex * stride] : nullptr;
+				const bool structural = !versions || track.chunks[chunkIndex] != &chunk ||
+					versions[0] != chunk.structureVersion();
+
+				const sizet chunkOffset = writer.writeValue(DeltaChunk{
+					static_cast<u32>(chunkIndex), static_cast<u32>(chunk.size()), 0, structural
+				});
+				if (structural)
+				{
+					const auto entities = chunk.entities();
+					writer.write(entities.data(), entities.size() * sizeof(Entity));
+					for (sizet column = 0; column < columnCount; ++column)
+					{
+						writer.writeValue(chunk.getEnabledMaskByIndex(column));
+					}
+				}
+
+				u32 changedColumnCount = 0;
+				for (sizet column = 0; column < columnCount; ++column)
+				{
+					if (structural || versions[column + 1] != chunk.columnVersionByIndex(column))
+					{
+						writeColumn(chunk, column, writer);
+						++changedColumnCount;
+					}
+				}
+
+				if (!structural && changedColumnCount == 0)
+				{
+					writer.truncate(chunkOffset);
+					continue;
+				}
+				writer.at<DeltaChunk>(chunkOffset).changedColumnCount = changedColumnCount;
+				hasStructuralChanges |= structural;
+				++changedChunkCount;
+			}
+
+			if (changedChunkCount == 0 && chunks.size() == track.chunks.size())
+			{
+				writer.truncate(archetypeOffset);
+				continue;
+			}
+
+			writer.at<DeltaArchetype>(archetypeOffset).changedChunkCount = changedChunkCount;
+			hasStructuralChanges |= chunks.size() != track.chunks.size();
+			++archetypeCount;
+			updateTrack(archetypeId);
+		}
+		writer.at<u32>(archetypeCountOffset) = archetypeCount;
+
+		// Creating or destroying an entity always changes the structure of some chunk
+		writer.writeValue(static_cast<u8>(hasStructuralChanges));
+		if (hasStructuralChanges)
+		{
+			writeArray(writer, m_entityManager->getGenerations());
+			writeArray(writer, m_entityManager->getFreeIndices());
+		}
+
+		return m_nextFrame++;
+	}
+
+	void WorldHistory::updateTrack(u32 archetypeId)
+	{
+		const auto& chunks = m_entityManager->getArchetypeManager()->getArchetypeById(archetypeId)->getChunks();
+		ArchetypeTrack& track = m_tracks[archetypeId];
+		track.chunks.clear();
+		track.versions.clear();
+		for (const Chunk* chunk : chunks)
+		{
+			track.chunks.push_back(chunk);
+			track.versions.push_back(chunk->structureVersion());
+			for (sizet column = 0, size = chunk->aspect().size(); column < size; ++column)
+			{
+				track.versions.push_back(chunk->columnVersionByIndex(column));
+			}
+		}
+	}
+
+	void WorldHistory::applyDelta(WorldImage& image, u64 frame) const
+	{
+		const SnapshotWriter& delta = m_frames[frame % m_frames.size()];
+		SnapshotReader reader(delta.data(), delta.size());
+
+		const u32 archetypeCount = reader.readValue<u32>();
+		for (u32 i = 0; i < archetypeCount; ++i)
+		{
+			const auto archetype = reader.readValue<DeltaArchetype>();
+			while (image.archetypes.size() <= archetype.archetypeId)
+			{
+				image.archetypes.emplace_back(m_allocator);
+			}
+
+			auto& chunks = image.archetypes[archetype.archetypeId].chunks;
+			while (chunks.size() < archetype.chunkCount)
+			{
+				chunks.emplace_back(m_allocator, archetype.columnCount);
+			}
+			while (chunks.size() > archetype.chunkCount)
+			{
+				chunks.pop_back();
+			}
+
+			for (u32 j = 0; j < archetype.changedChunkCount; ++j)
+			{
+				const auto chunkDelta = reader.readValue<DeltaChunk>();
+				ChunkImage& chunk = chunks[chunkDelta.chunkIndex];
+				if (chunkDelta.structural)
+				{
+					chunk.count = chunkDelta.entityCount;
+					reader.read(chunk.entities.data(), chunk.count * sizeof(Entity));
+					reader.read(chunk.enabledMasks.data(), archetype.columnCount * sizeof(u64));
+				}
+
+				for (u32 k = 0; k < chunkDelta.changedColumnCount; ++k)
+				{
+					const auto column = reader.readValue<DeltaColumn>();
+					auto& bytes = chunk.columns[column.column];
+					bytes.resize(column.size);
+					reader.read(bytes.data(), column.size);
+				}
+			}
+		}
+
+		if (reader.readValue<u8>())
+		{
+			readArray(reader, image.generations);
+			readArray(reader, image.freeIndices);
+		}
+		SASSERT(!reader.failed() && reader.remaining() == 0)
+	}
+
+	void WorldHistory::writeImage(const WorldImage& image)
+	{
+		ArchetypeManager& archetypeManager = *m_entityManager->getArchetypeManager();
+		for (u32 archetypeId = 0, size = static_cast<u32>(archetypeManager.archetypeCount()); archetypeId < size; ++
+		     archetypeId)
+		{
+			archetypeManager.clearArchetype(archetypeId);
+		}
+
+		for (u32 archetypeId = 0; archetypeId < image.archetypes.size(); ++archetypeId)
+		{
+			const Aspect& aspect = archetypeManager.getArchetypeById(archetypeId)->aspect();
+			const auto& componentIds = aspect.getComponentIds();
+			for (const ChunkImage& chunkImage : image.archetypes[archetypeId].chunks)
+			{
+				Chunk* chunk = archetypeManager.restoreChunk(
+					aspect,
+					{chunkImage.entities.data(), chunkImage.count},
+					{chunkImage.enabledMasks.data(), chunkImage.enabledMasks.size()});
+
+				for (sizet column = 0; column < componentIds.size(); ++column)
+				{
+					const auto& metadata = ComponentMetadataRegistry::getMetadata(componentIds[column]);
+					const auto& bytes = chunkImage.columns[column];
+					std::byte* array = chunk->getComponentArrayByIndex(column);
+					if (metadata.serializationMode == SerializationMode::eRaw)
+					{
+						memcpy(array, bytes.data(), bytes.size());
+						continue;
+					}
+
+					SnapshotReader reader(bytes.data(), bytes.size());
+					for (sizet i = 0; i < chunkImage.count; ++i)
+					{
+						metadata.deserialize(array + i * metadata.size, reader);
+					}
+				}
+			}
+		}
+
+		m_entityManager->restoreEntityIndices({image.generations.data(), image.generations.size()},
+		                                      {image.freeIndices.data(), image.freeIndices.size()});
+	}
+
+	void WorldHistory::restore(u64 frame)
+	{
+		SASSERTM(contains(frame), "Frame %llu is not in the history\n", frame)
+
+		WorldImage image = m_base;
+		for (u64 i = m_oldestFrame; i <= frame; ++i)
+		{
+			applyDelta(image, i);
+		}
+		writeImage(image);
+
+		m_nextFrame = frame + 1;
+		for (u32 archetypeId = 0; archetypeId < m_tracks.size(); ++archetypeId)
+		{
+			updateTrack(archetypeId);
+		}
+	}
+
+	bool WorldHistory::contains(u64 frame) const
+	{
+		return frame >= m_oldestFrame && frame < m_nextFrame;
+	}
+
+	u64 WorldHistory::oldestFrame() const
+	{
+		SASSERT(m_nextFrame != m_oldestFrame)
+		return m_oldestFrame;
+	}
+
+	u64 WorldHistory::newestFrame() const
+	{
+		SASSERT(m_nextFrame != m_oldestFrame)
+		return m_nextFrame - 1;
+	}
+
+	sizet WorldHistory::frameSize(u64 frame) const
+	{
+		SASSERT(contains(frame))
+		return m_frames[frame % m_frames.size()].size();
+	}
+}
@@ -0,0 +1,87 @@
+#pragma once
+#include "ecs/serialization/SnapshotStream.hpp"
+#include "ecs/storage/Chunk.hpp"
+
+namespace spite
+{
+	class EntityManager;
+
+	// Ring of per-frame world deltas for replays and rollback debugging.
+	// A capture records only the chunks and columns whose change versions moved since the previous capture,
+	// so its cost follows the amount of changed data. Frames leaving the ring are folded into a base image.
+	// Every column of a recorded world must be eRaw or eCustom, shared components and singletons are not recorded
+	class WorldHistory
+	{
+	private:
+		struct ChunkImage
+		{
+			u32 count = 0;
+			eastl::array<Entity, DEFAULT_CHUNK_CAPACITY> entities;
+			heap_vector<u64> enabledMasks;
+			// Raw column bytes or the custom serialized elements
+			heap_vector<heap_vector<std::byte>> columns;
+
+			ChunkImage(const HeapAllocator& allocator, sizet columnCount);
+		};
+
+		struct ArchetypeImage
+		{
+			heap_vector<ChunkImage> chunks;
+
+			ArchetypeImage(const HeapAllocator& allocator);
+		};
+
+		struct WorldImage
+		{
+			heap_vector<ArchetypeImage> archetypes;
+			heap_vector<u32> generations;
+			heap_vector<u32> freeIndices;
+
+			WorldImage(const HeapAllocator& allocator);
+		};
+
+		// Change versions seen by the last capture, structure version followed by column versions for every chunk
+		struct ArchetypeTrack
+		{
+			heap_vector<const Chunk*> chunks;
+			heap_vector<u32> versions;
+
+			ArchetypeTrack(const HeapAllocator& allocator);
+		};
+
+		EntityManager* m_entityManager;
+		HeapAllocator m_allocator;
+
+		// State before the oldest frame in the ring
+		WorldImage m_base;
+		heap_vector<ArchetypeTrack> m_tracks;
+		// Frame n is kept in slot n % capacity
+		heap_vector<SnapshotWriter> m_frames;
+		u64 m_oldestFrame = 0;
+		u64 m_nextFrame = 0;
+
+		void applyDelta(WorldImage& image, u64 frame) const;
+		void writeImage(const WorldImage& image);
+		void updateTrack(u32 archetypeId);
+
+	public:
+		WorldHistory(EntityManager& entityManager, sizet capacity, const HeapAllocator& allocator);
+
+		// Records the changes since the previous capture, the first capture records the whole world
+		// (returns the captured frame number)
+		u64 capture();
+
+		// Rewinds entity storage and indices to a frame in the ring, frames after it are dropped.
+		// Restored entities are reported to observers as removed and added again
+		void restore(u64 frame);
+
+		[[nodiscard]] bool contains(u64 frame) const;
+
+		// (only valid if a frame was captured)
+		[[nodiscard]] u64 oldestFrame() const;
+		[[nodiscard]] u64 newestFrame() const;
+
+		// Bytes recorded for a frame in the ring
+		[[nodiscard]] sizet frameSize(u64 frame) const;
+	};
+}
@@ -0,0 +1,661 @@
+#include "WorldSnapshot.hpp"
+
+#include <algorithm>
+#include <fstream>
+
+#include "base/Logging.hpp"
+#include "ecs/core/EntityManager.hpp"
+
+namespace spite
+{
+	namespace
+	{
+		constexpr u32 NOT_WRITTEN = U32_MAX;
+
+		bool isColumnWritten(ComponentID id, const SharedComponentManager& sharedComponentManager)
+		{
+			const auto& metadata = ComponentMetadataRegistry::getMetadata(id);
+			switch (metadata.serializationMode)
+			{
+			case SerializationMode::eRaw:
+			case SerializationMode::eCustom:
+				return true;
+			case SerializationMode::eSharedHandle:
+				return sharedComponentManager.getPools().count(id) != 0;
+			default:
+				return false;
+			}
+		}
+
+		bool isAdoptable(SerializationMode mode, sizet alignment)
+		{
+			return mode != SerializationMode::eCustom && alignment <= WORLD_SNAPSHOT_BLOCK_ALIGNMENT;
+		}
+
+		// Handles keep their data index, only the component id of the current run is written back
+		void relocateSharedHandles(std::byte* column, sizet count, ComponentID id)
+		{
+			const sizet stride = ComponentMetadataRegistry::getMetadata(id).size;
+			for (sizet i = 0; i < count; ++i)
+			{
+				auto* handle = reinterpret_cast<SharedComponentHandle*>(column + i * stride);
+				if (handle->componentId != INVALID_COMPONENT_ID)
+				{
+					handle->componentId = id;
+				}
+			}
+		}
+	}
+
+	void WorldSnapshot::write(const EntityManager& entityManager, SnapshotWriter& writer)
+	{
+		const ArchetypeManager& archetypeManager = *entityManager.getArchetypeManager();
+		const SharedComponentManager& sharedComponentManager = *entityManager.getSharedComponentManager();
+
+		auto marker = FrameScratchAllocator::get().get_scoped_marker();
+
+		// Component table, every component that is written at least once
+		auto fileComponentIndices = makeScratchVector<u32>(FrameScratchAllocator::get());
+		fileComponentIndices.resize(ComponentMetadataRegistry::getRegisteredComponentCount(), NOT_WRITTEN);
+		auto components = makeScratchVector<ComponentID>(FrameScratchAllocator::get());
+
+		// Written archetypes and the aspect positions of their columns
+		auto archetypes = makeScratchVector<const Archetype*>(FrameScratchAllocator::get());
+		auto columnIndices = makeScratchVector<u32>(FrameScratchAllocator::get());
+		auto archetypeFirstColumns = makeScratchVector<u32>(FrameScratchAllocator::get());
+		u32 chunkCount = 0;
+
+		for (sizet archetypeId = 0; archetypeId < archetypeManager.archetypeCount(); ++archetypeId)
+		{
+			const Archetype* archetype = archetypeManager.getArchetypeById(static_cast<u32>(archetypeId));
+			if (archetype->isEmpty())
+			{
+				continue;
+			}
+
+			archetypes.push_back(archetype);
+			archetypeFirstColumns.push_back(static_cast<u32>(columnIndices.size()));
+			const auto& componentIds = archetype->aspect().getComponentIds();
+			for (sizet i = 0; i < componentIds.size(); ++i)
+			{
+				const ComponentID id = componentIds[i];
+				if (!isColumnWritten(id, sharedComponentManager))
+				{
+					continue;
+				}
+				if (fileComponentIndices[id] == NOT_WRITTEN)
+				{
+					fileComponentIndices[id] = static_cast<u32>(components.size());
+					components.push_back(id);
+				}
+				columnIndices.push_back(static_cast<u32>(i));
+			}
+
+			for (const Chunk* chunk : archetype->getChunks())
+			{
+				chunkCount += chunk->empty() ? 0 : 1;
+			}
+		}
+		archetypeFirstColumns.push_back(static_cast<u32>(columnIndices.size()));
+
+		const sizet headerOffset = writer.reserve(sizeof(SnapshotHeader));
+
+		writer.align(alignof(u64));
+		const sizet componentsOffset = writer.size();
+		for (const ComponentID id : components)
+		{
+			const auto& metadata = ComponentMetadataRegistry::getMetadata(id);
+			SnapshotComponent component{};
+			component.typeHash = metadata.typeHash;
+			component.size = static_cast<u32>(metadata.size);
+			component.alignment = static_cast<u32>(metadata.alignment);
+			component.mode = metadata.serializationMode;
+			writer.writeValue(component);
+		}
+
+		const sizet archetypesOffset = writer.reserve(archetypes.size() * sizeof(SnapshotArchetype));
+		const sizet columnsOffset = writer.reserve(columnIndices.size() * sizeof(SnapshotColumn));
+		const sizet chunksOffset = writer.reserve(chunkCount * sizeof(SnapshotChunk));
+
+		const auto generations = entityManager.getGenerations();
+		const auto freeIndices = entityManager.getFreeIndices();
+		const sizet generationsOffset = writer.write(generations.data(), generations.size() * sizeof(u32));
+		const sizet freeIndicesOffset = writer.write(freeIndices.data(), freeIndices.size() * sizeof(u32));
+
+		// Shared pools of written handle columns
+		auto pools = makeScratchVector<ComponentID>(FrameScratchAllocator::get());
+		for (const ComponentID id : components)
+		{
+			if (ComponentMetadataRegistry::getMetadata(id).serializationMode == SerializationMode::eSharedHandle)
+			{
+				pools.push_back(id);
+			}
+		}
+		writer.align(alignof(u64));
+		const sizet sharedPoolsOffset = writer.reserve(pools.size() * sizeof(SnapshotSharedPool));
+		for (sizet i = 0; i < pools.size(); ++i)
+		{
+			const sizet poolOffset = writer.align(alignof(u64));
+			sharedComponentManager.getPools().at(pools[i])->serialize(writer);
+
+			auto& pool = writer.at<SnapshotSharedPool>(sharedPoolsOffset + i * sizeof(SnapshotSharedPool));
+			pool.component = fileComponentIndices[pools[i]];
+			pool.offset = poolOffset;
+			pool.size = writer.size() - poolOffset;
+		}
+
+		// Chunk data
+		u32 chunkIndex = 0;
+		auto columnOffsets = makeScratchVector<sizet>(FrameScratchAllocator::get());
+		auto columnIds = makeScratchVector<ComponentID>(FrameScratchAllocator::get());
+		for (sizet archetypeIndex = 0; archetypeIndex < archetypes.size(); ++archetypeIndex)
+		{
+			const Archetype* archetype = archetypes[archetypeIndex];
+			const auto& componentIds = archetype->aspect().getComponentIds();
+			const u32 firstColumn = archetypeFirstColumns[archetypeIndex];
+			const u32 columnCount = archetypeFirstColumns[archetypeIndex + 1] - firstColumn;
+
+			columnIds.clear();
+			for (u32 column = 0; column < columnCount; ++column)
+			{
+				columnIds.push_back(componentIds[columnIndices[firstColumn + column]]);
+			}
+			columnOffsets.resize(columnCount);
+			sizet blockAlignment;
+			const sizet blockSize = Chunk::computeColumnOffsets({columnIds.data(), columnIds.size()},
+			                                                    {columnOffsets.data(), columnOffsets.size()},
+			                                                    blockAlignment);
+
+			const u32 firstChunk = chunkIndex;
+			for (const Chunk* chunk : archetype->getChunks())
+			{
+				if (chunk->empty())
+				{
+					continue;
+				}
+
+				const sizet count = chunk->size();
+				const auto entities = chunk->entities();
+
+				writer.align(alignof(u64));
+				const sizet entitiesOffset = writer.write(entities.data(), count * sizeof(Entity));
+				const sizet enabledMasksOffset = writer.size();
+				for (u32 column = 0; column < columnCount; ++column)
+				{
+					writer.writeValue(chunk->getEnabledMaskByIndex(columnIndices[firstColumn + column]));
+				}
+
+				// Full capacity, so the block can be adopted as chunk storage
+				writer.align(WORLD_SNAPSHOT_BLOCK_ALIGNMENT);
+				const sizet blockOffset = writer.reserve(blockSize);
+				for (u32 column = 0; column < columnCount; ++column)
+				{
+					const auto& metadata = ComponentMetadataRegistry::getMetadata(columnIds[column]);
+					if (metadata.serializationMode == SerializationMode::eCustom)
+					{
+						continue;
+					}
+					memcpy(writer.data() + blockOffset + columnOffsets[column],
+					       chunk->getComponentArrayByIndex(columnIndices[firstColumn + column]), count * metadata.size);
+				}
+
+				const sizet customOffset = writer.size();
+				for (u32 column = 0; column < columnCount; ++column)
+				{
+					const auto& metadata = ComponentMetadataRegistry::getMetadata(columnIds[column]);
+					if (metadata.serializationMode != SerializationMode::eCustom)
+					{
+						continue;
+					}
+					const std::byte* array = chunk->getComponentArrayByIndex(columnIndices[firstColumn + column]);
+					for (sizet i = 0; i < count; ++i)
+					{
+						metadata.serialize(array + i * metadata.size, writer);
+					}
+				}
+
+				auto& entry = writer.at<SnapshotChunk>(chunksOffset + chunkIndex * sizeof(SnapshotChunk));
+				entry.archetype = static_cast<u32>(archetypeIndex);
+				entry.entityCount = static_cast<u32>(count);
+				entry.entitiesOffset = entitiesOffset;
+				entry.enabledMasksOffset = enabledMasksOffset;
+				entry.blockOffset = blockOffset;
+				entry.customOffset = customOffset;
+				entry.customSize = writer.size() - customOffset;
+				++chunkIndex;
+			}
+
+			for (u32 column = 0; column < columnCount; ++column)
+			{
+				auto& entry = writer.at<SnapshotColumn>(columnsOffset + (firstColumn + column) * sizeof(SnapshotColumn));
+				entry.component = fileComponentIndices[columnIds[column]];
+				entry.offset = columnOffsets[column];
+			}
+
+			auto& entry = writer.at<SnapshotArchetype>(archetypesOffset + archetypeIndex * sizeof(SnapshotArchetype));
+			entry.firstColumn = firstColumn;
+			entry.columnCount = columnCount;
+			entry.firstChunk = firstChunk;
+			entry.chunkCount = chunkIndex - firstChunk;
+			entry.blockSize = blockSize;
+		}
+
+		auto& header = writer.at<SnapshotHeader>(headerOffset);
+		header.magic = WORLD_SNAPSHOT_MAGIC;
+		header.version = WORLD_SNAPSHOT_VERSION;
+		header.fileSize = writer.size();
+		header.chunkCapacity = DEFAULT_CHUNK_CAPACITY;
+		header.componentCount = static_cast<u32>(components.size());
+		header.archetypeCount = static_cast<u32>(archetypes.size());
+		header.columnCount = static_cast<u32>(columnIndices.size());
+		header.chunkCount = chunkCount;
+		header.generationCount = static_cast<u32>(generations.size());
+		header.freeIndexCount = static_cast<u32>(freeIndices.size());
+		header.sharedPoolCount = static_cast<u32>(pools.size());
+		header.componentsOffset = componentsOffset;
+		header.archetypesOffset = archetypesOffset;
+		header.columnsOffset = columnsOffset;
+		header.chunksOffset = chunksOffset;
+		header.generationsOffset = generationsOffset;
+		header.freeIndicesOffset = freeIndicesOffset;
+		header.sharedPoolsOffset = sharedPoolsOffset;
+	}
+
+	bool WorldSnapshot::save(const EntityManager& entityManager, cstring path, const HeapAllocator& allocator)
+	{
+		SnapshotWriter writer(allocator);
+		write(entityManager, writer);
+
+		std::ofstream file(path, std::ios::out | std::ios::binary);
+		if (!file.is_open())
+		{
+			SDEBUG_LOG("WARNING: snapshot file %s could not be opened for writing\n", path)
+			return false;
+		}
+		file.write(reinterpret_cast<const char*>(writer.data()), static_cast<std::streamsize>(writer.size()));
+		return file.good();
+	}
+
+	bool WorldSnapshot::load(EntityManager& entityManager, cstring path)
+	{
+		MappedFile file;
+		if (!file.open(path))
+		{
+			return false;
+		}
+		return load(entityManager, std::move(file));
+	}
+
+	bool WorldSnapshot::load(EntityManager& entityManager, MappedFile&& file)
+	{
+		SASSERTM(entityManager.isPristine(), "World snapshot can only be loaded before any entity is created\n")
+		if (!file.isOpen())
+		{
+			return false;
+		}
+
+		std::byte* base = file.data();
+		const sizet size = file.size();
+		auto inBounds = [size](u64 offset, u64 bytes)
+		{
+			return offset <= size && bytes <= size - offset;
+		};
+		auto fail = [](cstring reason)
+		{
+			SDEBUG_LOG("WARNING: world snapshot rejected, %s\n", reason)
+			return false;
+		};
+
+		// --- Validate everything before the world is touched ---
+		if (!inBounds(0, sizeof(SnapshotHeader)))
+		{
+			return fail("file is too small");
+		}
+		const auto& header = *reinterpret_cast<const SnapshotHeader*>(base);
+		if (header.magic != WORLD_SNAPSHOT_MAGIC || header.version != WORLD_SNAPSHOT_VERSION)
+		{
+			return fail("unknown format or version");
+		}
+		if (header.fileSize != size || header.chunkCapacity != DEFAULT_CHUNK_CAPACITY)
+		{
+			return fail("size or chunk capacity mismatch");
+		}
+		if (!inBounds(header.componentsOffset, header.componentCount * sizeof(SnapshotComponent)) ||
+			!inBounds(header.archetypesOffset, header.archetypeCount * sizeof(SnapshotArchetype)) ||
+			!inBounds(header.columnsOffset, header.columnCount * sizeof(SnapshotColumn)) ||
+			!inBounds(header.chunksOffset, header.chunkCount * sizeof(SnapshotChunk)) ||
+			!inBounds(header.generationsOffset, header.generationCount * sizeof(u32)) ||
+			!inBounds(header.freeIndicesOffset, header.freeIndexCount * sizeof(u32)) ||
+			!inBounds(header.sharedPoolsOffset, header.sharedPoolCount * sizeof(SnapshotSharedPool)) ||
+			header.generationCount == 0)
+		{
+			return fail("table out of bounds");
+		}
+
+		const auto* fileComponents = reinterpret_cast<const SnapshotComponent*>(base + header.componentsOffset);
+		const auto* fileArchetypes = reinterpret_cast<const SnapshotArchetype*>(base + header.archetypesOffset);
+		const auto* fileColumns = reinterpret_cast<const SnapshotColumn*>(base + header.columnsOffset);
+		const auto* fileChunks = reinterpret_cast<const SnapshotChunk*>(base + header.chunksOffset);
+		const auto* filePools = reinterpret_cast<const SnapshotSharedPool*>(base + header.sharedPoolsOffset);
+
+		auto marker = FrameScratchAllocator::get().get_scoped_marker();
+
+		auto componentIds = makeScratchVector<ComponentID>(FrameScratchAllocator::get());
+		componentIds.reserve(header.componentCount);
+		for (u32 i = 0; i < header.componentCount; ++i)
+		{
+			const SnapshotComponent& component = fileComponents[i];
+			const ComponentID id = ComponentMetadataRegistry::findComponentIdByTypeHash(component.typeHash);
+			if (id == INVALID_COMPONENT_ID)
+			{
+				return fail("component type is not registered");
+			}
+			const auto& metadata = ComponentMetadataRegistry::getMetadata(id);
+			if (metadata.size != component.size || metadata.alignment != component.alignment ||
+				metadata.serializationMode != component.mode)
+			{
+				return fail("component layout changed");
+			}
+			componentIds.push_back(id);
+		}
+
+		for (u32 i = 0; i < header.archetypeCount; ++i)
+		{
+			const SnapshotArchetype& archetype = fileArchetypes[i];
+			if (archetype.firstColumn > header.columnCount ||
+				archetype.columnCount > header.columnCount - archetype.firstColumn ||
+				archetype.firstChunk > header.chunkCount ||
+				archetype.chunkCount > header.chunkCount - archetype.firstChunk)
+			{
+				return fail("archetype out of bounds");
+			}
+			for (u32 column = archetype.firstColumn; column < archetype.firstColumn + archetype.columnCount; ++column)
+			{
+				const SnapshotColumn& fileColumn = fileColumns[column];
+				if (fileColumn.component >= header.componentCount)
+				{
+					return fail("column out of bounds");
+				}
+				// Written as a difference so a huge offset cannot wrap past the check
+				const SnapshotComponent& component = fileComponents[fileColumn.component];
+				if (fileColumn.offset > archetype.blockSize ||
+					static_cast<u64>(component.size) * DEFAULT_CHUNK_CAPACITY > archetype.blockSize - fileColumn.offset)
+				{
+					return fail("column out of bounds");
+				}
+				if (fileColumn.offset % component.alignment != 0)
+				{
+					return fail("misaligned column");
+				}
+				for (u32 other = archetype.firstColumn; other < column; ++other)
+				{
+					if (componentIds[fileColumns[other].component] == componentIds[fileColumn.component])
+					{
+						return fail("archetype has duplicate columns");
+					}
+				}
+			}
+		}
+
+		for (u32 i = 0; i < header.chunkCount; ++i)
+		{
+			const SnapshotChunk& chunk = fileChunks[i];
+			if (chunk.archetype >= header.archetypeCount || chunk.entityCount > DEFAULT_CHUNK_CAPACITY)
+			{
+				return fail("chunk out of bounds");
+			}
+			const SnapshotArchetype& archetype = fileArchetypes[chunk.archetype];
+			if (i < archetype.firstChunk || i >= archetype.firstChunk + archetype.chunkCount ||
+				!inBounds(chunk.entitiesOffset, chunk.entityCount * sizeof(Entity)) ||
+				!inBounds(chunk.enabledMasksOffset, archetype.columnCount * sizeof(u64)) ||
+				!inBounds(chunk.blockOffset, archetype.blockSize) ||
+				!inBounds(chunk.customOffset, chunk.customSize) ||
+				chunk.entitiesOffset % alignof(Entity) != 0 || chunk.blockOffset % WORLD_SNAPSHOT_BLOCK_ALIGNMENT != 0)
+			{
+				return fail("chunk data out of bounds");
+			}
+		}
+
+		for (u32 i = 0; i < header.sharedPoolCount; ++i)
+		{
+			const SnapshotSharedPool& pool = filePools[i];
+			if (pool.component >= header.componentCount || !inBounds(pool.offset, pool.size) ||
+				fileComponents[pool.component].mode != SerializationMode::eSharedHandle)
+			{
+				return fail("shared pool out of bounds");
+			}
+		}
+
+		// Every chunk entity must be live in the generations table and stored once
+		const auto* generations = reinterpret_cast<const u32*>(base + header.generationsOffset);
+		const auto* freeIndices = reinterpret_cast<const u32*>(base + header.freeIndicesOffset);
+		auto indexTaken = makeScratchVector<u8>(FrameScratchAllocator::get());
+		indexTaken.resize(header.generationCount, 0);
+		for (u32 i = 0; i < header.freeIndexCount; ++i)
+		{
+			const u32 index = freeIndices[i];
+			if (index == 0 || index >= header.generationCount || indexTaken[index])
+			{
+				return fail("free index out of bounds");
+			}
+			indexTaken[index] = 1;
+		}
+		for (u32 i = 0; i < header.chunkCount; ++i)
+		{
+			const SnapshotChunk& chunk = fileChunks[i];
+			const auto* entities = reinterpret_cast<const Entity*>(base + chunk.entitiesOffset);
+			for (u32 e = 0; e < chunk.entityCount; ++e)
+			{
+				const u32 index = entities[e].index();
+				if (index == 0 || index >= header.generationCount || indexTaken[index] ||
+					generations[index] != entities[e].generation())
+				{
+					return fail("chunk entity was never allocated");
+				}
+				indexTaken[index] = 1;
+			}
+		}
+
+		// Custom columns are deserialized up front so truncated data is found before the world is touched.
+		// Per chunk, one array per custom column in snapshot column order
+		SharedComponentManager& sharedComponentManager = *entityManager.getSharedComponentManager();
+		auto customArrays = makeScratchVector<std::byte*>(FrameScratchAllocator::get());
+		auto firstCustomArrays = makeScratchVector<u32>(FrameScratchAllocator::get());
+		firstCustomArrays.reserve(header.chunkCount + 1);
+		auto destroyCustomArrays = [&]
+		{
+			const DestructionContext context(&sharedComponentManager);
+			for (u32 i = 0; i + 1 < firstCustomArrays.size(); ++i)
+			{
+				const SnapshotChunk& chunk = fileChunks[i];
+				const SnapshotArchetype& archetype = fileArchetypes[chunk.archetype];
+				u32 array = firstCustomArrays[i];
+				for (u32 column = archetype.firstColumn; column < archetype.firstColumn + archetype.columnCount; ++
+				     column)
+				{
+					const auto& metadata = ComponentMetadataRegistry::getMetadata(
+						componentIds[fileColumns[column].component]);
+					if (metadata.serializationMode != SerializationMode::eCustom)
+					{
+						continue;
+					}
+					for (u32 e = 0; e < chunk.entityCount; ++e)
+					{
+						metadata.destructionPolicy(customArrays[array] + e * metadata.size, context);
+					}
+					++array;
+				}
+			}
+		};
+		for (u32 i = 0; i < header.chunkCount; ++i)
+		{
+			const SnapshotChunk& chunk = fileChunks[i];
+			const SnapshotArchetype& archetype = fileArchetypes[chunk.archetype];
+			firstCustomArrays.push_back(static_cast<u32>(customArrays.size()));
+
+			SnapshotReader reader(base + chunk.customOffset, chunk.customSize);
+			for (u32 column = archetype.firstColumn; column < archetype.firstColumn + archetype.columnCount; ++column)
+			{
+				const auto& metadata = ComponentMetadataRegistry::getMetadata(componentIds[fileColumns[column].component]);
+				if (metadata.serializationMode != SerializationMode::eCustom)
+				{
+					continue;
+				}
+				auto* array = static_cast<std::byte*>(FrameScratchAllocator::get().allocate(
+					std::max<sizet>(chunk.entityCount * metadata.size, 1), metadata.alignment));
+				for (u32 e = 0; e < chunk.entityCount; ++e)
+				{
+					metadata.deserialize(array + e * metadata.size, reader);
+				}
+				customArrays.push_back(array);
+			}
+
+			if (reader.failed())
+			{
+				// The chunk's elements were constructed from zeros past the end, they are destroyed with the rest
+				firstCustomArrays.push_back(static_cast<u32>(customArrays.size()));
+				destroyCustomArrays();
+				return fail("custom component data is truncated");
+			}
+		}
+		firstCustomArrays.push_back(static_cast<u32>(customArrays.size()));
+
+		auto sharedPools = makeScratchVector<ISharedComponentPool*>(FrameScratchAllocator::get());
+		for (u32 i = 0; i < header.sharedPoolCount; ++i)
+		{
+			const SnapshotSharedPool& pool = filePools[i];
+			SnapshotReader reader(base + pool.offset, pool.size);
+			ISharedComponentPool* sharedPool = sharedComponentManager.readPool(componentIds[pool.component], reader);
+			if (!sharedPool)
+			{
+				for (ISharedComponentPool* readPool : sharedPools)
+				{
+					sharedComponentManager.discardPool(readPool);
+				}
+				destroyCustomArrays();
+				return fail("shared pool is truncated");
+			}
+			sharedPools.push_back(sharedPool);
+		}
+
+		// --- Restore, nothing below can fail ---
+		ArchetypeManager& archetypeManager = *entityManager.getArchetypeManager();
+
+		entityManager.restoreEntityIndices({generations, header.generationCount},
+		                                   {freeIndices, header.freeIndexCount});
+
+		for (u32 i = 0; i < header.sharedPoolCount; ++i)
+		{
+			sharedComponentManager.restorePool(componentIds[filePools[i].component], sharedPools[i]);
+		}
+
+		bool adoptedAny = false;
+		auto aspectIds = makeScratchVector<ComponentID>(FrameScratchAllocator::get());
+		// Chunk column -> snapshot column
+		auto columnMap = makeScratchVector<const SnapshotColumn*>(FrameScratchAllocator::get());
+		auto enabledMasks = makeScratchVector<u64>(FrameScratchAllocator::get());
+		auto dataStarts = makeScratchVector<std::byte*>(FrameScratchAllocator::get());
+		for (u32 archetypeIndex = 0; archetypeIndex < header.archetypeCount; ++archetypeIndex)
+		{
+			const SnapshotArchetype& fileArchetype = fileArchetypes[archetypeIndex];
+			const SnapshotColumn* firstColumn = fileColumns + fileArchetype.firstColumn;
+
+			aspectIds.clear();
+			bool adoptable = true;
+			for (u32 column = 0; column < fileArchetype.columnCount; ++column)
+			{
+				const SnapshotComponent& component = fileComponents[firstColumn[column].component];
+				aspectIds.push_back(componentIds[firstColumn[column].component]);
+				adoptable &= isAdoptable(component.mode, component.alignment);
+			}
+			const Aspect aspect(aspectIds.begin(), aspectIds.end());
+			const auto& chunkIds = aspect.getComponentIds();
+			SASSERT(chunkIds.size() == fileArchetype.columnCount)
+
+			// Current ids order the columns, which can differ from the order they were saved in
+			columnMap.clear();
+			for (const ComponentID id : chunkIds)
+			{
+				for (u32 column = 0; column < fileArchetype.columnCount; ++column)
+				{
+					if (componentIds[firstColumn[column].component] == id)
+					{
+						columnMap.push_back(firstColumn + column);
+						break;
+					}
+				}
+			}
+
+			for (u32 chunkIndex = fileArchetype.firstChunk;
+			     chunkIndex < fileArchetype.firstChunk + fileArchetype.chunkCount; ++chunkIndex)
+			{
+				const SnapshotChunk& fileChunk = fileChunks[chunkIndex];
+				std::byte* block = base + fileChunk.blockOffset;
+				const auto* masks = reinterpret_cast<const u64*>(base + fileChunk.enabledMasksOffset);
+				const eastl::span<const Entity> entities(reinterpret_cast<const Entity*>(base + fileChunk.entitiesOffset),
+				                                         fileChunk.entityCount);
+
+				enabledMasks.clear();
+				dataStarts.clear();
+				for (const SnapshotColumn* column : columnMap)
+				{
+					enabledMasks.push_back(masks[column - firstColumn]);
+					dataStarts.push_back(block + column->offset);
+				}
+
+				Chunk* chunk;
+				if (adoptable)
+				{
+					chunk = archetypeManager.restoreChunk(aspect, entities, {enabledMasks.data(), enabledMasks.size()},
+					                                      block, {dataStarts.data(), dataStarts.size()});
+					adoptedAny = true;
+				}
+				else
+				{
+					chunk = archetypeManager.restoreChunk(aspect, entities, {enabledMasks.data(), enabledMasks.size()});
+					for (sizet i = 0; i < columnMap.size(); ++i)
+					{
+						const SnapshotComponent& component = fileComponents[columnMap[i]->component];
+						if (component.mode != SerializationMode::eCustom)
+						{
+							memcpy(chunk->getComponentArrayByIndex(i), dataStarts[i],
+							       fileChunk.entityCount * component.size);
+						}
+					}
+
+					// Custom arrays were read in snapshot column order
+					u32 array = firstCustomArrays[chunkIndex];
+					for (u32 column = 0; column < fileArchetype.columnCount; ++column)
+					{
+						const ComponentID id = componentIds[firstColumn[column].component];
+						const auto& metadata = ComponentMetadataRegistry::getMetadata(id);
+						if (metadata.serializationMode != SerializationMode::eCustom)
+						{
+							continue;
+						}
+						std::byte* destination = chunk->getComponentArrayByIndex(chunk->getComponentIndex(id));
+						std::byte* source = customArrays[array++];
+						for (u32 i = 0; i < fileChunk.entityCount; ++i)
+						{
+							metadata.moveAndDestroy(destination + i * metadata.size, source + i * metadata.size);
+						}
+					}
+				}
+
+				for (sizet i = 0; i < columnMap.size(); ++i)
+				{
+					if (fileComponents[columnMap[i]->component].mode == SerializationMode::eSharedHandle)
+					{
+						relocateSharedHandles(chunk->getComponentArrayByIndex(i), fileChunk.entityCount, chunkIds[i]);
+					}
+				}
+			}
+		}
+
+		if (adoptedAny)
+		{
+			archetypeManager.retainMappedFile(std::move(file));
+		}
+		return true;
+	}
+}
@@ -0,0 +1,107 @@
+#pragma once
+#include "base/MappedFile.hpp"
+#include "ecs/core/ComponentMetadata.hpp"
+#include "ecs/serialization/SnapshotStream.hpp"
+
+namespace spite
+{
+	class EntityManager;
+
+	constexpr u32 WORLD_SNAPSHOT_MAGIC = 0x53575053; // "SPWS"
+	constexpr u32 WORLD_SNAPSHOT_VERSION = 1;
+	// Chunk blocks are aligned to this in the file, archetypes with stricter components are copied instead of adopted
+	constexpr sizet WORLD_SNAPSHOT_BLOCK_ALIGNMENT = 64;
+
+	// File layout, offsets are from the start of the file:
+	// header | components | archetypes | columns | chunks | generations | free indices | shared pools | chunk data.
+	// Every chunk stores its entities, enabled masks and a storage block laid out like Chunk memory,
+	// followed by the custom serialized columns
+	struct SnapshotHeader
+	{
+		u32 magic;
+		u32 version;
+		u64 fileSize;
+		u32 chunkCapacity;
+		u32 componentCount;
+		u32 archetypeCount;
+		u32 columnCount;
+		u32 chunkCount;
+		u32 generationCount;
+		u32 freeIndexCount;
+		u32 sharedPoolCount;
+		u64 componentsOffset;
+		u64 archetypesOffset;
+		u64 columnsOffset;
+		u64 chunksOffset;
+		u64 generationsOffset;
+		u64 freeIndicesOffset;
+		u64 sharedPoolsOffset;
+	};
+
+	struct SnapshotComponent
+	{
+		u64 typeHash;
+		u32 size;
+		u32 alignment;
+		SerializationMode mode;
+		u8 padding[7];
+	};
+
+	struct SnapshotArchetype
+	{
+		u32 firstColumn;
+		u32 columnCount;
+		u32 firstChunk;
+		u32 chunkCount;
+		u64 blockSize;
+	};
+
+	struct SnapshotColumn
+	{
+		// Index into the component table
+		u32 component;
+		u32 padding;
+		// Start of the component array inside a chunk block
+		u64 offset;
+	};
+
+	struct SnapshotChunk
+	{
+		u32 archetype;
+		u32 entityCount;
+		u64 entitiesOffset;
+		// One u64 per column
+		u64 enabledMasksOffset;
+		u64 blockOffset;
+		u64 customOffset;
+		u64 customSize;
+	};
+
+	struct SnapshotSharedPool
+	{
+		u32 component;
+		u32 padding;
+		u64 offset;
+		u64 size;
+	};
+
+	// Saves and loads the entity storage of a world: archetypes, chunk columns, entity indices and shared pools.
+	// Components are matched by type name hash, their ids may differ between runs.
+	// Components without a serialization mode are dropped, singletons are not part of the snapshot
+	class WorldSnapshot
+	{
+	public:
+		static void write(const EntityManager& entityManager, SnapshotWriter& writer);
+
+		// (returns false if the file could not be written)
+		static bool save(const EntityManager& entityManager, cstring path, const HeapAllocator& allocator);
+
+		// Loads into a manager that has not created any entity yet.
+		// Every component type of the snapshot must already be registered in ComponentMetadataRegistry.
+		// Chunks of archetypes without custom columns adopt the mapped file memory,
+		// the file then stays mapped for the lifetime of the ArchetypeManager
+		// (returns false if the file is missing, malformed or references unknown components)
+		static bool load(EntityManager& entityManager, cstring path);
+		static bool load(EntityManager& entityManager, MappedFile&& file);
+	};
+}
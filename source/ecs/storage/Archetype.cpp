@@ -7,23 +7,51 @@
 namespace spite
 {
 	Archetype::Archetype(const Aspect* aspect,
-	                     HeapAllocator& allocator): m_aspect(aspect),
+	                     u32 id,
+	                     EntityRecordTable& entityRecords,
+	                     HeapAllocator& allocator,
+	                     ChunkLayoutMode layoutMode,
+	                     ChunkNumaArenas* numaArenas): m_aspect(aspect),
+	                                                m_id(id),
 	                                                m_componentIdToIndexMap(
-		                                                makeHeapMap<
+		                                                makeHeapFlatMap<
 			                                                ComponentID, int>(allocator)),
 	                                                m_chunks(makeHeapVector<Chunk*>(allocator)),
 	                                                m_freeChunks(
 		                                                makeHeapVector<Chunk*>(
 			                                                allocator)), m_firstNonFullChunkIdx(0),
 	                                                m_allocator(allocator),
-	                                                m_entityLocations(
-		                                                makeHeapMap<Entity, eastl::pair<sizet, sizet>, Entity::hash>(
-			                                                allocator))
+	                                                m_entityRecords(entityRecords),
+	                                                m_addEdges(makeSboVector<eastl::pair<ComponentID, Archetype*>,
+		                                                DEFAULT_COMPONENTS_INLINE_CAPACITY>(allocator)),
+	                                                m_removeEdges(makeSboVector<eastl::pair<ComponentID, Archetype*>,
+		                                                DEFAULT_COMPONENTS_INLINE_CAPACITY>(allocator)),
+	                                                m_columnPlacements(makeSboVector<ComponentPlacement,
+		                                                DEFAULT_COMPONENTS_INLINE_CAPACITY>(allocator)),
+	                                                m_numaArenas(numaArenas)
 	{
 		const auto& ids = m_aspect->getComponentIds();
+		bool hasColdColumns = false;
 		for (int i = 0, size = static_cast<int>(ids.size()); i < size; ++i)
 		{
 			m_componentIdToIndexMap[ids[i]] = i;
+
+			// Pinned placements win, access statistics only decide for eAuto components
+			ComponentPlacement placement = ComponentMetadataRegistry::getMetadata(ids[i]).placement;
+			if (placement == ComponentPlacement::eAuto)
+			{
+				placement = layoutMode == ChunkLayoutMode::eAccessStats && ComponentAccessStats::suggestsCold(ids[i])
+					            ? ComponentPlacement::eCold
+					            : ComponentPlacement::eHot;
+			}
+			hasColdColumns |= placement == ComponentPlacement::eCold;
+			m_columnPlacements.push_back(placement);
+		}
+
+		// Keep the single block layout when every column is hot
+		if (!hasColdColumns)
+		{
+			m_columnPlacements.clear();
 		}
 	}
 
@@ -79,7 +107,7 @@ namespace spite
 			}
 			else
 			{
-				Chunk* newChunk = m_allocator.new_object<Chunk>(m_aspect, m_allocator);
+				Chunk* newChunk = createChunk();
 				targetChunk = newChunk;
 				m_chunks.push_back(newChunk);
 				chunkIndex = m_chunks.size() - 1;
@@ -88,7 +116,7 @@ namespace spite
 		}
 
 		sizet indexInChunk = targetChunk->addEntity(entity);
-		m_entityLocations[entity] = {chunkIndex, indexInChunk};
+		setRecord(entity, chunkIndex, indexInChunk);
 		return {targetChunk, indexInChunk};
 	}
 
@@ -100,7 +128,6 @@ namespace spite
 		if (entities.empty()) return locations;
 
 		locations.reserve(entities.size());
-		m_entityLocations.reserve(m_entityLocations.size() + entities.size());
 
 		sizet entitiesAdded = 0;
 		sizet totalToAdd = entities.size();
@@ -115,7 +142,7 @@ namespace spite
 				const Entity& entity = entities[entitiesAdded];
 				sizet indexInChunk = chunk->addEntity(entity);
 				auto location = eastl::make_pair(chunk, indexInChunk);
-				m_entityLocations[entity] = {chunkIdx, indexInChunk};
+				setRecord(entity, chunkIdx, indexInChunk);
 				locations.push_back(location);
 				entitiesAdded++;
 			}
@@ -130,7 +157,7 @@ namespace spite
 
 			for (sizet i = 0; i < numNewChunks; ++i)
 			{
-				Chunk* newChunk = m_allocator.new_object<Chunk>(m_aspect, m_allocator);
+				Chunk* newChunk = createChunk();
 				m_chunks.push_back(newChunk);
 			}
 
@@ -143,7 +170,7 @@ namespace spite
 					const Entity& entity = entities[entitiesAdded];
 					sizet indexInChunk = chunk->addEntity(entity);
 					auto location = eastl::make_pair(chunk, indexInChunk);
-					m_entityLocations[entity] = {chunkIdx, indexInChunk};
+					setRecord(entity, chunkIdx, indexInChunk);
 					locations.push_back(location);
 					entitiesAdded++;
 				}
@@ -152,17 +179,66 @@ namespace spite
 		return locations;
 	}
 
+	Chunk* Archetype::restoreChunk(eastl::span<const Entity> entities,
+	                               eastl::span<const u64> enabledMasks,
+	                               std::byte* externalStorage,
+	                               eastl::span<std::byte* const> componentDataStarts)
+	{
+		Chunk* chunk;
+		if (externalStorage)
+		{
+			chunk = m_allocator.new_object<Chunk>(m_aspect, m_allocator, externalStorage, componentDataStarts);
+		}
+		else if (!m_freeChunks.empty())
+		{
+			chunk = m_freeChunks.back();
+			m_freeChunks.pop_back();
+		}
+		else
+		{
+			chunk = createChunk();
+		}
+		chunk->restoreEntities(entities, enabledMasks);
+
+		const sizet chunkIndex = m_chunks.size();
+		m_chunks.push_back(chunk);
+		for (sizet i = 0; i < entities.size(); ++i)
+		{
+			setRecord(entities[i], chunkIndex, i);
+		}
+		return chunk;
+	}
+
+	void Archetype::clear(const DestructionContext* destructionContext)
+	{
+		for (Chunk* chunk : m_chunks)
+		{
+			if (destructionContext)
+			{
+				destroyAllComponentsInChunk(chunk, *destructionContext);
+			}
+			for (const Entity entity : chunk->entities())
+			{
+				m_entityRecords.release(entity);
+			}
+			chunk->clear();
+			m_freeChunks.push_back(chunk);
+		}
+		m_chunks.clear();
+		m_firstNonFullChunkIdx = 0;
+	}
+
 	void Archetype::removeEntity(Entity entity, const DestructionContext& context)
 	{
-		auto it = m_entityLocations.find(entity);
-		if (it == m_entityLocations.end())
+		const EntityRecord* record = m_entityRecords.find(entity);
+		if (!record || record->archetype != this)
 		{
 			SASSERTM(false, "Entity %llu not in this archetype for removal\n", entity.id())
 			return;
 		}
 
-		sizet chunkIdx = it->second.first;
-		sizet entityIdxInChunk = it->second.second;
+		const sizet chunkIdx = record->chunkIndex;
+		const sizet entityIdxInChunk = record->indexInChunk;
 
 		Chunk* chunk = m_chunks[chunkIdx];
 
@@ -178,11 +254,11 @@ namespace spite
 
 		Entity swappedEntity = chunk->removeEntityAndSwap(entityIdxInChunk);
 
-		m_entityLocations.erase(entity);
+		m_entityRecords.release(entity);
 		if (swappedEntity != Entity::undefined())
 		{
 			// If an entity was swapped into the removed slot
-			m_entityLocations[swappedEntity] = {chunkIdx, entityIdxInChunk};
+			setRecord(swappedEntity, chunkIdx, entityIdxInChunk);
 		}
 
 		// If chunk becomes empty, move it to the free list
@@ -206,7 +282,7 @@ namespace spite
 					Entity updEntity = movedChunk->entity(i);
 					if (updEntity != Entity::undefined())
 					{
-						m_entityLocations[updEntity].first = chunkIdx;
+						m_entityRecords.find(updEntity)->chunkIndex = static_cast<u32>(chunkIdx);
 					}
 				}
 			}
@@ -228,57 +304,71 @@ namespace spite
 		if (entities.empty()) return;
 
 		auto marker = FrameScratchAllocator::get().get_scoped_marker();
-
-		auto toRemoveByChunk = makeScratchMap<Chunk*, scratch_vector<sizet>>(
-			FrameScratchAllocator::get());
-
-		// Group entities by chunk
+		auto locations = makeScratchVector<eastl::pair<Chunk*, sizet>>(FrameScratchAllocator::get());
+		locations.reserve(entities.size());
 		for (const auto& entity : entities)
 		{
-			auto it = m_entityLocations.find(entity);
-			if (it != m_entityLocations.end())
+			const EntityRecord* record = m_entityRecords.find(entity);
+			if (record && record->archetype == this)
 			{
-				Chunk* chunk = m_chunks[it->second.first];
-				auto groupIt = toRemoveByChunk.find(chunk);
-				if (groupIt == toRemoveByChunk.end())
-				{
-					groupIt = toRemoveByChunk.emplace(chunk, makeScratchVector<sizet>(FrameScratchAllocator::get())).
-					                          first;
-				}
-				groupIt->second.push_back(it->second.second);
+				locations.emplace_back(m_chunks[record->chunkIndex], record->indexInChunk);
 			}
 		}
 
-		for (auto& pair : toRemoveByChunk)
-		{
-			Chunk* chunk = pair.first;
-			scratch_vector<sizet>& indices = pair.second;
+		removeAtLocations(locations, context, skipDestructionAspect, true);
+	}
+
+	void Archetype::removeMovedEntities(eastl::span<eastl::pair<Chunk*, sizet>> locations,
+	                                    const DestructionContext& context,
+	                                    const Aspect* skipDestructionAspect)
+	{
+		removeAtLocations(locations, context, skipDestructionAspect, false);
+	}
 
-			// Sort indices descending to safely use swap-and-pop
-			eastl::sort(indices.begin(), indices.end(), eastl::greater<sizet>());
+	void Archetype::setRecord(Entity entity, sizet chunkIndex, sizet indexInChunk)
+	{
+		EntityRecord& record = m_entityRecords.getOrCreate(entity);
+		record.archetype = this;
+		record.chunkIndex = static_cast<u32>(chunkIndex);
+		record.indexInChunk = static_cast<u32>(indexInChunk);
+	}
 
-			for (sizet indexToRemove : indices)
+	void Archetype::removeAtLocations(eastl::span<eastl::pair<Chunk*, sizet>> locations,
+	                                  const DestructionContext& context,
+	                                  const Aspect* skipDestructionAspect,
+	                                  bool releaseRecords)
+	{
+		// Grouped by chunk, indices descending to safely use swap-and-pop
+		eastl::sort(locations.begin(), locations.end(),
+		            [](const eastl::pair<Chunk*, sizet>& a, const eastl::pair<Chunk*, sizet>& b)
+		            {
+			            return a.first != b.first ? a.first < b.first : a.second > b.second;
+		            });
+
+		for (const auto& [chunk, indexToRemove] : locations)
+		{
+			// Call destruction policies
+			for (const auto& componentId : m_aspect->getComponentIds())
 			{
-				// Call destruction policies
-				for (const auto& componentId : m_aspect->getComponentIds())
-				{
-					if (skipDestructionAspect && skipDestructionAspect->contains(componentId)) continue;
+				if (skipDestructionAspect && skipDestructionAspect->contains(componentId)) continue;
 
-					const auto& meta = ComponentMetadataRegistry::getMetadata(componentId);
-					void* componentPtr = chunk->getComponentDataPtrByIndex(
-						getComponentIndex(componentId),
-						indexToRemove);
-					meta.destructionPolicy(componentPtr, context);
-				}
+				const auto& meta = ComponentMetadataRegistry::getMetadata(componentId);
+				void* componentPtr = chunk->getComponentDataPtrByIndex(
+					getComponentIndex(componentId),
+					indexToRemove);
+				meta.destructionPolicy(componentPtr, context);
+			}
 
-				Entity removedEntity = chunk->entity(indexToRemove);
-				Entity swappedEntity = chunk->removeEntityAndSwap(indexToRemove);
+			Entity removedEntity = chunk->entity(indexToRemove);
+			Entity swappedEntity = chunk->removeEntityAndSwap(indexToRemove);
 
-				m_entityLocations.erase(removedEntity);
-				if (swappedEntity != Entity::undefined())
-				{
-					m_entityLocations[swappedEntity].second = indexToRemove;
-				}
+			if (releaseRecords)
+			{
+				m_entityRecords.release(removedEntity);
+			}
+			if (swappedEntity != Entity::undefined())
+			{
+				m_entityRecords.find(swappedEntity)->indexInChunk = static_cast<u32>(indexToRemove);
 			}
 		}
 	}
@@ -293,6 +383,47 @@ namespace spite
 		return *m_aspect;
 	}
 
+	u32 Archetype::id() const
+	{
+		return m_id;
+	}
+
+	Archetype* Archetype::findAddEdge(ComponentID id) const
+	{
+		for (const auto& [componentId, archetype] : m_addEdges)
+		{
+			if (componentId == id)
+			{
+				return archetype;
+			}
+		}
+		return nullptr;
+	}
+
+	Archetype* Archetype::findRemoveEdge(ComponentID id) const
+	{
+		for (const auto& [componentId, archetype] : m_removeEdges)
+		{
+			if (componentId == id)
+			{
+				return archetype;
+			}
+		}
+		return nullptr;
+	}
+
+	void Archetype::setAddEdge(ComponentID id, Archetype* archetype)
+	{
+		SASSERT(!findAddEdge(id))
+		m_addEdges.emplace_back(id, archetype);
+	}
+
+	void Archetype::setRemoveEdge(ComponentID id, Archetype* archetype)
+	{
+		SASSERT(!findRemoveEdge(id))
+		m_removeEdges.emplace_back(id, archetype);
+	}
+
 	int Archetype::getComponentIndex(ComponentID id) const
 	{
 		auto it = m_componentIdToIndexMap.find(id);
@@ -303,12 +434,34 @@ namespace spite
 		return -1;
 	}
 
+	eastl::span<const ComponentPlacement> Archetype::columnPlacements() const
+	{
+		return {m_columnPlacements.begin(), m_columnPlacements.size()};
+	}
+
+	Chunk* Archetype::createChunk()
+	{
+		if (m_numaArenas && m_numaArenas->count > 1)
+		{
+			// The chunk object stays in m_allocator, only its storage is node local
+			const u32 node = m_numaArenas->nextNode++ % m_numaArenas->count;
+			return m_allocator.new_object<Chunk>(m_aspect, *m_numaArenas->arenas[node], columnPlacements(), node);
+		}
+		return m_allocator.new_object<Chunk>(m_aspect, m_allocator, columnPlacements());
+	}
+
+	ComponentPlacement Archetype::getColumnPlacement(sizet componentIndex) const
+	{
+		SASSERT(componentIndex < m_aspect->size())
+		return m_columnPlacements.empty() ? ComponentPlacement::eHot : m_columnPlacements[componentIndex];
+	}
+
 	eastl::pair<Chunk*, sizet> Archetype::getEntityLocation(Entity entity) const
 	{
-		auto it = m_entityLocations.find(entity);
-		if (it != m_entityLocations.end())
+		const EntityRecord* record = m_entityRecords.find(entity);
+		if (record && record->archetype == this)
 		{
-			return {m_chunks[it->second.first], it->second.second};
+			return {m_chunks[record->chunkIndex], record->indexInChunk};
 		}
 		SASSERTM(false, "Entity %llu is not located in Archetype\n", entity.id())
 		return {nullptr, static_cast<sizet>(-1)};
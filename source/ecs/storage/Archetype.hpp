@@ -1,28 +1,52 @@
 #pragma once
 #include "Aspect.hpp"
 #include "Chunk.hpp"
+#include "EntityRecordTable.hpp"
 
 #include "ecs/core/Entity.hpp"
 
 namespace spite
 {
+	// Node local allocators new chunks are spread across round robin, shared by the archetypes of an ArchetypeManager.
+	// With fewer than two arenas chunks are allocated from the archetype allocator
+	struct ChunkNumaArenas
+	{
+		HeapAllocator* arenas[MAX_NUMA_NODES] = {};
+		u32 count = 0;
+		u32 nextNode = 0;
+	};
+
 	// An Archetype manages a collection of Chunks, all sharing the same Aspect.
 	class Archetype
 	{
 		const Aspect* m_aspect;
-		heap_unordered_map<ComponentID, int> m_componentIdToIndexMap;
+		u32 m_id;
+		heap_flat_map<ComponentID, int> m_componentIdToIndexMap;
 
 		heap_vector<Chunk*> m_chunks;
 		heap_vector<Chunk*> m_freeChunks;
 		sizet m_firstNonFullChunkIdx;
 		HeapAllocator& m_allocator;
 
-		// Maps Entity ID to its location (chunkIdx, entityIdxInChunk)
-		heap_unordered_map<Entity, eastl::pair<sizet, sizet>, Entity::hash> m_entityLocations;
+		// Shared with every archetype of the owning ArchetypeManager
+		EntityRecordTable& m_entityRecords;
+
+		// Cached single component transitions, filled lazily by ArchetypeManager
+		heap_sbo_vector<eastl::pair<ComponentID, Archetype*>, DEFAULT_COMPONENTS_INLINE_CAPACITY> m_addEdges;
+		heap_sbo_vector<eastl::pair<ComponentID, Archetype*>, DEFAULT_COMPONENTS_INLINE_CAPACITY> m_removeEdges;
+
+		// Resolved per column at construction, chunks allocate hot and cold columns in separate blocks
+		heap_sbo_vector<ComponentPlacement, DEFAULT_COMPONENTS_INLINE_CAPACITY> m_columnPlacements;
+
+		ChunkNumaArenas* m_numaArenas;
 
 	public:
 		Archetype(const Aspect* aspect,
-		          HeapAllocator& allocator);
+		          u32 id,
+		          EntityRecordTable& entityRecords,
+		          HeapAllocator& allocator,
+		          ChunkLayoutMode layoutMode = ChunkLayoutMode::eSingleBlock,
+		          ChunkNumaArenas* numaArenas = nullptr);
 
 		~Archetype();
 
@@ -35,13 +59,42 @@ namespace spite
 		void removeEntity(Entity entity, const DestructionContext& destructionContext);
 		void removeEntities(eastl::span<const Entity> entities, const DestructionContext& destructionContext,
 		                    const Aspect* skipDestructionAspect = nullptr);
+		// Removes entities that were already placed into another archetype,
+		// locations must be taken before the move since their records now point to the new archetype (reorders locations)
+		void removeMovedEntities(eastl::span<eastl::pair<Chunk*, sizet>> locations,
+		                         const DestructionContext& destructionContext,
+		                         const Aspect* skipDestructionAspect);
+
+		// Appends a chunk holding entities restored from a snapshot and points their records at it.
+		// Adopts externalStorage when given, otherwise reuses a free chunk or allocates and the caller fills the component data
+		Chunk* restoreChunk(eastl::span<const Entity> entities,
+		                    eastl::span<const u64> enabledMasks,
+		                    std::byte* externalStorage = nullptr,
+		                    eastl::span<std::byte* const> componentDataStarts = {});
+
+		// Releases the records of every entity and moves all chunks to the free list.
+		// Components are destroyed unless destructionContext is null (they were already moved out)
+		void clear(const DestructionContext* destructionContext);
 
 		const heap_vector<Chunk*>& getChunks() const;
 
 		const Aspect& aspect() const;
 
+		// Dense index assigned by ArchetypeManager, stable for the archetype lifetime
+		u32 id() const;
+
+		// (returns nullptr if the transition was not cached yet)
+		Archetype* findAddEdge(ComponentID id) const;
+		Archetype* findRemoveEdge(ComponentID id) const;
+
+		void setAddEdge(ComponentID id, Archetype* archetype);
+		void setRemoveEdge(ComponentID id, Archetype* archetype);
+
 		int getComponentIndex(ComponentID id) const;
 
+		// eHot or eCold, never eAuto
+		ComponentPlacement getColumnPlacement(sizet componentIndex) const;
+
 		eastl::pair<Chunk*, sizet> getEntityLocation(Entity entity) const;
 
 		bool isEmpty() const;
@@ -49,6 +102,19 @@ namespace spite
 		void destroyAllComponentsInChunk(Chunk* chunk, const DestructionContext& destructionContext) const;
 
 		void destroyAllComponents(const DestructionContext& destructionContext) const;
+
+	private:
+		void setRecord(Entity entity, sizet chunkIndex, sizet indexInChunk);
+
+		// Empty when every column is hot
+		eastl::span<const ComponentPlacement> columnPlacements() const;
+
+		Chunk* createChunk();
+
+		void removeAtLocations(eastl::span<eastl::pair<Chunk*, sizet>> locations,
+		                       const DestructionContext& destructionContext,
+		                       const Aspect* skipDestructionAspect,
+		                       bool releaseRecords);
 	};
 
 }
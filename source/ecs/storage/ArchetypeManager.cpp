@@ -1,6 +1,7 @@
 #include "ArchetypeManager.hpp"
 
 #include "AspectRegistry.hpp"
+#include "SharedComponentManager.hpp"
 #include "VersionManager.hpp"
 
 #include "base/CollectionUtilities.hpp"
@@ -13,14 +14,17 @@ namespace spite
 {
 	ArchetypeManager::ArchetypeManager(const HeapAllocator& allocator, AspectRegistry* aspectRegistry,
 	                                   VersionManager* versionManager,
-	                                   SharedComponentManager* sharedComponentManager) : m_archetypes(
-			makeHeapMap<Aspect, std::unique_ptr<Archetype>, Aspect::hash>(allocator)),
+	                                   SharedComponentManager* sharedComponentManager) :
+		m_mappedFiles(makeHeapVector<MappedFile>(allocator)),
+		m_archetypes(makeHeapFlatMap<Aspect, std::unique_ptr<Archetype>, Aspect::hash>(allocator)),
+		m_archetypesById(makeHeapVector<Archetype*>(allocator)),
 		m_aspectRegistry(aspectRegistry),
 		m_allocator(allocator),
 		m_versionManager(versionManager),
-		m_entityToArchetype(
-			makeHeapMap<Entity, Archetype*, Entity::hash>(allocator)),
-		m_destructionContext(sharedComponentManager)
+		m_sharedComponentManager(sharedComponentManager),
+		m_entityRecords(allocator),
+		m_destructionContext(sharedComponentManager),
+		m_observerRegistry(allocator)
 	{
 	}
 
@@ -34,9 +38,14 @@ namespace spite
 
 		const Aspect* registeredAspect = m_aspectRegistry->addOrGetAspect(aspect);
 		auto newArchetype = std::make_unique<Archetype>(registeredAspect,
-		                                                m_allocator);
+		                                                static_cast<u32>(m_archetypesById.size()),
+		                                                m_entityRecords,
+		                                                m_allocator,
+		                                                m_chunkLayoutMode,
+		                                                &m_numaArenas);
 		Archetype* result = newArchetype.get();
 		m_archetypes[aspect] = std::move(newArchetype);
+		m_archetypesById.push_back(result);
 
 		// A new archetype is created, which is a structural change.
 		m_versionManager->makeDirty(*registeredAspect);
@@ -44,6 +53,26 @@ namespace spite
 		return result;
 	}
 
+	void ArchetypeManager::setChunkLayoutMode(ChunkLayoutMode mode)
+	{
+		m_chunkLayoutMode = mode;
+	}
+
+	ChunkLayoutMode ArchetypeManager::getChunkLayoutMode() const
+	{
+		return m_chunkLayoutMode;
+	}
+
+	void ArchetypeManager::setChunkNumaArenas(eastl::span<HeapAllocator* const> arenas)
+	{
+		SASSERT(arenas.size() <= MAX_NUMA_NODES)
+		m_numaArenas = {};
+		for (HeapAllocator* arena : arenas)
+		{
+			m_numaArenas.arenas[m_numaArenas.count++] = arena;
+		}
+	}
+
 	Archetype* ArchetypeManager::findArchetype(const Aspect& aspect) const
 	{
 		auto it = m_archetypes.find(aspect);
@@ -54,6 +83,68 @@ namespace spite
 		return nullptr;
 	}
 
+	Archetype* ArchetypeManager::getArchetypeById(u32 id) const
+	{
+		SASSERT(id < m_archetypesById.size())
+		return m_archetypesById[id];
+	}
+
+	sizet ArchetypeManager::archetypeCount() const
+	{
+		return m_archetypesById.size();
+	}
+
+	Archetype* ArchetypeManager::getRootArchetype()
+	{
+		return getOrCreateArchetype(Aspect());
+	}
+
+	Archetype* ArchetypeManager::getArchetypeWith(Archetype* from, ComponentID id)
+	{
+		if (from->aspect().contains(id))
+		{
+			return from;
+		}
+
+		Archetype* to = from->findAddEdge(id);
+		if (!to)
+		{
+			to = getOrCreateArchetype(from->aspect().add({&id, 1}));
+			from->setAddEdge(id, to);
+			if (!to->findRemoveEdge(id))
+			{
+				to->setRemoveEdge(id, from);
+			}
+		}
+		return to;
+	}
+
+	Archetype* ArchetypeManager::getArchetypeWithout(Archetype* from, ComponentID id)
+	{
+		if (!from->aspect().contains(id))
+		{
+			return from;
+		}
+
+		Archetype* to = from->findRemoveEdge(id);
+		if (!to)
+		{
+			to = getOrCreateArchetype(from->aspect().remove({&id, 1}));
+			from->setRemoveEdge(id, to);
+			if (!to->findAddEdge(id))
+			{
+				to->setAddEdge(id, from);
+			}
+		}
+		return to;
+	}
+
+	Archetype* ArchetypeManager::findEntityArchetype(Entity entity) const
+	{
+		const EntityRecord* record = m_entityRecords.find(entity);
+		return record ? record->archetype : nullptr;
+	}
+
 	void ArchetypeManager::addEntities(const Aspect& aspect, eastl::span<const Entity> entities)
 	{
 		if (entities.empty()) return;
@@ -65,11 +156,117 @@ namespace spite
 		{
 			m_versionManager->makeDirty(archetype->aspect());
 		}
+		m_observerRegistry.recordAspect(archetype->aspect(), nullptr, ObserverEvent::eAdd, entities);
+	}
 
-		for (const auto& entity : entities)
+	Chunk* ArchetypeManager::restoreChunk(const Aspect& aspect,
+	                                      eastl::span<const Entity> entities,
+	                                      eastl::span<const u64> enabledMasks,
+	                                      std::byte* externalStorage,
+	                                      eastl::span<std::byte* const> componentDataStarts)
+	{
+		Archetype* archetype = getOrCreateArchetype(aspect);
+
+		const bool wasEmpty = archetype->isEmpty();
+		Chunk* chunk = archetype->restoreChunk(entities, enabledMasks, externalStorage, componentDataStarts);
+		if (wasEmpty && !entities.empty())
+		{
+			m_versionManager->makeDirty(archetype->aspect());
+		}
+		m_observerRegistry.recordAspect(archetype->aspect(), nullptr, ObserverEvent::eAdd, entities);
+		return chunk;
+	}
+
+	void ArchetypeManager::retainMappedFile(MappedFile&& file)
+	{
+		m_mappedFiles.push_back(std::move(file));
+	}
+
+	void ArchetypeManager::mergeFrom(ArchetypeManager& source, eastl::span<const Entity> remap)
+	{
+		SASSERT(&source != this)
+
+		auto marker = FrameScratchAllocator::get().get_scoped_marker();
+		auto entities = makeScratchVector<Entity>(FrameScratchAllocator::get());
+		auto enabledMasks = makeScratchVector<u64>(FrameScratchAllocator::get());
+
+		for (Archetype* sourceArchetype : source.m_archetypesById)
+		{
+			if (sourceArchetype->isEmpty())
+			{
+				continue;
+			}
+
+			const Aspect& aspect = sourceArchetype->aspect();
+			const auto& componentIds = aspect.getComponentIds();
+			for (Chunk* sourceChunk : sourceArchetype->getChunks())
+			{
+				const sizet count = sourceChunk->size();
+				entities.clear();
+				for (const Entity entity : sourceChunk->entities())
+				{
+					SASSERT(entity.index() < remap.size() && remap[entity.index()] != Entity::undefined())
+					entities.push_back(remap[entity.index()]);
+				}
+				enabledMasks.clear();
+				for (sizet column = 0; column < componentIds.size(); ++column)
+				{
+					enabledMasks.push_back(sourceChunk->getEnabledMaskByIndex(column));
+				}
+
+				Chunk* chunk = restoreChunk(aspect, {entities.data(), entities.size()},
+				                            {enabledMasks.data(), enabledMasks.size()});
+
+				for (sizet column = 0; column < componentIds.size(); ++column)
+				{
+					const auto& metadata = ComponentMetadataRegistry::getMetadata(componentIds[column]);
+					std::byte* destination = chunk->getComponentArrayByIndex(column);
+					std::byte* origin = sourceChunk->getComponentArrayByIndex(column);
+
+					if (metadata.createSharedPool)
+					{
+						auto* handles = reinterpret_cast<SharedComponentHandle*>(origin);
+						for (sizet i = 0; i < count; ++i)
+						{
+							new(destination + i * metadata.size) SharedComponentHandle(
+								m_sharedComponentManager->importHandle(handles[i], *source.m_sharedComponentManager));
+							source.m_sharedComponentManager->decrementRef(handles[i]);
+						}
+					}
+					else if (metadata.serializationMode == SerializationMode::eRaw)
+					{
+						memcpy(destination, origin, count * metadata.size);
+					}
+					else
+					{
+						for (sizet i = 0; i < count; ++i)
+						{
+							metadata.moveAndDestroy(destination + i * metadata.size, origin + i * metadata.size);
+						}
+					}
+				}
+			}
+
+			// Components were moved out above
+			sourceArchetype->clear(nullptr);
+			source.m_versionManager->makeDirty(aspect);
+		}
+	}
+
+	void ArchetypeManager::clearArchetype(u32 archetypeId)
+	{
+		Archetype* archetype = getArchetypeById(archetypeId);
+		if (archetype->isEmpty())
+		{
+			return;
+		}
+
+		for (const Chunk* chunk : archetype->getChunks())
 		{
-			m_entityToArchetype[entity] = archetype;
+			m_observerRegistry.recordAspect(archetype->aspect(), nullptr, ObserverEvent::eRemove, chunk->entities());
 		}
+		archetype->clear(&m_destructionContext);
+		m_versionManager->makeDirty(archetype->aspect());
 	}
 
 	void ArchetypeManager::addComponent(const Entity entity, eastl::span<const ComponentID> componentsToAdd)
@@ -98,7 +295,7 @@ namespace spite
 	                                  const Aspect& toAspect)
 	{
 		SASSERT(isEntityTracked(entity))
-		Archetype* fromArchetype = m_entityToArchetype.at(entity);
+		Archetype* fromArchetype = m_entityRecords.find(entity)->archetype;
 		Archetype* toArchetype = getOrCreateArchetype(toAspect);
 
 		SASSERT(fromArchetype)
@@ -113,13 +310,13 @@ namespace spite
 
 		Archetype* toArchetype = getOrCreateArchetype(toAspect);
 		auto marker = FrameScratchAllocator::get().get_scoped_marker();
-		auto groups = makeScratchMap<Archetype*, scratch_vector<Entity>>(
+		auto groups = makeScratchFlatMap<Archetype*, scratch_vector<Entity>>(
 			FrameScratchAllocator::get());
 
 		for (const auto& entity : entities)
 		{
 			SASSERT(isEntityTracked(entity))
-			Archetype* archetype = m_entityToArchetype.at(entity);
+			Archetype* archetype = m_entityRecords.find(entity)->archetype;
 			auto it = groups.find(archetype);
 			if (it == groups.end())
 			{
@@ -137,10 +334,18 @@ namespace spite
 		}
 	}
 
+	void ArchetypeManager::moveEntities(Archetype* from, Archetype* to, eastl::span<const Entity> entities)
+	{
+		if (entities.empty() || from == to) return;
+		moveEntitiesBetweenArchetypes(from, to, entities);
+	}
+
 	void ArchetypeManager::removeEntity(Entity entity)
 	{
 		auto& archetype = getEntityArchetypeInternal(entity);
 
+		m_observerRegistry.recordAspect(archetype.aspect(), nullptr, ObserverEvent::eRemove, {&entity, 1});
+
 		const bool wasEmpty = archetype.isEmpty();
 		archetype.removeEntity(entity, m_destructionContext);
 		const bool isNowEmpty = archetype.isEmpty();
@@ -149,8 +354,6 @@ namespace spite
 		{
 			m_versionManager->makeDirty(archetype.aspect());
 		}
-
-		m_entityToArchetype.erase(entity);
 	}
 
 	void ArchetypeManager::removeEntities(eastl::span<const Entity> entities)
@@ -158,17 +361,17 @@ namespace spite
 		if (entities.empty()) return;
 
 		auto marker = FrameScratchAllocator::get().get_scoped_marker();
-		auto groups = makeScratchMap<Archetype*, scratch_vector<Entity>>(
+		auto groups = makeScratchFlatMap<Archetype*, scratch_vector<Entity>>(
 			FrameScratchAllocator::get());
 		for (const auto& entity : entities)
 		{
-			auto it = m_entityToArchetype.find(entity);
-			if (it != m_entityToArchetype.end())
+			Archetype* archetype = findEntityArchetype(entity);
+			if (archetype)
 			{
-				auto groupIt = groups.find(it->second);
+				auto groupIt = groups.find(archetype);
 				if (groupIt == groups.end())
 				{
-					groupIt = groups.emplace(it->second, makeScratchVector<Entity>(FrameScratchAllocator::get())).first;
+					groupIt = groups.emplace(archetype, makeScratchVector<Entity>(FrameScratchAllocator::get())).first;
 				}
 				groupIt->second.push_back(entity);
 			}
@@ -176,6 +379,8 @@ namespace spite
 
 		for (auto const& [archetype, entityGroup] : groups)
 		{
+			m_observerRegistry.recordAspect(archetype->aspect(), nullptr, ObserverEvent::eRemove, entityGroup);
+
 			const bool wasEmpty = archetype->isEmpty();
 			archetype->removeEntities(entityGroup, m_destructionContext);
 			const bool isNowEmpty = archetype->isEmpty();
@@ -185,11 +390,6 @@ namespace spite
 				m_versionManager->makeDirty(archetype->aspect());
 			}
 		}
-
-		for (const auto& entity : entities)
-		{
-			m_entityToArchetype.erase(entity);
-		}
 	}
 
 	void ArchetypeManager::addEntity(const Aspect& aspect, const Entity& entity)
@@ -202,14 +402,13 @@ namespace spite
 		{
 			m_versionManager->makeDirty(archetype->aspect());
 		}
-
-		m_entityToArchetype[entity] = archetype;
+		m_observerRegistry.recordAspect(archetype->aspect(), nullptr, ObserverEvent::eAdd, {&entity, 1});
 	}
 
 	const Archetype& ArchetypeManager::getEntityArchetype(Entity entity) const
 	{
 		SASSERT(isEntityTracked(entity))
-		return *m_entityToArchetype.at(entity);
+		return *m_entityRecords.find(entity)->archetype;
 	}
 
 	const Aspect& ArchetypeManager::getEntityAspect(Entity entity) const
@@ -276,6 +475,11 @@ namespace spite
 		return result;
 	}
 
+	ComponentObserverRegistry& ArchetypeManager::getObserverRegistry()
+	{
+		return m_observerRegistry;
+	}
+
 	void ArchetypeManager::resetAllModificationTracking()
 	{
 		for (const auto& [aspect, archetype] : m_archetypes)
@@ -298,12 +502,17 @@ namespace spite
 	Archetype& ArchetypeManager::getEntityArchetypeInternal(Entity entity)
 	{
 		SASSERT(isEntityTracked(entity))
-		return *m_entityToArchetype.at(entity);
+		return *m_entityRecords.find(entity)->archetype;
 	}
 
 	bool ArchetypeManager::isEntityTracked(Entity entity) const
 	{
-		return m_entityToArchetype.find(entity) != m_entityToArchetype.end();
+		return m_entityRecords.find(entity) != nullptr;
+	}
+
+	const EntityRecordTable& ArchetypeManager::getEntityRecords() const
+	{
+		return m_entityRecords;
 	}
 
 	void ArchetypeManager::moveEntitiesBetweenArchetypes(Archetype* from,
@@ -314,18 +523,21 @@ namespace spite
 		const bool toWasEmpty = to->isEmpty();
 
 		auto marker = FrameScratchAllocator::get().get_scoped_marker();
-		auto newLocations = to->addEntities(entities);
-		auto newLocationMap = makeScratchMap<Entity, eastl::pair<Chunk*, sizet>, Entity::hash>(
-			FrameScratchAllocator::get());
-		for (sizet i = 0; i < entities.size(); ++i)
+		// Taken before adding, the records are repointed to the new archetype afterwards
+		auto oldLocations = makeScratchVector<eastl::pair<Chunk*, sizet>>(FrameScratchAllocator::get());
+		oldLocations.reserve(entities.size());
+		for (const auto& entity : entities)
 		{
-			newLocationMap[entities[i]] = newLocations[i];
+			oldLocations.push_back(from->getEntityLocation(entity));
 		}
 
-		for (const auto& entity : entities)
+		// Locations are returned in the order of entities
+		auto newLocations = to->addEntities(entities);
+
+		for (sizet i = 0; i < entities.size(); ++i)
 		{
-			auto [fromChunk, fromIndex] = from->getEntityLocation(entity);
-			auto [toChunk, toIndex] = newLocationMap.at(entity);
+			auto [fromChunk, fromIndex] = oldLocations[i];
+			auto [toChunk, toIndex] = newLocations[i];
 			copyCompatibleComponents(fromChunk,
 			                         fromIndex,
 			                         toChunk,
@@ -334,12 +546,10 @@ namespace spite
 			                         to);
 		}
 
-		from->removeEntities(entities, m_destructionContext, &to->aspect());
+		from->removeMovedEntities(oldLocations, m_destructionContext, &to->aspect());
 
-		for (auto entity : entities)
-		{
-			m_entityToArchetype[entity] = to;
-		}
+		m_observerRegistry.recordAspect(to->aspect(), &from->aspect(), ObserverEvent::eAdd, entities);
+		m_observerRegistry.recordAspect(from->aspect(), &to->aspect(), ObserverEvent::eRemove, entities);
 
 		const bool fromIsNowEmpty = from->isEmpty();
 		const bool toIsNowEmpty = to->isEmpty();
@@ -2,8 +2,10 @@
 #include "Archetype.hpp"
 
 #include "base/CollectionUtilities.hpp"
+#include "base/MappedFile.hpp"
 
 #include "ecs/core/ComponentMetadataRegistry.hpp"
+#include "ecs/event/ComponentObserverRegistry.hpp"
 
 namespace spite
 {
@@ -13,17 +15,31 @@ namespace spite
 	class ArchetypeManager
 	{
 	private:
-		heap_unordered_map<Aspect, std::unique_ptr<Archetype>, Aspect::hash> m_archetypes;
+		// Snapshots whose chunk memory was adopted, declared first to be unmapped after the chunks are gone
+		heap_vector<MappedFile> m_mappedFiles;
+
+		heap_flat_map<Aspect, std::unique_ptr<Archetype>, Aspect::hash> m_archetypes;
+		// Indexed by Archetype::id()
+		heap_vector<Archetype*> m_archetypesById;
 		AspectRegistry* m_aspectRegistry;
 
 		HeapAllocator m_allocator;
 
 		VersionManager* m_versionManager;
+		SharedComponentManager* m_sharedComponentManager;
 
-		heap_unordered_map<Entity, Archetype*, Entity::hash> m_entityToArchetype;
+		// Entity -> archetype slot, kept up to date by the archetypes themselves
+		EntityRecordTable m_entityRecords;
 
 		DestructionContext m_destructionContext;
 
+		// Fed with added/removed batches on every structural change
+		ComponentObserverRegistry m_observerRegistry;
+
+		ChunkLayoutMode m_chunkLayoutMode = ChunkLayoutMode::eSingleBlock;
+		// Referenced by every archetype
+		ChunkNumaArenas m_numaArenas;
+
 	public:
 		ArchetypeManager(const HeapAllocator& allocator, AspectRegistry* aspectRegistry,
 		                 VersionManager* versionManager, SharedComponentManager* sharedComponentManager);
@@ -35,13 +51,40 @@ namespace spite
 
 		Archetype* getOrCreateArchetype(const Aspect& aspect);
 
+		// Applies to archetypes created afterwards, existing ones keep their layout
+		void setChunkLayoutMode(ChunkLayoutMode mode);
+		ChunkLayoutMode getChunkLayoutMode() const;
+
+		// Spreads the storage of chunks allocated from now on across node local arenas (arenas[i] lives on node i,
+		// see AllocatorRegistry::createNumaArenas), the arenas must outlive the manager.
+		// An empty span or a single arena restores regular allocation
+		void setChunkNumaArenas(eastl::span<HeapAllocator* const> arenas);
+
 		// (returns nullptr if not found)
 		Archetype* findArchetype(const Aspect& aspect) const;
 
+		Archetype* getArchetypeById(u32 id) const;
+
+		sizet archetypeCount() const;
+
+		// Archetype with an empty aspect, newly created entities start here
+		Archetype* getRootArchetype();
+
+		// Resolves single component transitions through the cached archetype edges
+		Archetype* getArchetypeWith(Archetype* from, ComponentID id);
+		Archetype* getArchetypeWithout(Archetype* from, ComponentID id);
+
+		// (returns nullptr if entity is not tracked)
+		Archetype* findEntityArchetype(Entity entity) const;
+
 		bool isEntityTracked(Entity entity) const;
 
+		const EntityRecordTable& getEntityRecords() const;
+
 		void moveEntity(Entity entity, const Aspect& toAspect);
 		void moveEntities(const Aspect& toAspect, eastl::span<const Entity> entities);
+		// All entities must be located in from
+		void moveEntities(Archetype* from, Archetype* to, eastl::span<const Entity> entities);
 
 		void removeEntity(Entity entity);
 		void removeEntities(eastl::span<const Entity> entities);
@@ -49,6 +92,27 @@ namespace spite
 		void addEntity(const Aspect& aspect, const Entity& entity);
 		void addEntities(const Aspect& aspect, eastl::span<const Entity> entities);
 
+		// Places snapshot entities into a new chunk of the aspect's archetype, see Archetype::restoreChunk.
+		// Entities are reported to observers as added
+		Chunk* restoreChunk(const Aspect& aspect,
+		                    eastl::span<const Entity> entities,
+		                    eastl::span<const u64> enabledMasks,
+		                    std::byte* externalStorage = nullptr,
+		                    eastl::span<std::byte* const> componentDataStarts = {});
+
+		// Keeps a mapped snapshot alive for as long as chunks may point into it
+		void retainMappedFile(MappedFile&& file);
+
+		// Moves every chunk of source into the matching archetypes of this manager, source is left without entities.
+		// remap holds the entity of this manager for every source entity index.
+		// Trivially copyable columns are copied with one memcpy per chunk column, others are relocated with their
+		// move hooks, shared handles are re-interned into this manager's pools
+		void mergeFrom(ArchetypeManager& source, eastl::span<const Entity> remap);
+
+		// Destroys every entity of the archetype without touching entity indices (world rollback).
+		// Entities are reported to observers as removed
+		void clearArchetype(u32 archetypeId);
+
 		void addComponent(const Entity entity, eastl::span<const ComponentID> componentsToAdd);
 		void addComponents(eastl::span<const Entity> entities, eastl::span<const ComponentID> componentsToAdd);
 
@@ -67,6 +131,8 @@ namespace spite
 		heap_vector<Archetype*> queryNonEmptyArchetypes(const Aspect& includeAspect,
 		                                                const Aspect& excludeAspect = {}) const;
 
+		ComponentObserverRegistry& getObserverRegistry();
+
 		//resets component modified statuses of chunks
 		void resetAllModificationTracking();
 
@@ -102,7 +168,7 @@ namespace spite
 	void ArchetypeManager::modifyComponent(const Entity entity, eastl::span<const ComponentID> componentsToModify)
 	{
 		SASSERT(isEntityTracked(entity))
-		Archetype* fromArchetype = m_entityToArchetype.at(entity);
+		Archetype* fromArchetype = m_entityRecords.find(entity)->archetype;
 
 		auto allocMarker = FrameScratchAllocator::get().get_scoped_marker();
 		auto components = makeScratchVector<ComponentID>(FrameScratchAllocator::get());
@@ -143,12 +209,12 @@ namespace spite
 	                                        eastl::span<const ComponentID> componentsToModify)
 	{
 		auto allocMarker = FrameScratchAllocator::get().get_scoped_marker();
-		auto entityLookup = makeScratchMap<Archetype*, scratch_vector<Entity>>(FrameScratchAllocator::get());
+		auto entityLookup = makeScratchFlatMap<Archetype*, scratch_vector<Entity>>(FrameScratchAllocator::get());
 
 		for (const auto& entity : entities)
 		{
 			SASSERT(isEntityTracked(entity))
-			Archetype* archetype = m_entityToArchetype.at(entity);
+			Archetype* archetype = m_entityRecords.find(entity)->archetype;
 			auto it = entityLookup.find(archetype);
 			if (it == entityLookup.end())
 			{
@@ -39,6 +39,9 @@ namespace spite
 			return it->second;
 		}
 
+		// Parents and children are returned in scratch memory, released here rather than inside the helpers
+		auto marker = FrameScratchAllocator::get().get_scoped_marker();
+
 		// 1. Create the new node
 		auto newNode = new AspectNode(m_allocator, aspect);
 		m_aspectToNode.emplace(aspect, newNode);
@@ -51,27 +54,20 @@ namespace spite
 			parent->children.push_back(newNode);
 		}
 
-		// 3. Find children and reparent them. A child `c` of a parent `p` of `newNode` 
-		// might now need to become a child of `newNode` if `c` is a superset of `newNode`.
-		for (AspectNode* p : parents)
+		// 3. Find its children and reparent them. Any existing superset can become a child,
+		// not only children of the new parents: a superset may hang below an unrelated subset of itself
+		auto children = findBestChildren(aspect);
+		for (AspectNode* c : children)
 		{
-			auto p_children_copy = makeScratchVector<AspectNode*>(FrameScratchAllocator::get());
-			p_children_copy.assign(p->children.begin(), p->children.end());
-
-			for (AspectNode* c : p_children_copy)
+			// The direct link from a parent p to c is now redundant, p < newNode < c
+			for (AspectNode* p : parents)
 			{
-				if (c != newNode && c->aspect.contains(newNode->aspect))
-				{
-					// c should be a child of newNode, and the direct link from p to c is now redundant.
-					// Remove p <-> c link
-					p->children.erase(std::remove(p->children.begin(), p->children.end(), c), p->children.end());
-					c->parents.erase(std::remove(c->parents.begin(), c->parents.end(), p), c->parents.end());
-
-					// Add newNode <-> c link
-					newNode->children.push_back(c);
-					c->parents.push_back(newNode);
-				}
+				p->children.erase(std::remove(p->children.begin(), p->children.end(), c), p->children.end());
+				c->parents.erase(std::remove(c->parents.begin(), c->parents.end(), p), c->parents.end());
 			}
+
+			newNode->children.push_back(c);
+			c->parents.push_back(newNode);
 		}
 
 		return newNode;
@@ -79,7 +75,6 @@ namespace spite
 
 	scratch_vector<AspectRegistry::AspectNode*> AspectRegistry::findBestParents(const Aspect& newAspect)
 	{
-		auto marker = FrameScratchAllocator::get().get_scoped_marker();
 		auto candidates = makeScratchVector<AspectNode*>(FrameScratchAllocator::get());
 
 		// 1. Find all proper subsets of newAspect
@@ -120,6 +115,42 @@ namespace spite
 		return bestParents;
 	}
 
+	scratch_vector<AspectRegistry::AspectNode*> AspectRegistry::findBestChildren(const Aspect& newAspect)
+	{
+		auto candidates = makeScratchVector<AspectNode*>(FrameScratchAllocator::get());
+
+		// 1. Find all proper supersets of newAspect
+		for (const auto& [aspect, node] : m_aspectToNode)
+		{
+			if (aspect.contains(newAspect) && aspect != newAspect)
+			{
+				candidates.push_back(node);
+			}
+		}
+
+		auto bestChildren = makeScratchVector<AspectNode*>(FrameScratchAllocator::get());
+
+		// 2. Filter for minimal supersets (remove candidates that are supersets of other candidates)
+		for (AspectNode* candidate : candidates)
+		{
+			bool isMinimal = true;
+			for (AspectNode* other : candidates)
+			{
+				if (candidate != other && candidate->aspect.contains(other->aspect))
+				{
+					isMinimal = false;
+					break;
+				}
+			}
+			if (isMinimal)
+			{
+				bestChildren.push_back(candidate);
+			}
+		}
+
+		return bestChildren;
+	}
+
 	scratch_vector<const Aspect*> AspectRegistry::getDescendantAspects(const Aspect& aspect) const
 	{
 		auto descendants = makeScratchVector<const Aspect*>(FrameScratchAllocator::get());
@@ -49,6 +49,7 @@ namespace spite
 
 		// Finds all most-specific parents for a new aspect
 		scratch_vector<AspectNode*> findBestParents(const Aspect& newAspect);
+		scratch_vector<AspectNode*> findBestChildren(const Aspect& newAspect);
 
 		// Traversal helpers with visited set for DAGs
 		void collectDescendants(AspectNode* node, scratch_vector<const Aspect*>& descendants,
@@ -10,54 +10,78 @@
 namespace spite
 {
 	Chunk::Chunk(const Aspect* aspect,
-	             HeapAllocator& allocator): m_aspect(aspect), m_count(0),
-	                                        m_allocator(allocator), m_storageBlock(nullptr),
-	                                        m_componentDataStarts(
-		                                        makeSboVector<
-			                                        std::byte*, DEFAULT_COMPONENTS_INLINE_CAPACITY>(
-			                                        m_allocator)),
-	                                        m_modifiedBitsets(
-		                                        makeSboVector<
-			                                        std::bitset<CAPACITY>,
-			                                        DEFAULT_COMPONENTS_INLINE_CAPACITY>(
-			                                        m_allocator)),
-	                                        m_enabledBitsets(
-		                                        makeSboVector<
-			                                        std::bitset<CAPACITY>,
-			                                        DEFAULT_COMPONENTS_INLINE_CAPACITY>(
-			                                        m_allocator))
+	             HeapAllocator& allocator,
+	             eastl::span<const ComponentPlacement> columnPlacements,
+	             u32 numaNode): m_aspect(aspect), m_count(0),
+	                                                                     m_allocator(allocator),
+	                                                                     m_storageBlock(nullptr),
+	                                                                     m_numaNode(numaNode),
+	                                                                     m_componentDataStarts(
+		                                                                     makeSboVector<
+			                                                                     std::byte*,
+			                                                                     DEFAULT_COMPONENTS_INLINE_CAPACITY>(
+			                                                                     m_allocator)),
+	                                                                     m_modifiedBitsets(
+		                                                                     makeSboVector<
+			                                                                     std::bitset<CAPACITY>,
+			                                                                     DEFAULT_COMPONENTS_INLINE_CAPACITY>(
+			                                                                     m_allocator)),
+	                                                                     m_enabledBitsets(
+		                                                                     makeSboVector<
+			                                                                     std::bitset<CAPACITY>,
+			                                                                     DEFAULT_COMPONENTS_INLINE_CAPACITY>(
+			                                                                     m_allocator)),
+	                                                                     m_columnVersions(
+		                                                                     makeSboVector<
+			                                                                     u32,
+			                                                                     DEFAULT_COMPONENTS_INLINE_CAPACITY>(
+			                                                                     m_allocator))
 	{
 		const auto& componentIds = m_aspect->getComponentIds();
 		const auto numComponentTypes = componentIds.size();
+		SASSERT(columnPlacements.empty() || columnPlacements.size() == numComponentTypes)
 		m_componentDataStarts.resize(numComponentTypes);
 		m_modifiedBitsets.resize(numComponentTypes);
 		m_enabledBitsets.resize(numComponentTypes);
+		m_columnVersions.resize(numComponentTypes, 0);
 
-		// Calculate total size, offsets, and max alignment
-		sizet totalSize = 0;
-		sizet maxAlignment = alignof(std::max_align_t);
-		sbo_vector<sizet> offsets;
-		offsets.resize(numComponentTypes);
-		for (sizet i = 0; i < componentIds.size(); ++i)
+		// Hot and cold columns are laid out as two independent blocks
+		for (const ComponentPlacement placement : {ComponentPlacement::eHot, ComponentPlacement::eCold})
 		{
-			const auto& meta = ComponentMetadataRegistry::getMetadata(componentIds[i]);
-			maxAlignment = std::max(meta.alignment, maxAlignment);
-			// Align the current offset
-			if (totalSize % meta.alignment != 0)
+			sbo_vector<ComponentID> blockIds;
+			sbo_vector<sizet> blockColumns;
+			for (sizet i = 0; i < numComponentTypes; ++i)
 			{
-				totalSize += meta.alignment - (totalSize % meta.alignment);
+				const ComponentPlacement columnPlacement = columnPlacements.empty()
+					                                           ? ComponentPlacement::eHot
+					                                           : columnPlacements[i];
+				if (columnPlacement == placement)
+				{
+					blockIds.push_back(componentIds[i]);
+					blockColumns.push_back(i);
+				}
+			}
+			if (placement == ComponentPlacement::eCold && blockIds.empty())
+			{
+				break;
 			}
-			offsets[i] = totalSize;
-			totalSize += meta.size * CAPACITY;
-		}
 
-		// Perform the single allocation
-		m_storageBlock = static_cast<std::byte*>(m_allocator.allocate(totalSize, maxAlignment));
+			sizet maxAlignment;
+			sbo_vector<sizet> offsets;
+			offsets.resize(blockIds.size());
+			const sizet totalSize = computeColumnOffsets(
+				eastl::span<const ComponentID>(blockIds.begin(), blockIds.size()),
+				eastl::span<sizet>(offsets.begin(), offsets.size()), maxAlignment);
 
-		// Set component start pointers
-		for (sizet i = 0; i < componentIds.size(); ++i)
-		{
-			m_componentDataStarts[i] = m_storageBlock + offsets[i];
+			// Perform the single allocation
+			std::byte* block = static_cast<std::byte*>(m_allocator.allocate(totalSize, maxAlignment));
+			(placement == ComponentPlacement::eHot ? m_storageBlock : m_coldStorageBlock) = block;
+
+			// Set component start pointers
+			for (sizet i = 0; i < blockIds.size(); ++i)
+			{
+				m_componentDataStarts[blockColumns[i]] = block + offsets[i];
+			}
 		}
 
 		for (auto& enabledBitset : m_enabledBitsets)
@@ -66,22 +90,99 @@ namespace spite
 		}
 	}
 
+	Chunk::Chunk(const Aspect* aspect,
+	             HeapAllocator& allocator,
+	             std::byte* externalStorage,
+	             eastl::span<std::byte* const> componentDataStarts): m_aspect(aspect), m_count(0),
+	                                                                m_allocator(allocator),
+	                                                                m_storageBlock(externalStorage),
+	                                                                m_ownsStorage(false),
+	                                                                m_componentDataStarts(
+		                                                                makeSboVector<
+			                                                                std::byte*,
+			                                                                DEFAULT_COMPONENTS_INLINE_CAPACITY>(
+			                                                                m_allocator)),
+	                                                                m_modifiedBitsets(
+		                                                                makeSboVector<
+			                                                                std::bitset<CAPACITY>,
+			                                                                DEFAULT_COMPONENTS_INLINE_CAPACITY>(
+			                                                                m_allocator)),
+	                                                                m_enabledBitsets(
+		                                                                makeSboVector<
+			                                                                std::bitset<CAPACITY>,
+			                                                                DEFAULT_COMPONENTS_INLINE_CAPACITY>(
+			                                                                m_allocator)),
+	                                                                m_columnVersions(
+		                                                                makeSboVector<
+			                                                                u32, DEFAULT_COMPONENTS_INLINE_CAPACITY>(
+			                                                                m_allocator))
+	{
+		const auto numComponentTypes = m_aspect->getComponentIds().size();
+		SASSERT(componentDataStarts.size() == numComponentTypes)
+		m_componentDataStarts.resize(numComponentTypes);
+		m_modifiedBitsets.resize(numComponentTypes);
+		m_enabledBitsets.resize(numComponentTypes);
+		m_columnVersions.resize(numComponentTypes, 0);
+
+		for (sizet i = 0; i < numComponentTypes; ++i)
+		{
+			m_componentDataStarts[i] = componentDataStarts[i];
+			m_enabledBitsets[i].set();
+		}
+	}
+
 	Chunk::~Chunk()
 	{
-		m_allocator.deallocate(m_storageBlock, 0);
+		if (m_ownsStorage)
+		{
+			m_allocator.deallocate(m_storageBlock, 0);
+		}
+		if (m_coldStorageBlock)
+		{
+			m_allocator.deallocate(m_coldStorageBlock, 0);
+		}
+	}
+
+	sizet Chunk::computeColumnOffsets(eastl::span<const ComponentID> componentIds, eastl::span<sizet> offsets,
+	                                  sizet& alignment)
+	{
+		SASSERT(offsets.size() >= componentIds.size())
+
+		// Calculate total size, offsets, and max alignment
+		sizet totalSize = 0;
+		alignment = alignof(std::max_align_t);
+		for (sizet i = 0; i < componentIds.size(); ++i)
+		{
+			const auto& meta = ComponentMetadataRegistry::getMetadata(componentIds[i]);
+			alignment = std::max(meta.alignment, alignment);
+			// Align the current offset
+			if (totalSize % meta.alignment != 0)
+			{
+				totalSize += meta.alignment - (totalSize % meta.alignment);
+			}
+			offsets[i] = totalSize;
+			totalSize += meta.size * CAPACITY;
+		}
+		return totalSize;
 	}
 
 	Chunk::Chunk(Chunk&& other) noexcept: m_aspect(other.m_aspect),
 	                                      m_count(other.m_count),
 	                                      m_allocator(other.m_allocator),
 	                                      m_storageBlock(other.m_storageBlock),
+	                                      m_coldStorageBlock(other.m_coldStorageBlock),
+	                                      m_ownsStorage(other.m_ownsStorage),
+	                                      m_numaNode(other.m_numaNode),
 	                                      m_entities(other.m_entities),
 	                                      m_componentDataStarts(
 		                                      std::move(other.m_componentDataStarts)),
 	                                      m_modifiedBitsets(std::move(other.m_modifiedBitsets)),
-	                                      m_enabledBitsets(std::move(other.m_enabledBitsets))
+	                                      m_enabledBitsets(std::move(other.m_enabledBitsets)),
+	                                      m_structureVersion(other.m_structureVersion),
+	                                      m_columnVersions(std::move(other.m_columnVersions))
 	{
 		other.m_storageBlock = nullptr;
+		other.m_coldStorageBlock = nullptr;
 		other.m_count = 0;
 	}
 
@@ -89,21 +190,31 @@ namespace spite
 	{
 		if (this != &other)
 		{
-			if (m_storageBlock)
+			if (m_storageBlock && m_ownsStorage)
 			{
 				m_allocator.deallocate(m_storageBlock, 0);
 			}
+			if (m_coldStorageBlock)
+			{
+				m_allocator.deallocate(m_coldStorageBlock, 0);
+			}
 
 			m_aspect = other.m_aspect;
 			m_count = other.m_count;
 			m_allocator = other.m_allocator;
 			m_storageBlock = other.m_storageBlock;
+			m_coldStorageBlock = other.m_coldStorageBlock;
+			m_ownsStorage = other.m_ownsStorage;
+			m_numaNode = other.m_numaNode;
 			m_entities = other.m_entities;
 			m_componentDataStarts = std::move(other.m_componentDataStarts);
 			m_modifiedBitsets = std::move(other.m_modifiedBitsets);
 			m_enabledBitsets = std::move(other.m_enabledBitsets);
+			m_structureVersion = other.m_structureVersion;
+			m_columnVersions = std::move(other.m_columnVersions);
 
 			other.m_storageBlock = nullptr;
+			other.m_coldStorageBlock = nullptr;
 			other.m_count = 0;
 		}
 		return *this;
@@ -134,6 +245,11 @@ namespace spite
 		return *m_aspect;
 	}
 
+	u32 Chunk::numaNode() const
+	{
+		return m_numaNode;
+	}
+
 	sizet Chunk::addEntity(const Entity entity)
 	{
 		SASSERT(!full())
@@ -147,6 +263,7 @@ namespace spite
 			m_modifiedBitsets[i].set(newEntityIndex);
 			m_enabledBitsets[i].set(newEntityIndex);
 		}
+		++m_structureVersion;
 
 		return m_count++;
 	}
@@ -183,9 +300,37 @@ namespace spite
 			}
 		}
 		m_count--;
+		++m_structureVersion;
 		return swappedEntity;
 	}
 
+	void Chunk::restoreEntities(eastl::span<const Entity> entities, eastl::span<const u64> enabledMasks)
+	{
+		SASSERT(empty())
+		SASSERT(entities.size() <= CAPACITY)
+		SASSERT(enabledMasks.size() == m_enabledBitsets.size())
+
+		std::copy(entities.begin(), entities.end(), m_entities.begin());
+		m_count = entities.size();
+		for (sizet i = 0; i < m_enabledBitsets.size(); ++i)
+		{
+			m_enabledBitsets[i] = std::bitset<CAPACITY>(enabledMasks[i]);
+			m_modifiedBitsets[i].set();
+		}
+		++m_structureVersion;
+	}
+
+	void Chunk::clear()
+	{
+		m_count = 0;
+		for (sizet i = 0; i < m_enabledBitsets.size(); ++i)
+		{
+			m_enabledBitsets[i].set();
+			m_modifiedBitsets[i].reset();
+		}
+		++m_structureVersion;
+	}
+
 	Entity Chunk::entity(const sizet entityChunkIndex) const
 	{
 		SASSERT(entityChunkIndex < m_count)
@@ -205,6 +350,37 @@ namespace spite
 		}
 	}
 
+	u32 Chunk::structureVersion() const
+	{
+		return m_structureVersion;
+	}
+
+	u32 Chunk::columnVersionByIndex(sizet componentIndexInChunk) const
+	{
+		return m_columnVersions[componentIndexInChunk];
+	}
+
+	sizet Chunk::getComponentIndex(ComponentID id) const
+	{
+		SASSERT(m_aspect->contains(id))
+
+		const auto& aspectIds = m_aspect->getComponentIds();
+		for (sizet i = 0; i < aspectIds.size(); ++i)
+		{
+			if (aspectIds[i] == id)
+			{
+				return i;
+			}
+		}
+		return 0;
+	}
+
+	std::byte* Chunk::getComponentArrayByIndex(sizet componentIndexInChunk) const
+	{
+		SASSERT(componentIndexInChunk < m_componentDataStarts.size())
+		return m_componentDataStarts[componentIndexInChunk];
+	}
+
 	void* Chunk::getComponentDataPtrByIndex(sizet componentIndexInChunk, sizet entityIndexInChunk)
 	{
 		SASSERT(componentIndexInChunk < m_aspect->getComponentIds().size())
@@ -232,6 +408,7 @@ namespace spite
 		SASSERT(componentIndexInChunk < m_aspect->getComponentIds().size())
 		SASSERT(entityIndexInChunk < m_count)
 		m_modifiedBitsets[componentIndexInChunk].set(entityIndexInChunk);
+		++m_columnVersions[componentIndexInChunk];
 	}
 
 	bool Chunk::wasModifiedLastFrameByIndex(const sizet componentIndexInChunk,
@@ -240,15 +417,22 @@ namespace spite
 		return m_modifiedBitsets[componentIndexInChunk].test(entityIndexInChunk);
 	}
 
+	u64 Chunk::getEnabledMaskByIndex(sizet componentIndexInChunk) const
+	{
+		return m_enabledBitsets[componentIndexInChunk].to_ullong();
+	}
+
 	void Chunk::enableComponentByIndex(sizet componentIndexInChunk, sizet entityIndexInChunk)
 	{
 		m_enabledBitsets[componentIndexInChunk].set(entityIndexInChunk);
+		++m_structureVersion;
 	}
 
 	void Chunk::disableComponentByIndex(sizet componentIndexInChunk,
 	                                           sizet entityIndexInChunk)
 	{
 		m_enabledBitsets[componentIndexInChunk].reset(entityIndexInChunk);
+		++m_structureVersion;
 	}
 
 	bool Chunk::isComponentEnabledByIndex(sizet componentIndexInChunk,
@@ -8,6 +8,7 @@
 #include "base/CollectionAliases.hpp"
 #include "base/memory/HeapAllocator.hpp"
 
+#include "ecs/core/ComponentAccessStats.hpp"
 #include "ecs/core/ComponentMetadataRegistry.hpp"
 #include "ecs/storage/Aspect.hpp"
 
@@ -17,6 +18,16 @@ namespace spite
 	constexpr sizet DEFAULT_CHUNK_CAPACITY = 32;
 	constexpr sizet DEFAULT_COMPONENTS_INLINE_CAPACITY = 8;
 
+	// How columns of ComponentPlacement::eAuto components are placed in chunks of newly created archetypes,
+	// pinned eHot/eCold placements are always honored
+	enum class ChunkLayoutMode : u8
+	{
+		// In the main storage block
+		eSingleBlock,
+		// In the cold block if ComponentAccessStats reports them as rarely accessed
+		eAccessStats
+	};
+
 	class Chunk
 	{
 		static constexpr sizet CAPACITY = DEFAULT_CHUNK_CAPACITY;
@@ -26,8 +37,14 @@ namespace spite
 		sizet m_count;
 		HeapAllocator& m_allocator;
 
-		// A single block of memory for all component arrays.
+		// A single block of memory for all hot component arrays.
 		std::byte* m_storageBlock;
+		// Side allocation for cold component arrays, nullptr if every column is hot
+		std::byte* m_coldStorageBlock = nullptr;
+		// False if the block was adopted from memory owned elsewhere (mapped world snapshot)
+		bool m_ownsStorage = true;
+		// Node the storage was allocated on, 0 if NUMA placement is off
+		u32 m_numaNode = 0;
 
 		eastl::array<Entity, CAPACITY> m_entities;
 		heap_sbo_vector<std::byte*, DEFAULT_COMPONENTS_INLINE_CAPACITY> m_componentDataStarts;
@@ -37,12 +54,32 @@ namespace spite
 		m_modifiedBitsets;
 		heap_sbo_vector<std::bitset<CAPACITY>, DEFAULT_COMPONENTS_INLINE_CAPACITY> m_enabledBitsets;
 
+		// Change versions for delta capture, unlike the modification bits they are never reset.
+		// Structure covers entity order and enabled bits, columns are bumped whenever a column is marked modified
+		u32 m_structureVersion = 0;
+		heap_sbo_vector<u32, DEFAULT_COMPONENTS_INLINE_CAPACITY> m_columnVersions;
+
 	public:
+		// columnPlacements holds eHot or eCold for every column, empty places everything in the main block
+		Chunk(const Aspect* aspect,
+		      HeapAllocator& allocator,
+		      eastl::span<const ComponentPlacement> columnPlacements = {},
+		      u32 numaNode = 0);
+
+		// Uses externalStorage for the component arrays instead of allocating,
+		// the memory must outlive the chunk and fit CAPACITY elements at every column start
 		Chunk(const Aspect* aspect,
-		      HeapAllocator& allocator);
+		      HeapAllocator& allocator,
+		      std::byte* externalStorage,
+		      eastl::span<std::byte* const> componentDataStarts);
 
 		~Chunk();
 
+		// Offsets of component arrays inside a storage block, laid out in the given order.
+		// Returns the block size, alignment receives the required block alignment
+		static sizet computeColumnOffsets(eastl::span<const ComponentID> componentIds, eastl::span<sizet> offsets,
+		                                  sizet& alignment);
+
 		Chunk(const Chunk&) = delete;
 		Chunk& operator=(const Chunk&) = delete;
 
@@ -60,6 +97,8 @@ namespace spite
 
 		[[nodiscard]] const Aspect& aspect() const;
 
+		[[nodiscard]] u32 numaNode() const;
+
 		//should be used for per-chunk iteration
 		template <typename T>
 		T* getComponents() const;
@@ -79,6 +118,13 @@ namespace spite
 		// Destructors for removedEntity should be called in Archetype
 		Entity removeEntityAndSwap(const sizet entityChunkIndex);
 
+		// Sets the entities of an empty chunk whose component data is already in place (snapshot loading).
+		// enabledMasks holds one bit per entity for every component, all components are marked modified
+		void restoreEntities(eastl::span<const Entity> entities, eastl::span<const u64> enabledMasks);
+
+		// Forgets all entities, their components must already be destroyed
+		void clear();
+
 		[[nodiscard]] Entity entity(const sizet entityChunkIndex) const;
 
 		[[nodiscard]] eastl::span<const Entity> entities() const;
@@ -88,6 +134,16 @@ namespace spite
 
 		void resetModificationTracking();
 
+		[[nodiscard]] u32 structureVersion() const;
+
+		[[nodiscard]] u32 columnVersionByIndex(sizet componentIndexInChunk) const;
+
+		// Position of the component column in this chunk, the component must be part of the aspect
+		[[nodiscard]] sizet getComponentIndex(ComponentID id) const;
+
+		// Start of a component column, elements are laid out contiguously without tracking side effects
+		[[nodiscard]] std::byte* getComponentArrayByIndex(sizet componentIndexInChunk) const;
+
 		// Gets a raw pointer to an entity's component data using a pre-calculated index. (O(1) access)
 		void* getComponentDataPtrByIndex(sizet componentIndexInChunk, sizet entityIndexInChunk);
 
@@ -97,6 +153,9 @@ namespace spite
 		// Marks a component as modified using a pre-calculated index. (O(1) access)
 		void markModifiedByIndex(sizet componentIndexInChunk, sizet entityIndexInChunk);
 
+		// One bit per entity
+		[[nodiscard]] u64 getEnabledMaskByIndex(sizet componentIndexInChunk) const;
+
 		void enableComponentByIndex(sizet componentIndexInChunk, sizet entityIndexInChunk);
 
 		void disableComponentByIndex(sizet componentIndexInChunk, sizet entityIndexInChunk);
@@ -108,43 +167,25 @@ namespace spite
 	template <typename T>
 	T* Chunk::getComponents() const
 	{
-		auto id = ComponentMetadataRegistry::getComponentId<T>();
-		SASSERT(m_aspect->contains(id))
-
-		const auto& aspectIds = m_aspect->getComponentIds();
-		sizet componentIdx = 0;
-
-		for (sizet i = 0; i < aspectIds.size(); ++i)
+		const ComponentID componentId = ComponentMetadataRegistry::getComponentId<T>();
+		if (ComponentAccessStats::isEnabled())
 		{
-			if (aspectIds[i] == id)
-			{
-				componentIdx = i;
-				break;
-			}
+			ComponentAccessStats::recordChunk(componentId, false, m_count);
 		}
-
-		return reinterpret_cast<T*>(m_componentDataStarts[componentIdx]);
+		return reinterpret_cast<T*>(m_componentDataStarts[getComponentIndex(componentId)]);
 	}
 
 	template <typename T>
 	T* Chunk::getComponents()
 	{
-		auto id = ComponentMetadataRegistry::getComponentId<T>();
-		SASSERT(m_aspect->contains(id))
-
-		const auto& aspectIds = m_aspect->getComponentIds();
-		sizet componentIdx = 0;
-
-		for (sizet i = 0; i < aspectIds.size(); ++i)
+		const ComponentID componentId = ComponentMetadataRegistry::getComponentId<T>();
+		if (ComponentAccessStats::isEnabled())
 		{
-			if (aspectIds[i] == id)
-			{
-				componentIdx = i;
-				break;
-			}
+			ComponentAccessStats::recordChunk(componentId, true, m_count);
 		}
-
+		const sizet componentIdx = getComponentIndex(componentId);
 		m_modifiedBitsets[componentIdx].set();
+		++m_columnVersions[componentIdx];
 
 		return reinterpret_cast<T*>(m_componentDataStarts[componentIdx]);
 	}
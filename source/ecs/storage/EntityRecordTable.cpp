@@ -0,0 +1,36 @@
+#include "EntityRecordTable.hpp"
+
+#include "base/Assert.hpp"
+
+namespace spite
+{
+	EntityRecordTable::EntityRecordTable(const HeapAllocator& allocator)
+		: m_records(makeHeapVector<EntityRecord>(allocator))
+	{
+	}
+
+	EntityRecord& EntityRecordTable::getOrCreate(Entity entity)
+	{
+		SASSERTM(entity.generation() != Entity::PROXY_GENERATION, "Proxy entity %llu cannot be placed\n",
+		         entity.id())
+
+		const u32 index = entity.index();
+		if (index >= m_records.size())
+		{
+			m_records.resize(index + 1);
+		}
+
+		EntityRecord& record = m_records[index];
+		record.generation = entity.generation();
+		return record;
+	}
+
+	void EntityRecordTable::release(Entity entity)
+	{
+		EntityRecord* record = find(entity);
+		if (record)
+		{
+			record->archetype = nullptr;
+		}
+	}
+}
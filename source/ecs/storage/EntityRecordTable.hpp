@@ -0,0 +1,53 @@
+#pragma once
+#include "base/CollectionUtilities.hpp"
+#include "ecs/core/Entity.hpp"
+
+namespace spite
+{
+	class Archetype;
+
+	// Where an entity currently lives
+	struct EntityRecord
+	{
+		Archetype* archetype = nullptr;
+		u32 generation = 0;
+		u32 chunkIndex = 0;
+		u32 indexInChunk = 0;
+	};
+
+	// Dense table indexed by Entity::index(), replaces per-archetype location maps.
+	// Written by Archetype on every placement, so it always points at the current slot
+	class EntityRecordTable
+	{
+	private:
+		heap_vector<EntityRecord> m_records;
+
+	public:
+		EntityRecordTable(const HeapAllocator& allocator);
+
+		// Grows the table if needed and binds the slot to the entity generation
+		EntityRecord& getOrCreate(Entity entity);
+
+		// (returns nullptr if entity is not tracked or the handle is stale)
+		EntityRecord* find(Entity entity);
+		const EntityRecord* find(Entity entity) const;
+
+		void release(Entity entity);
+	};
+
+	inline EntityRecord* EntityRecordTable::find(Entity entity)
+	{
+		const u32 index = entity.index();
+		if (index >= m_records.size())
+		{
+			return nullptr;
+		}
+		EntityRecord& record = m_records[index];
+		return record.archetype && record.generation == entity.generation() ? &record : nullptr;
+	}
+
+	inline const EntityRecord* EntityRecordTable::find(Entity entity) const
+	{
+		return const_cast<EntityRecordTable*>(this)->find(entity);
+	}
+}
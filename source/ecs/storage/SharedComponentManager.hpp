@@ -1,5 +1,7 @@
 #pragma once
 
+#include <new>
+
 #include <EASTL/vector.h>
 #include <EASTL/unordered_set.h>
 
@@ -9,6 +11,7 @@
 #include "ecs/core/ComponentMetadata.hpp"
 #include "ecs/core/ComponentMetadataRegistry.hpp"
 #include "ecs/core/IComponent.hpp"
+#include "ecs/serialization/SnapshotStream.hpp"
 
 namespace spite
 {
@@ -39,6 +42,15 @@ namespace spite
 		virtual void incrementRef(u32 index) = 0;
 		virtual void decrementRef(u32 index) = 0;
 		virtual void destroy(HeapAllocator& allocator) = 0;
+
+		// Snapshot support, slots keep their indices so handles stay valid
+		virtual void serialize(SnapshotWriter& writer) const = 0;
+		// Pool must be empty, (returns false if the data is truncated)
+		virtual bool deserialize(SnapshotReader& reader) = 0;
+
+		// Interns the value at index into target, a pool of the same type, and references it there
+		// (returns the index in target)
+		virtual u32 transferTo(u32 index, ISharedComponentPool& target) const = 0;
 	};
 
 	template <t_shared_component T>
@@ -155,6 +167,18 @@ namespace spite
 		{
 			allocator.delete_object(this);
 		}
+
+		void serialize(SnapshotWriter& writer) const override;
+		bool deserialize(SnapshotReader& reader) override;
+
+		u32 transferTo(u32 index, ISharedComponentPool& target) const override
+		{
+			SASSERT(index < m_data.size())
+			auto& typedTarget = static_cast<TypedSharedComponentPool&>(target);
+			const u32 targetIndex = typedTarget.findOrCreateIndex(m_data[index]);
+			typedTarget.incrementRef(targetIndex);
+			return targetIndex;
+		}
 	};
 
 	template <t_shared_component T>
@@ -203,6 +227,73 @@ namespace spite
 		return newIndex;
 	}
 
+	template <t_shared_component T>
+	void TypedSharedComponentPool<T>::serialize(SnapshotWriter& writer) const
+	{
+		if constexpr (std::is_trivially_copyable_v<T>)
+		{
+			// Free slots are written as well, their bytes are never read
+			writer.writeValue(static_cast<u32>(m_data.size()));
+			writer.writeValue(static_cast<u32>(m_freeList.size()));
+			writer.write(m_data.data(), m_data.size() * sizeof(T));
+			writer.write(m_refCounts.data(), m_refCounts.size() * sizeof(u32));
+			writer.write(m_freeList.data(), m_freeList.size() * sizeof(u32));
+		}
+		else
+		{
+			SASSERTM(false, "Shared component %s is not trivially copyable and cannot be serialized\n",
+			         typeid(T).name())
+		}
+	}
+
+	template <t_shared_component T>
+	bool TypedSharedComponentPool<T>::deserialize(SnapshotReader& reader)
+	{
+		SASSERT(m_data.empty())
+		if constexpr (std::is_trivially_copyable_v<T>)
+		{
+			const u32 slotCount = reader.readValue<u32>();
+			const u32 freeCount = reader.readValue<u32>();
+			const std::byte* data = reader.skip(static_cast<sizet>(slotCount) * sizeof(T));
+			if (!data)
+			{
+				return false;
+			}
+
+			m_data.reserve(slotCount);
+			m_refCounts.resize(slotCount);
+			m_freeList.resize(freeCount);
+			for (u32 i = 0; i < slotCount; ++i)
+			{
+				alignas(T) std::byte slot[sizeof(T)];
+				memcpy(slot, data + i * sizeof(T), sizeof(T));
+				m_data.push_back(*std::launder(reinterpret_cast<T*>(slot)));
+			}
+			reader.read(m_refCounts.data(), slotCount * sizeof(u32));
+			reader.read(m_freeList.data(), freeCount * sizeof(u32));
+			if (reader.failed())
+			{
+				return false;
+			}
+
+			// Values modified in place were removed from interning, after a reload they can be shared again
+			for (u32 i = 0; i < slotCount; ++i)
+			{
+				if (m_refCounts[i] > 0)
+				{
+					m_valueToIndexSet.insert(i);
+				}
+			}
+			return true;
+		}
+		else
+		{
+			SASSERTM(false, "Shared component %s is not trivially copyable and cannot be deserialized\n",
+			         typeid(T).name())
+			return false;
+		}
+	}
+
 	class SharedComponentManager
 	{
 	private:
@@ -263,6 +354,61 @@ namespace spite
 			if (handle.componentId == INVALID_COMPONENT_ID) return;
 			m_pools.at(handle.componentId)->decrementRef(handle.dataIndex);
 		}
+
+		const heap_unordered_map<ComponentID, ISharedComponentPool*>& getPools() const { return m_pools; }
+
+		// Re-interns a handle of another manager into this one (world merging), the returned handle holds a reference
+		SharedComponentHandle importHandle(SharedComponentHandle handle, const SharedComponentManager& source)
+		{
+			if (handle.componentId == INVALID_COMPONENT_ID) return handle;
+
+			auto it = m_pools.find(handle.componentId);
+			if (it == m_pools.end())
+			{
+				it = m_pools.emplace(handle.componentId,
+				                     ComponentMetadataRegistry::getMetadata(handle.componentId).createSharedPool(
+					                     m_allocator)).first;
+			}
+			return {handle.componentId, source.m_pools.at(handle.componentId)->transferTo(handle.dataIndex, *it->second)};
+		}
+
+		// Reads a pool of a shared component from a snapshot without installing it
+		// (returns nullptr if the data is truncated)
+		ISharedComponentPool* readPool(ComponentID id, SnapshotReader& reader)
+		{
+			const auto& metadata = ComponentMetadataRegistry::getMetadata(id);
+			SASSERTM(metadata.createSharedPool, "Component %u is not a shared component\n", id)
+
+			ISharedComponentPool* pool = metadata.createSharedPool(m_allocator);
+			if (!pool->deserialize(reader))
+			{
+				pool->destroy(m_allocator);
+				return nullptr;
+			}
+			return pool;
+		}
+
+		// Destroys a pool from readPool that was not restored
+		void discardPool(ISharedComponentPool* pool)
+		{
+			pool->destroy(m_allocator);
+		}
+
+		// Replaces the pool of a shared component with one from readPool,
+		// no handle of the replaced pool may be alive
+		void restorePool(ComponentID id, ISharedComponentPool* pool)
+		{
+			auto it = m_pools.find(id);
+			if (it != m_pools.end())
+			{
+				it->second->destroy(m_allocator);
+				it->second = pool;
+			}
+			else
+			{
+				m_pools[id] = pool;
+			}
+		}
 	private:
 		template <t_shared_component T>
 		TypedSharedComponentPool<T>* getOrCreatePool()
@@ -96,6 +96,14 @@ namespace spite
 		}
 	}
 
+	void SystemBase::deliverObserved(ComponentObserverRegistry& observerRegistry) const
+	{
+		for (const auto& slot : m_observers)
+		{
+			observerRegistry.deliver(slot.observer);
+		}
+	}
+
 	bool SystemBase::isActive() const
 	{
 		return m_isActive;
@@ -6,7 +6,9 @@
 #include "SystemDependencyStorage.hpp"
 #include "SystemContext.hpp"
 
+#include "base/Collections.hpp"
 #include "ecs/core/IComponent.hpp"
+#include "ecs/event/ComponentObserverRegistry.hpp"
 #include "ecs/query/QueryHandle.hpp"
 #include "ecs/systems/ExecutionStage.hpp"
 
@@ -32,12 +34,35 @@ namespace spite
 
 		ExecutionStage m_stage = CoreExecutionStages::UPDATE;
 
+		struct ObserverSlot
+		{
+			ComponentID componentId;
+			ObserverEvent event;
+			ObserverID observer;
+		};
+
+		sbo_vector<ObserverSlot, 4> m_observers;
+
 	protected:
 		QueryHandle registerQuery(SystemQueryBuilder& builder, SystemDependencyStorage& dependencyStorage);
 
+		// Accepts Read<T>/Write<T> of both chunk components and singletons.
+		// Declared singletons are reached through SystemContext::readSingleton/writeSingleton without locking,
+		// the scheduler orders systems with conflicting singleton access instead
 		template <typename... T>
 		void declareAccess(SystemDependencyStorage& dependencyStorage);
 
+		template <typename TWrapper>
+		void declareSingleAccess(SystemDependencyStorage& dependencyStorage);
+
+		// Subscribes to add/remove/change batches of T, call from onInitialize
+		template <t_component T>
+		void observe(SystemContext ctx, ObserverEvent event);
+
+		// Entities of the batch delivered right before this update, in recording order
+		template <t_component T>
+		eastl::span<const Entity> observed(SystemContext ctx, ObserverEvent event) const;
+
 		void setExecutionStage(ExecutionStage stage)
 		{
 			m_stage = stage;
@@ -67,22 +92,60 @@ namespace spite
 	private:
 		void updatePrerequisiteState(const VersionManager& versionManager);
 		void prepareForUpdate(const SystemContext& ctx, const VersionManager& versionManager);
+		// Makes everything recorded since the previous update readable through observed()
+		void deliverObserved(ComponentObserverRegistry& observerRegistry) const;
 	};
 
+	template <t_component T>
+	void SystemBase::observe(SystemContext ctx, ObserverEvent event)
+	{
+		const ComponentID componentId = ComponentMetadataRegistry::getComponentId<T>();
+		const ObserverID observer = ctx.getObserverRegistry().subscribe(componentId, event);
+		m_observers.push_back({componentId, event, observer});
+	}
+
+	template <t_component T>
+	eastl::span<const Entity> SystemBase::observed(SystemContext ctx, ObserverEvent event) const
+	{
+		const ComponentID componentId = ComponentMetadataRegistry::getComponentId<T>();
+		for (const auto& slot : m_observers)
+		{
+			if (slot.componentId == componentId && slot.event == event)
+			{
+				return ctx.getObserverRegistry().getDelivered(slot.observer);
+			}
+		}
+		SASSERTM(false, "System did not observe component '%s' for this event\n", typeid(T).name())
+		return {};
+	}
+
 	template <typename... T>
 	void SystemBase::declareAccess(SystemDependencyStorage& dependencyStorage)
 	{
 		static_assert(((is_read_wrapper_v<T> || is_write_wrapper_v<T>) && ...),
 		              "declareAccess must be called with Read<T> or Write<T> wrappers.");
-		dependencyStorage.registerDependencies(
-			this, {
-				(is_read_wrapper_v<T>
-					 ? ComponentMetadataRegistry::getComponentId<typename T::type>()
-					 : INVALID_COMPONENT_ID)...
-			}, {
-				(is_write_wrapper_v<T>
-					 ? ComponentMetadataRegistry::getComponentId<typename T::type>()
-					 : INVALID_COMPONENT_ID)...
-			});
+		(declareSingleAccess<T>(dependencyStorage), ...);
+	}
+
+	template <typename TWrapper>
+	void SystemBase::declareSingleAccess(SystemDependencyStorage& dependencyStorage)
+	{
+		using T = typename TWrapper::type;
+		constexpr bool isWrite = is_write_wrapper_v<TWrapper>;
+
+		if constexpr (t_singleton_component<T>)
+		{
+			const SingletonID id = SingletonComponentRegistry::getSingletonId<T>();
+			const eastl::span<const SingletonID> ids(&id, 1);
+			dependencyStorage.registerSingletonDependencies(this, isWrite ? eastl::span<const SingletonID>() : ids,
+			                                                isWrite ? ids : eastl::span<const SingletonID>());
+		}
+		else
+		{
+			const ComponentID id = ComponentMetadataRegistry::getComponentId<T>();
+			const eastl::span<const ComponentID> ids(&id, 1);
+			dependencyStorage.registerDependencies(this, isWrite ? eastl::span<const ComponentID>() : ids,
+			                                       isWrite ? ids : eastl::span<const ComponentID>());
+		}
 	}
 }
@@ -1,4 +1,12 @@
 #pragma once
+#include <algorithm>
+#include <atomic>
+#include <functional>
+
+#include <enkiTS/TaskScheduler.h>
+
+#include "base/CollectionUtilities.hpp"
+#include "base/Numa.hpp"
 
 #include "ecs/systems/SystemDependencies.hpp"
 #include "ecs/core/EntityManager.hpp"
@@ -62,6 +70,68 @@ namespace spite
 		}
 	};
 
+	// Runs a range callback over the partitions enkiTS hands out
+	struct ParallelForTask : enki::ITaskSet
+	{
+		const std::function<void(u32 begin, u32 end)>* func;
+		// Workers record with the order of the calling system
+		u32 recordingOrder;
+
+		ParallelForTask(u32 count, u32 minRange, const std::function<void(u32 begin, u32 end)>& func) : func(&func),
+			recordingOrder(CommandBuffer::getRecordingOrder())
+		{
+			m_SetSize = count;
+			m_MinRange = minRange;
+		}
+
+		void ExecuteRange(enki::TaskSetPartition range, u32 threadnum) override
+		{
+			CommandBuffer::RecordingOrderScope orderScope(recordingOrder);
+			(*func)(range.start, range.end);
+		}
+	};
+
+	// Chunks grouped by the NUMA node of their storage, every worker drains the queue of the node
+	// it runs on before helping with the others
+	struct NumaChunkTask : enki::ITaskSet
+	{
+		const std::function<void(Chunk* chunk)>* func;
+		Chunk* const* chunks;
+		// nodeStarts[node]..nodeStarts[node + 1] are the chunks of node
+		const u32* nodeStarts;
+		u32 nodeCount;
+		u32 recordingOrder;
+		std::atomic<u32> cursors[MAX_NUMA_NODES];
+
+		NumaChunkTask(u32 workerCount, const std::function<void(Chunk* chunk)>& func, Chunk* const* chunks,
+		              const u32* nodeStarts, u32 nodeCount) : func(&func), chunks(chunks),
+		                                                      nodeStarts(nodeStarts), nodeCount(nodeCount),
+		                                                      recordingOrder(CommandBuffer::getRecordingOrder())
+		{
+			m_SetSize = workerCount;
+			m_MinRange = 1;
+			for (u32 node = 0; node < nodeCount; ++node)
+			{
+				cursors[node].store(nodeStarts[node], std::memory_order_relaxed);
+			}
+		}
+
+		void ExecuteRange(enki::TaskSetPartition range, u32 threadnum) override
+		{
+			CommandBuffer::RecordingOrderScope orderScope(recordingOrder);
+			const u32 homeNode = getCurrentNumaNode();
+			for (u32 i = 0; i < nodeCount; ++i)
+			{
+				const u32 node = (homeNode + i) % nodeCount;
+				for (u32 index = cursors[node].fetch_add(1, std::memory_order_relaxed); index < nodeStarts[node + 1];
+				     index = cursors[node].fetch_add(1, std::memory_order_relaxed))
+				{
+					(*func)(chunks[index]);
+				}
+			}
+		}
+	};
+
 	// A context object passed to systems during their execution.
 	// It provides a safe, verified wrapper around the EntityManager, preventing
 	// direct structural changes and enforcing dependency declarations.
@@ -71,6 +141,7 @@ namespace spite
 		EntityManager* m_entityManager{};
 		const SystemDependencies* m_dependencies{};
 		CommandBuffer* cb{};
+		enki::TaskScheduler* m_taskScheduler{};
 
 	public:
 		float deltaTime{};
@@ -78,8 +149,9 @@ namespace spite
 		SystemContext() = default;
 
 		SystemContext(EntityManager* entityManager, CommandBuffer* commandBuffer, float dt,
-		              const SystemDependencies* deps)
-			: m_entityManager(entityManager), m_dependencies(deps), cb(commandBuffer), deltaTime(dt)
+		              const SystemDependencies* deps, enki::TaskScheduler* taskScheduler = nullptr)
+			: m_entityManager(entityManager), m_dependencies(deps), cb(commandBuffer),
+			  m_taskScheduler(taskScheduler), deltaTime(dt)
 		{
 		}
 
@@ -89,6 +161,68 @@ namespace spite
 			return *cb;
 		}
 
+		// Splits [0, count) between worker threads and blocks until every range is done.
+		// The waiting thread executes ranges too, so this is safe to call from a system task.
+		// Runs inline without a scheduler or when count does not exceed minRange
+		void parallelFor(u32 count, u32 minRange, const std::function<void(u32 begin, u32 end)>& func) const
+		{
+			if (count == 0) return;
+			if (!m_taskScheduler || count <= minRange)
+			{
+				func(0, count);
+				return;
+			}
+
+			ParallelForTask task(count, minRange, func);
+			m_taskScheduler->AddTaskSetToPipe(&task);
+			m_taskScheduler->WaitforTask(&task);
+		}
+
+		// Runs func for every non-empty chunk of query on the worker threads and blocks until all are done.
+		// Chunks are preferably processed by workers on the NUMA node owning their storage
+		void parallelForChunks(QueryHandle& query, const std::function<void(Chunk* chunk)>& func) const
+		{
+			if (!m_taskScheduler)
+			{
+				query.forEachChunk([&func](Chunk* chunk)
+				{
+					if (!chunk->empty()) func(chunk);
+				});
+				return;
+			}
+
+			auto marker = FrameScratchAllocator::get().get_scoped_marker();
+			auto chunks = makeScratchVector<Chunk*>(FrameScratchAllocator::get());
+			u32 nodeStarts[MAX_NUMA_NODES + 1] = {};
+			u32 nodeCount = 0;
+			query.forEachChunk([&](Chunk* chunk)
+			{
+				if (chunk->empty()) return;
+				chunks.push_back(chunk);
+				++nodeStarts[chunk->numaNode() + 1];
+				nodeCount = std::max(nodeCount, chunk->numaNode() + 1);
+			});
+			if (chunks.empty()) return;
+
+			// Counting sort by node
+			for (u32 node = 0; node < nodeCount; ++node)
+			{
+				nodeStarts[node + 1] += nodeStarts[node];
+			}
+			auto sortedChunks = makeScratchVector<Chunk*>(FrameScratchAllocator::get());
+			sortedChunks.resize(chunks.size());
+			u32 nodeCursors[MAX_NUMA_NODES];
+			std::copy(nodeStarts, nodeStarts + nodeCount, nodeCursors);
+			for (Chunk* chunk : chunks)
+			{
+				sortedChunks[nodeCursors[chunk->numaNode()]++] = chunk;
+			}
+
+			NumaChunkTask task(m_taskScheduler->GetNumTaskThreads(), func, sortedChunks.data(), nodeStarts, nodeCount);
+			m_taskScheduler->AddTaskSetToPipe(&task);
+			m_taskScheduler->WaitforTask(&task);
+		}
+
 		SystemQueryBuilder getQueryBuilder() const
 		{
 			return SystemQueryBuilder(m_entityManager->getQueryBuilder());
@@ -99,6 +233,11 @@ namespace spite
 			return m_entityManager->getEventManager();
 		}
 
+		ComponentObserverRegistry& getObserverRegistry() const
+		{
+			return m_entityManager->getArchetypeManager()->getObserverRegistry();
+		}
+
 		template <t_component T>
 		const T* tryGetComponent(Entity entity) const
 		{
@@ -141,6 +280,59 @@ namespace spite
 			return m_entityManager->getComponent<T>(entity);
 		}
 
+		// Obtain once per update, requires Write<T>
+		template <t_component T>
+		ComponentLookup<T> getComponentLookup() const
+		{
+			const ComponentID componentId = ComponentMetadataRegistry::getComponentId<T>();
+			SASSERTM(m_dependencies && m_dependencies->write.test(componentId),
+			         "System attempted a WRITE lookup on component '%s' which it did not declare with Write<T>.",
+			         typeid(T).name())
+			return m_entityManager->getComponentLookup<T>();
+		}
+
+		// Obtain once per update, requires Read<T> or Write<T>
+		template <t_component T>
+		ComponentLookup<const T> getReadOnlyComponentLookup() const
+		{
+			const ComponentID componentId = ComponentMetadataRegistry::getComponentId<T>();
+			SASSERTM(
+				m_dependencies && (m_dependencies->read.test(componentId) || m_dependencies->write.test(
+					componentId)),
+				"System attempted a READ lookup on component '%s' which it did not declare a dependency on.",
+				typeid(T).name())
+			return m_entityManager->getReadOnlyComponentLookup<T>();
+		}
+
+		// Lock-free access to a singleton declared with declareAccess<Write<T>>.
+		// The scheduler never runs it concurrently with other systems that declared T
+		template <t_singleton_component T>
+		T& writeSingleton() const
+		{
+			const SingletonID singletonId = SingletonComponentRegistry::getSingletonId<T>();
+			SASSERTM(m_dependencies && m_dependencies->singletonWrite.test(singletonId),
+			         "System attempted a WRITE on singleton '%s' which it did not declare with Write<T>.",
+			         typeid(T).name())
+			T* singleton = m_entityManager->tryGetSingletonComponent<T>();
+			SASSERTM(singleton, "Singleton of type %s was accessed before it was created\n", typeid(T).name())
+			return *singleton;
+		}
+
+		// Lock-free access to a singleton declared with declareAccess<Read<T>> or declareAccess<Write<T>>
+		template <t_singleton_component T>
+		const T& readSingleton() const
+		{
+			const SingletonID singletonId = SingletonComponentRegistry::getSingletonId<T>();
+			SASSERTM(
+				m_dependencies && (m_dependencies->singletonRead.test(singletonId) || m_dependencies->singletonWrite.
+					test(singletonId)),
+				"System attempted a READ on singleton '%s' which it did not declare a dependency on.",
+				typeid(T).name())
+			const T* singleton = m_entityManager->tryGetSingletonComponent<T>();
+			SASSERTM(singleton, "Singleton of type %s was accessed before it was created\n", typeid(T).name())
+			return *singleton;
+		}
+
 		//not thread safe
 		template <t_singleton_component T>
 		T& getSingletonComponent()
@@ -9,11 +9,16 @@ namespace spite
 	{
 		DynamicBitset read;
 		DynamicBitset write;
+		// Indexed by SingletonID
+		DynamicBitset singletonRead;
+		DynamicBitset singletonWrite;
 		heap_vector<QueryDescriptor> queries;
 
 		SystemDependencies(const HeapAllocator& allocator)
 			: read(allocator),
 			  write(allocator),
+			  singletonRead(allocator),
+			  singletonWrite(allocator),
 			  queries(makeHeapVector<QueryDescriptor>(allocator))
 		{
 		}
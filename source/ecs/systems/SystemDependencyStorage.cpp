@@ -33,6 +33,29 @@ namespace spite
 		}
 	}
 
+	void SystemDependencyStorage::registerSingletonDependencies(SystemBase* system,
+	                                                            eastl::span<const SingletonID> reads,
+	                                                            eastl::span<const SingletonID> writes)
+	{
+		auto it = m_systemDependencies.find(system);
+		if (it == m_systemDependencies.end())
+		{
+			it = m_systemDependencies.emplace(system, SystemDependencies(m_allocator)).first;
+		}
+
+		auto& deps = it->second;
+
+		for (const auto& singletonId : reads)
+		{
+			deps.singletonRead.set(singletonId);
+		}
+
+		for (const auto& singletonId : writes)
+		{
+			deps.singletonWrite.set(singletonId);
+		}
+	}
+
 	void SystemDependencyStorage::registerQuery(SystemBase* system, const QueryDescriptor& queryDescriptor)
 	{
 		auto it = m_systemDependencies.find(system);
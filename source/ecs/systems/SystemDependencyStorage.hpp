@@ -5,6 +5,7 @@
 #include "base/CollectionAliases.hpp"
 
 #include "ecs/core/ComponentMetadata.hpp"
+#include "ecs/core/SingletonComponentRegistry.hpp"
 #include "ecs/systems/SystemDependencies.hpp"
 
 namespace spite
@@ -23,6 +24,9 @@ namespace spite
 		void registerDependencies(SystemBase* system, eastl::span<const ComponentID> reads,
 		                          eastl::span<const ComponentID> writes);
 
+		void registerSingletonDependencies(SystemBase* system, eastl::span<const SingletonID> reads,
+		                                   eastl::span<const SingletonID> writes);
+
 		void registerQuery(SystemBase* system, const QueryDescriptor& queryDescriptor);
 
 		const SystemDependencies& getDependencies(SystemBase* system);
@@ -53,7 +53,7 @@ namespace spite
 		for (const auto& system : m_systems)
 		{
 			SystemContext context(m_entityManager, commandBuffer, deltaTime,
-			                      &m_dependencyStorage.getDependencies(system.get()));
+			                      &m_dependencyStorage.getDependencies(system.get()), m_taskScheduler.get());
 
 			system->prepareForUpdate(context, *m_versionManager);
 			if (system->getExecutionStage() == stage && system->isActive())
@@ -67,11 +67,15 @@ namespace spite
 		auto tasks = makeScratchMap<SystemBase*, SystemTask>(FrameScratchAllocator::get());
 		auto activeIncomingCounts = makeScratchMap<SystemBase*, u32>(FrameScratchAllocator::get());
 
+		auto& observerRegistry = m_entityManager->getArchetypeManager()->getObserverRegistry();
+		// Active systems keep registration order, which makes their index a stable recording order
+		u32 recordingOrder = 0;
 		for (auto* system : activeSystems)
 		{
+			system->deliverObserved(observerRegistry);
 			SystemContext context(m_entityManager, commandBuffer, deltaTime,
-			                      &m_dependencyStorage.getDependencies(system));
-			tasks.emplace(system, SystemTask(system, context, deltaTime));
+			                      &m_dependencyStorage.getDependencies(system), m_taskScheduler.get());
+			tasks.emplace(system, SystemTask(system, context, deltaTime, recordingOrder++));
 			activeIncomingCounts[system] = 0; // Initialize active count
 		}
 
@@ -131,7 +135,19 @@ namespace spite
 				const auto& readB = depsB.read;
 				const auto& writeB = depsB.write;
 
-				if ((writeA & readB).any() || (writeA & writeB).any() || (writeB & readA).any())
+				if (writeA.intersects(readB) || writeA.intersects(writeB) || writeB.intersects(readA))
+				{
+					hasConflict = true;
+				}
+
+				// Same rule for singletons declared through declareAccess
+				const auto& singletonReadA = depsA.singletonRead;
+				const auto& singletonWriteA = depsA.singletonWrite;
+				const auto& singletonReadB = depsB.singletonRead;
+				const auto& singletonWriteB = depsB.singletonWrite;
+
+				if (singletonWriteA.intersects(singletonReadB) || singletonWriteA.intersects(singletonWriteB) ||
+					singletonWriteB.intersects(singletonReadA))
 				{
 					hasConflict = true;
 				}
@@ -236,8 +252,9 @@ namespace spite
 				if (system->getExecutionStage() == m_executionStages[i])
 				{
 					SystemContext context(m_entityManager, &m_commandBuffers[i], deltaTime,
-					                      &m_dependencyStorage.getDependencies(system.get()));
+					                      &m_dependencyStorage.getDependencies(system.get()), m_taskScheduler.get());
 					system->prepareForUpdate(context, *m_versionManager);
+					system->deliverObserved(m_entityManager->getArchetypeManager()->getObserverRegistry());
 					system->onUpdate(context);
 				}
 			}
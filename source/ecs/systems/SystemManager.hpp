@@ -21,21 +21,25 @@ namespace spite
 		SystemBase* system = nullptr;
 		SystemContext systemContext{};
 		float deltaTime = 0.0f;
+		// Position of the system in the stage, orders its commands at commit independent of the worker it ran on
+		u32 recordingOrder = 0;
 
 		enki::Dependency dependency;
 
 		SystemTask() = default;
 
-		SystemTask(SystemBase* system, const SystemContext& context, float dt) : system(system),
+		SystemTask(SystemBase* system, const SystemContext& context, float dt, u32 recordingOrder) : system(system),
 			systemContext(context),
-			deltaTime(dt)
+			deltaTime(dt),
+			recordingOrder(recordingOrder)
 		{
 		}
 
 		SystemTask(const SystemTask& other) = delete;
 
 		SystemTask(SystemTask&& other) noexcept: system(other.system), systemContext(other.systemContext),
-		                                         deltaTime(other.deltaTime), dependency(std::move(other.dependency))
+		                                         deltaTime(other.deltaTime), recordingOrder(other.recordingOrder),
+		                                         dependency(std::move(other.dependency))
 		{
 		}
 
@@ -46,6 +50,7 @@ namespace spite
 
 		void ExecuteRange(enki::TaskSetPartition range, u32 threadnum) override
 		{
+			CommandBuffer::RecordingOrderScope orderScope(recordingOrder);
 			system->onUpdate(systemContext);
 		}
 	};
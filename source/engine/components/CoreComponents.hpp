@@ -19,6 +19,8 @@ namespace spite
 	{
 		Entity parent = Entity::undefined();
 		heap_vector<Entity> children;
+		// Distance from the hierarchy root, maintained by TransformHierarchySystem
+		u32 depth = 0;
 	};
 
 	struct TransformMatrixComponent : IComponent
@@ -0,0 +1,231 @@
+#include "TransformKernels.hpp"
+
+#if defined(SPITE_SIMD_SSE) || defined(SPITE_SIMD_AVX)
+#include <immintrin.h>
+#elif defined(SPITE_SIMD_NEON)
+#include <arm_neon.h>
+#endif
+
+namespace spite
+{
+	namespace
+	{
+		// Distance between the same field of two neighbouring transforms, in floats
+		constexpr sizet TRANSFORM_STRIDE = sizeof(TransformComponent) / sizeof(float);
+		static_assert(sizeof(TransformComponent) % sizeof(float) == 0);
+
+		float* matrixData(TransformMatrixComponent& matrix)
+		{
+			return &matrix.matrix[0][0];
+		}
+
+#if defined(SPITE_SIMD_SSE)
+		struct SseFloat4
+		{
+			static constexpr sizet WIDTH = 4;
+			__m128 v;
+
+			static SseFloat4 broadcast(float value) { return {_mm_set1_ps(value)}; }
+
+			static SseFloat4 gather(const float* first)
+			{
+				return {
+					_mm_set_ps(first[3 * TRANSFORM_STRIDE], first[2 * TRANSFORM_STRIDE], first[TRANSFORM_STRIDE],
+					           first[0])
+				};
+			}
+
+			friend SseFloat4 operator+(SseFloat4 a, SseFloat4 b) { return {_mm_add_ps(a.v, b.v)}; }
+			friend SseFloat4 operator-(SseFloat4 a, SseFloat4 b) { return {_mm_sub_ps(a.v, b.v)}; }
+			friend SseFloat4 operator*(SseFloat4 a, SseFloat4 b) { return {_mm_mul_ps(a.v, b.v)}; }
+		};
+
+		// Lanes hold one row of a column for 4 entities, transposed back into 4 matrix columns
+		void storeColumn(__m128 x, __m128 y, __m128 z, __m128 w, TransformMatrixComponent* matrices, sizet column)
+		{
+			_MM_TRANSPOSE4_PS(x, y, z, w);
+			_mm_storeu_ps(matrixData(matrices[0]) + column * 4, x);
+			_mm_storeu_ps(matrixData(matrices[1]) + column * 4, y);
+			_mm_storeu_ps(matrixData(matrices[2]) + column * 4, z);
+			_mm_storeu_ps(matrixData(matrices[3]) + column * 4, w);
+		}
+
+		void storeMatrices(const SseFloat4 (&columns)[4][4], TransformMatrixComponent* matrices)
+		{
+			for (sizet column = 0; column < 4; ++column)
+			{
+				storeColumn(columns[column][0].v, columns[column][1].v, columns[column][2].v, columns[column][3].v,
+				            matrices, column);
+			}
+		}
+#endif
+
+#if defined(SPITE_SIMD_AVX)
+		struct AvxFloat8
+		{
+			static constexpr sizet WIDTH = 8;
+			__m256 v;
+
+			static AvxFloat8 broadcast(float value) { return {_mm256_set1_ps(value)}; }
+
+			static AvxFloat8 gather(const float* first)
+			{
+				return {
+					_mm256_set_ps(first[7 * TRANSFORM_STRIDE], first[6 * TRANSFORM_STRIDE],
+					              first[5 * TRANSFORM_STRIDE], first[4 * TRANSFORM_STRIDE],
+					              first[3 * TRANSFORM_STRIDE], first[2 * TRANSFORM_STRIDE], first[TRANSFORM_STRIDE],
+					              first[0])
+				};
+			}
+
+			friend AvxFloat8 operator+(AvxFloat8 a, AvxFloat8 b) { return {_mm256_add_ps(a.v, b.v)}; }
+			friend AvxFloat8 operator-(AvxFloat8 a, AvxFloat8 b) { return {_mm256_sub_ps(a.v, b.v)}; }
+			friend AvxFloat8 operator*(AvxFloat8 a, AvxFloat8 b) { return {_mm256_mul_ps(a.v, b.v)}; }
+		};
+
+		// Both 128-bit halves go through the SSE transpose
+		void storeMatrices(const AvxFloat8 (&columns)[4][4], TransformMatrixComponent* matrices)
+		{
+			for (sizet column = 0; column < 4; ++column)
+			{
+				const __m256* rows[4] = {&columns[column][0].v, &columns[column][1].v, &columns[column][2].v,
+				                         &columns[column][3].v};
+				storeColumn(_mm256_castps256_ps128(*rows[0]), _mm256_castps256_ps128(*rows[1]),
+				            _mm256_castps256_ps128(*rows[2]), _mm256_castps256_ps128(*rows[3]), matrices, column);
+				storeColumn(_mm256_extractf128_ps(*rows[0], 1), _mm256_extractf128_ps(*rows[1], 1),
+				            _mm256_extractf128_ps(*rows[2], 1), _mm256_extractf128_ps(*rows[3], 1), matrices + 4,
+				            column);
+			}
+		}
+#endif
+
+#if defined(SPITE_SIMD_NEON)
+		struct NeonFloat4
+		{
+			static constexpr sizet WIDTH = 4;
+			float32x4_t v;
+
+			static NeonFloat4 broadcast(float value) { return {vdupq_n_f32(value)}; }
+
+			static NeonFloat4 gather(const float* first)
+			{
+				const float values[4] = {
+					first[0], first[TRANSFORM_STRIDE], first[2 * TRANSFORM_STRIDE], first[3 * TRANSFORM_STRIDE]
+				};
+				return {vld1q_f32(values)};
+			}
+
+			friend NeonFloat4 operator+(NeonFloat4 a, NeonFloat4 b) { return {vaddq_f32(a.v, b.v)}; }
+			friend NeonFloat4 operator-(NeonFloat4 a, NeonFloat4 b) { return {vsubq_f32(a.v, b.v)}; }
+			friend NeonFloat4 operator*(NeonFloat4 a, NeonFloat4 b) { return {vmulq_f32(a.v, b.v)}; }
+		};
+
+		void storeMatrices(const NeonFloat4 (&columns)[4][4], TransformMatrixComponent* matrices)
+		{
+			for (sizet column = 0; column < 4; ++column)
+			{
+				const float32x4x2_t xy = vtrnq_f32(columns[column][0].v, columns[column][1].v);
+				const float32x4x2_t zw = vtrnq_f32(columns[column][2].v, columns[column][3].v);
+
+				vst1q_f32(matrixData(matrices[0]) + column * 4,
+				          vcombine_f32(vget_low_f32(xy.val[0]), vget_low_f32(zw.val[0])));
+				vst1q_f32(matrixData(matrices[1]) + column * 4,
+				          vcombine_f32(vget_low_f32(xy.val[1]), vget_low_f32(zw.val[1])));
+				vst1q_f32(matrixData(matrices[2]) + column * 4,
+				          vcombine_f32(vget_high_f32(xy.val[0]), vget_high_f32(zw.val[0])));
+				vst1q_f32(matrixData(matrices[3]) + column * 4,
+				          vcombine_f32(vget_high_f32(xy.val[1]), vget_high_f32(zw.val[1])));
+			}
+		}
+#endif
+
+		// Structure-of-arrays version of composeTransformMatrix, every lane is a separate transform
+		template <typename V>
+		void composeBatch(const TransformComponent* transforms, TransformMatrixComponent* matrices)
+		{
+			const V px = V::gather(&transforms->position.x);
+			const V py = V::gather(&transforms->position.y);
+			const V pz = V::gather(&transforms->position.z);
+			const V qx = V::gather(&transforms->rotation.x);
+			const V qy = V::gather(&transforms->rotation.y);
+			const V qz = V::gather(&transforms->rotation.z);
+			const V qw = V::gather(&transforms->rotation.w);
+			const V sx = V::gather(&transforms->scale.x);
+			const V sy = V::gather(&transforms->scale.y);
+			const V sz = V::gather(&transforms->scale.z);
+
+			const V zero = V::broadcast(0.0f);
+			const V one = V::broadcast(1.0f);
+			const V two = V::broadcast(2.0f);
+
+			const V xx = qx * qx;
+			const V yy = qy * qy;
+			const V zz = qz * qz;
+			const V xy = qx * qy;
+			const V xz = qx * qz;
+			const V yz = qy * qz;
+			const V wx = qw * qx;
+			const V wy = qw * qy;
+			const V wz = qw * qz;
+
+			// columns[column][row]
+			const V columns[4][4] = {
+				{(one - two * (yy + zz)) * sx, two * (xy + wz) * sx, two * (xz - wy) * sx, zero},
+				{two * (xy - wz) * sy, (one - two * (xx + zz)) * sy, two * (yz + wx) * sy, zero},
+				{two * (xz + wy) * sz, two * (yz - wx) * sz, (one - two * (xx + yy)) * sz, zero},
+				{px, py, pz, one}
+			};
+
+			storeMatrices(columns, matrices);
+		}
+	}
+
+	glm::mat4 composeTransformMatrix(const TransformComponent& transform)
+	{
+		const glm::quat& q = transform.rotation;
+		const float xx = q.x * q.x;
+		const float yy = q.y * q.y;
+		const float zz = q.z * q.z;
+		const float xy = q.x * q.y;
+		const float xz = q.x * q.z;
+		const float yz = q.y * q.z;
+		const float wx = q.w * q.x;
+		const float wy = q.w * q.y;
+		const float wz = q.w * q.z;
+
+		const glm::vec3& s = transform.scale;
+		glm::mat4 matrix(1.0f);
+		matrix[0] = glm::vec4((1.0f - 2.0f * (yy + zz)) * s.x, 2.0f * (xy + wz) * s.x, 2.0f * (xz - wy) * s.x, 0.0f);
+		matrix[1] = glm::vec4(2.0f * (xy - wz) * s.y, (1.0f - 2.0f * (xx + zz)) * s.y, 2.0f * (yz + wx) * s.y, 0.0f);
+		matrix[2] = glm::vec4(2.0f * (xz + wy) * s.z, 2.0f * (yz - wx) * s.z, (1.0f - 2.0f * (xx + yy)) * s.z, 0.0f);
+		matrix[3] = glm::vec4(transform.position.x, transform.position.y, transform.position.z, 1.0f);
+		return matrix;
+	}
+
+	void composeTransformMatrices(const TransformComponent* transforms, TransformMatrixComponent* matrices,
+	                              sizet count)
+	{
+		sizet i = 0;
+#if defined(SPITE_SIMD_AVX)
+		for (; i + AvxFloat8::WIDTH <= count; i += AvxFloat8::WIDTH)
+		{
+			composeBatch<AvxFloat8>(transforms + i, matrices + i);
+		}
+#endif
+#if defined(SPITE_SIMD_SSE)
+		for (; i + SseFloat4::WIDTH <= count; i += SseFloat4::WIDTH)
+		{
+			composeBatch<SseFloat4>(transforms + i, matrices + i);
+		}
+#elif defined(SPITE_SIMD_NEON)
+		for (; i + NeonFloat4::WIDTH <= count; i += NeonFloat4::WIDTH)
+		{
+			composeBatch<NeonFloat4>(transforms + i, matrices + i);
+		}
+#endif
+		for (; i < count; ++i)
+		{
+			matrices[i].matrix = composeTransformMatrix(transforms[i]);
+		}
+	}
+}
@@ -0,0 +1,15 @@
+#pragma once
+#include "base/Platform.hpp"
+
+#include "engine/components/CoreComponents.hpp"
+
+namespace spite
+{
+	// translate * rotate * scale, same result as chaining glm::translate, glm::mat4_cast and glm::scale
+	glm::mat4 composeTransformMatrix(const TransformComponent& transform);
+
+	// Batched composeTransformMatrix over contiguous component columns.
+	// Processes 8 transforms per step with AVX, 4 with SSE or NEON, the remainder is done one by one
+	void composeTransformMatrices(const TransformComponent* transforms, TransformMatrixComponent* matrices,
+	                              sizet count);
+}
@@ -65,9 +65,9 @@ namespace spite
 
 			//TODO check depthchecks correctness
 			// Depth Pass
-			renderGraph.addPass<PassData>(toHashedString("Depth"), [&](RGBuilder& builder, PassData& data)
+			renderGraph.addPass<PassData>("Depth"_hs, [&](RGBuilder& builder, PassData& data)
 			{
-				depthHandle = builder.createTexture(toHashedString("DepthBuffer"), depthDesc);
+				depthHandle = builder.createTexture("DepthBuffer"_hs, depthDesc);
 
 				builder.write(depthHandle, RGUsage::DepthStencilAttachmentWrite,
 				              {
@@ -76,7 +76,7 @@ namespace spite
 					              .clearValue = ClearDepthStencilValue{1.0f, 0}
 				              });
 
-				builder.useUbo(toHashedString("cameraUBO"));
+				builder.useUbo("cameraUBO"_hs);
 
 				PipelineDescription psoDesc{};
 				psoDesc.depthTestEnable = true;
@@ -93,11 +93,11 @@ namespace spite
 			});
 
 			// Geometry Pass
-			renderGraph.addPass<PassData>(toHashedString("Geometry"), [&](RGBuilder& builder, PassData& data)
+			renderGraph.addPass<PassData>("Geometry"_hs, [&](RGBuilder& builder, PassData& data)
 			{
-				positionHandle = builder.createTexture(toHashedString("PositionBuffer"), gbufferFormatDesc);
-				normalHandle = builder.createTexture(toHashedString("NormalBuffer"), gbufferFormatDesc);
-				albedoHandle = builder.createTexture(toHashedString("AlbedoBuffer"), albedoDesc);
+				positionHandle = builder.createTexture("PositionBuffer"_hs, gbufferFormatDesc);
+				normalHandle = builder.createTexture("NormalBuffer"_hs, gbufferFormatDesc);
+				albedoHandle = builder.createTexture("AlbedoBuffer"_hs, albedoDesc);
 
 				builder.write(positionHandle, RGUsage::ColorAttachmentWrite,
 				              {
@@ -114,7 +114,7 @@ namespace spite
 
 				builder.read(depthHandle, RGUsage::DepthStencilAttachmentRead);
 
-				builder.useUbo(toHashedString("cameraUBO"));
+				builder.useUbo("cameraUBO"_hs);
 
 				PipelineDescription psoDesc{};
 				psoDesc.depthTestEnable = true;
@@ -135,14 +135,14 @@ namespace spite
 			});
 
 			// Light Pass (renders to offscreen texture)
-			renderGraph.addPass<PassData>(toHashedString("Light"), [&](RGBuilder& builder, PassData& data)
+			renderGraph.addPass<PassData>("Light"_hs, [&](RGBuilder& builder, PassData& data)
 			{
 				builder.read(positionHandle, RGUsage::FragmentShaderReadSampled);
 				builder.read(normalHandle, RGUsage::FragmentShaderReadSampled);
 				builder.read(albedoHandle, RGUsage::FragmentShaderReadSampled);
 				builder.read(depthHandle, RGUsage::FragmentShaderReadSampled);
 
-				sceneColorHandle = builder.createTexture(toHashedString("SceneColor"), offscreenDesc);
+				sceneColorHandle = builder.createTexture("SceneColor"_hs, offscreenDesc);
 				builder.write(sceneColorHandle, RGUsage::ColorAttachmentWrite,
 				              {
 					              .loadOp = AttachmentLoadOp::CLEAR,
@@ -168,13 +168,13 @@ namespace spite
 			});
 
 			// UI Pass (renders to offscreen texture)
-			renderGraph.addPass<PassData>(toHashedString("UI"), [&](RGBuilder& builder, PassData& data)
+			renderGraph.addPass<PassData>("UI"_hs, [&](RGBuilder& builder, PassData& data)
 			                              {
 				                              builder.read(sceneColorHandle, RGUsage::FragmentShaderReadSampled);
 				                              // Dependency
 
 				                              uiTextureHandle = builder.createTexture(
-					                              toHashedString("UIColor"), offscreenDesc);
+					                              "UIColor"_hs, offscreenDesc);
 				                              builder.write(uiTextureHandle, RGUsage::ColorAttachmentWrite,
 				                                            {
 					                                            .loadOp = AttachmentLoadOp::CLEAR,
@@ -200,7 +200,7 @@ namespace spite
 			                              }, [](IRenderCommandBuffer& cmd) { UIInspectorManager::get()->render(cmd); });
 
 			// Composite Pass (blends scene and UI to swapchain)
-			renderGraph.addPass<PassData>(toHashedString("Composite"), [&](RGBuilder& builder, PassData& data)
+			renderGraph.addPass<PassData>("Composite"_hs, [&](RGBuilder& builder, PassData& data)
 			{
 				builder.read(sceneColorHandle, RGUsage::FragmentShaderReadSampled);
 				builder.read(uiTextureHandle, RGUsage::FragmentShaderReadSampled);
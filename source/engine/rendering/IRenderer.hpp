@@ -11,6 +11,7 @@ namespace spite
 	struct ImageViewHandle;
 	struct TextureHandle;
 	class NamedBufferRegistry;
+	class BufferedFrameAllocator;
 
 	// The abstract interface for all rendering operations.
 	class IRenderer
@@ -19,6 +20,8 @@ namespace spite
 		virtual ~IRenderer() = default;
 		virtual IRenderDevice& getDevice() = 0;
 		virtual NamedBufferRegistry& getNamedBufferRegistry() = 0;
+		// Scratch memory that stays valid until the GPU is done with the frame it was allocated in
+		virtual BufferedFrameAllocator& getFrameAllocator() = 0;
 		virtual void waitIdle() = 0;
 		virtual IRenderCommandBuffer* beginFrame() = 0;
 		virtual void endFrameAndSubmit(IRenderCommandBuffer& commandBuffer) = 0;
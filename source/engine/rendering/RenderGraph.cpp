@@ -31,8 +31,8 @@ namespace spite
 		  m_passBarriers(
 			  makeHeapVector<sbo_vector<std::variant<MemoryBarrier2, BufferBarrier2, TextureBarrier2>>>(allocator)),
 		  m_physicalResourceStates(makeHeapMap<u32, PhysicalResourceState>(allocator)),
-		  m_passLookup(makeHeapMap<HashedString, RGPass*>(allocator)),
-		  m_resourceNameLookup(makeHeapMap<HashedString, RGResourceHandle>(allocator)),
+		  m_passLookup(makeHeapFlatMap<HashedString, RGPass*>(allocator)),
+		  m_resourceNameLookup(makeHeapFlatMap<HashedString, RGResourceHandle>(allocator)),
 		  m_managedImageViews(makeHeapMap<u32, ImageViewHandle>(allocator))
 	{
 	}
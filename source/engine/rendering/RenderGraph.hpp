@@ -140,8 +140,8 @@ namespace spite
 		heap_vector<sbo_vector<std::variant<MemoryBarrier2, BufferBarrier2, TextureBarrier2>>> m_passBarriers;
 		heap_unordered_map<u32, PhysicalResourceState> m_physicalResourceStates;
 
-		heap_unordered_map<HashedString, RGPass*> m_passLookup;
-		heap_unordered_map<HashedString, RGResourceHandle> m_resourceNameLookup;
+		heap_flat_map<HashedString, RGPass*> m_passLookup;
+		heap_flat_map<HashedString, RGResourceHandle> m_resourceNameLookup;
 		heap_unordered_map<u32, ImageViewHandle> m_managedImageViews;
 
 		RGResourceHandle createManagedTexture(HashedString name, const TextureDesc& desc);
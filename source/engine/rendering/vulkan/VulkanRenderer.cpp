@@ -24,10 +24,12 @@ namespace spite
 		  m_windowManager(windowManager),
 		  m_renderGraph(renderGraph),
 		  m_namedBufferRegistry(*m_renderDevice, allocator),
+		  m_frameAllocator(MAX_FRAMES_IN_FLIGHT, FRAME_ALLOCATOR_SIZE, "RendererFrameAllocator"),
 		  m_renderFinishedSemaphores(makeHeapVector<vk::Semaphore>(allocator)),
 		  m_swapchainTextureHandles(makeHeapVector<TextureHandle>(allocator)),
 		  m_swapchainImageViewHandles(makeHeapVector<ImageViewHandle>(allocator))
 	{
+		m_frameAllocatorFrames.fill(BufferedFrameAllocator::NO_FRAME);
 		for (sizet i = 0; i < MAX_FRAMES_IN_FLIGHT; ++i)
 		{
 			m_secondaryCommandPools[i] = makeHeapMap<HashedString, vk::CommandPool>(allocator);
@@ -129,6 +131,10 @@ namespace spite
 
 		vk::Result res = m_context.device.waitForFences(1, &m_inFlightFences[m_currentFrame], VK_TRUE, UINT64_MAX);
 		SASSERT_VULKAN(res)
+		if (m_frameAllocatorFrames[m_currentFrame] != BufferedFrameAllocator::NO_FRAME)
+		{
+			m_frameAllocator.retireFrame(m_frameAllocatorFrames[m_currentFrame]);
+		}
 
 		res = m_context.device.acquireNextImageKHR(m_swapchain.get(), UINT64_MAX,
 		                                           m_imageAvailableSemaphores[m_currentFrame], nullptr,
@@ -144,6 +150,7 @@ namespace spite
 
 		res = m_context.device.resetFences(1, &m_inFlightFences[m_currentFrame]);
 		SASSERT_VULKAN(res)
+		m_frameAllocatorFrames[m_currentFrame] = m_frameAllocator.beginFrame();
 
 		// Reset all secondary command pools for the new frame.
 		for (auto& pool : m_secondaryCommandPools[m_currentFrame])
@@ -183,6 +190,8 @@ namespace spite
 
 	ISecondaryRenderCommandBuffer* VulkanRenderer::acquireSecondaryCommandBuffer(HashedString passName)
 	{
+		std::lock_guard<std::mutex> lock(m_secondaryCommandBufferMutex);
+
 		auto& currentFrameCommandBuffers = m_secondaryCommandBuffers[m_currentFrame];
 		auto it = currentFrameCommandBuffers.find(passName);
 
@@ -196,22 +205,18 @@ namespace spite
 		else
 		{
 			// Command buffer does not exist, create it
-			vk::CommandPool pool;
+			auto& currentFramePools = m_secondaryCommandPools[m_currentFrame];
+			auto poolIt = currentFramePools.find(passName);
+			if (poolIt == currentFramePools.end())
 			{
-				std::lock_guard<std::mutex> lock(m_poolCreationMutex);
-				auto& currentFramePools = m_secondaryCommandPools[m_currentFrame];
-				auto poolIt = currentFramePools.find(passName);
-				if (poolIt == currentFramePools.end())
-				{
-					vk::CommandPoolCreateInfo threadPoolInfo{};
-					threadPoolInfo.queueFamilyIndex = m_context.graphicsQueueFamily;
-					threadPoolInfo.flags = vk::CommandPoolCreateFlagBits::eResetCommandBuffer;
-					auto [result, newPool] = m_context.device.createCommandPool(threadPoolInfo);
-					SASSERT_VULKAN(result)
-					poolIt = currentFramePools.emplace(passName, newPool).first;
-				}
-				pool = poolIt->second;
+				vk::CommandPoolCreateInfo threadPoolInfo{};
+				threadPoolInfo.queueFamilyIndex = m_context.graphicsQueueFamily;
+				threadPoolInfo.flags = vk::CommandPoolCreateFlagBits::eResetCommandBuffer;
+				auto [result, newPool] = m_context.device.createCommandPool(threadPoolInfo);
+				SASSERT_VULKAN(result)
+				poolIt = currentFramePools.emplace(passName, newPool).first;
 			}
+			const vk::CommandPool pool = poolIt->second;
 
 			vk::CommandBufferAllocateInfo allocInfo{};
 			allocInfo.commandPool = pool;
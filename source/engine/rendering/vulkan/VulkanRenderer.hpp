@@ -8,6 +8,7 @@
 
 #include "base/CollectionAliases.hpp"
 #include "base/Platform.hpp"
+#include "base/memory/BufferedFrameAllocator.hpp"
 #include "base/VulkanUsage.hpp"
 
 #include "engine/rendering/GraphicsTypes.hpp"
@@ -41,7 +42,11 @@ namespace spite
 		u32 m_currentFrame = 0;
 		u32 m_currentSwapchainImageIndex = 0;
 		static constexpr int MAX_FRAMES_IN_FLIGHT = 2;
+		static constexpr sizet FRAME_ALLOCATOR_SIZE = 16 * MB;
 
+		// Regions are retired once the fence of their frame signals
+		BufferedFrameAllocator m_frameAllocator;
+		eastl::array<u64, MAX_FRAMES_IN_FLIGHT> m_frameAllocatorFrames;
 
 		eastl::array<VulkanRenderCommandBuffer, MAX_FRAMES_IN_FLIGHT> m_commandBuffers;
 		eastl::array<vk::Semaphore, MAX_FRAMES_IN_FLIGHT> m_imageAvailableSemaphores;
@@ -52,7 +57,8 @@ namespace spite
 		eastl::array<heap_unordered_map<HashedString, vk::CommandPool>, MAX_FRAMES_IN_FLIGHT> m_secondaryCommandPools;
 		eastl::array<heap_unordered_map<HashedString, std::unique_ptr<VulkanSecondaryRenderCommandBuffer>>,
 		             MAX_FRAMES_IN_FLIGHT> m_secondaryCommandBuffers;
-		std::mutex m_poolCreationMutex;
+		// Pass systems that only read RendererSingleton acquire their buffers concurrently
+		std::mutex m_secondaryCommandBufferMutex;
 
 		heap_vector<TextureHandle> m_swapchainTextureHandles;
 		heap_vector<ImageViewHandle> m_swapchainImageViewHandles;
@@ -90,6 +96,7 @@ namespace spite
 
 		IRenderDevice& getDevice() override { return *m_renderDevice; }
 		NamedBufferRegistry& getNamedBufferRegistry() override { return m_namedBufferRegistry; }
+		BufferedFrameAllocator& getFrameAllocator() override { return m_frameAllocator; }
 		ImageViewHandle getCurrentSwapchainImageView() const override;
 		TextureHandle getCurrentSwapchainTextureHandle() const override;
 		Format getSwapchainFormat() const override;
@@ -8,13 +8,12 @@ namespace spite
 	void BeginFrameSystem::onInitialize(SystemContext ctx, SystemDependencyStorage& dependencyStorage)
 	{
 		setExecutionStage(CoreExecutionStages::PRE_RENDER);
+		// beginFrame resets the renderer's per-frame state, so pass systems reading it must be ordered after us
+		declareAccess<Write<RenderingManagerSingleton>, Write<RendererSingleton>>(dependencyStorage);
 	}
 
 	void BeginFrameSystem::onUpdate(SystemContext ctx)
 	{
-		ctx.accessSingleton<RenderingManagerSingleton>([](RenderingManagerSingleton& singleton)
-		{
-			singleton.renderingManager->beginFrame();
-		});
+		ctx.writeSingleton<RenderingManagerSingleton>().renderingManager->beginFrame();
 	}
 }
@@ -1,6 +1,6 @@
 ﻿#include "CameraMatricesUpdateSystem.hpp"
 
-#include "base/StringInterner.hpp"
+#include "base/HashedString.hpp"
 
 #include "engine/components/CoreComponents.hpp"
 #include "engine/components/RenderingComponents.hpp"
@@ -9,22 +9,21 @@
 
 namespace spite
 {
-	void CameraMatricesUpdateSystem::onUpdate(SystemContext ctx)
+	void CameraMatricesUpdateSystem::onInitialize(SystemContext ctx, SystemDependencyStorage& dependencyStorage)
 	{
-		glm::mat4 viewProjection;
+		declareAccess<Write<CameraMatricesSingleton>, Write<RendererSingleton>>(dependencyStorage);
+	}
 
-		ctx.accessSingleton<CameraMatricesSingleton>([&viewProjection](CameraMatricesSingleton& singleton)
-		{
-			singleton.view = glm::mat4(1);
-			singleton.projection = glm::perspective(90.f, 4.f / 3.f, 1.f, 1000.f);
+	void CameraMatricesUpdateSystem::onUpdate(SystemContext ctx)
+	{
+		auto& cameraMatrices = ctx.writeSingleton<CameraMatricesSingleton>();
+		cameraMatrices.view = glm::mat4(1);
+		cameraMatrices.projection = glm::perspective(90.f, 4.f / 3.f, 1.f, 1000.f);
 
-			viewProjection = singleton.view * singleton.projection;
-		});
+		const glm::mat4 viewProjection = cameraMatrices.view * cameraMatrices.projection;
 
-		ctx.accessSingleton<RendererSingleton>([&viewProjection](const RendererSingleton& singleton)
-		{
-			auto& registry = singleton.renderer->getNamedBufferRegistry();
-			registry.updateBuffer(toHashedString("cameraUBO"), &viewProjection, sizeof(viewProjection));
-		});
+		// Updating the buffer writes renderer owned state
+		auto& registry = ctx.writeSingleton<RendererSingleton>().renderer->getNamedBufferRegistry();
+		registry.updateBuffer("cameraUBO"_hs, &viewProjection, sizeof(viewProjection));
 	}
 }
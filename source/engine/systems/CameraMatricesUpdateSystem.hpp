@@ -7,6 +7,7 @@ namespace spite
 	class CameraMatricesUpdateSystem : public SystemBase
 	{
 	public:
+		void onInitialize(SystemContext ctx, SystemDependencyStorage& dependencyStorage) override;
 		void onUpdate(SystemContext ctx) override;
 	};
 }
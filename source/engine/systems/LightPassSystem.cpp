@@ -10,33 +10,25 @@ namespace spite
 	void LightPassSystem::onInitialize(SystemContext ctx, SystemDependencyStorage& dependencyStorage)
 	{
 		setExecutionStage(CoreExecutionStages::PRE_RENDER);
+		declareAccess<Read<RendererSingleton>, Read<RenderGraphSingleton>>(dependencyStorage);
 	}
 
 	void LightPassSystem::onUpdate(SystemContext ctx)
 	{
-		auto passName = toHashedString("Light");
+		auto passName = "Light"_hs;
 
-		ISecondaryRenderCommandBuffer* cb;
-		ctx.accessSingleton<RendererSingleton>([&cb,&passName](const RendererSingleton& singleton)
-		{
-			cb = singleton.renderer->acquireSecondaryCommandBuffer(passName);
-		});
+		const auto& renderer = ctx.readSingleton<RendererSingleton>();
+		const auto& renderGraph = ctx.readSingleton<RenderGraphSingleton>();
 
-		PipelineLayoutHandle layout;
-		ctx.accessSingleton<RenderGraphSingleton>([&layout,&passName](const RenderGraphSingleton& singleton)
-		{
-			layout = singleton.renderGraph->getPipelineLayoutForPass(passName);
-		});
+		ISecondaryRenderCommandBuffer* cb = renderer.renderer->acquireSecondaryCommandBuffer(passName);
+		PipelineLayoutHandle layout = renderGraph.renderGraph->getPipelineLayoutForPass(passName);
 
 #if defined(SPITE_USE_DESCRIPTOR_SETS)
-		ctx.accessSingleton<RenderGraphSingleton>([&](const RenderGraphSingleton& singleton)
+		auto& resourceSets = renderGraph.renderGraph->getPassResourceSets(passName);
+		if (!resourceSets.empty())
 		{
-			auto& resourceSets = singleton.renderGraph->getPassResourceSets(passName);
-			if (!resourceSets.empty())
-			{
-				cb->bindDescriptorSets(layout, 0, {resourceSets.begin(), resourceSets.end()});
-			}
-		});
+			cb->bindDescriptorSets(layout, 0, {resourceSets.begin(), resourceSets.end()});
+		}
 #endif
 
 		cb->draw(3);
@@ -12,32 +12,29 @@ namespace spite
 	void ModelLoadSystem::onInitialize(SystemContext ctx, SystemDependencyStorage& dependencyStorage)
 	{
 		setExecutionStage(CoreExecutionStages::UPDATE);
-		auto& queryDesc = ctx.getQueryBuilder().with<Read<ModelLoadRequest>, Read<EventTag>>();
+		declareAccess<Read<RenderDeviceSingleton>, Read<RenderResourceManagerSingleton>>(dependencyStorage);
 
-		requestQuery = registerQuery(queryDesc, dependencyStorage);
-		setPrerequisite(requestQuery);
+		auto& eventManager = ctx.getEventManager();
+		if (!eventManager.isChannelRegistered<ModelLoadRequest>())
+		{
+			eventManager.registerChannel<ModelLoadRequest>();
+		}
 	}
 
 	void ModelLoadSystem::onUpdate(SystemContext ctx)
 	{
-		auto& cb = ctx.getCommandBuffer();
-
-		IRenderDevice* device;
-
-		ctx.accessSingleton<RenderDeviceSingleton>([&device](const RenderDeviceSingleton& singleton)
+		auto requests = ctx.getEventManager().read<ModelLoadRequest>();
+		if (requests.empty())
 		{
-			device = singleton.renderDevice;
-		});
+			return;
+		}
 
-		IRenderResourceManager* resourceManager;
+		auto& cb = ctx.getCommandBuffer();
 
-		ctx.accessSingleton<RenderResourceManagerSingleton>(
-			[&resourceManager](const RenderResourceManagerSingleton& singleton)
-			{
-				resourceManager = singleton.resourceManager;
-			});
+		IRenderDevice* device = ctx.readSingleton<RenderDeviceSingleton>().renderDevice;
+		IRenderResourceManager* resourceManager = ctx.readSingleton<RenderResourceManagerSingleton>().resourceManager;
 
-		for (const auto& request : requestQuery.view<Read<ModelLoadRequest>>())
+		for (const auto& request : requests)
 		{
 			printf("Loading model %s ...\n", request.filePath.c_str());
 			auto allocMarker = FrameScratchAllocator::get().get_scoped_marker();
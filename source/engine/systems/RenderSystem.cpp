@@ -8,13 +8,11 @@ namespace spite
 	void RenderSystem::onInitialize(SystemContext ctx, SystemDependencyStorage& dependencyStorage)
 	{
 		setExecutionStage(CoreExecutionStages::RENDER);
+		declareAccess<Write<RenderingManagerSingleton>, Write<RendererSingleton>>(dependencyStorage);
 	}
 
 	void RenderSystem::onUpdate(SystemContext ctx)
 	{
-		ctx.accessSingleton<RenderingManagerSingleton>([](RenderingManagerSingleton& singleton)
-		{
-			singleton.renderingManager->render();
-		});
+		ctx.writeSingleton<RenderingManagerSingleton>().renderingManager->render();
 	}
 }
@@ -0,0 +1,189 @@
+﻿#include "TransformHierarchySystem.hpp"
+
+#include "base/RadixSort.hpp"
+
+#include "engine/components/CoreComponents.hpp"
+#include "engine/math/TransformKernels.hpp"
+
+namespace spite
+{
+	namespace
+	{
+		struct LevelItem
+		{
+			u64 chunkKey;
+			u32 node;
+		};
+	}
+
+	void TransformHierarchySystem::onInitialize(SystemContext ctx, SystemDependencyStorage& dependencyStorage)
+	{
+		setExecutionStage(CoreExecutionStages::POST_UPDATE);
+
+		auto hierarchyDesc = ctx.getQueryBuilder().with<
+			Read<TransformComponent>, Write<TransformRelationsComponent>, Write<TransformMatrixComponent>>();
+		m_hierarchyQuery = registerQuery(hierarchyDesc, dependencyStorage);
+
+		auto reparentDesc = ctx.getQueryBuilder().with<Read<TransformRelationsComponent>>().
+		                         modified<TransformRelationsComponent>();
+		m_reparentQuery = registerQuery(reparentDesc, dependencyStorage);
+
+		observe<TransformRelationsComponent>(ctx, ObserverEvent::eAdd);
+		observe<TransformRelationsComponent>(ctx, ObserverEvent::eRemove);
+	}
+
+	void TransformHierarchySystem::onUpdate(SystemContext ctx)
+	{
+		const bool rebuilt = isStructureChanged(ctx);
+		if (rebuilt)
+		{
+			rebuildHierarchy(ctx);
+		}
+
+		m_dirty.resize(m_nodes.size());
+		for (sizet level = 1; level < m_levelOffsets.size(); ++level)
+		{
+			// Levels depend on the previous one, so only the work inside a level runs in parallel
+			propagateLevel(ctx, m_levelOffsets[level - 1], m_levelOffsets[level], rebuilt);
+		}
+	}
+
+	bool TransformHierarchySystem::isStructureChanged(SystemContext ctx)
+	{
+		if (!observed<TransformRelationsComponent>(ctx, ObserverEvent::eAdd).empty() ||
+			!observed<TransformRelationsComponent>(ctx, ObserverEvent::eRemove).empty())
+		{
+			return true;
+		}
+
+		// Parent/children edits go through the component itself
+		for ([[maybe_unused]] Entity entity : m_reparentQuery.view<Entity>())
+		{
+			return true;
+		}
+		return false;
+	}
+
+	void TransformHierarchySystem::rebuildHierarchy(SystemContext ctx)
+	{
+		m_nodes.clear();
+		m_levelOffsets.clear();
+		m_levelOffsets.push_back(0);
+
+		auto relations = ctx.getComponentLookup<TransformRelationsComponent>();
+		auto transforms = ctx.getReadOnlyComponentLookup<TransformComponent>();
+		auto matrices = ctx.getComponentLookup<TransformMatrixComponent>();
+
+		auto marker = FrameScratchAllocator::get().get_scoped_marker();
+		// (entity, index in m_nodes) of the level being expanded
+		auto frontier = makeScratchVector<eastl::pair<Entity, u32>>(FrameScratchAllocator::get());
+		auto nextFrontier = makeScratchVector<eastl::pair<Entity, u32>>(FrameScratchAllocator::get());
+
+		for (auto [entity, relation] : m_hierarchyQuery.view<Entity, Write<TransformRelationsComponent>>())
+		{
+			if (relation.parent == Entity::undefined() || !relations.has(relation.parent))
+			{
+				relation.depth = 0;
+				frontier.emplace_back(entity, NO_PARENT_NODE);
+
+				// A former child keeps its old world matrix until its own transform changes
+				if (TransformMatrixComponent* matrix = matrices.tryGet(entity))
+				{
+					matrix->matrix = composeTransformMatrix(transforms.get(entity));
+				}
+			}
+		}
+
+		// Breadth-first from the roots, children whose parent field disagrees are skipped, so are cycles
+		u32 depth = 1;
+		while (!frontier.empty())
+		{
+			nextFrontier.clear();
+			for (const auto& [parent, parentNode] : frontier)
+			{
+				for (Entity child : relations.get(parent).children)
+				{
+					TransformRelationsComponent* childRelations = relations.tryGet(child);
+					if (!childRelations || childRelations->parent != parent || !matrices.has(child) || !transforms.
+						has(child))
+					{
+						continue;
+					}
+
+					childRelations->depth = depth;
+					nextFrontier.emplace_back(child, static_cast<u32>(m_nodes.size()));
+					m_nodes.push_back({child, parent, parentNode});
+				}
+			}
+
+			if (!nextFrontier.empty())
+			{
+				m_levelOffsets.push_back(static_cast<u32>(m_nodes.size()));
+			}
+			frontier.swap(nextFrontier);
+			++depth;
+		}
+	}
+
+	void TransformHierarchySystem::propagateLevel(SystemContext ctx, u32 begin, u32 end, bool forceDirty)
+	{
+		auto transforms = ctx.getReadOnlyComponentLookup<TransformComponent>();
+		auto worldMatrices = ctx.getReadOnlyComponentLookup<TransformMatrixComponent>();
+		auto matrices = ctx.getComponentLookup<TransformMatrixComponent>();
+
+		auto marker = FrameScratchAllocator::get().get_scoped_marker();
+		const u32 count = end - begin;
+		auto items = makeScratchVector<LevelItem>(FrameScratchAllocator::get());
+		auto scratch = makeScratchVector<LevelItem>(FrameScratchAllocator::get());
+		items.reserve(count);
+		scratch.resize(count);
+
+		for (u32 node = begin; node < end; ++node)
+		{
+			const Chunk* chunk = matrices.findChunk(m_nodes[node].entity);
+			items.push_back({reinterpret_cast<u64>(chunk), node});
+		}
+
+		// Modification bits are per chunk, so a chunk must be written by a single thread
+		radixSort(eastl::span<LevelItem>(items), eastl::span<LevelItem>(scratch),
+		          [](const LevelItem& item) { return item.chunkKey; });
+
+		auto runStarts = makeScratchVector<u32>(FrameScratchAllocator::get());
+		for (u32 i = 0; i < count; ++i)
+		{
+			if (i == 0 || items[i].chunkKey != items[i - 1].chunkKey)
+			{
+				runStarts.push_back(i);
+			}
+		}
+		runStarts.push_back(count);
+
+		ctx.parallelFor(static_cast<u32>(runStarts.size() - 1), 1, [&](u32 firstRun, u32 lastRun)
+		{
+			for (u32 i = runStarts[firstRun]; i < runStarts[lastRun]; ++i)
+			{
+				const u32 nodeIndex = items[i].node;
+				const HierarchyNode& node = m_nodes[nodeIndex];
+
+				const bool parentDirty = node.parentNode == NO_PARENT_NODE
+					                         ? transforms.wasModified(node.parent)
+					                         : m_dirty[node.parentNode] != 0;
+				const bool dirty = forceDirty || parentDirty || transforms.wasModified(node.entity);
+				m_dirty[nodeIndex] = dirty;
+				if (!dirty)
+				{
+					continue;
+				}
+
+				const TransformMatrixComponent* parentMatrix = worldMatrices.tryGet(node.parent);
+				if (!parentMatrix)
+				{
+					continue;
+				}
+
+				matrices.get(node.entity).matrix = parentMatrix->matrix * composeTransformMatrix(
+					transforms.get(node.entity));
+			}
+		});
+	}
+}
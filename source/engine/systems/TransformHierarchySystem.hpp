@@ -0,0 +1,42 @@
+﻿#pragma once
+#include <limits>
+
+#include "ecs/systems/SystemBase.hpp"
+
+namespace spite
+{
+	// Turns local TransformMatrixComponent values of parented entities into world matrices.
+	// Entities are kept in depth order, every level is processed in parallel and only waits for the previous one.
+	// A subtree is recomputed only when its root or one of its ancestors changed this frame
+	class TransformHierarchySystem : public SystemBase
+	{
+	private:
+		static constexpr u32 NO_PARENT_NODE = std::numeric_limits<u32>::max();
+
+		struct HierarchyNode
+		{
+			Entity entity;
+			Entity parent;
+			// Index of the parent in m_nodes, NO_PARENT_NODE for hierarchy roots
+			u32 parentNode;
+		};
+
+		QueryHandle m_hierarchyQuery;
+		QueryHandle m_reparentQuery;
+
+		// Parented entities only, sorted by depth
+		glheap_vector<HierarchyNode> m_nodes;
+		// Level L (starting with depth 1) spans [m_levelOffsets[L - 1], m_levelOffsets[L])
+		glheap_vector<u32> m_levelOffsets;
+		// Per node, whether its world matrix was rebuilt during the current update
+		glheap_vector<u8> m_dirty;
+
+		bool isStructureChanged(SystemContext ctx);
+		void rebuildHierarchy(SystemContext ctx);
+		void propagateLevel(SystemContext ctx, u32 begin, u32 end, bool forceDirty);
+
+	public:
+		void onInitialize(SystemContext ctx, SystemDependencyStorage& dependencyStorage) override;
+		void onUpdate(SystemContext ctx) override;
+	};
+}
@@ -1,6 +1,7 @@
 ﻿#include "TransformMatrixCalculateSystem.hpp"
 
 #include "engine/components/CoreComponents.hpp"
+#include "engine/math/TransformKernels.hpp"
 
 
 namespace spite
@@ -9,7 +10,7 @@ namespace spite
 	{
 		setExecutionStage(CoreExecutionStages::POST_UPDATE);
 
-		auto& queryDesc = ctx.getQueryBuilder().with<Read<TransformComponent>, Write<TransformMatrixComponent>>().
+		auto queryDesc = ctx.getQueryBuilder().with<Read<TransformComponent>, Write<TransformMatrixComponent>>().
 		                      modified<TransformComponent>();
 
 		query = registerQuery(queryDesc, dependencyStorage);
@@ -18,14 +19,42 @@ namespace spite
 
 	void TransformMatrixCalculateSystem::onUpdate(SystemContext ctx)
 	{
-		for (auto [matrix, transform] : query.view<
-			     Write<TransformMatrixComponent>, Read<TransformComponent>>())
+		const ComponentID transformId = ComponentMetadataRegistry::getComponentId<TransformComponent>();
+		const ComponentID matrixId = ComponentMetadataRegistry::getComponentId<TransformMatrixComponent>();
+
+		// Whole chunks go through the batched kernel, entities with unmodified transforms split them into runs.
+		// Chunks are independent, so they are spread over the workers
+		ctx.parallelForChunks(query, [transformId, matrixId](Chunk* chunk)
 		{
-			matrix.matrix = glm::mat4(1.0f);
+			const Chunk* constChunk = chunk;
+			const sizet transformIndex = chunk->getComponentIndex(transformId);
+			const sizet matrixIndex = chunk->getComponentIndex(matrixId);
+			const TransformComponent* transforms = constChunk->getComponents<TransformComponent>();
+			TransformMatrixComponent* matrices = constChunk->getComponents<TransformMatrixComponent>();
+
+			const sizet count = chunk->size();
+			sizet begin = 0;
+			while (begin < count)
+			{
+				if (!chunk->wasModifiedLastFrameByIndex(transformIndex, begin))
+				{
+					++begin;
+					continue;
+				}
+
+				sizet end = begin + 1;
+				while (end < count && chunk->wasModifiedLastFrameByIndex(transformIndex, end))
+				{
+					++end;
+				}
 
-			matrix.matrix = glm::translate(matrix.matrix, transform.position);
-			matrix.matrix = matrix.matrix * glm::mat4_cast(transform.rotation);
-			matrix.matrix = glm::scale(matrix.matrix, transform.scale);
-		}
+				composeTransformMatrices(transforms + begin, matrices + begin, end - begin);
+				for (sizet i = begin; i < end; ++i)
+				{
+					chunk->markModifiedByIndex(matrixIndex, i);
+				}
+				begin = end;
+			}
+		});
 	}
 }
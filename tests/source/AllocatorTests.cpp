@@ -1,4 +1,13 @@
 #include <gtest/gtest.h>
+#include <atomic>
+#include <bitset>
+#include <chrono>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#include "base/memory/AllocatorRegistry.hpp"
+#include "base/memory/BufferedFrameAllocator.hpp"
 #include "base/memory/HeapAllocator.hpp"
 #include "base/memory/ScratchAllocator.hpp"
 #include "base/memory/PoolAllocator.hpp"
@@ -61,6 +70,280 @@ TEST_F(HeapAllocatorTest, LeakDetection) {
     allocator.shutdown(true); // Force shutdown
 }
 
+TEST_F(HeapAllocatorTest, SmallBlockReallocationKeepsContents) {
+    spite::HeapAllocator allocator("TestHeap", 1 * spite::MB);
+    auto* block = static_cast<char*>(allocator.allocate(24));
+    memcpy(block, "small block contents", 21);
+    block = static_cast<char*>(allocator.reallocate(block, 4096));
+    ASSERT_STREQ(block, "small block contents");
+    block = static_cast<char*>(allocator.reallocate(block, 40));
+    ASSERT_STREQ(block, "small block contents");
+    allocator.deallocate(block);
+    allocator.shutdown();
+}
+
+TEST_F(HeapAllocatorTest, ReallocationToZeroFreesSmallBlocks) {
+    spite::HeapAllocator allocator("TestHeap", 1 * spite::MB);
+    void* block = allocator.allocate(64);
+    ASSERT_GE(allocator.get_stats().liveBytes, 64u);
+    ASSERT_EQ(allocator.reallocate(block, 0), nullptr);
+    ASSERT_EQ(allocator.get_stats().liveBytes, 0u);
+    allocator.shutdown();
+}
+
+TEST_F(HeapAllocatorTest, ConcurrentAllocationWithCrossThreadFrees) {
+    spite::HeapAllocator allocator("TestConcurrentHeap", 32 * spite::MB);
+    constexpr int THREAD_COUNT = 4;
+    constexpr int BLOCK_COUNT = 4000;
+    std::vector<std::pair<unsigned char*, size_t>> blocks[THREAD_COUNT];
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < THREAD_COUNT; ++t) {
+        threads.emplace_back([&, t] {
+            for (int i = 0; i < BLOCK_COUNT; ++i) {
+                // Mostly cached size classes with some pool allocations in between
+                const size_t size = i % 16 == 0 ? 2048 : 8 + (i * 37) % 500;
+                auto* block = static_cast<unsigned char*>(allocator.allocate(size));
+                memset(block, t, size);
+                blocks[t].emplace_back(block, size);
+                if (i % 3 == 0) {
+                    allocator.deallocate(blocks[t].back().first);
+                    blocks[t].pop_back();
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) thread.join();
+    threads.clear();
+
+    // Every thread frees the blocks of its neighbour
+    std::atomic<int> corrupted = 0;
+    for (int t = 0; t < THREAD_COUNT; ++t) {
+        threads.emplace_back([&, t] {
+            const int owner = (t + 1) % THREAD_COUNT;
+            for (auto [block, size] : blocks[owner]) {
+                if (block[0] != owner || block[size - 1] != owner) corrupted++;
+                allocator.deallocate(block);
+            }
+        });
+    }
+    for (auto& thread : threads) thread.join();
+
+    ASSERT_EQ(corrupted.load(), 0);
+    // Remote frees are drained, nothing is reported as leaked
+    allocator.shutdown();
+}
+
+TEST_F(HeapAllocatorTest, NumaNodeAllocation) {
+    const u32 node = spite::getNumaNodeCount() - 1;
+    spite::HeapAllocator allocator("TestNumaHeap", 1 * spite::MB, node);
+    ASSERT_EQ(allocator.get_numa_node(), node);
+    auto* block = static_cast<unsigned char*>(allocator.allocate(4096));
+    ASSERT_NE(block, nullptr);
+    memset(block, 0xAB, 4096);
+    ASSERT_EQ(block[4095], 0xAB);
+    allocator.deallocate(block);
+    allocator.shutdown();
+}
+
+TEST_F(HeapAllocatorTest, NumaArenaPerNode) {
+    auto& registry = spite::AllocatorRegistry::instance();
+    // Without arenas callers get the global allocator
+    ASSERT_EQ(&registry.getNumaArena(0), &spite::getGlobalAllocator());
+
+    registry.createNumaArenas(1 * spite::MB);
+    ASSERT_EQ(registry.getNumaArenaCount(), spite::getNumaNodeCount());
+    ASSERT_TRUE(registry.hasAllocator("NumaArena0"));
+    for (u32 node = 0; node < registry.getNumaArenaCount(); ++node) {
+        spite::HeapAllocator& arena = registry.getNumaArena(node);
+        void* block = arena.allocate(256);
+        ASSERT_NE(block, nullptr);
+        arena.deallocate(block);
+    }
+    ASSERT_STREQ(registry.getNumaArena(0).get_name(), "NumaArena0");
+    registry.shutdownAll();
+    ASSERT_EQ(registry.getNumaArenaCount(), 0u);
+}
+
+TEST_F(HeapAllocatorTest, GrowsByRegionsUpToCeiling) {
+    spite::HeapAllocator allocator("TestGrowableHeap", 1 * spite::MB, 8 * spite::MB, spite::ANY_NUMA_NODE);
+    ASSERT_EQ(allocator.get_reserved_size(), 1 * spite::MB);
+    ASSERT_EQ(allocator.get_max_size(), 8 * spite::MB);
+
+    std::vector<unsigned char*> blocks;
+    for (int i = 0; i < 4; ++i) {
+        auto* block = static_cast<unsigned char*>(allocator.allocate(512 * spite::KB));
+        ASSERT_NE(block, nullptr);
+        memset(block, i, 512 * spite::KB);
+        blocks.push_back(block);
+    }
+    ASSERT_GT(allocator.get_reserved_size(), 1 * spite::MB);
+
+    // Moves into a new region, the one it leaves is released
+    const sizet reserved = allocator.get_reserved_size();
+    blocks[3] = static_cast<unsigned char*>(allocator.reallocate(blocks[3], 1536 * spite::KB));
+    ASSERT_NE(blocks[3], nullptr);
+    ASSERT_LT(allocator.get_reserved_size(), reserved + 1536 * spite::KB);
+
+    // Larger than the initial region
+    void* large = allocator.allocate(3 * spite::MB);
+    ASSERT_NE(large, nullptr);
+    ASSERT_EQ(allocator.allocate(4 * spite::MB), nullptr);
+    ASSERT_LE(allocator.get_reserved_size(), 8 * spite::MB);
+
+    for (int i = 0; i < 4; ++i) {
+        ASSERT_EQ(blocks[i][512 * spite::KB - 1], i);
+    }
+
+    // Emptied regions go back to the OS
+    allocator.deallocate(large);
+    for (unsigned char* block : blocks) {
+        allocator.deallocate(block);
+    }
+    ASSERT_EQ(allocator.get_reserved_size(), 1 * spite::MB);
+    allocator.shutdown();
+}
+
+TEST_F(HeapAllocatorTest, ConcurrentGrowthAndRelease) {
+    spite::HeapAllocator allocator("TestGrowableHeap", 256 * spite::KB, 64 * spite::MB, spite::ANY_NUMA_NODE);
+    constexpr int THREADS = 4;
+    std::atomic<bool> failed = false;
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < THREADS; ++t) {
+        threads.emplace_back([&, t] {
+            std::vector<std::pair<unsigned char*, sizet>> blocks;
+            for (int round = 0; round < 20; ++round) {
+                for (int i = 0; i < 64; ++i) {
+                    const sizet size = (i % 3 == 0) ? 64 : (i % 3 == 1) ? 4 * spite::KB : 96 * spite::KB;
+                    auto* block = static_cast<unsigned char*>(allocator.allocate(size));
+                    if (!block) {
+                        failed = true;
+                        return;
+                    }
+                    memset(block, t + round, size);
+                    blocks.emplace_back(block, size);
+                }
+                for (auto [block, size] : blocks) {
+                    if (block[0] != static_cast<unsigned char>(t + round) ||
+                        block[size - 1] != static_cast<unsigned char>(t + round)) {
+                        failed = true;
+                    }
+                    allocator.deallocate(block);
+                }
+                blocks.clear();
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    ASSERT_FALSE(failed.load());
+    ASSERT_LE(allocator.get_reserved_size(), 64 * spite::MB);
+    allocator.shutdown();
+}
+
+TEST_F(HeapAllocatorTest, HugePageBackedRegions) {
+    spite::HeapAllocator allocator("TestHugePageHeap", 3 * spite::MB, 8 * spite::MB, spite::ANY_NUMA_NODE, true);
+    // Regions are whole huge pages whether or not the OS provided them
+    ASSERT_EQ(allocator.get_reserved_size(), 4 * spite::MB);
+    SDEBUG_LOG("Huge pages: %s\n", spite::hugePageModeName(allocator.get_huge_page_mode()))
+
+    auto* first = static_cast<unsigned char*>(allocator.allocate(3 * spite::MB));
+    auto* second = static_cast<unsigned char*>(allocator.allocate(3 * spite::MB));
+    ASSERT_NE(first, nullptr);
+    ASSERT_NE(second, nullptr);
+    memset(first, 1, 3 * spite::MB);
+    memset(second, 2, 3 * spite::MB);
+    ASSERT_EQ(allocator.get_reserved_size(), 8 * spite::MB);
+    ASSERT_EQ(first[3 * spite::MB - 1], 1);
+    ASSERT_EQ(second[3 * spite::MB - 1], 2);
+
+    allocator.deallocate(second);
+    allocator.deallocate(first);
+    allocator.shutdown();
+}
+
+TEST_F(HeapAllocatorTest, StatsTrackLiveBytesAndFrames) {
+    spite::HeapAllocator allocator("TestStatsHeap", 4 * spite::MB);
+    void* small = allocator.allocate(48);
+    void* large = allocator.allocate(100 * spite::KB);
+    auto stats = allocator.get_stats();
+    ASSERT_EQ(stats.totalAllocations, 2u);
+    ASSERT_GE(stats.liveBytes, 100 * spite::KB + 48);
+    // Frame counters are closed by end_frame
+    ASSERT_EQ(stats.frameAllocations, 0u);
+
+    allocator.end_frame();
+    allocator.deallocate(large);
+    void* other = nullptr;
+    std::thread([&] { other = allocator.allocate(200); }).join();
+    allocator.end_frame();
+
+    stats = allocator.get_stats();
+    ASSERT_EQ(stats.frameAllocations, 1u);
+    ASSERT_EQ(stats.frameFrees, 1u);
+    ASSERT_LT(stats.liveBytes, 100 * spite::KB);
+    ASSERT_GE(stats.peakBytes, 100 * spite::KB + 48);
+
+    // Frees from another thread balance allocations made here
+    std::thread([&] { allocator.deallocate(small); }).join();
+    allocator.deallocate(other);
+    stats = allocator.get_stats();
+    ASSERT_EQ(stats.liveBytes, 0u);
+    ASSERT_EQ(stats.totalFrees, stats.totalAllocations);
+    allocator.shutdown();
+}
+
+TEST_F(HeapAllocatorTest, StatsReportFragmentation) {
+    spite::HeapAllocator allocator("TestStatsHeap", 4 * spite::MB);
+    auto stats = allocator.get_stats(true);
+    ASSERT_GT(stats.freeBytes, 3 * spite::MB);
+    ASSERT_EQ(stats.largestFreeBlock, stats.freeBytes);
+    ASSERT_EQ(stats.fragmentation, 0.f);
+
+    // Every other block freed leaves holes between live ones
+    std::vector<void*> blocks;
+    for (int i = 0; i < 32; ++i) {
+        blocks.push_back(allocator.allocate(64 * spite::KB));
+    }
+    for (int i = 0; i < 32; i += 2) {
+        allocator.deallocate(blocks[i]);
+    }
+    stats = allocator.get_stats(true);
+    ASSERT_LT(stats.largestFreeBlock, stats.freeBytes);
+    ASSERT_GT(stats.fragmentation, 0.f);
+
+    for (int i = 1; i < 32; i += 2) {
+        allocator.deallocate(blocks[i]);
+    }
+    ASSERT_EQ(allocator.get_stats(true).fragmentation, 0.f);
+    allocator.shutdown();
+}
+
+TEST_F(HeapAllocatorTest, RegistryCollectsStatsPerAllocator) {
+    auto& registry = spite::AllocatorRegistry::instance();
+    spite::HeapAllocator& allocator = registry.createAllocator("TestStatsAllocator", 1 * spite::MB);
+    void* block = allocator.allocate(16 * spite::KB);
+    registry.endFrame(true);
+
+    bool found = false;
+    for (const auto& report : registry.collectStats()) {
+        if (strcmp(report.name, "TestStatsAllocator") == 0) {
+            found = true;
+            ASSERT_EQ(report.stats.frameAllocations, 1u);
+            ASSERT_GE(report.stats.liveBytes, 16 * spite::KB);
+            ASSERT_EQ(report.stats.reservedBytes, 1 * spite::MB);
+        }
+    }
+    ASSERT_TRUE(found);
+    ASSERT_STREQ(registry.collectStats(false).back().name, spite::getGlobalAllocatorName());
+
+    allocator.deallocate(block);
+    registry.shutdownAll();
+}
+
 // Test fixture for ScratchAllocator
 class ScratchAllocatorTest : public testing::Test {
 protected:
@@ -104,48 +387,352 @@ TEST_F(ScratchAllocatorTest, ScopedMarker) {
     ASSERT_EQ(scratch.bytes_used(), initial_used);
 }
 
-TEST_F(ScratchAllocatorTest, OutOfMemory) {
+TEST_F(ScratchAllocatorTest, OverflowChainsBlocks) {
     spite::ScratchAllocator scratch(1 * spite::KB);
+    auto* first = static_cast<unsigned char*>(scratch.allocate(512));
+    memset(first, 1, 512);
+    auto* second = static_cast<unsigned char*>(scratch.allocate(1024));
+    ASSERT_NE(second, nullptr);
+    memset(second, 2, 1024);
+    ASSERT_EQ(scratch.overflow_count(), 1u);
+    ASSERT_TRUE(scratch.owns(first));
+    ASSERT_TRUE(scratch.owns(second));
+    ASSERT_EQ(first[511], 1);
+    ASSERT_GE(scratch.bytes_used(), 512u + 1024u);
+    ASSERT_GT(scratch.total_size(), 1 * spite::KB);
+
+    // The next frame fits into a grown buffer
+    scratch.reset();
+    ASSERT_GE(scratch.total_size(), 512u + 1024u);
     scratch.allocate(512);
-    ASSERT_THROW(scratch.allocate(1024), std::runtime_error);
+    scratch.allocate(1024);
+    ASSERT_EQ(scratch.overflow_count(), 1u);
 }
 
-// Test fixture for PoolAllocator
-class PoolAllocatorTest : public testing::Test {
+TEST_F(ScratchAllocatorTest, MarkerRewindsAcrossBlocks) {
+    spite::ScratchAllocator scratch(1 * spite::KB);
+    scratch.allocate(768);
+    const size_t used = scratch.bytes_used();
+    void* chained;
+    {
+        auto marker = scratch.get_scoped_marker();
+        chained = scratch.allocate(512);
+        scratch.allocate(4 * spite::KB);
+        ASSERT_EQ(scratch.overflow_count(), 2u);
+    }
+    ASSERT_EQ(scratch.bytes_used(), used);
+    ASSERT_GT(scratch.bytes_remaining(), 0u);
+
+    // Rewound blocks are reused
+    {
+        auto marker = scratch.get_scoped_marker();
+        ASSERT_EQ(scratch.allocate(512), chained);
+        ASSERT_EQ(scratch.overflow_count(), 2u);
+    }
+    ASSERT_EQ(scratch.bytes_used(), used);
+}
+
+TEST_F(ScratchAllocatorTest, ShrinksBackAfterSpike) {
+    spite::ScratchAllocator scratch(64 * spite::KB);
+    scratch.allocate(64 * spite::KB);
+    scratch.allocate(1 * spite::MB);
+    scratch.reset();
+    const size_t grown = scratch.total_size();
+    ASSERT_GT(grown, 1 * spite::MB);
+
+    for (int frame = 0; frame < 100; ++frame) {
+        scratch.allocate(16 * spite::KB);
+        scratch.reset();
+    }
+    ASSERT_EQ(scratch.total_size(), 64 * spite::KB);
+    ASSERT_GT(scratch.high_water_mark(), 1 * spite::MB);
+}
+
+TEST_F(ScratchAllocatorTest, HugePageBuffer) {
+    spite::ScratchAllocator allocator(3 * spite::MB, "TestHugePageScratch", true);
+    ASSERT_EQ(allocator.total_size(), 4 * spite::MB);
+
+    auto* block = static_cast<unsigned char*>(allocator.allocate(4 * spite::MB - 64));
+    ASSERT_NE(block, nullptr);
+    memset(block, 7, 4 * spite::MB - 64);
+    if (allocator.huge_page_mode() != spite::HugePageMode::eNone) {
+        ASSERT_EQ(reinterpret_cast<uintptr_t>(block) % spite::HUGE_PAGE_SIZE, 0u);
+    }
+
+    spite::ScratchAllocator moved(std::move(allocator));
+    ASSERT_EQ(moved.huge_page_mode(), allocator.huge_page_mode());
+    ASSERT_TRUE(moved.owns(block));
+}
+
+// Test fixture for BufferedFrameAllocator
+class BufferedFrameAllocatorTest : public testing::Test {
 protected:
     void SetUp() override {
-        spite::initGlobalAllocator();
+        //spite::initGlobalAllocator();
     }
 
+    void TearDown() override {
+        //spite::shutdownGlobalAllocator();
+    }
+};
+
+TEST_F(BufferedFrameAllocatorTest, DataLivesUntilItsFrameIsRetired) {
+    spite::BufferedFrameAllocator allocator(2, 64 * spite::KB, "TestFrames");
+    ASSERT_EQ(allocator.current_frame(), spite::BufferedFrameAllocator::NO_FRAME);
+
+    const u64 first = allocator.beginFrame();
+    auto* firstData = allocator.new_object<int>(1);
+    const u64 second = allocator.beginFrame();
+    auto* secondData = allocator.new_object<int>(2);
+    ASSERT_NE(first, second);
+    ASSERT_EQ(*firstData, 1);
+    ASSERT_TRUE(allocator.owns(firstData));
+
+    // The first region is still in flight
+    ASSERT_FALSE(allocator.isRetired(first));
+    ASSERT_THROW(allocator.beginFrame(), std::runtime_error);
+
+    allocator.retireFrame(first);
+    ASSERT_TRUE(allocator.isRetired(first));
+    const u64 third = allocator.beginFrame();
+    ASSERT_EQ(allocator.current_frame(), third);
+    ASSERT_EQ(allocator.bytes_used(), 0u);
+    ASSERT_EQ(*secondData, 2);
+
+    // Markers rewind within the current frame only
+    allocator.allocate(128);
+    const sizet used = allocator.bytes_used();
+    {
+        auto marker = allocator.get_scoped_marker();
+        allocator.allocate(1024);
+    }
+    ASSERT_EQ(allocator.bytes_used(), used);
+    ASSERT_EQ(allocator.total_size(), 2 * 64 * spite::KB);
+}
+
+TEST_F(BufferedFrameAllocatorTest, RegionsRecycleAsFramesRetire) {
+    spite::BufferedFrameAllocator allocator(3, 64 * spite::KB, "TestFrames");
+    int* drawLists[3] = {};
+    for (int frame = 0; frame < 10; ++frame) {
+        const u64 id = allocator.beginFrame();
+        int* drawList = static_cast<int*>(allocator.allocate(100 * sizeof(int), alignof(int)));
+        ASSERT_TRUE(allocator.owns(drawList));
+        for (int i = 0; i < 100; ++i) {
+            drawList[i] = frame * 100 + i;
+        }
+        drawLists[id % 3] = drawList;
+
+        // Frames retire two frames late, the previous lists are untouched until then
+        if (id >= 1) {
+            ASSERT_EQ(drawLists[(id - 1) % 3][99], (frame - 1) * 100 + 99);
+        }
+        if (id >= 2) {
+            ASSERT_EQ(drawLists[(id - 2) % 3][99], (frame - 2) * 100 + 99);
+            allocator.retireFrame(id - 2);
+        }
+    }
+    ASSERT_GE(allocator.high_water_mark(), 100 * sizeof(int));
+}
+
+// Test fixture for PoolAllocator
+class PoolAllocatorTest : public testing::Test {
+protected:
     void TearDown() override {
         spite::PoolAllocator<int>::instance().cleanup();
-        spite::shutdownGlobalAllocator();
+        spite::PoolAllocator<int, 4>::instance().cleanup();
     }
 };
 
-//TEST_F(PoolAllocatorTest, AllocateAndDeallocate) {
-//    auto& pool = spite::PoolAllocator<int>::instance();
-//    int* p1 = pool.allocate();
-//    ASSERT_NE(p1, nullptr);
-//    *p1 = 123;
-//    pool.deallocate(p1);
-//    int* p2 = pool.allocate();
-//    ASSERT_EQ(p1, p2); // Should reuse the deallocated slot
-//    pool.cleanup();
-//}
-//
-//TEST_F(PoolAllocatorTest, MultipleAllocations) {
-//    auto& pool = spite::PoolAllocator<int, 4>::instance();
-//    int* p1 = pool.allocate();
-//    int* p2 = pool.allocate();
-//    int* p3 = pool.allocate();
-//    int* p4 = pool.allocate();
-//    ASSERT_NE(p1, nullptr);
-//    ASSERT_NE(p2, nullptr);
-//    ASSERT_NE(p3, nullptr);
-//    ASSERT_NE(p4, nullptr);
-//
-//    // This should trigger a new block allocation
-//    int* p5 = pool.allocate();
-//    ASSERT_NE(p5, nullptr);
-//}
+TEST_F(PoolAllocatorTest, AllocateAndDeallocate) {
+    auto& pool = spite::PoolAllocator<int>::instance();
+    int* p1 = pool.allocate();
+    ASSERT_NE(p1, nullptr);
+    *p1 = 123;
+    pool.deallocate(p1);
+    int* p2 = pool.allocate();
+    ASSERT_EQ(p1, p2); // Should reuse the deallocated slot
+    pool.cleanup();
+}
+
+TEST_F(PoolAllocatorTest, MultipleAllocations) {
+    auto& pool = spite::PoolAllocator<int, 4>::instance();
+    int* p1 = pool.allocate();
+    int* p2 = pool.allocate();
+    int* p3 = pool.allocate();
+    int* p4 = pool.allocate();
+    ASSERT_NE(p1, nullptr);
+    ASSERT_NE(p2, nullptr);
+    ASSERT_NE(p3, nullptr);
+    ASSERT_NE(p4, nullptr);
+
+    // This should trigger a new block allocation
+    int* p5 = pool.allocate();
+    ASSERT_NE(p5, nullptr);
+    ASSERT_TRUE(pool.owns(p1));
+    ASSERT_TRUE(pool.owns(p5));
+}
+
+TEST_F(PoolAllocatorTest, BlocksAreFullyCarved) {
+    struct Payload { u64 values[2]; };
+    using Pool = spite::PoolAllocator<Payload>;
+    // 1024 slots of 16 bytes plus the header just exceed 16 KB, the block stays at 16 KB
+    static_assert(Pool::block_bytes() == 16 * 1024);
+    ASSERT_EQ(Pool::slots_per_block(), (16 * 1024 - 16) / sizeof(Payload));
+    static_assert(spite::PoolAllocator<int, 4>::slots_per_block() >= 1);
+
+    spite::HeapAllocator allocator("TestPoolHeap", 4 * spite::MB);
+    {
+        Pool pool(allocator);
+        std::vector<Payload*> slots(Pool::slots_per_block() + 1);
+        for (auto*& slot : slots) slot = pool.allocate();
+        const auto blockOf = [](const Payload* ptr) {
+            return reinterpret_cast<uintptr_t>(ptr) & ~(Pool::block_bytes() - 1);
+        };
+        for (size_t i = 1; i < Pool::slots_per_block(); ++i) {
+            ASSERT_EQ(blockOf(slots[i]), blockOf(slots[0]));
+        }
+        // The slot after a full block comes from a new one
+        ASSERT_NE(blockOf(slots.back()), blockOf(slots[0]));
+        for (auto* slot : slots) pool.deallocate(slot);
+    }
+    allocator.shutdown();
+}
+
+TEST_F(PoolAllocatorTest, BulkAllocation) {
+    struct alignas(32) SideData { float values[12]; };
+    spite::HeapAllocator allocator("TestPoolHeap", 4 * spite::MB);
+    {
+        spite::PoolAllocator<SideData, 64> pool(allocator);
+        std::vector<SideData*> slots(1000);
+        pool.allocate(eastl::span<SideData*>(slots.data(), slots.size()));
+        for (size_t i = 0; i < slots.size(); ++i) {
+            ASSERT_EQ(reinterpret_cast<uintptr_t>(slots[i]) % alignof(SideData), 0u);
+            ASSERT_TRUE(pool.owns(slots[i]));
+            slots[i]->values[0] = static_cast<float>(i);
+        }
+        for (size_t i = 0; i < slots.size(); ++i) {
+            ASSERT_EQ(slots[i]->values[0], static_cast<float>(i));
+        }
+        pool.deallocate(eastl::span<SideData* const>(slots.data(), slots.size()));
+    }
+    allocator.shutdown();
+}
+
+TEST_F(PoolAllocatorTest, ThreadMagazines) {
+    spite::HeapAllocator allocator("TestPoolHeap", 16 * spite::MB);
+    {
+        spite::PoolAllocator<std::pair<int, int>, 256> pool(allocator, spite::PoolConcurrency::eThreadMagazines);
+        constexpr int THREAD_COUNT = 4;
+        constexpr int SLOT_COUNT = 5000;
+        std::vector<std::pair<int, int>*> slots[THREAD_COUNT];
+
+        std::vector<std::thread> threads;
+        for (int t = 0; t < THREAD_COUNT; ++t) {
+            threads.emplace_back([&, t] {
+                for (int i = 0; i < SLOT_COUNT; ++i) {
+                    auto* slot = pool.allocate();
+                    *slot = {t, i};
+                    slots[t].push_back(slot);
+                }
+            });
+        }
+        for (auto& thread : threads) thread.join();
+        threads.clear();
+
+        // Slots are returned by other threads
+        std::atomic<int> corrupted = 0;
+        for (int t = 0; t < THREAD_COUNT; ++t) {
+            threads.emplace_back([&, t] {
+                const int owner = (t + 1) % THREAD_COUNT;
+                for (int i = 0; i < SLOT_COUNT; ++i) {
+                    if (*slots[owner][i] != std::pair(owner, i)) corrupted++;
+                    pool.deallocate(slots[owner][i]);
+                }
+            });
+        }
+        for (auto& thread : threads) thread.join();
+        ASSERT_EQ(corrupted.load(), 0);
+    }
+    allocator.shutdown();
+}
+
+namespace {
+    // The previous PoolAllocator algorithm: first fit bitset scan over every block
+    template <typename T, size_t BlockSize>
+    class BitsetScanPool {
+        struct Block {
+            alignas(T) char data[sizeof(T) * BlockSize];
+            std::bitset<BlockSize> used;
+            Block* next = nullptr;
+        };
+        Block* m_blocks = nullptr;
+
+    public:
+        ~BitsetScanPool() {
+            while (m_blocks) {
+                Block* next = m_blocks->next;
+                delete m_blocks;
+                m_blocks = next;
+            }
+        }
+
+        T* allocate() {
+            for (Block* block = m_blocks; block; block = block->next) {
+                for (size_t i = 0; i < BlockSize; ++i) {
+                    if (!block->used[i]) {
+                        block->used[i] = true;
+                        return reinterpret_cast<T*>(block->data + i * sizeof(T));
+                    }
+                }
+            }
+            auto* block = new Block();
+            block->next = m_blocks;
+            m_blocks = block;
+            block->used[0] = true;
+            return reinterpret_cast<T*>(block->data);
+        }
+
+        void deallocate(T* ptr) {
+            auto* bytes = reinterpret_cast<char*>(ptr);
+            for (Block* block = m_blocks; block; block = block->next) {
+                if (bytes >= block->data && bytes < block->data + sizeof(T) * BlockSize) {
+                    block->used[(bytes - block->data) / sizeof(T)] = false;
+                    return;
+                }
+            }
+        }
+    };
+}
+
+TEST_F(PoolAllocatorTest, DISABLED_Benchmark) {
+    struct Payload { u64 values[4]; };
+    constexpr int count = 50000;
+    constexpr int iterations = 10;
+
+    auto measure = [&](auto& pool) {
+        std::vector<Payload*> slots(count);
+        const auto start = std::chrono::high_resolution_clock::now();
+        for (int iteration = 0; iteration < iterations; ++iteration) {
+            for (int i = 0; i < count; ++i) slots[i] = pool.allocate();
+            // Free every other slot and refill to exercise reuse
+            for (int i = 0; i < count; i += 2) pool.deallocate(slots[i]);
+            for (int i = 0; i < count; i += 2) slots[i] = pool.allocate();
+            for (int i = 0; i < count; ++i) pool.deallocate(slots[i]);
+        }
+        const auto end = std::chrono::high_resolution_clock::now();
+        return std::chrono::duration<double, std::milli>(end - start).count() / iterations;
+    };
+
+    spite::HeapAllocator allocator("BenchmarkPoolHeap", 64 * spite::MB);
+    double freeListTime;
+    {
+        spite::PoolAllocator<Payload> pool(allocator);
+        freeListTime = measure(pool);
+    }
+    allocator.shutdown();
+    BitsetScanPool<Payload, 1024> reference;
+    const double bitsetTime = measure(reference);
+
+    printf("pool of %d slots: bitset scan %.3f ms, free list %.3f ms (x%.1f)\n", count, bitsetTime, freeListTime,
+           bitsetTime / freeListTime);
+}
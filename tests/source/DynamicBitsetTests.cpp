@@ -0,0 +1,122 @@
+#include <gtest/gtest.h>
+#include <random>
+#include <vector>
+
+#include "base/DynamicBitset.hpp"
+#include "base/memory/HeapAllocator.hpp"
+
+class DynamicBitsetTest : public testing::Test {
+protected:
+    spite::HeapAllocator allocator;
+
+    DynamicBitsetTest() : allocator("DynamicBitsetTestAllocator", 1 * spite::MB) {}
+    ~DynamicBitsetTest() override {
+        allocator.shutdown();
+    }
+};
+
+namespace {
+    std::vector<bool> randomBits(std::mt19937& random, sizet size, int density) {
+        std::vector<bool> bits(size);
+        for (sizet i = 0; i < size; ++i) {
+            bits[i] = static_cast<int>(random() % 100) < density;
+        }
+        return bits;
+    }
+
+    template <typename Bitset>
+    void assign(Bitset& bitset, const std::vector<bool>& bits) {
+        for (sizet i = 0; i < bits.size(); ++i) {
+            if (bits[i]) bitset.set(i);
+        }
+    }
+
+    sizet firstSetFrom(const std::vector<bool>& bits, sizet pos) {
+        for (sizet i = pos; i < bits.size(); ++i) {
+            if (bits[i]) return i;
+        }
+        return spite::BITSET_NPOS;
+    }
+}
+
+// Sizes around every vector width and tail length
+TEST_F(DynamicBitsetTest, OperationsMatchReference) {
+    std::mt19937 random(7);
+    for (sizet size = 1; size < 600; size += 13) {
+        for (int density : {0, 1, 30}) {
+            const auto a = randomBits(random, size, density);
+            const auto b = randomBits(random, size / 2 + 1, density);
+            spite::DynamicBitset left(size, allocator);
+            spite::DynamicBitset right(b.size(), allocator);
+            assign(left, a);
+            assign(right, b);
+
+            bool intersects = false;
+            sizet count = 0;
+            for (sizet i = 0; i < size; ++i) {
+                intersects |= a[i] && i < b.size() && b[i];
+                count += a[i];
+            }
+            ASSERT_EQ(left.intersects(right), intersects);
+            ASSERT_EQ(right.intersects(left), intersects);
+            ASSERT_EQ((left & right).any(), intersects);
+            ASSERT_EQ(left.count(), count);
+            ASSERT_EQ(left.any(), count != 0);
+            ASSERT_EQ(left.find_first(), firstSetFrom(a, 0));
+            ASSERT_EQ(left.find_next(size / 3), firstSetFrom(a, size / 3));
+
+            auto united = right | left;
+            auto masked = left;
+            masked.and_not(right);
+            auto narrowed = left;
+            narrowed &= right;
+            ASSERT_EQ(united.size(), size);
+            for (sizet i = 0; i < size; ++i) {
+                const bool inB = i < b.size() && b[i];
+                ASSERT_EQ(united.test(i), a[i] || inB);
+                ASSERT_EQ(masked.test(i), a[i] && !inB);
+                ASSERT_EQ(narrowed.test(i), a[i] && inB);
+            }
+        }
+    }
+}
+
+TEST_F(DynamicBitsetTest, ShrinkingClearsTrailingBits) {
+    spite::DynamicBitset bits(200, allocator);
+    bits.set(150).set(70);
+    bits.resize(100);
+    ASSERT_EQ(bits.count(), 1u);
+    bits.resize(200);
+    ASSERT_FALSE(bits.test(150));
+    ASSERT_EQ(bits.find_next(71), spite::BITSET_NPOS);
+
+    bits.reset(70);
+    ASSERT_TRUE(bits.none());
+}
+
+TEST_F(DynamicBitsetTest, FixedBitsetMatchesDynamic) {
+    std::mt19937 random(11);
+    const auto a = randomBits(random, 300, 5);
+    const auto b = randomBits(random, 300, 5);
+    spite::FixedBitset<300> fixedA;
+    spite::FixedBitset<300> fixedB;
+    spite::DynamicBitset dynamicA(300, allocator);
+    spite::DynamicBitset dynamicB(300, allocator);
+    assign(fixedA, a);
+    assign(fixedB, b);
+    assign(dynamicA, a);
+    assign(dynamicB, b);
+
+    ASSERT_EQ(fixedA.intersects(fixedB), dynamicA.intersects(dynamicB));
+    ASSERT_EQ(fixedA.count(), dynamicA.count());
+    ASSERT_EQ((fixedA | fixedB).count(), (dynamicA | dynamicB).count());
+    for (sizet pos = fixedA.find_first(); pos != spite::BITSET_NPOS; pos = fixedA.find_next(pos + 1)) {
+        ASSERT_TRUE(dynamicA.test(pos));
+    }
+
+    ASSERT_THROW(fixedA.set(300), std::runtime_error);
+    ASSERT_FALSE(fixedA.test(300));
+    fixedA.reset();
+    ASSERT_TRUE(fixedA.none());
+    ASSERT_EQ(fixedA, spite::FixedBitset<300>());
+}
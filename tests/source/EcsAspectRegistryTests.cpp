@@ -63,6 +63,19 @@ TEST_F(EcsAspectRegistryTest, GetDescendants)
     ASSERT_EQ(*descendants[0], child);
 }
 
+TEST_F(EcsAspectRegistryTest, GetDescendantsOfLaterSubset)
+{
+    // {2, 3} hangs below {3}, adding {2} afterwards must still find it
+    spite::Aspect superset({2, 3});
+    registry->addOrGetAspect(spite::Aspect({3}));
+    registry->addOrGetAspect(superset);
+    registry->addOrGetAspect(spite::Aspect({2}));
+
+    auto descendants = registry->getDescendantAspects(spite::Aspect({2}));
+    ASSERT_EQ(descendants.size(), 1);
+    ASSERT_EQ(*descendants[0], superset);
+}
+
 TEST_F(EcsAspectRegistryTest, GetAncestors)
 {
     spite::Aspect parent({1, 2});
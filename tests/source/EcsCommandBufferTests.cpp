@@ -1,4 +1,9 @@
 #include <gtest/gtest.h>
+#include <array>
+#include <atomic>
+#include <thread>
+#include <vector>
+
 #include "ecs/core/EntityWorld.hpp"
 #include "ecs/query/QueryBuilder.hpp"
 #include "ecs/cbuffer/CommandBuffer.hpp"
@@ -26,6 +31,32 @@ struct Velocity : spite::IComponent
 	}
 };
 
+// Larger than a single command can hold inline
+struct LargePayload : spite::IComponent
+{
+	std::array<u32, 32 * 1024> values;
+};
+
+struct alignas(32) OverAlignedPayload : spite::IComponent
+{
+	float values[8];
+};
+
+// Counts live instances, payloads that never reach a chunk must still be destroyed
+struct TrackedPayload : spite::IComponent
+{
+	static inline int live = 0;
+	std::vector<int> values;
+
+	TrackedPayload() { ++live; }
+	TrackedPayload(std::vector<int> values) : values(std::move(values)) { ++live; }
+	TrackedPayload(const TrackedPayload& other) : values(other.values) { ++live; }
+	TrackedPayload(TrackedPayload&& other) noexcept : values(std::move(other.values)) { ++live; }
+	TrackedPayload& operator=(const TrackedPayload&) = default;
+	TrackedPayload& operator=(TrackedPayload&&) noexcept = default;
+	~TrackedPayload() { --live; }
+};
+
 class EcsCommandBufferTest : public testing::Test
 {
 protected:
@@ -86,6 +117,7 @@ protected:
 	{
 		spite::ComponentMetadataRegistry::registerComponent<Position>();
 		spite::ComponentMetadataRegistry::registerComponent<Velocity>();
+		spite::ComponentMetadataRegistry::registerComponent<TrackedPayload>();
 	}
 
 	void TearDown() override
@@ -97,7 +129,7 @@ protected:
 
 TEST_F(EcsCommandBufferTest, CreateEntity)
 {
-	auto cmd = entityManager.getCommandBuffer();
+	auto cmd = entityManager.createCommandBuffer();
 	auto e_proxy = cmd.createEntity();
 	cmd.commit(entityManager);
 
@@ -111,7 +143,7 @@ TEST_F(EcsCommandBufferTest, DestroyEntity)
 	auto e = entityManager.createEntity();
 	ASSERT_TRUE(archetypeManager.isEntityTracked(e));
 
-	auto cmd = entityManager.getCommandBuffer();
+	auto cmd = entityManager.createCommandBuffer();
 	cmd.destroyEntity(e);
 	cmd.commit(entityManager);
 
@@ -120,7 +152,7 @@ TEST_F(EcsCommandBufferTest, DestroyEntity)
 
 TEST_F(EcsCommandBufferTest, AddComponent)
 {
-	auto cmd = entityManager.getCommandBuffer();
+	auto cmd = entityManager.createCommandBuffer();
 	auto e_proxy = cmd.createEntity();
 	cmd.addComponent<Position>(e_proxy, {1, 2, 3});
 	cmd.commit(entityManager);
@@ -144,7 +176,7 @@ TEST_F(EcsCommandBufferTest, RemoveComponent)
 	auto e = entityManager.createEntity();
 	entityManager.addComponent<Position>(e);
 
-	auto cmd = entityManager.getCommandBuffer();
+	auto cmd = entityManager.createCommandBuffer();
 	cmd.removeComponent<Position>(e);
 	cmd.commit(entityManager);
 
@@ -153,7 +185,7 @@ TEST_F(EcsCommandBufferTest, RemoveComponent)
 
 TEST_F(EcsCommandBufferTest, MixedCommands)
 {
-	auto cmd = entityManager.getCommandBuffer();
+	auto cmd = entityManager.createCommandBuffer();
 
 	auto e1_proxy = cmd.createEntity();
 	cmd.addComponent<Position>(e1_proxy, {1, 1, 1});
@@ -175,3 +207,323 @@ TEST_F(EcsCommandBufferTest, MixedCommands)
 	ASSERT_EQ(count, 1);
 	ASSERT_FALSE(archetypeManager.isEntityTracked(e2));
 }
+
+TEST_F(EcsCommandBufferTest, ConcurrentRecording)
+{
+	constexpr int threadCount = 4;
+	constexpr int entitiesPerThread = 600;
+
+	auto cmd = entityManager.createCommandBuffer();
+
+	std::vector<std::thread> threads;
+	for (int t = 0; t < threadCount; ++t)
+	{
+		threads.emplace_back([&cmd, t]()
+		{
+			for (int i = 0; i < entitiesPerThread; ++i)
+			{
+				auto proxy = cmd.createEntity();
+				cmd.addComponent<Position>(proxy, {static_cast<float>(t), static_cast<float>(i), 0.f});
+			}
+		});
+	}
+	for (auto& thread : threads)
+	{
+		thread.join();
+	}
+
+	cmd.commit(entityManager);
+	ASSERT_TRUE(cmd.isEmpty());
+
+	auto query = entityManager.getQueryBuilder().with<spite::Read<Position>>().build();
+	int count = 0;
+	float sumY = 0.f;
+	for (auto& pos : query.view<spite::Read<Position>>())
+	{
+		count++;
+		sumY += pos.y;
+	}
+	ASSERT_EQ(count, threadCount * entitiesPerThread);
+	ASSERT_FLOAT_EQ(sumY, threadCount * (entitiesPerThread - 1) * entitiesPerThread / 2.f);
+}
+
+namespace
+{
+	// Runs first and then second on two threads that are alive at the same time, so they hold distinct thread slots
+	template <typename First, typename Second>
+	void recordOnTwoThreads(First first, Second second)
+	{
+		std::atomic<int> stage = 0;
+		std::thread firstThread([&]()
+		{
+			first();
+			stage = 1;
+			while (stage != 2)
+			{
+				std::this_thread::yield();
+			}
+		});
+		std::thread secondThread([&]()
+		{
+			while (stage != 1)
+			{
+				std::this_thread::yield();
+			}
+			second();
+			stage = 2;
+		});
+		firstThread.join();
+		secondThread.join();
+	}
+}
+
+TEST_F(EcsCommandBufferTest, ThreadsMergeByRecordingOrder)
+{
+	// Either thread may get the lower slot, the higher order wins both ways round
+	for (const u32 firstOrder : {1u, 2u})
+	{
+		auto e = entityManager.createEntity();
+		entityManager.addComponent<Velocity>(e);
+
+		auto cmd = entityManager.createCommandBuffer();
+		auto record = [&cmd, e](u32 order)
+		{
+			spite::CommandBuffer::RecordingOrderScope scope(order);
+			cmd.addComponent<Position>(e, {static_cast<float>(order), 0, 0});
+			cmd.setComponent<Velocity>(e, {static_cast<float>(order), 0, 0});
+		};
+		recordOnTwoThreads([&]() { record(firstOrder); }, [&]() { record(3 - firstOrder); });
+		cmd.commit(entityManager);
+
+		ASSERT_EQ(entityManager.getComponent<Position>(e).x, 2);
+		ASSERT_EQ(entityManager.getComponent<Velocity>(e).dx, 2);
+	}
+	ASSERT_EQ(spite::CommandBuffer::getRecordingOrder(), 0u);
+}
+
+#ifdef DEBUG
+TEST_F(EcsCommandBufferTest, ConflictingCommandsWithoutOrderAssert)
+{
+	auto e = entityManager.createEntity();
+	entityManager.addComponent<Position>(e);
+
+	auto cmd = entityManager.createCommandBuffer();
+	recordOnTwoThreads([&]() { cmd.setComponent<Position>(e, {1, 0, 0}); },
+	                   [&]() { cmd.setComponent<Position>(e, {2, 0, 0}); });
+	ASSERT_THROW(cmd.commit(entityManager), std::runtime_error);
+}
+#endif
+
+TEST_F(EcsCommandBufferTest, AddThenRemoveKeepsRecordingOrder)
+{
+	auto e = entityManager.createEntity();
+
+	auto cmd = entityManager.createCommandBuffer();
+	cmd.addComponent<Position>(e, {1, 2, 3});
+	cmd.removeComponent<Position>(e);
+	cmd.addComponent<Velocity>(e, {4, 5, 6});
+	cmd.commit(entityManager);
+
+	ASSERT_FALSE(entityManager.hasComponent<Position>(e));
+	ASSERT_TRUE(entityManager.hasComponent<Velocity>(e));
+	ASSERT_EQ(entityManager.getComponent<Velocity>(e).dx, 4);
+}
+
+TEST_F(EcsCommandBufferTest, SupersededAddPayloadsAreDestroyed)
+{
+	auto kept = entityManager.createEntity();
+	auto removed = entityManager.createEntity();
+	auto destroyed = entityManager.createEntity();
+	const int liveBefore = TrackedPayload::live;
+
+	auto cmd = entityManager.createCommandBuffer();
+	cmd.addComponent<TrackedPayload>(kept, TrackedPayload({1, 2, 3}));
+	cmd.addComponent<TrackedPayload>(kept, TrackedPayload({4, 5, 6}));
+	cmd.addComponent<TrackedPayload>(removed, TrackedPayload({7}));
+	cmd.removeComponent<TrackedPayload>(removed);
+	cmd.addComponent<TrackedPayload>(destroyed, TrackedPayload({8}));
+	cmd.destroyEntity(destroyed);
+	auto proxy = cmd.createEntity();
+	cmd.addComponent<TrackedPayload>(proxy, TrackedPayload({9}));
+	cmd.destroyEntity(proxy);
+	cmd.commit(entityManager);
+
+	ASSERT_EQ(TrackedPayload::live, liveBefore + 1);
+	ASSERT_EQ(entityManager.getComponent<TrackedPayload>(kept).values, std::vector<int>({4, 5, 6}));
+	ASSERT_FALSE(entityManager.hasComponent<TrackedPayload>(removed));
+}
+
+TEST_F(EcsCommandBufferTest, LargeCommitGroupsByArchetype)
+{
+	constexpr int existingCount = 300;
+	std::vector<spite::Entity> existing;
+	for (int i = 0; i < existingCount; ++i)
+	{
+		existing.push_back(entityManager.createEntity());
+	}
+
+	auto cmd = entityManager.createCommandBuffer();
+	for (int i = 0; i < existingCount; ++i)
+	{
+		// Interleave targets so ops for one archetype are spread across the recording
+		if (i % 3 == 0)
+		{
+			cmd.addComponent<Position>(existing[i], {static_cast<float>(i), 0, 0});
+		}
+		else if (i % 3 == 1)
+		{
+			cmd.addComponent<Velocity>(existing[i], {static_cast<float>(i), 0, 0});
+			cmd.addComponent<Position>(existing[i], {static_cast<float>(i), 1, 0});
+		}
+		else
+		{
+			cmd.destroyEntity(existing[i]);
+		}
+
+		auto proxy = cmd.createEntity();
+		cmd.addComponent<Position>(proxy, {static_cast<float>(-i), 0, 0});
+	}
+	cmd.commit(entityManager);
+
+	for (int i = 0; i < existingCount; ++i)
+	{
+		if (i % 3 == 2)
+		{
+			ASSERT_FALSE(entityManager.isEntityValid(existing[i]));
+			continue;
+		}
+		ASSERT_EQ(entityManager.getComponent<Position>(existing[i]).x, static_cast<float>(i));
+		ASSERT_EQ(entityManager.hasComponent<Velocity>(existing[i]), i % 3 == 1);
+	}
+
+	auto query = entityManager.getQueryBuilder().with<spite::Read<Position>>().without<Velocity>().build();
+	int createdCount = 0;
+	for (auto& pos : query.view<spite::Read<Position>>())
+	{
+		if (pos.x <= 0)
+		{
+			++createdCount;
+		}
+	}
+	// Entity 0 got Position{0} added directly, every proxy got a non-positive x
+	ASSERT_EQ(createdCount, existingCount + 1);
+}
+
+TEST_F(EcsCommandBufferTest, SetComponentOverwritesInPlace)
+{
+	auto e = entityManager.createEntity();
+	entityManager.addComponent<Position>(e, 1.f, 1.f, 1.f);
+	const auto& aspectBefore = archetypeManager.getEntityAspect(e);
+
+	auto cmd = entityManager.createCommandBuffer();
+	cmd.setComponent<Position>(e, {2, 3, 4});
+	cmd.setComponent<Position>(e, {5, 6, 7});
+	cmd.commit(entityManager);
+
+	ASSERT_EQ(&archetypeManager.getEntityAspect(e), &aspectBefore);
+	const auto& pos = entityManager.getComponent<Position>(e);
+	ASSERT_EQ(pos.x, 5);
+	ASSERT_EQ(pos.z, 7);
+}
+
+TEST_F(EcsCommandBufferTest, SetComponentOnCreatedAndDestroyedEntities)
+{
+	auto destroyed = entityManager.createEntity();
+	entityManager.addComponent<Position>(destroyed);
+
+	auto cmd = entityManager.createCommandBuffer();
+	auto proxy = cmd.createEntity();
+	cmd.addComponent<Position>(proxy, {1, 1, 1});
+	cmd.setComponent<Position>(proxy, {8, 8, 8});
+	cmd.setComponent<Position>(destroyed, {9, 9, 9});
+	cmd.destroyEntity(destroyed);
+	cmd.commit(entityManager);
+
+	ASSERT_FALSE(entityManager.isEntityValid(destroyed));
+	auto query = entityManager.getQueryBuilder().with<spite::Read<Position>>().build();
+	int count = 0;
+	for (auto& pos : query.view<spite::Read<Position>>())
+	{
+		ASSERT_EQ(pos.x, 8);
+		++count;
+	}
+	ASSERT_EQ(count, 1);
+}
+
+TEST_F(EcsCommandBufferTest, DroppedSetPayloadsAreDestroyed)
+{
+	auto destroyed = entityManager.createEntity();
+	entityManager.addComponent<TrackedPayload>(destroyed);
+	auto withoutComponent = entityManager.createEntity();
+	auto target = entityManager.createEntity();
+	entityManager.addComponent<TrackedPayload>(target);
+	const int liveBefore = TrackedPayload::live;
+
+	auto cmd = entityManager.createCommandBuffer();
+	cmd.setComponent<TrackedPayload>(destroyed, TrackedPayload({1}));
+	cmd.destroyEntity(destroyed);
+	cmd.setComponent<TrackedPayload>(withoutComponent, TrackedPayload({2}));
+	auto proxy = cmd.createEntity();
+	cmd.setComponent<TrackedPayload>(proxy, TrackedPayload({3}));
+	cmd.destroyEntity(proxy);
+	cmd.setComponent<TrackedPayload>(target, TrackedPayload({4}));
+	cmd.commit(entityManager);
+
+	// Only the component of the destroyed entity is gone
+	ASSERT_EQ(TrackedPayload::live, liveBefore - 1);
+	ASSERT_EQ(entityManager.getComponent<TrackedPayload>(target).values, std::vector<int>({4}));
+}
+
+TEST_F(EcsCommandBufferTest, EnableDisableComponent)
+{
+	auto e1 = entityManager.createEntity();
+	auto e2 = entityManager.createEntity();
+	entityManager.addComponent<Position>(e1);
+	entityManager.addComponent<Position>(e2);
+	entityManager.disableComponent<Position>(e2);
+
+	auto cmd = entityManager.createCommandBuffer();
+	cmd.disableComponent<Position>(e1);
+	cmd.enableComponent<Position>(e2);
+	cmd.commit(entityManager);
+
+	ASSERT_FALSE(entityManager.isComponentEnabled<Position>(e1));
+	ASSERT_TRUE(entityManager.isComponentEnabled<Position>(e2));
+}
+
+TEST_F(EcsCommandBufferTest, OutOfLinePayloads)
+{
+	auto cmd = entityManager.createCommandBuffer();
+	auto proxy = cmd.createEntity();
+
+	LargePayload large;
+	for (u32 i = 0; i < large.values.size(); ++i)
+	{
+		large.values[i] = i;
+	}
+	cmd.addComponent<LargePayload>(proxy, std::move(large));
+
+	OverAlignedPayload aligned{};
+	aligned.values[7] = 42.f;
+	cmd.addComponent<OverAlignedPayload>(proxy, std::move(aligned));
+	cmd.addComponent<Position>(proxy, {1, 2, 3});
+	cmd.commit(entityManager);
+
+	auto query = entityManager.getQueryBuilder().with<spite::Read<LargePayload>>().build();
+	int count = 0;
+	for (auto& payload : query.view<spite::Read<LargePayload>>())
+	{
+		ASSERT_EQ(payload.values[0], 0u);
+		ASSERT_EQ(payload.values[large.values.size() - 1], large.values.size() - 1);
+		++count;
+	}
+	ASSERT_EQ(count, 1);
+
+	auto alignedQuery = entityManager.getQueryBuilder().with<spite::Read<OverAlignedPayload>, spite::Read<Position>>().
+	                                  build();
+	for (auto& payload : alignedQuery.view<spite::Read<OverAlignedPayload>>())
+	{
+		ASSERT_EQ(reinterpret_cast<uintptr_t>(&payload) % alignof(OverAlignedPayload), 0u);
+		ASSERT_EQ(payload.values[7], 42.f);
+	}
+}
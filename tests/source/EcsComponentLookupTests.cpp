@@ -0,0 +1,152 @@
+#include <gtest/gtest.h>
+#include <vector>
+
+#include "ecs/core/EntityWorld.hpp"
+#include "ecs/core/ComponentLookup.hpp"
+#include "base/memory/HeapAllocator.hpp"
+
+struct LookupPosition : spite::IComponent
+{
+	float x = 0.f;
+	float y = 0.f;
+
+	LookupPosition() = default;
+
+	LookupPosition(float x, float y) : x(x), y(y)
+	{
+	}
+};
+
+struct LookupParent : spite::IComponent
+{
+	spite::Entity parent;
+
+	LookupParent() = default;
+
+	explicit LookupParent(spite::Entity parent) : parent(parent)
+	{
+	}
+};
+
+struct LookupTag : spite::IComponent
+{
+};
+
+class EcsComponentLookupTest : public testing::Test
+{
+protected:
+	struct Allocators
+	{
+		spite::HeapAllocator allocator;
+
+		Allocators()
+			: allocator("EcsComponentLookupTestAllocator", 32 * spite::MB)
+		{
+		}
+
+		~Allocators() { allocator.shutdown(); }
+	};
+
+	struct Container
+	{
+		spite::AspectRegistry aspectRegistry;
+		spite::VersionManager versionManager;
+		spite::SharedComponentManager sharedComponentManager;
+		spite::ArchetypeManager archetypeManager;
+		spite::EntityManager entityManager;
+		spite::SingletonComponentRegistry singletonComponentRegistry;
+		spite::QueryRegistry queryRegistry;
+
+		Container(spite::HeapAllocator& allocator) :
+			aspectRegistry(allocator)
+			, versionManager(allocator, &aspectRegistry)
+			, sharedComponentManager(allocator)
+			, archetypeManager(allocator, &aspectRegistry, &versionManager, &sharedComponentManager)
+			, entityManager(&archetypeManager, &sharedComponentManager, &singletonComponentRegistry, &aspectRegistry,
+			                &queryRegistry, allocator),
+			singletonComponentRegistry(allocator)
+			, queryRegistry(allocator, &archetypeManager, &versionManager)
+		{
+		}
+	};
+
+	Allocators* allocContainer = new Allocators;
+	Container* container = allocContainer->allocator.new_object<Container>(allocContainer->allocator);
+	spite::ArchetypeManager& archetypeManager = container->archetypeManager;
+	spite::EntityManager& entityManager = container->entityManager;
+
+	~EcsComponentLookupTest() override
+	{
+		allocContainer->allocator.delete_object(container);
+		delete allocContainer;
+	}
+};
+
+TEST_F(EcsComponentLookupTest, ResolvesAcrossArchetypes)
+{
+	auto e1 = entityManager.createEntity();
+	auto e2 = entityManager.createEntity();
+	auto e3 = entityManager.createEntity();
+	entityManager.addComponent<LookupPosition>(e1, 1.f, 2.f);
+	entityManager.addComponent<LookupPosition>(e2, 3.f, 4.f);
+	entityManager.addComponent<LookupTag>(e2);
+	entityManager.addComponent<LookupTag>(e3);
+
+	auto lookup = entityManager.getComponentLookup<LookupPosition>();
+
+	ASSERT_TRUE(lookup.has(e1));
+	ASSERT_TRUE(lookup.has(e2));
+	EXPECT_FALSE(lookup.has(e3));
+	EXPECT_EQ(lookup.tryGet(e3), nullptr);
+
+	EXPECT_EQ(lookup.get(e1).x, 1.f);
+	EXPECT_EQ(lookup.get(e2).y, 4.f);
+	EXPECT_EQ(lookup.tryGet(e2), &entityManager.getComponent<LookupPosition>(e2));
+
+	lookup.get(e1).x = 10.f;
+	EXPECT_EQ(entityManager.getComponent<LookupPosition>(e1).x, 10.f);
+}
+
+TEST_F(EcsComponentLookupTest, FollowsEntityReferences)
+{
+	constexpr int count = 200;
+	std::vector<spite::Entity> entities;
+	for (int i = 0; i < count; ++i)
+	{
+		auto entity = entityManager.createEntity();
+		entityManager.addComponent<LookupPosition>(entity, static_cast<float>(i), 0.f);
+		entityManager.addComponent<LookupParent>(entity, i > 0 ? entities.back() : spite::Entity::undefined());
+		entities.push_back(entity);
+	}
+
+	auto parents = entityManager.getReadOnlyComponentLookup<LookupParent>();
+	auto positions = entityManager.getReadOnlyComponentLookup<LookupPosition>();
+
+	for (int i = 1; i < count; ++i)
+	{
+		const spite::Entity parent = parents.get(entities[i]).parent;
+		EXPECT_EQ(positions.get(parent).x, static_cast<float>(i - 1));
+	}
+}
+
+TEST_F(EcsComponentLookupTest, StaleAndRemovedEntities)
+{
+	auto e1 = entityManager.createEntity();
+	auto e2 = entityManager.createEntity();
+	auto e3 = entityManager.createEntity();
+	entityManager.addComponent<LookupPosition>(e1, 1.f, 0.f);
+	entityManager.addComponent<LookupPosition>(e2, 2.f, 0.f);
+	entityManager.addComponent<LookupPosition>(e3, 3.f, 0.f);
+
+	// e3 is swapped into the slot of e1 and e2 changes archetype
+	entityManager.destroyEntity(e1);
+	entityManager.addComponent<LookupTag>(e2);
+	entityManager.removeComponent<LookupPosition>(e3);
+	entityManager.addComponent<LookupPosition>(e3, 5.f, 0.f);
+
+	auto lookup = entityManager.getReadOnlyComponentLookup<LookupPosition>();
+	EXPECT_FALSE(lookup.has(e1));
+	EXPECT_EQ(lookup.tryGet(e1), nullptr);
+	EXPECT_EQ(lookup.get(e2).x, 2.f);
+	EXPECT_EQ(lookup.get(e3).x, 5.f);
+}
@@ -0,0 +1,162 @@
+#include <gtest/gtest.h>
+#include <thread>
+#include <vector>
+
+#include "ecs/core/EntityWorld.hpp"
+#include "ecs/query/QueryBuilder.hpp"
+#include "ecs/event/EntityEventManager.hpp"
+#include "base/memory/HeapAllocator.hpp"
+#include "base/memory/ScratchAllocator.hpp"
+
+struct DamageEvent : spite::IEventComponent
+{
+	int amount = 0;
+};
+
+struct SpawnEvent : spite::IEventComponent
+{
+	int id = 0;
+};
+
+class EcsEventChannelTest : public testing::Test
+{
+protected:
+	struct Allocators
+	{
+		spite::HeapAllocator allocator;
+
+		Allocators()
+			: allocator("EcsEventChannelTestAllocator", 32 * spite::MB)
+		{
+		}
+
+		~Allocators() { allocator.shutdown(); }
+	};
+
+	struct Container
+	{
+		spite::AspectRegistry aspectRegistry;
+		spite::VersionManager versionManager;
+		spite::SharedComponentManager sharedComponentManager;
+		spite::ArchetypeManager archetypeManager;
+		spite::EntityManager entityManager;
+		spite::SingletonComponentRegistry singletonComponentRegistry;
+		spite::QueryRegistry queryRegistry;
+
+		Container(spite::HeapAllocator& allocator) :
+			aspectRegistry(allocator)
+			, versionManager(allocator, &aspectRegistry)
+			, sharedComponentManager(allocator)
+			, archetypeManager(allocator, &aspectRegistry, &versionManager, &sharedComponentManager)
+			, entityManager(&archetypeManager, &sharedComponentManager, &singletonComponentRegistry, &aspectRegistry,
+			                &queryRegistry, allocator),
+			singletonComponentRegistry(allocator)
+			, queryRegistry(allocator, &archetypeManager, &versionManager)
+		{
+		}
+	};
+
+	Allocators* allocContainer = new Allocators;
+	Container* container = allocContainer->allocator.new_object<Container>(allocContainer->allocator);
+	spite::EntityManager& entityManager = container->entityManager;
+	spite::EntityEventManager& eventManager = entityManager.getEventManager();
+
+	EcsEventChannelTest()
+	{
+		eventManager.registerChannel<DamageEvent>();
+	}
+
+	~EcsEventChannelTest() override
+	{
+		allocContainer->allocator.delete_object(container);
+		delete allocContainer;
+	}
+};
+
+TEST_F(EcsEventChannelTest, EventsAreReadableAfterCommit)
+{
+	eventManager.send(DamageEvent{.amount = 5});
+	eventManager.send(DamageEvent{.amount = 7});
+	ASSERT_TRUE(eventManager.read<DamageEvent>().empty());
+
+	eventManager.commit();
+	auto events = eventManager.read<DamageEvent>();
+	ASSERT_EQ(events.size(), 2);
+	ASSERT_EQ(events[0].amount, 5);
+	ASSERT_EQ(events[1].amount, 7);
+}
+
+TEST_F(EcsEventChannelTest, EventsLiveForOneCommit)
+{
+	eventManager.send(DamageEvent{.amount = 1});
+	eventManager.commit();
+	eventManager.send(DamageEvent{.amount = 2});
+	eventManager.commit();
+
+	auto events = eventManager.read<DamageEvent>();
+	ASSERT_EQ(events.size(), 1);
+	ASSERT_EQ(events[0].amount, 2);
+
+	eventManager.commit();
+	ASSERT_TRUE(eventManager.read<DamageEvent>().empty());
+}
+
+TEST_F(EcsEventChannelTest, ChannelsAreIndependent)
+{
+	eventManager.registerChannel<SpawnEvent>();
+	ASSERT_NE(spite::EntityEventManager::getChannelId<DamageEvent>(),
+	          spite::EntityEventManager::getChannelId<SpawnEvent>());
+
+	eventManager.send(SpawnEvent{.id = 3});
+	eventManager.commit();
+	ASSERT_TRUE(eventManager.read<DamageEvent>().empty());
+	ASSERT_EQ(eventManager.read<SpawnEvent>().size(), 1);
+}
+
+TEST_F(EcsEventChannelTest, ConcurrentSend)
+{
+	constexpr int threadCount = 4;
+	constexpr int eventsPerThread = 500;
+
+	std::vector<std::thread> threads;
+	for (int t = 0; t < threadCount; ++t)
+	{
+		threads.emplace_back([this]()
+		{
+			for (int i = 0; i < eventsPerThread; ++i)
+			{
+				eventManager.send(DamageEvent{.amount = i});
+			}
+		});
+	}
+	for (auto& thread : threads)
+	{
+		thread.join();
+	}
+
+	eventManager.commit();
+	auto events = eventManager.read<DamageEvent>();
+	ASSERT_EQ(events.size(), threadCount * eventsPerThread);
+
+	int sum = 0;
+	for (const auto& event : events)
+	{
+		sum += event.amount;
+	}
+	ASSERT_EQ(sum, threadCount * (eventsPerThread - 1) * eventsPerThread / 2);
+}
+
+TEST_F(EcsEventChannelTest, FireCreatesQueryableEntity)
+{
+	eventManager.fire(SpawnEvent{.id = 9});
+	eventManager.commit();
+
+	auto query = entityManager.getQueryBuilder().with<spite::Read<SpawnEvent>, spite::Read<spite::EventTag>>().build();
+	int count = 0;
+	for (auto& event : query.view<spite::Read<SpawnEvent>>())
+	{
+		ASSERT_EQ(event.id, 9);
+		++count;
+	}
+	ASSERT_EQ(count, 1);
+}
@@ -0,0 +1,216 @@
+#include <gtest/gtest.h>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "ecs/core/EntityWorld.hpp"
+#include "ecs/serialization/WorldHistory.hpp"
+#include "base/memory/HeapAllocator.hpp"
+
+struct HistoryPosition : spite::IComponent
+{
+	float x = 0.f, y = 0.f, z = 0.f;
+};
+
+struct HistoryVelocity : spite::IComponent
+{
+	float x = 0.f;
+};
+
+// Custom serialized
+struct HistoryName : spite::IComponent
+{
+	std::string value;
+
+	static void serialize(const HistoryName& name, spite::SnapshotWriter& writer)
+	{
+		writer.writeValue(static_cast<u32>(name.value.size()));
+		writer.write(name.value.data(), name.value.size());
+	}
+
+	static HistoryName deserialize(spite::SnapshotReader& reader)
+	{
+		HistoryName name;
+		name.value.resize(reader.readValue<u32>());
+		reader.read(name.value.data(), name.value.size());
+		return name;
+	}
+};
+
+class EcsHistoryTest : public testing::Test
+{
+protected:
+	struct Allocators
+	{
+		spite::HeapAllocator allocator;
+
+		Allocators()
+			: allocator("EcsHistoryTestAllocator", 64 * spite::MB)
+		{
+		}
+
+		~Allocators() { allocator.shutdown(); }
+	};
+
+	struct Container
+	{
+		spite::AspectRegistry aspectRegistry;
+		spite::VersionManager versionManager;
+		spite::SharedComponentManager sharedComponentManager;
+		spite::ArchetypeManager archetypeManager;
+		spite::EntityManager entityManager;
+		spite::SingletonComponentRegistry singletonComponentRegistry;
+		spite::QueryRegistry queryRegistry;
+
+		Container(spite::HeapAllocator& allocator) :
+			aspectRegistry(allocator)
+			, versionManager(allocator, &aspectRegistry)
+			, sharedComponentManager(allocator)
+			, archetypeManager(allocator, &aspectRegistry, &versionManager, &sharedComponentManager)
+			, entityManager(&archetypeManager, &sharedComponentManager, &singletonComponentRegistry, &aspectRegistry,
+			                &queryRegistry, allocator),
+			singletonComponentRegistry(allocator)
+			, queryRegistry(allocator, &archetypeManager, &versionManager)
+		{
+		}
+	};
+
+	Allocators* allocContainer = new Allocators;
+	spite::HeapAllocator& allocator = allocContainer->allocator;
+	Container* container = allocator.new_object<Container>(allocator);
+	spite::EntityManager& entityManager = container->entityManager;
+
+	EcsHistoryTest()
+	{
+		spite::ComponentMetadataRegistry::registerComponent<HistoryPosition>();
+		spite::ComponentMetadataRegistry::registerComponent<HistoryVelocity>();
+		spite::ComponentMetadataRegistry::registerComponent<HistoryName>();
+	}
+
+	~EcsHistoryTest() override
+	{
+		allocator.delete_object(container);
+		delete allocContainer;
+	}
+
+	float positionOf(spite::Entity entity) const
+	{
+		return std::as_const(entityManager).getComponent<HistoryPosition>(entity).x;
+	}
+};
+
+TEST_F(EcsHistoryTest, DeltasRecordOnlyChangedColumns)
+{
+	std::vector<spite::Entity> entities;
+	for (int i = 0; i < 256; ++i)
+	{
+		auto entity = entityManager.createEntity();
+		entityManager.addComponent<HistoryPosition>(entity, HistoryPosition{{}, static_cast<float>(i)});
+		entityManager.addComponent<HistoryVelocity>(entity);
+		entities.push_back(entity);
+	}
+
+	spite::WorldHistory history(entityManager, 8, allocator);
+	const u64 full = history.capture();
+
+	// Nothing changed, only the frame framing is recorded
+	const u64 idle = history.capture();
+	ASSERT_LT(history.frameSize(idle), 16u);
+
+	// One column of one chunk
+	entityManager.getComponent<HistoryVelocity>(entities[0]).x = 1.f;
+	const u64 single = history.capture();
+	ASSERT_LT(history.frameSize(single), history.frameSize(full) / 16);
+	ASSERT_GT(history.frameSize(single), sizeof(HistoryVelocity) * spite::DEFAULT_CHUNK_CAPACITY);
+
+	for (int i = 0; i < 256; ++i)
+	{
+		entityManager.getComponent<HistoryPosition>(entities[i]).x = -1.f;
+	}
+	history.capture();
+
+	history.restore(single);
+	ASSERT_EQ(history.newestFrame(), single);
+	for (int i = 0; i < 256; ++i)
+	{
+		ASSERT_EQ(positionOf(entities[i]), static_cast<float>(i));
+	}
+	ASSERT_EQ(std::as_const(entityManager).getComponent<HistoryVelocity>(entities[0]).x, 1.f);
+
+	history.restore(full);
+	ASSERT_EQ(std::as_const(entityManager).getComponent<HistoryVelocity>(entities[0]).x, 0.f);
+}
+
+TEST_F(EcsHistoryTest, RestoreUndoesStructuralChanges)
+{
+	std::vector<spite::Entity> entities;
+	for (int i = 0; i < 100; ++i)
+	{
+		auto entity = entityManager.createEntity();
+		entityManager.addComponent<HistoryPosition>(entity, HistoryPosition{{}, static_cast<float>(i)});
+		entities.push_back(entity);
+	}
+	entityManager.addComponent<HistoryName>(entities[5], HistoryName{{}, "fifth"});
+
+	spite::WorldHistory history(entityManager, 4, allocator);
+	const u64 before = history.capture();
+
+	entityManager.destroyEntity(entities[10]);
+	entityManager.removeComponent<HistoryName>(entities[5]);
+	entityManager.addComponent<HistoryName>(entities[6], HistoryName{{}, "sixth"});
+	entityManager.disableComponent<HistoryPosition>(entities[20]);
+	auto created = entityManager.createEntity();
+	entityManager.addComponent<HistoryPosition>(created, HistoryPosition{{}, 1000.f});
+	history.capture();
+
+	history.restore(before);
+	ASSERT_FALSE(entityManager.isEntityValid(created));
+	for (int i = 0; i < 100; ++i)
+	{
+		ASSERT_TRUE(entityManager.isEntityValid(entities[i]));
+		ASSERT_EQ(positionOf(entities[i]), static_cast<float>(i));
+	}
+	ASSERT_EQ(entityManager.getComponent<HistoryName>(entities[5]).value, "fifth");
+	ASSERT_FALSE(entityManager.hasComponent<HistoryName>(entities[6]));
+	ASSERT_TRUE(entityManager.isComponentEnabled<HistoryPosition>(entities[20]));
+
+	// Restored storage keeps working and recording
+	entityManager.destroyEntity(entities[0]);
+	auto reused = entityManager.createEntity();
+	ASSERT_EQ(reused.index(), entities[0].index());
+	const u64 after = history.capture();
+	history.restore(before);
+	ASSERT_TRUE(entityManager.isEntityValid(entities[0]));
+	ASSERT_FALSE(entityManager.isEntityValid(reused));
+	ASSERT_FALSE(history.contains(after));
+}
+
+TEST_F(EcsHistoryTest, OldFramesFoldIntoBase)
+{
+	auto entity = entityManager.createEntity();
+	entityManager.addComponent<HistoryName>(entity);
+
+	spite::WorldHistory history(entityManager, 3, allocator);
+	for (int frame = 0; frame < 10; ++frame)
+	{
+		entityManager.getComponent<HistoryName>(entity).value = std::to_string(frame);
+		if (frame == 4)
+		{
+			entityManager.addComponent<HistoryPosition>(entity, HistoryPosition{{}, 4.f});
+		}
+		history.capture();
+	}
+
+	ASSERT_FALSE(history.contains(6));
+	ASSERT_EQ(history.oldestFrame(), 7u);
+	ASSERT_EQ(history.newestFrame(), 9u);
+
+	history.restore(7);
+	ASSERT_EQ(entityManager.getComponent<HistoryName>(entity).value, "7");
+	ASSERT_EQ(positionOf(entity), 4.f);
+
+	entityManager.getComponent<HistoryName>(entity).value = "branch";
+	ASSERT_EQ(history.capture(), 8u);
+	history.restore(8);
+	ASSERT_EQ(entityManager.getComponent<HistoryName>(entity).value, "branch");
+}
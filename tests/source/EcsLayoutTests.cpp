@@ -0,0 +1,263 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "ecs/core/EntityWorld.hpp"
+#include "ecs/systems/SystemContext.hpp"
+#include "base/memory/HeapAllocator.hpp"
+
+struct LayoutPosition : spite::IComponent
+{
+	float x = 0.f, y = 0.f, z = 0.f;
+};
+
+struct LayoutVelocity : spite::IComponent
+{
+	float x = 0.f;
+};
+
+// Touched rarely, pinned out of the hot block
+struct LayoutDebugInfo : spite::IComponent
+{
+	static constexpr spite::ComponentPlacement placement = spite::ComponentPlacement::eCold;
+
+	std::string label;
+};
+
+struct LayoutSpawnData : spite::IComponent
+{
+	int seed = 0;
+};
+
+class EcsLayoutTest : public testing::Test
+{
+protected:
+	struct Allocators
+	{
+		spite::HeapAllocator allocator;
+		// Stand-ins for node local arenas
+		spite::HeapAllocator firstArena;
+		spite::HeapAllocator secondArena;
+
+		Allocators()
+			: allocator("EcsLayoutTestAllocator", 64 * spite::MB),
+			  firstArena("EcsLayoutTestFirstArena", 4 * spite::MB),
+			  secondArena("EcsLayoutTestSecondArena", 4 * spite::MB)
+		{
+		}
+
+		~Allocators()
+		{
+			secondArena.shutdown();
+			firstArena.shutdown();
+			allocator.shutdown();
+		}
+	};
+
+	struct Container
+	{
+		spite::AspectRegistry aspectRegistry;
+		spite::VersionManager versionManager;
+		spite::SharedComponentManager sharedComponentManager;
+		spite::ArchetypeManager archetypeManager;
+		spite::EntityManager entityManager;
+		spite::SingletonComponentRegistry singletonComponentRegistry;
+		spite::QueryRegistry queryRegistry;
+
+		Container(spite::HeapAllocator& allocator) :
+			aspectRegistry(allocator)
+			, versionManager(allocator, &aspectRegistry)
+			, sharedComponentManager(allocator)
+			, archetypeManager(allocator, &aspectRegistry, &versionManager, &sharedComponentManager)
+			, entityManager(&archetypeManager, &sharedComponentManager, &singletonComponentRegistry, &aspectRegistry,
+			                &queryRegistry, allocator),
+			singletonComponentRegistry(allocator)
+			, queryRegistry(allocator, &archetypeManager, &versionManager)
+		{
+		}
+	};
+
+	Allocators* allocContainer = new Allocators;
+	spite::HeapAllocator& allocator = allocContainer->allocator;
+	Container* container = allocator.new_object<Container>(allocator);
+	spite::EntityManager& entityManager = container->entityManager;
+
+	EcsLayoutTest()
+	{
+		spite::ComponentMetadataRegistry::registerComponent<LayoutPosition>();
+		spite::ComponentMetadataRegistry::registerComponent<LayoutVelocity>();
+		spite::ComponentMetadataRegistry::registerComponent<LayoutDebugInfo>();
+		spite::ComponentMetadataRegistry::registerComponent<LayoutSpawnData>();
+		spite::ComponentAccessStats::reset();
+	}
+
+	~EcsLayoutTest() override
+	{
+		spite::ComponentAccessStats::setEnabled(false);
+		spite::ComponentAccessStats::reset();
+		allocator.delete_object(container);
+		delete allocContainer;
+	}
+
+	spite::ComponentPlacement placementOf(spite::Entity entity, spite::ComponentID id) const
+	{
+		const spite::Archetype* archetype = container->archetypeManager.findEntityArchetype(entity);
+		return archetype->getColumnPlacement(archetype->getComponentIndex(id));
+	}
+};
+
+TEST_F(EcsLayoutTest, AccessStatsCountChunkVisits)
+{
+	spite::Entity entity;
+	for (int i = 0; i < 200; ++i)
+	{
+		entity = entityManager.createEntity();
+		entityManager.addComponent<LayoutPosition>(entity);
+		entityManager.addComponent<LayoutVelocity>(entity);
+	}
+
+	auto query = entityManager.getQueryBuilder().with<spite::Write<LayoutPosition>, spite::Read<LayoutVelocity>>().
+	                           build();
+	auto iterate = [&]
+	{
+		for (auto [position, velocity] : query.view<spite::Write<LayoutPosition>, spite::Read<LayoutVelocity>>())
+		{
+			position.x += velocity.x;
+		}
+	};
+
+	// Disabled by default
+	iterate();
+	const spite::ComponentID positionId = spite::ComponentMetadataRegistry::getComponentId<LayoutPosition>();
+	const spite::ComponentID velocityId = spite::ComponentMetadataRegistry::getComponentId<LayoutVelocity>();
+	ASSERT_EQ(spite::ComponentAccessStats::get(positionId).writeChunks, 0u);
+
+	spite::ComponentAccessStats::setEnabled(true);
+	iterate();
+	const sizet chunkCount = container->archetypeManager.findEntityArchetype(entity)->getChunks().size();
+	ASSERT_GT(chunkCount, 1u);
+	const auto position = spite::ComponentAccessStats::get(positionId);
+	const auto velocity = spite::ComponentAccessStats::get(velocityId);
+	ASSERT_EQ(position.writeChunks, chunkCount);
+	ASSERT_EQ(position.readChunks, 0u);
+	ASSERT_EQ(position.elements, 200u);
+	ASSERT_EQ(velocity.readChunks, chunkCount);
+	ASSERT_EQ(velocity.writeChunks, 0u);
+
+	const spite::ComponentID spawnId = spite::ComponentMetadataRegistry::getComponentId<LayoutSpawnData>();
+	ASSERT_TRUE(spite::ComponentAccessStats::suggestsCold(spawnId));
+	ASSERT_FALSE(spite::ComponentAccessStats::suggestsCold(velocityId));
+
+	const std::string path = testing::TempDir() + "spite_component_access.csv";
+	ASSERT_TRUE(spite::ComponentAccessStats::exportCsv(path.c_str()));
+	std::ifstream file(path);
+	std::string line;
+	std::getline(file, line);
+	ASSERT_EQ(line, "id,type,size,pinned,read_chunks,write_chunks,elements,suggested");
+	bool foundVelocity = false;
+	while (std::getline(file, line))
+	{
+		if (line.find("LayoutVelocity") != std::string::npos)
+		{
+			foundVelocity = true;
+			ASSERT_EQ(line.substr(line.rfind(',') + 1), "hot");
+		}
+	}
+	ASSERT_TRUE(foundVelocity);
+	file.close();
+	std::remove(path.c_str());
+}
+
+TEST_F(EcsLayoutTest, ColdColumnsLiveOutsideTheHotBlock)
+{
+	std::vector<spite::Entity> entities;
+	for (int i = 0; i < 100; ++i)
+	{
+		auto entity = entityManager.createEntity();
+		entityManager.addComponent<LayoutPosition>(entity, LayoutPosition{{}, static_cast<float>(i)});
+		entityManager.addComponent<LayoutDebugInfo>(entity, LayoutDebugInfo{{}, "entity " + std::to_string(i)});
+		entityManager.addComponent<LayoutSpawnData>(entity, LayoutSpawnData{{}, i});
+		entities.push_back(entity);
+	}
+
+	const spite::ComponentID positionId = spite::ComponentMetadataRegistry::getComponentId<LayoutPosition>();
+	const spite::ComponentID debugId = spite::ComponentMetadataRegistry::getComponentId<LayoutDebugInfo>();
+	const spite::ComponentID spawnId = spite::ComponentMetadataRegistry::getComponentId<LayoutSpawnData>();
+	ASSERT_EQ(placementOf(entities[0], positionId), spite::ComponentPlacement::eHot);
+	ASSERT_EQ(placementOf(entities[0], debugId), spite::ComponentPlacement::eCold);
+	// Without access stats unpinned components stay hot
+	ASSERT_EQ(placementOf(entities[0], spawnId), spite::ComponentPlacement::eHot);
+
+	// Swaps and archetype moves go through the cold block too
+	entityManager.destroyEntity(entities[0]);
+	entityManager.removeComponent<LayoutSpawnData>(entities[1]);
+	for (int i = 1; i < 100; ++i)
+	{
+		ASSERT_EQ(std::as_const(entityManager).getComponent<LayoutPosition>(entities[i]).x, static_cast<float>(i));
+		ASSERT_EQ(std::as_const(entityManager).getComponent<LayoutDebugInfo>(entities[i]).label,
+		          "entity " + std::to_string(i));
+	}
+	ASSERT_EQ(placementOf(entities[1], debugId), spite::ComponentPlacement::eCold);
+
+	// Rarely visited components move out once the archetype is created in access stats mode
+	spite::ComponentAccessStats::setEnabled(true);
+	auto query = entityManager.getQueryBuilder().with<spite::Read<LayoutPosition>>().build();
+	for (auto& position : query.view<spite::Read<LayoutPosition>>())
+	{
+		(void)position;
+	}
+	container->archetypeManager.setChunkLayoutMode(spite::ChunkLayoutMode::eAccessStats);
+
+	auto entity = entityManager.createEntity();
+	entityManager.addComponent<LayoutPosition>(entity, LayoutPosition{{}, 7.f});
+	entityManager.addComponent<LayoutSpawnData>(entity, LayoutSpawnData{{}, 7});
+	ASSERT_EQ(placementOf(entity, positionId), spite::ComponentPlacement::eHot);
+	ASSERT_EQ(placementOf(entity, spawnId), spite::ComponentPlacement::eCold);
+	ASSERT_EQ(std::as_const(entityManager).getComponent<LayoutSpawnData>(entity).seed, 7);
+	ASSERT_EQ(std::as_const(entityManager).getComponent<LayoutPosition>(entity).x, 7.f);
+}
+
+TEST_F(EcsLayoutTest, ChunksAreSpreadOverNumaArenas)
+{
+	spite::HeapAllocator* arenas[] = {&allocContainer->firstArena, &allocContainer->secondArena};
+	container->archetypeManager.setChunkNumaArenas(arenas);
+
+	std::vector<spite::Entity> entities;
+	for (int i = 0; i < 100; ++i)
+	{
+		auto entity = entityManager.createEntity();
+		entityManager.addComponent<LayoutPosition>(entity, LayoutPosition{{}, static_cast<float>(i)});
+		entities.push_back(entity);
+	}
+
+	const auto& chunks = container->archetypeManager.findEntityArchetype(entities[0])->getChunks();
+	ASSERT_GT(chunks.size(), 2u);
+	for (sizet i = 1; i < chunks.size(); ++i)
+	{
+		ASSERT_NE(chunks[i]->numaNode(), chunks[i - 1]->numaNode());
+	}
+
+	enki::TaskScheduler scheduler;
+	scheduler.Initialize();
+	spite::SystemContext ctx(&entityManager, nullptr, 0.f, nullptr, &scheduler);
+	auto query = entityManager.getQueryBuilder().with<spite::Write<LayoutPosition>>().build();
+	std::atomic<int> visited = 0;
+	ctx.parallelForChunks(query, [&visited](spite::Chunk* chunk)
+	{
+		LayoutPosition* positions = chunk->getComponents<LayoutPosition>();
+		for (sizet i = 0; i < chunk->size(); ++i)
+		{
+			positions[i].y = positions[i].x;
+		}
+		visited.fetch_add(static_cast<int>(chunk->size()));
+	});
+	ASSERT_EQ(visited.load(), 100);
+	for (int i = 0; i < 100; ++i)
+	{
+		ASSERT_EQ(std::as_const(entityManager).getComponent<LayoutPosition>(entities[i]).y, static_cast<float>(i));
+	}
+}
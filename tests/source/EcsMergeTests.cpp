@@ -0,0 +1,222 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "ecs/core/EntityWorld.hpp"
+#include "ecs/core/StagingWorld.hpp"
+#include "base/memory/HeapAllocator.hpp"
+
+struct MergePosition : spite::IComponent
+{
+	float x = 0.f, y = 0.f, z = 0.f;
+};
+
+struct MergeName : spite::IComponent
+{
+	std::string value;
+};
+
+struct MergeMaterial : spite::ISharedComponent
+{
+	float roughness = 0.f;
+
+	bool operator==(const MergeMaterial& other) const { return roughness == other.roughness; }
+
+	struct Hash
+	{
+		size_t operator()(const MergeMaterial& m) const { return std::hash<float>()(m.roughness); }
+	};
+
+	struct Equals
+	{
+		bool operator()(const MergeMaterial& a, const MergeMaterial& b) const { return a == b; }
+	};
+};
+
+class EcsMergeTest : public testing::Test
+{
+protected:
+	struct Allocators
+	{
+		spite::HeapAllocator allocator;
+		spite::HeapAllocator stagingAllocator;
+
+		Allocators()
+			: allocator("EcsMergeTestAllocator", 64 * spite::MB),
+			  stagingAllocator("EcsMergeTestStagingAllocator", 64 * spite::MB)
+		{
+		}
+
+		~Allocators()
+		{
+			stagingAllocator.shutdown();
+			allocator.shutdown();
+		}
+	};
+
+	struct Container
+	{
+		spite::AspectRegistry aspectRegistry;
+		spite::VersionManager versionManager;
+		spite::SharedComponentManager sharedComponentManager;
+		spite::ArchetypeManager archetypeManager;
+		spite::EntityManager entityManager;
+		spite::SingletonComponentRegistry singletonComponentRegistry;
+		spite::QueryRegistry queryRegistry;
+
+		Container(spite::HeapAllocator& allocator) :
+			aspectRegistry(allocator)
+			, versionManager(allocator, &aspectRegistry)
+			, sharedComponentManager(allocator)
+			, archetypeManager(allocator, &aspectRegistry, &versionManager, &sharedComponentManager)
+			, entityManager(&archetypeManager, &sharedComponentManager, &singletonComponentRegistry, &aspectRegistry,
+			                &queryRegistry, allocator),
+			singletonComponentRegistry(allocator)
+			, queryRegistry(allocator, &archetypeManager, &versionManager)
+		{
+		}
+	};
+
+	Allocators* allocContainer = new Allocators;
+	spite::HeapAllocator& allocator = allocContainer->allocator;
+	Container* container = allocator.new_object<Container>(allocator);
+	spite::StagingWorld* staging = allocContainer->stagingAllocator.new_object<spite::StagingWorld>(
+		allocContainer->stagingAllocator);
+	spite::EntityManager& entityManager = container->entityManager;
+
+	EcsMergeTest()
+	{
+		spite::ComponentMetadataRegistry::registerComponent<MergePosition>();
+		spite::ComponentMetadataRegistry::registerComponent<MergeName>();
+		spite::ComponentMetadataRegistry::registerComponent<spite::SharedComponent<MergeMaterial>>();
+	}
+
+	~EcsMergeTest() override
+	{
+		allocContainer->stagingAllocator.delete_object(staging);
+		allocator.delete_object(container);
+		delete allocContainer;
+	}
+};
+
+TEST_F(EcsMergeTest, BackgroundBuiltWorldIsMergedWithRemappedEntities)
+{
+	auto existing = entityManager.createEntity();
+	entityManager.addComponent<MergePosition>(existing, MergePosition{{}, -1.f});
+	entityManager.setShared<MergeMaterial>(existing, MergeMaterial{{}, 0.5f});
+
+	std::vector<spite::Entity> staged;
+	std::atomic<bool> built = false;
+	std::thread loader([&]
+	{
+		spite::StagingWorld::BuildScope scope(*staging);
+		auto& stagingManager = staging->getEntityManager();
+		for (int i = 0; i < 70; ++i)
+		{
+			auto entity = stagingManager.createEntity();
+			stagingManager.addComponent<MergePosition>(entity, MergePosition{{}, static_cast<float>(i)});
+			if (i % 2 == 0)
+			{
+				stagingManager.addComponent<MergeName>(entity, MergeName{{}, "a name long enough to allocate " +
+					                                         std::to_string(i)});
+			}
+			stagingManager.setShared<MergeMaterial>(entity, MergeMaterial{{}, i < 35 ? 0.5f : 0.75f});
+			staged.push_back(entity);
+		}
+		stagingManager.disableComponent<MergePosition>(staged[3]);
+		built = true;
+	});
+	// Frames keep ending on the main thread while the loader builds
+	while (!built)
+	{
+		spite::FrameScratchAllocator::resetFrame();
+		std::this_thread::yield();
+	}
+	loader.join();
+
+	auto marker = spite::FrameScratchAllocator::get().get_scoped_marker();
+	auto remap = entityManager.mergeFrom(staging->getEntityManager());
+
+	for (int i = 0; i < 70; ++i)
+	{
+		const spite::Entity merged = remap[staged[i].index()];
+		ASSERT_TRUE(entityManager.isEntityValid(merged));
+		ASSERT_NE(merged, existing);
+		ASSERT_EQ(std::as_const(entityManager).getComponent<MergePosition>(merged).x, static_cast<float>(i));
+		ASSERT_EQ(entityManager.hasComponent<MergeName>(merged), i % 2 == 0);
+		if (i % 2 == 0)
+		{
+			ASSERT_EQ(std::as_const(entityManager).getComponent<MergeName>(merged).value,
+			          "a name long enough to allocate " + std::to_string(i));
+		}
+	}
+	ASSERT_FALSE(entityManager.isComponentEnabled<MergePosition>(remap[staged[3].index()]));
+	ASSERT_TRUE(entityManager.isComponentEnabled<MergePosition>(remap[staged[4].index()]));
+
+	// Shared values are interned into the world's pools
+	ASSERT_EQ(&entityManager.getShared<MergeMaterial>(remap[staged[0].index()]),
+	          &entityManager.getShared<MergeMaterial>(existing));
+	ASSERT_EQ(entityManager.getShared<MergeMaterial>(remap[staged[69].index()]).roughness, 0.75f);
+
+	// The staging world is empty and reusable
+	auto& stagingManager = staging->getEntityManager();
+	ASSERT_FALSE(stagingManager.isEntityValid(staged[0]));
+	auto next = stagingManager.createEntity();
+	stagingManager.addComponent<MergePosition>(next);
+	ASSERT_EQ(staging->getEntityManager().getArchetypeManager()->getEntityRecords().find(next)->indexInChunk, 0u);
+}
+
+TEST_F(EcsMergeTest, MergedChunksJoinExistingArchetypes)
+{
+	std::vector<spite::Entity> worldEntities;
+	for (int i = 0; i < 40; ++i)
+	{
+		auto entity = entityManager.createEntity();
+		entityManager.addComponent<MergePosition>(entity, MergePosition{{}, static_cast<float>(i)});
+		worldEntities.push_back(entity);
+	}
+
+	auto& stagingManager = staging->getEntityManager();
+	std::vector<spite::Entity> staged;
+	for (int i = 0; i < 10; ++i)
+	{
+		auto entity = stagingManager.createEntity();
+		stagingManager.addComponent<MergePosition>(entity, MergePosition{{}, 100.f + static_cast<float>(i)});
+		staged.push_back(entity);
+	}
+
+	auto marker = spite::FrameScratchAllocator::get().get_scoped_marker();
+	auto remap = entityManager.mergeFrom(stagingManager);
+
+	// Structural changes on both sides of the merged chunks keep records consistent
+	entityManager.destroyEntity(worldEntities[0]);
+	entityManager.destroyEntity(remap[staged[0].index()]);
+	entityManager.addComponent<MergeName>(remap[staged[1].index()]);
+	for (int i = 0; i < 30; ++i)
+	{
+		auto entity = entityManager.createEntity();
+		entityManager.addComponent<MergePosition>(entity, MergePosition{{}, 200.f});
+	}
+
+	for (int i = 1; i < 40; ++i)
+	{
+		ASSERT_EQ(std::as_const(entityManager).getComponent<MergePosition>(worldEntities[i]).x, static_cast<float>(i));
+	}
+	for (int i = 1; i < 10; ++i)
+	{
+		ASSERT_EQ(std::as_const(entityManager).getComponent<MergePosition>(remap[staged[i].index()]).x,
+		          100.f + static_cast<float>(i));
+	}
+
+	auto query = entityManager.getQueryBuilder().with<spite::Read<MergePosition>>().build();
+	int count = 0;
+	for (auto& position : query.view<spite::Read<MergePosition>>())
+	{
+		(void)position;
+		count++;
+	}
+	ASSERT_EQ(count, 39 + 9 + 30);
+}
@@ -0,0 +1,160 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+
+#include "ecs/core/EntityWorld.hpp"
+#include "ecs/cbuffer/CommandBuffer.hpp"
+#include "ecs/systems/SystemBase.hpp"
+#include "base/memory/HeapAllocator.hpp"
+
+struct ObservedPosition : spite::IComponent
+{
+	float x = 0.f;
+};
+
+struct UnobservedVelocity : spite::IComponent
+{
+	float dx = 0.f;
+};
+
+class ObserverTestSystem : public spite::SystemBase
+{
+public:
+	void subscribe(spite::SystemContext ctx)
+	{
+		observe<ObservedPosition>(ctx, spite::ObserverEvent::eAdd);
+	}
+
+	eastl::span<const spite::Entity> added(spite::SystemContext ctx) const
+	{
+		return observed<ObservedPosition>(ctx, spite::ObserverEvent::eAdd);
+	}
+};
+
+class EcsObserverTest : public testing::Test
+{
+protected:
+	struct Allocators
+	{
+		spite::HeapAllocator allocator;
+
+		Allocators()
+			: allocator("EcsObserverTestAllocator", 32 * spite::MB)
+		{
+		}
+
+		~Allocators() { allocator.shutdown(); }
+	};
+
+	struct Container
+	{
+		spite::AspectRegistry aspectRegistry;
+		spite::VersionManager versionManager;
+		spite::SharedComponentManager sharedComponentManager;
+		spite::ArchetypeManager archetypeManager;
+		spite::EntityManager entityManager;
+		spite::SingletonComponentRegistry singletonComponentRegistry;
+		spite::QueryRegistry queryRegistry;
+
+		Container(spite::HeapAllocator& allocator) :
+			aspectRegistry(allocator)
+			, versionManager(allocator, &aspectRegistry)
+			, sharedComponentManager(allocator)
+			, archetypeManager(allocator, &aspectRegistry, &versionManager, &sharedComponentManager)
+			, entityManager(&archetypeManager, &sharedComponentManager, &singletonComponentRegistry, &aspectRegistry,
+			                &queryRegistry, allocator),
+			singletonComponentRegistry(allocator)
+			, queryRegistry(allocator, &archetypeManager, &versionManager)
+		{
+		}
+	};
+
+	Allocators* allocContainer = new Allocators;
+	Container* container = allocContainer->allocator.new_object<Container>(allocContainer->allocator);
+	spite::ArchetypeManager& archetypeManager = container->archetypeManager;
+	spite::EntityManager& entityManager = container->entityManager;
+	spite::ComponentObserverRegistry& observers = archetypeManager.getObserverRegistry();
+
+	~EcsObserverTest() override
+	{
+		allocContainer->allocator.delete_object(container);
+		delete allocContainer;
+	}
+
+	static bool containsEntity(eastl::span<const spite::Entity> entities, spite::Entity entity)
+	{
+		return std::find(entities.begin(), entities.end(), entity) != entities.end();
+	}
+};
+
+TEST_F(EcsObserverTest, StructuralChangesAreRecorded)
+{
+	const auto positionId = spite::ComponentMetadataRegistry::getComponentId<ObservedPosition>();
+	const auto onAdd = observers.subscribe(positionId, spite::ObserverEvent::eAdd);
+	const auto onRemove = observers.subscribe(positionId, spite::ObserverEvent::eRemove);
+
+	auto e1 = entityManager.createEntity();
+	auto e2 = entityManager.createEntity();
+	entityManager.addComponent<ObservedPosition>(e1);
+	entityManager.addComponent<ObservedPosition>(e2);
+	entityManager.addComponent<UnobservedVelocity>(e2);
+	entityManager.destroyEntity(e1);
+
+	observers.deliver(onAdd);
+	observers.deliver(onRemove);
+
+	auto added = observers.getDelivered(onAdd);
+	ASSERT_EQ(added.size(), 2);
+	ASSERT_TRUE(containsEntity(added, e1));
+	ASSERT_TRUE(containsEntity(added, e2));
+
+	auto removed = observers.getDelivered(onRemove);
+	ASSERT_EQ(removed.size(), 1);
+	ASSERT_EQ(removed[0], e1);
+
+	// A new delivery replaces the old batch
+	observers.deliver(onAdd);
+	ASSERT_TRUE(observers.getDelivered(onAdd).empty());
+}
+
+TEST_F(EcsObserverTest, CommandBufferCommitIsRecorded)
+{
+	const auto positionId = spite::ComponentMetadataRegistry::getComponentId<ObservedPosition>();
+	const auto onAdd = observers.subscribe(positionId, spite::ObserverEvent::eAdd);
+	const auto onChange = observers.subscribe(positionId, spite::ObserverEvent::eChange);
+
+	auto existing = entityManager.createEntity();
+	entityManager.addComponent<ObservedPosition>(existing);
+	observers.deliver(onAdd);
+
+	auto cmd = entityManager.createCommandBuffer();
+	for (int i = 0; i < 10; ++i)
+	{
+		auto proxy = cmd.createEntity();
+		cmd.addComponent(proxy, ObservedPosition{.x = static_cast<float>(i)});
+	}
+	cmd.setComponent(existing, ObservedPosition{.x = 42.f});
+	cmd.commit(entityManager);
+
+	observers.deliver(onAdd);
+	observers.deliver(onChange);
+	ASSERT_EQ(observers.getDelivered(onAdd).size(), 10);
+	ASSERT_FALSE(containsEntity(observers.getDelivered(onAdd), existing));
+	ASSERT_EQ(observers.getDelivered(onChange).size(), 1);
+	ASSERT_EQ(observers.getDelivered(onChange)[0], existing);
+}
+
+TEST_F(EcsObserverTest, SystemReceivesBatches)
+{
+	ObserverTestSystem system;
+	spite::SystemContext ctx(&entityManager, nullptr, 0.f, nullptr);
+	system.subscribe(ctx);
+
+	auto e = entityManager.createEntity();
+	entityManager.addComponent<ObservedPosition>(e);
+	ASSERT_TRUE(system.added(ctx).empty());
+
+	// The system holds the only subscription of this registry
+	observers.deliver(0);
+	ASSERT_EQ(system.added(ctx).size(), 1);
+	ASSERT_EQ(system.added(ctx)[0], e);
+}
@@ -3,6 +3,7 @@
 #include "ecs/core/EntityManager.hpp"
 #include "base/memory/HeapAllocator.hpp"
 #include "ecs/core/EntityWorld.hpp"
+#include "ecs/systems/SystemBase.hpp"
 
 struct TestSingletonA : spite::ISingletonComponent
 {
@@ -14,6 +15,21 @@ struct TestSingletonB : spite::ISingletonComponent
 	float value = 20.0f;
 };
 
+struct TestPositionComponent : spite::IComponent
+{
+	float x = 0.f;
+};
+
+class SingletonAccessTestSystem : public spite::SystemBase
+{
+public:
+	void declare(spite::SystemDependencyStorage& dependencyStorage)
+	{
+		declareAccess<spite::Read<TestSingletonA>, spite::Write<TestSingletonB>, spite::Read<TestPositionComponent>>(
+			dependencyStorage);
+	}
+};
+
 class EcsSingletonComponentTest : public testing::Test
 {
 protected:
@@ -129,3 +145,44 @@ TEST_F(EcsSingletonComponentTest, EntityManagerIntegration)
 	ASSERT_EQ(s2.value, 55);
 	ASSERT_EQ(&s1, &s2);
 }
+
+TEST_F(EcsSingletonComponentTest, SingletonIdsAreStableAndDistinct)
+{
+	const spite::SingletonID idA = spite::SingletonComponentRegistry::getSingletonId<TestSingletonA>();
+	const spite::SingletonID idB = spite::SingletonComponentRegistry::getSingletonId<TestSingletonB>();
+
+	ASSERT_NE(idA, idB);
+	ASSERT_EQ(idA, spite::SingletonComponentRegistry::getSingletonId<TestSingletonA>());
+}
+
+TEST_F(EcsSingletonComponentTest, TryGetReturnsRegisteredInstance)
+{
+	ASSERT_EQ(registry.tryGet<TestSingletonA>(), nullptr);
+	ASSERT_FALSE(registry.isRegistered<TestSingletonA>());
+
+	registry.registerSingleton<TestSingletonA>();
+
+	TestSingletonA* singleton = registry.tryGet<TestSingletonA>();
+	ASSERT_NE(singleton, nullptr);
+	ASSERT_EQ(singleton, &registry.get<TestSingletonA>());
+	ASSERT_EQ(singleton, entityManager.tryGetSingletonComponent<TestSingletonA>());
+}
+
+TEST_F(EcsSingletonComponentTest, DeclareAccessRecordsSingletonDependencies)
+{
+	spite::SystemDependencyStorage dependencyStorage(allocContainer->allocator);
+	SingletonAccessTestSystem system;
+	system.declare(dependencyStorage);
+
+	const auto& deps = dependencyStorage.getDependencies(&system);
+	const spite::SingletonID idA = spite::SingletonComponentRegistry::getSingletonId<TestSingletonA>();
+	const spite::SingletonID idB = spite::SingletonComponentRegistry::getSingletonId<TestSingletonB>();
+	const spite::ComponentID positionId = spite::ComponentMetadataRegistry::getComponentId<TestPositionComponent>();
+
+	ASSERT_TRUE(deps.singletonRead.test(idA));
+	ASSERT_FALSE(deps.singletonWrite.test(idA));
+	ASSERT_TRUE(deps.singletonWrite.test(idB));
+	ASSERT_FALSE(deps.singletonRead.test(idB));
+	ASSERT_TRUE(deps.read.test(positionId));
+	ASSERT_FALSE(deps.write.test(positionId));
+}
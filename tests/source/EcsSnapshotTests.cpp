@@ -0,0 +1,285 @@
+#include <gtest/gtest.h>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "ecs/core/EntityWorld.hpp"
+#include "ecs/serialization/WorldSnapshot.hpp"
+#include "base/memory/HeapAllocator.hpp"
+
+struct SnapshotPosition : spite::IComponent
+{
+	float x = 0.f, y = 0.f, z = 0.f;
+};
+
+// Custom serialized
+struct SnapshotName : spite::IComponent
+{
+	std::string value;
+
+	static void serialize(const SnapshotName& name, spite::SnapshotWriter& writer)
+	{
+		writer.writeValue(static_cast<u32>(name.value.size()));
+		writer.write(name.value.data(), name.value.size());
+	}
+
+	static SnapshotName deserialize(spite::SnapshotReader& reader)
+	{
+		SnapshotName name;
+		name.value.resize(reader.readValue<u32>());
+		reader.read(name.value.data(), name.value.size());
+		return name;
+	}
+};
+
+// Not serializable, dropped from snapshots
+struct SnapshotTransient : spite::IComponent
+{
+	std::vector<int> values;
+};
+
+struct SnapshotMaterial : spite::ISharedComponent
+{
+	float roughness = 0.f;
+
+	bool operator==(const SnapshotMaterial& other) const { return roughness == other.roughness; }
+
+	struct Hash
+	{
+		size_t operator()(const SnapshotMaterial& m) const { return std::hash<float>()(m.roughness); }
+	};
+
+	struct Equals
+	{
+		bool operator()(const SnapshotMaterial& a, const SnapshotMaterial& b) const { return a == b; }
+	};
+};
+
+class EcsSnapshotTest : public testing::Test
+{
+protected:
+	struct Allocators
+	{
+		spite::HeapAllocator allocator;
+
+		Allocators()
+			: allocator("EcsSnapshotTestAllocator", 64 * spite::MB)
+		{
+		}
+
+		~Allocators() { allocator.shutdown(); }
+	};
+
+	struct Container
+	{
+		spite::AspectRegistry aspectRegistry;
+		spite::VersionManager versionManager;
+		spite::SharedComponentManager sharedComponentManager;
+		spite::ArchetypeManager archetypeManager;
+		spite::EntityManager entityManager;
+		spite::SingletonComponentRegistry singletonComponentRegistry;
+		spite::QueryRegistry queryRegistry;
+
+		Container(spite::HeapAllocator& allocator) :
+			aspectRegistry(allocator)
+			, versionManager(allocator, &aspectRegistry)
+			, sharedComponentManager(allocator)
+			, archetypeManager(allocator, &aspectRegistry, &versionManager, &sharedComponentManager)
+			, entityManager(&archetypeManager, &sharedComponentManager, &singletonComponentRegistry, &aspectRegistry,
+			                &queryRegistry, allocator),
+			singletonComponentRegistry(allocator)
+			, queryRegistry(allocator, &archetypeManager, &versionManager)
+		{
+		}
+	};
+
+	Allocators* allocContainer = new Allocators;
+	spite::HeapAllocator& allocator = allocContainer->allocator;
+	Container* source = allocator.new_object<Container>(allocator);
+	Container* target = allocator.new_object<Container>(allocator);
+	std::string path = (std::filesystem::temp_directory_path() / "spite_snapshot_test.bin").string();
+
+	EcsSnapshotTest()
+	{
+		spite::ComponentMetadataRegistry::registerComponent<SnapshotPosition>();
+		spite::ComponentMetadataRegistry::registerComponent<SnapshotName>();
+		spite::ComponentMetadataRegistry::registerComponent<SnapshotTransient>();
+		spite::ComponentMetadataRegistry::registerComponent<spite::SharedComponent<SnapshotMaterial>>();
+	}
+
+	~EcsSnapshotTest() override
+	{
+		allocator.delete_object(target);
+		allocator.delete_object(source);
+		delete allocContainer;
+		std::filesystem::remove(path);
+	}
+};
+
+TEST_F(EcsSnapshotTest, RawComponentsRoundTrip)
+{
+	auto& entityManager = source->entityManager;
+	std::vector<spite::Entity> entities;
+	for (int i = 0; i < 100; ++i)
+	{
+		auto entity = entityManager.createEntity();
+		entityManager.addComponent<SnapshotPosition>(entity, SnapshotPosition{{}, static_cast<float>(i), 1.f, 2.f});
+		entities.push_back(entity);
+	}
+	entityManager.destroyEntity(entities[10]);
+	entityManager.disableComponent<SnapshotPosition>(entities[20]);
+
+	ASSERT_TRUE(spite::WorldSnapshot::save(entityManager, path.c_str(), allocator));
+	ASSERT_TRUE(spite::WorldSnapshot::load(target->entityManager, path.c_str()));
+
+	auto& loaded = target->entityManager;
+	ASSERT_FALSE(loaded.isEntityValid(entities[10]));
+	for (int i = 0; i < 100; ++i)
+	{
+		if (i == 10) continue;
+		ASSERT_TRUE(loaded.isEntityValid(entities[i]));
+		ASSERT_EQ(loaded.getComponent<SnapshotPosition>(entities[i]).x, static_cast<float>(i));
+	}
+	ASSERT_FALSE(loaded.isComponentEnabled<SnapshotPosition>(entities[20]));
+	ASSERT_TRUE(loaded.isComponentEnabled<SnapshotPosition>(entities[21]));
+
+	// Index allocation continues where the saved world stopped
+	auto reused = loaded.createEntity();
+	ASSERT_EQ(reused.index(), entities[10].index());
+	ASSERT_NE(reused, entities[10]);
+
+	// Adopted chunks behave like allocated ones
+	loaded.addComponent<SnapshotName>(entities[0]);
+	loaded.destroyEntity(entities[1]);
+	ASSERT_EQ(loaded.getComponent<SnapshotPosition>(entities[0]).x, 0.f);
+	ASSERT_EQ(loaded.getComponent<SnapshotPosition>(entities[99]).x, 99.f);
+}
+
+TEST_F(EcsSnapshotTest, CustomSharedAndTransientComponents)
+{
+	auto& entityManager = source->entityManager;
+	auto first = entityManager.createEntity();
+	auto second = entityManager.createEntity();
+	entityManager.addComponent<SnapshotName>(first, SnapshotName{{}, "first"});
+	entityManager.addComponent<SnapshotName>(second, SnapshotName{{}, "a somewhat longer second name"});
+	entityManager.addComponent<SnapshotTransient>(second);
+	entityManager.setShared<SnapshotMaterial>(first, SnapshotMaterial{{}, 0.5f});
+	entityManager.setShared<SnapshotMaterial>(second, SnapshotMaterial{{}, 0.5f});
+
+	ASSERT_TRUE(spite::WorldSnapshot::save(entityManager, path.c_str(), allocator));
+	ASSERT_TRUE(spite::WorldSnapshot::load(target->entityManager, path.c_str()));
+
+	auto& loaded = target->entityManager;
+	ASSERT_EQ(loaded.getComponent<SnapshotName>(first).value, "first");
+	ASSERT_EQ(loaded.getComponent<SnapshotName>(second).value, "a somewhat longer second name");
+	ASSERT_FALSE(loaded.hasComponent<SnapshotTransient>(second));
+
+	ASSERT_EQ(loaded.getShared<SnapshotMaterial>(first).roughness, 0.5f);
+	ASSERT_EQ(&loaded.getShared<SnapshotMaterial>(first), &loaded.getShared<SnapshotMaterial>(second));
+
+	// Restored reference counts allow copy-on-write
+	loaded.getMutableShared<SnapshotMaterial>(first).roughness = 0.9f;
+	ASSERT_EQ(loaded.getShared<SnapshotMaterial>(first).roughness, 0.9f);
+	ASSERT_EQ(loaded.getShared<SnapshotMaterial>(second).roughness, 0.5f);
+}
+
+TEST_F(EcsSnapshotTest, MalformedFilesAreRejected)
+{
+	auto& entityManager = source->entityManager;
+	auto entity = entityManager.createEntity();
+	entityManager.addComponent<SnapshotPosition>(entity);
+
+	spite::SnapshotWriter writer(allocator);
+	spite::WorldSnapshot::write(entityManager, writer);
+
+	// Truncated
+	{
+		std::ofstream file(path, std::ios::binary | std::ios::trunc);
+		file.write(reinterpret_cast<const char*>(writer.data()), static_cast<std::streamsize>(writer.size() / 2));
+	}
+	ASSERT_FALSE(spite::WorldSnapshot::load(target->entityManager, path.c_str()));
+
+	// Wrong magic
+	writer.at<spite::SnapshotHeader>(0).magic = 0;
+	{
+		std::ofstream file(path, std::ios::binary | std::ios::trunc);
+		file.write(reinterpret_cast<const char*>(writer.data()), static_cast<std::streamsize>(writer.size()));
+	}
+	ASSERT_FALSE(spite::WorldSnapshot::load(target->entityManager, path.c_str()));
+	ASSERT_FALSE(spite::WorldSnapshot::load(target->entityManager, "missing_snapshot_file.bin"));
+	ASSERT_TRUE(target->entityManager.isPristine());
+}
+
+TEST_F(EcsSnapshotTest, CorruptDataLeavesTheWorldUntouched)
+{
+	auto& entityManager = source->entityManager;
+	auto entity = entityManager.createEntity();
+	entityManager.addComponent<SnapshotName>(entity, SnapshotName{{}, "a name long enough to allocate its storage"});
+	entityManager.setShared<SnapshotMaterial>(entity, SnapshotMaterial{{}, 0.5f});
+
+	spite::SnapshotWriter writer(allocator);
+	spite::WorldSnapshot::write(entityManager, writer);
+	const std::vector<std::byte> intact(writer.data(), writer.data() + writer.size());
+	const auto& header = *reinterpret_cast<const spite::SnapshotHeader*>(intact.data());
+	ASSERT_EQ(header.chunkCount, 1u);
+	ASSERT_EQ(header.sharedPoolCount, 1u);
+
+	auto loadCorrupted = [&](auto&& corrupt)
+	{
+		std::vector<std::byte> bytes = intact;
+		corrupt(bytes.data());
+		{
+			std::ofstream file(path, std::ios::binary | std::ios::trunc);
+			file.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+		}
+		return spite::WorldSnapshot::load(target->entityManager, path.c_str());
+	};
+	auto chunkOf = [&](std::byte* bytes)
+	{
+		return reinterpret_cast<spite::SnapshotChunk*>(bytes + header.chunksOffset);
+	};
+
+	// Entity generation that was never allocated
+	ASSERT_FALSE(loadCorrupted([&](std::byte* bytes)
+	{
+		auto* stored = reinterpret_cast<spite::Entity*>(bytes + chunkOf(bytes)->entitiesOffset);
+		*stored = spite::Entity(stored->index(), stored->generation() + 1);
+	}));
+	// Entity index past the generations table
+	ASSERT_FALSE(loadCorrupted([&](std::byte* bytes)
+	{
+		auto* stored = reinterpret_cast<spite::Entity*>(bytes + chunkOf(bytes)->entitiesOffset);
+		*stored = spite::Entity(header.generationCount, 0);
+	}));
+	auto firstColumnOf = [&](std::byte* bytes)
+	{
+		return reinterpret_cast<spite::SnapshotColumn*>(bytes + header.columnsOffset);
+	};
+	// Column offset that wraps around the block size check
+	ASSERT_FALSE(loadCorrupted([&](std::byte* bytes)
+	{
+		firstColumnOf(bytes)->offset = ~0ull - 7;
+	}));
+	// Column offset misaligned for its component
+	ASSERT_FALSE(loadCorrupted([&](std::byte* bytes)
+	{
+		firstColumnOf(bytes)->offset += 1;
+	}));
+	// Truncated custom column
+	ASSERT_FALSE(loadCorrupted([&](std::byte* bytes)
+	{
+		chunkOf(bytes)->customSize = 6;
+	}));
+	// Truncated shared pool
+	ASSERT_FALSE(loadCorrupted([&](std::byte* bytes)
+	{
+		reinterpret_cast<spite::SnapshotSharedPool*>(bytes + header.sharedPoolsOffset)->size = 4;
+	}));
+	ASSERT_TRUE(target->entityManager.isPristine());
+
+	ASSERT_TRUE(loadCorrupted([](std::byte*) {}));
+	ASSERT_EQ(target->entityManager.getComponent<SnapshotName>(entity).value,
+	          "a name long enough to allocate its storage");
+	ASSERT_EQ(target->entityManager.getShared<SnapshotMaterial>(entity).roughness, 0.5f);
+}
@@ -0,0 +1,224 @@
+#include <gtest/gtest.h>
+#include <chrono>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "base/CollectionUtilities.hpp"
+#include "base/memory/HeapAllocator.hpp"
+#include "base/memory/ScratchAllocator.hpp"
+
+class FlatHashMapTest : public testing::Test {
+protected:
+    spite::HeapAllocator allocator;
+
+    FlatHashMapTest() : allocator("FlatHashMapTestAllocator", 16 * spite::MB) {}
+    ~FlatHashMapTest() override {
+        allocator.shutdown();
+    }
+};
+
+// Every key lands in the same group and the same control bits
+struct CollidingHash {
+    sizet operator()(int) const { return 0; }
+};
+
+TEST_F(FlatHashMapTest, InsertFindErase) {
+    auto map = spite::makeHeapFlatMap<int, int>(allocator);
+    ASSERT_TRUE(map.empty());
+    ASSERT_EQ(map.find(1), map.end());
+    ASSERT_EQ(map.begin(), map.end());
+
+    ASSERT_TRUE(map.emplace(1, 10).second);
+    ASSERT_FALSE(map.emplace(1, 20).second);
+    map[2] = 20;
+    ASSERT_EQ(map.size(), 2u);
+    ASSERT_EQ(map.find(1)->second, 10);
+    ASSERT_EQ(map.at(2), 20);
+    ASSERT_TRUE(map.contains(2));
+    ASSERT_THROW(map.at(3), std::runtime_error);
+
+    ASSERT_EQ(map.erase(1), 1u);
+    ASSERT_EQ(map.erase(1), 0u);
+    ASSERT_FALSE(map.contains(1));
+    ASSERT_EQ(map.size(), 1u);
+}
+
+TEST_F(FlatHashMapTest, GrowsAndKeepsEveryElement) {
+    auto map = spite::makeHeapFlatMap<int, int>(allocator);
+    for (int i = 0; i < 10000; ++i) {
+        map[i * 7] = i;
+    }
+    ASSERT_EQ(map.size(), 10000u);
+    for (int i = 0; i < 10000; i += 2) {
+        map.erase(i * 7);
+    }
+    for (int i = 0; i < 10000; ++i) {
+        auto it = map.find(i * 7);
+        if (i % 2 == 0) {
+            ASSERT_EQ(it, map.end());
+        } else {
+            ASSERT_NE(it, map.end());
+            ASSERT_EQ(it->second, i);
+        }
+    }
+
+    int visited = 0;
+    for (const auto& [key, value] : map) {
+        ASSERT_EQ(key, value * 7);
+        visited++;
+    }
+    ASSERT_EQ(visited, 5000);
+}
+
+TEST_F(FlatHashMapTest, CollisionsProbeAcrossGroups) {
+    spite::heap_flat_map<int, int, CollidingHash> map{
+        spite::HeapAllocatorAdapter<eastl::pair<const int, int>>(allocator)};
+    for (int i = 0; i < 100; ++i) {
+        map.emplace(i, -i);
+    }
+    // Tombstones in full groups must not cut probe sequences short
+    for (int i = 0; i < 100; i += 3) {
+        map.erase(i);
+    }
+    for (int i = 0; i < 100; ++i) {
+        ASSERT_EQ(map.contains(i), i % 3 != 0);
+    }
+    for (int i = 0; i < 100; i += 3) {
+        map.emplace(i, -i);
+    }
+    for (int i = 0; i < 100; ++i) {
+        ASSERT_EQ(map.at(i), -i);
+    }
+}
+
+TEST_F(FlatHashMapTest, ChurnReusesTombstones) {
+    auto map = spite::makeHeapFlatMap<int, int>(allocator);
+    for (int i = 0; i < 100; ++i) {
+        map[i] = i;
+    }
+    const sizet capacity = map.capacity();
+    for (int round = 1; round < 200; ++round) {
+        for (int i = 0; i < 100; ++i) {
+            map.erase(round * 100 + i - 100);
+            map[round * 100 + i] = i;
+        }
+    }
+    ASSERT_EQ(map.size(), 100u);
+    ASSERT_LE(map.capacity(), capacity * 2);
+}
+
+TEST_F(FlatHashMapTest, EraseWhileIterating) {
+    auto map = spite::makeHeapFlatMap<int, int>(allocator);
+    for (int i = 0; i < 1000; ++i) {
+        map[i] = i;
+    }
+    for (auto it = map.begin(); it != map.end();) {
+        if (it->first % 2) {
+            it = map.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    ASSERT_EQ(map.size(), 500u);
+    for (const auto& [key, value] : map) {
+        ASSERT_EQ(key % 2, 0);
+    }
+}
+
+TEST_F(FlatHashMapTest, NonTrivialElements) {
+    auto marker = std::make_shared<int>(0);
+    {
+        spite::heap_flat_map<std::string, std::shared_ptr<int>> map{
+            spite::HeapAllocatorAdapter<eastl::pair<const std::string, std::shared_ptr<int>>>(allocator)};
+        for (int i = 0; i < 300; ++i) {
+            map.emplace("a key long enough to allocate " + std::to_string(i), marker);
+        }
+        map.erase("a key long enough to allocate 7");
+        ASSERT_EQ(marker.use_count(), 300);
+
+        auto copy = map;
+        ASSERT_EQ(marker.use_count(), 599);
+        ASSERT_TRUE(copy.contains("a key long enough to allocate 299"));
+        ASSERT_FALSE(copy.contains("a key long enough to allocate 7"));
+
+        auto moved = std::move(copy);
+        ASSERT_TRUE(copy.empty());
+        ASSERT_EQ(moved.size(), 299u);
+        moved.clear();
+        ASSERT_EQ(marker.use_count(), 300);
+
+        spite::heap_flat_map<int, std::unique_ptr<int>> owners{
+            spite::HeapAllocatorAdapter<eastl::pair<const int, std::unique_ptr<int>>>(allocator)};
+        for (int i = 0; i < 100; ++i) {
+            owners.emplace(i, std::make_unique<int>(i));
+        }
+        ASSERT_EQ(*owners.at(42), 42);
+    }
+    ASSERT_EQ(marker.use_count(), 1);
+}
+
+TEST_F(FlatHashMapTest, ScratchBackedSet) {
+    spite::ScratchAllocator scratch(1 * spite::MB);
+    {
+        auto set = spite::makeScratchFlatSet<u32>(scratch);
+        set.reserve(1000);
+        const sizet capacity = set.capacity();
+        const sizet used = scratch.bytes_used();
+        for (u32 i = 0; i < 1000; ++i) {
+            ASSERT_TRUE(set.insert(i * 3).second);
+        }
+        ASSERT_FALSE(set.insert(3u).second);
+        // Reserved up front, nothing else came from the scratch buffer
+        ASSERT_EQ(set.capacity(), capacity);
+        ASSERT_EQ(scratch.bytes_used(), used);
+        ASSERT_TRUE(scratch.owns(&*set.begin()));
+        ASSERT_TRUE(set.contains(2997u));
+        ASSERT_FALSE(set.contains(2998u));
+    }
+    scratch.reset();
+}
+
+// Run with --gtest_also_run_disabled_tests
+TEST_F(FlatHashMapTest, DISABLED_Benchmark) {
+    constexpr int count = 100000;
+    constexpr int iterations = 10;
+    std::vector<u64> keys(count);
+    std::mt19937_64 random(42);
+    for (u64& key : keys) {
+        key = random();
+    }
+
+    auto measure = [&](auto& map) {
+        const auto start = std::chrono::high_resolution_clock::now();
+        u64 sum = 0;
+        for (int iteration = 0; iteration < iterations; ++iteration) {
+            map.clear();
+            for (int i = 0; i < count; ++i) map[keys[i]] = i;
+            // Half hits, half misses
+            for (int i = 0; i < count; ++i) {
+                auto it = map.find(keys[i] ^ (i & 1));
+                if (it != map.end()) sum += it->second;
+            }
+            for (int i = 0; i < count; i += 2) map.erase(keys[i]);
+        }
+        const auto end = std::chrono::high_resolution_clock::now();
+        EXPECT_GT(sum, 0u);
+        return std::chrono::duration<double, std::milli>(end - start).count() / iterations;
+    };
+
+    double chainedTime;
+    {
+        auto chained = spite::makeHeapMap<u64, int>(allocator);
+        chainedTime = measure(chained);
+    }
+    double flatTime;
+    {
+        auto flat = spite::makeHeapFlatMap<u64, int>(allocator);
+        flatTime = measure(flat);
+    }
+
+    printf("%d keys: chained map %.3f ms, flat map %.3f ms (x%.1f)\n", count, chainedTime, flatTime,
+           chainedTime / flatTime);
+}
@@ -0,0 +1,52 @@
+#include <gtest/gtest.h>
+#include <cstring>
+
+#include "base/StringInterner.hpp"
+#include "base/memory/HeapAllocator.hpp"
+
+using spite::operator""_hs;
+
+class HashedStringTest : public testing::Test {
+protected:
+    spite::HeapAllocator allocator;
+
+    HashedStringTest() : allocator("HashedStringTestAllocator", 1 * spite::MB) {
+        spite::StringInterner::init(allocator);
+    }
+    ~HashedStringTest() override {
+        spite::StringInterner::destroy();
+        allocator.shutdown();
+    }
+};
+
+// Literals are folded at compile time
+static_assert("Geometry"_hs.id() == spite::hashString("Geometry", 8));
+static_assert("Geometry"_hs != "Depth"_hs);
+static_assert(!""_hs.isValid());
+
+TEST_F(HashedStringTest, LiteralsMatchInternedStrings) {
+    const spite::HashedString interned = spite::toHashedString("Geometry");
+    ASSERT_EQ(interned, "Geometry"_hs);
+    ASSERT_EQ(spite::toHashedString("Geometry"), interned);
+    ASSERT_NE(interned, spite::toHashedString("geometry"));
+    ASSERT_STREQ(interned.c_str(), "Geometry");
+
+    const spite::heap_string name("cameraUBO", spite::HeapAllocatorAdapter<char>(allocator));
+    ASSERT_EQ(spite::StringInterner::get()->getOrCreate(name), "cameraUBO"_hs);
+
+    ASSERT_EQ(spite::toHashedString(""), spite::HashedString::undefined());
+    ASSERT_STREQ(spite::HashedString::undefined().c_str(), "");
+}
+
+TEST_F(HashedStringTest, UnregisteredNames) {
+    const spite::HashedString literal = "NeverInterned"_hs;
+#ifdef DEBUG
+    ASSERT_STREQ(literal.c_str(), "NeverInterned");
+#else
+    ASSERT_EQ(literal.c_str(), nullptr);
+#endif
+    ASSERT_EQ(spite::StringInterner::get()->resolve(literal), nullptr);
+
+    spite::toHashedString("NeverInterned");
+    ASSERT_STREQ(spite::StringInterner::get()->resolve(literal), "NeverInterned");
+}
@@ -0,0 +1,122 @@
+#include <gtest/gtest.h>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "engine/math/TransformKernels.hpp"
+
+namespace
+{
+	// Path the transform system used before the batched kernel
+	glm::mat4 composeReference(const spite::TransformComponent& transform)
+	{
+		glm::mat4 matrix = glm::translate(glm::mat4(1.0f), transform.position);
+		matrix = matrix * glm::mat4_cast(transform.rotation);
+		return glm::scale(matrix, transform.scale);
+	}
+
+	std::vector<spite::TransformComponent> makeTransforms(size_t count)
+	{
+		std::mt19937 rng(1337);
+		std::uniform_real_distribution<float> position(-100.f, 100.f);
+		std::uniform_real_distribution<float> unit(-1.f, 1.f);
+		std::uniform_real_distribution<float> scale(0.1f, 4.f);
+
+		std::vector<spite::TransformComponent> transforms(count);
+		for (auto& transform : transforms)
+		{
+			transform.position = {position(rng), position(rng), position(rng)};
+			glm::quat rotation(unit(rng), unit(rng), unit(rng), unit(rng));
+			const float length = std::sqrt(rotation.w * rotation.w + rotation.x * rotation.x +
+				rotation.y * rotation.y + rotation.z * rotation.z);
+			transform.rotation = glm::quat(rotation.w / length, rotation.x / length, rotation.y / length,
+			                               rotation.z / length);
+			transform.scale = {scale(rng), scale(rng), scale(rng)};
+		}
+		return transforms;
+	}
+
+	void expectMatrixNear(const glm::mat4& actual, const glm::mat4& expected)
+	{
+		for (int column = 0; column < 4; ++column)
+		{
+			for (int row = 0; row < 4; ++row)
+			{
+				EXPECT_NEAR(actual[column][row], expected[column][row], 1e-4f) << "column " << column << " row " << row;
+			}
+		}
+	}
+}
+
+TEST(TransformKernelTest, SingleMatchesGlm)
+{
+	for (const auto& transform : makeTransforms(64))
+	{
+		expectMatrixNear(spite::composeTransformMatrix(transform), composeReference(transform));
+	}
+}
+
+TEST(TransformKernelTest, BatchMatchesGlmForEveryTailLength)
+{
+	const auto transforms = makeTransforms(37);
+	// Covers counts below, at and between the vector widths
+	for (size_t count = 0; count <= transforms.size(); ++count)
+	{
+		std::vector<spite::TransformMatrixComponent> matrices(count + 1);
+		matrices[count].matrix = glm::mat4(42.f);
+
+		spite::composeTransformMatrices(transforms.data(), matrices.data(), count);
+
+		for (size_t i = 0; i < count; ++i)
+		{
+			expectMatrixNear(matrices[i].matrix, composeReference(transforms[i]));
+		}
+		// Nothing past the end is written
+		expectMatrixNear(matrices[count].matrix, glm::mat4(42.f));
+	}
+}
+
+// Run with --gtest_also_run_disabled_tests
+TEST(TransformKernelTest, DISABLED_Benchmark)
+{
+	constexpr size_t count = 200000;
+	constexpr int iterations = 20;
+	const auto transforms = makeTransforms(count);
+	std::vector<spite::TransformMatrixComponent> matrices(count);
+
+	auto measure = [&](auto&& compose)
+	{
+		const auto start = std::chrono::high_resolution_clock::now();
+		for (int i = 0; i < iterations; ++i)
+		{
+			compose();
+		}
+		const auto end = std::chrono::high_resolution_clock::now();
+		return std::chrono::duration<double, std::milli>(end - start).count() / iterations;
+	};
+
+	const double glmTime = measure([&]
+	{
+		for (size_t i = 0; i < count; ++i)
+		{
+			matrices[i].matrix = composeReference(transforms[i]);
+		}
+	});
+	const double scalarTime = measure([&]
+	{
+		for (size_t i = 0; i < count; ++i)
+		{
+			matrices[i].matrix = spite::composeTransformMatrix(transforms[i]);
+		}
+	});
+	const double batchTime = measure([&]
+	{
+		spite::composeTransformMatrices(transforms.data(), matrices.data(), count);
+	});
+
+	std::printf("%zu transforms: glm %.3f ms, scalar %.3f ms, batched %.3f ms\n", count, glmTime, scalarTime,
+	            batchTime);
+	ASSERT_FALSE(std::isnan(matrices[count - 1].matrix[3][3]));
+}